@@ -58,6 +58,9 @@ Vehicle ID to access.
 This program provides a textual console to an OVMS module, using
 the server v3 (MQTT) protocol.
 
+Delta encoded vector metrics (module config server.v3 metrics.delta)
+are decoded and shown as full value lists.
+
 =cut
 
 our $verbose = 0;       # "1" if verbose output is requested
@@ -114,6 +117,7 @@ $prefix = "ovms/$username/$vehicleid" if (!defined $prefix);
 
 our $rl;
 my $commandsoutstanding = 0;
+my %deltastate;           # delta encoded metrics: name => [ seq, [ values ] ]
 
 sub newprompt()
   {
@@ -140,6 +144,44 @@ sub mqtt_event
   &newprompt();
   }
 
+# Decode delta encoded vector metric frame:
+#   keyframe {"q":<seq>,"s":<scale>,"k":[<values>]}
+#   delta    {"q":<seq>,"s":<scale>,"d":[<index>,<value>,...]}
+# Returns the comma separated value list, undef if out of sequence
+sub decode_delta
+  {
+  my ($name, $frame) = @_;
+
+  my ($seq) = $frame =~ /"q":(\d+)/;
+  my ($scale) = $frame =~ /"s":(\d+)/;
+  my ($type, $list) = $frame =~ /"([kd])":\[([-\d,]*)\]/;
+  return undef if (!defined $seq || !$scale || !defined $type);
+
+  my @nums = split /,/, $list;
+  if ($type eq 'k')
+    {
+    $deltastate{$name} = [ $seq, [ @nums ] ];
+    }
+  elsif (defined $deltastate{$name} && $seq == $deltastate{$name}->[0] + 1)
+    {
+    my $values = $deltastate{$name}->[1];
+    while (@nums >= 2)
+      {
+      my $idx = shift @nums;
+      $values->[$idx] = shift @nums;
+      }
+    $deltastate{$name}->[0] = $seq;
+    }
+  else
+    {
+    # lost sync, wait for next keyframe:
+    delete $deltastate{$name};
+    return undef;
+    }
+
+  return join(',', map { $_ / $scale } @{$deltastate{$name}->[1]});
+  }
+
 sub mqtt_metric
   {
   my ($topic, $message) = @_;
@@ -148,6 +190,11 @@ sub mqtt_metric
     {
     $topic = substr($topic,length($prefix)+8);
     $topic =~ s/\//\./g;
+    if ($topic =~ s/\.delta$//)
+      {
+      $message = &decode_delta($topic, $message);
+      return if (!defined $message);
+      }
     AnyEvent::ReadLine::Gnu->print("METRIC $topic=$message\n");
     &newprompt();
     }
@@ -892,9 +892,11 @@ void can::IncomingFrame(CAN_frame_t* p_frame)
   NotifyListeners(p_frame, false);
   }
 
-void can::RegisterListener(QueueHandle_t queue, bool txfeedback)
+void can::RegisterListener(QueueHandle_t queue, bool txfeedback, CanListenerFilter filter)
   {
-  m_listeners[queue] = txfeedback;
+  CanListener_t& listener = m_listeners[queue];
+  listener.txfeedback = txfeedback;
+  listener.filter = filter;
   }
 
 void can::DeregisterListener(QueueHandle_t queue)
@@ -908,8 +910,11 @@ void can::NotifyListeners(const CAN_frame_t* frame, bool tx)
   {
   for (CanListenerMap_t::iterator it = m_listeners.begin(); it != m_listeners.end(); ++it)
     {
-    if (!tx || (tx && it->second))
-      xQueueSend(it->first,frame,0);
+    if (tx && !it->second.txfeedback)
+      continue;
+    if (it->second.filter && !it->second.filter(frame))
+      continue;
+    xQueueSend(it->first,frame,0);
     }
   }
 
@@ -1021,6 +1026,7 @@ void canbus::ClearStatus()
 void canbus::AttachDBC(dbcfile *dbcfile)
   {
   if (m_dbcfile) DetachDBC();
+  OvmsMutexLock ldbc(&MyDBC.m_mutex);
   m_dbcfile = dbcfile;
   m_dbcfile->LockFile();
   }
@@ -1029,8 +1035,10 @@ bool canbus::AttachDBC(const char *name)
   {
   if (m_dbcfile) DetachDBC();
 
-  dbcfile *dbcfile = MyDBC.Find(name);
-  if (dbcfile == NULL) return false;
+  OvmsMutexLock ldbc(&MyDBC.m_mutex);
+  auto f = MyDBC.m_dbclist.find(name);
+  if (f == MyDBC.m_dbclist.end()) return false;
+  dbcfile *dbcfile = f->second;
 
   m_dbcfile = dbcfile;
   m_dbcfile->LockFile();
@@ -343,7 +343,15 @@ class canbus : public pcp, public InternalRamAllocated
 // can - the CAN system controller
 ////////////////////////////////////////////////////////////////////////
 
-typedef std::map<QueueHandle_t, bool> CanListenerMap_t;
+// Listener filter: return false to skip the frame for the listener
+typedef std::function<bool(const CAN_frame_t*)> CanListenerFilter;
+
+typedef struct
+  {
+  bool txfeedback;                    // Also deliver TX results
+  CanListenerFilter filter;           // Optional frame filter (called in the CAN task)
+  } CanListener_t;
+typedef std::map<QueueHandle_t, CanListener_t> CanListenerMap_t;
 
 
 class CanFrameCallbackEntry
@@ -377,7 +385,7 @@ class can : public InternalRamAllocated
     QueueHandle_t m_rxqueue;
 
   public:
-    void RegisterListener(QueueHandle_t queue, bool txfeedback=false);
+    void RegisterListener(QueueHandle_t queue, bool txfeedback=false, CanListenerFilter filter=NULL);
     void DeregisterListener(QueueHandle_t queue);
     void NotifyListeners(const CAN_frame_t* frame, bool tx);
 
@@ -177,6 +177,19 @@ size_t canformat_crtd::put(CAN_log_message_t* message, uint8_t *buffer, size_t l
     // We look for something like
     // 1524311386.811100 1R11 100 01 02 03
     if (!isdigit(b[0])) return consumed;    // Discard invalid line
+    message->timestamp.tv_sec = strtol(b,NULL,10);
+    message->timestamp.tv_usec = 0;
+    for (;((*b != 0)&&(*b != ' ')&&(*b != '.'));b++) {}
+    if (*b == '.')
+      {
+      // Fraction: up to 6 digits (µs)
+      long scale = 100000;
+      for (b++;isdigit(*b);b++)
+        {
+        message->timestamp.tv_usec += (*b - '0') * scale;
+        scale /= 10;
+        }
+      }
     for (;((*b != 0)&&(*b != ' '));b++) {}
     if (*b == 0) return consumed;           // Discard invalid line
     b++;
@@ -39,8 +39,8 @@ static const char *TAG = "dbc";
 #include <stdlib.h>
 #include <math.h>
 #include "dbc.h"
-#include "dbc_tokeniser.hpp"
 #include "dbc_parser.hpp"
+#include "dbc_tokeniser.hpp"
 #ifdef CONFIG_OVMS
 #include "ovms_config.h"
 #endif // #ifdef CONFIG_OVMS
@@ -105,6 +105,49 @@ dbc_extract_bits_big_endian(uint8_t *candata, unsigned int bpos, unsigned int bi
   return val;
   }
 
+static void
+dbc_insert_bits_little_endian(uint8_t *candata, unsigned int bpos, unsigned int bits, uint64_t val)
+  {
+  unsigned int aligner, shifter;
+  uint8_t mask;
+
+  while (bits > 0 && bpos < 64)
+    {
+    aligner = bpos % 8;
+    shifter = 8 - aligner;
+    shifter = MIN(shifter, bits);
+
+    mask = ((1 << shifter) - 1) << aligner;
+    candata[bpos/8] = (candata[bpos/8] & ~mask) | ((val << aligner) & mask);
+    val >>= shifter;
+
+    bpos += shifter;
+    bits -= shifter;
+    }
+  }
+
+static void
+dbc_insert_bits_big_endian(uint8_t *candata, unsigned int bpos, unsigned int bits, uint64_t val)
+  {
+  unsigned int pos, aligner, slicer;
+  uint8_t mask;
+
+  pos = bits;
+  while (bits > 0 && bpos < 64)
+    {
+    slicer = (bpos % 8) + 1;
+    slicer = MIN(slicer, bits);
+    aligner = ((bpos % 8) + 1) - slicer;
+
+    pos -= slicer;
+    mask = ((1 << slicer) - 1) << aligner;
+    candata[bpos/8] = (candata[bpos/8] & ~mask) | (((val >> pos) << aligner) & mask);
+
+    bpos = ((bpos / 8) + 1) * 8 + 7;
+    bits -= slicer;
+    }
+  }
+
 uint32_t dbcMessageIdFromString(const char* id)
   {
   uint32_t msgid = 0;
@@ -172,6 +215,110 @@ void dbcCommentTable::WriteFile(dbcOutputCallback callback,
     }
   }
 
+////////////////////////////////////////////////////////////////////////
+// dbcAttribute...
+
+dbcAttributeTable::dbcAttributeTable()
+  {
+  }
+
+dbcAttributeTable::~dbcAttributeTable()
+  {
+  EmptyContent();
+  }
+
+void dbcAttributeTable::SetAttribute(const std::string& name, const dbcNumber& value)
+  {
+  m_entrymap[name] = value;
+  }
+
+void dbcAttributeTable::RemoveAttribute(const std::string& name)
+  {
+  m_entrymap.erase(name);
+  }
+
+bool dbcAttributeTable::HasAttribute(const std::string& name)
+  {
+  return (m_entrymap.find(name) != m_entrymap.end());
+  }
+
+dbcNumber dbcAttributeTable::GetAttribute(const std::string& name)
+  {
+  auto search = m_entrymap.find(name);
+  if (search != m_entrymap.end())
+    return search->second;
+  else
+    return dbcNumber();
+  }
+
+int dbcAttributeTable::GetCount()
+  {
+  return m_entrymap.size();
+  }
+
+void dbcAttributeTable::EmptyContent()
+  {
+  m_entrymap.clear();
+  }
+
+void dbcAttributeTable::WriteFile(dbcOutputCallback callback,
+                                  void* param,
+                                  std::string object)
+  {
+  for (dbcAttributeEntry_t::iterator it=m_entrymap.begin();
+       it != m_entrymap.end();
+       ++it)
+    {
+    std::ostringstream ss;
+    ss << "BA_ \"";
+    ss << it->first;
+    ss << "\" ";
+    ss << object;
+    ss << " ";
+    ss << it->second;
+    ss << ";\n";
+    callback(param,ss.str().c_str());
+    }
+  }
+
+////////////////////////////////////////////////////////////////////////
+// dbcMuxTable...
+
+dbcMuxTable::dbcMuxTable()
+  {
+  }
+
+dbcMuxTable::~dbcMuxTable()
+  {
+  EmptyContent();
+  }
+
+void dbcMuxTable::AddSignal(dbcSignal* signal, uint32_t min, uint32_t max)
+  {
+  if (max < min) std::swap(min, max);
+  if (max - min < DBC_MUX_MAXEXPAND
+    && m_values.size() + (max - min) < DBC_MUX_MAXVALUES)
+    {
+    // Note: check before increment, max may be UINT32_MAX
+    for (uint32_t val = min; ; val++)
+      {
+      m_values[val].push_back(signal);
+      if (val == max) break;
+      }
+    }
+  else
+    {
+    dbcMuxRange_t range = { min, max };
+    m_ranges.push_back(std::make_pair(range, signal));
+    }
+  }
+
+void dbcMuxTable::EmptyContent()
+  {
+  m_values.clear();
+  m_ranges.clear();
+  }
+
 ////////////////////////////////////////////////////////////////////////
 // dbcNewSymbol...
 
@@ -578,21 +725,32 @@ void dbcValueTableTable::WriteFile(dbcOutputCallback callback, void* param)
 
 dbcSignal::dbcSignal()
   {
+  m_mux.multiplexed = DBC_MUX_NONE;
+  m_mux.switchvalue = 0;
+  m_mux.switchsignal = NULL;
   m_start_bit = 0;
   m_signal_size = 0;
   m_metric = NULL;
+  m_muxtable = NULL;
+  ClearFilter();
   }
 
 dbcSignal::dbcSignal(std::string name)
   {
+  m_mux.multiplexed = DBC_MUX_NONE;
+  m_mux.switchvalue = 0;
+  m_mux.switchsignal = NULL;
   m_start_bit = 0;
   m_signal_size = 0;
   m_name = name;
   m_metric = MyMetrics.Find(name.c_str());
+  m_muxtable = NULL;
+  ClearFilter();
   }
 
 dbcSignal::~dbcSignal()
   {
+  if (m_muxtable) delete m_muxtable;
   }
 
 void dbcSignal::AddReceiver(std::string receiver)
@@ -672,17 +830,28 @@ void dbcSignal::SetName(const char* name)
 
 bool dbcSignal::IsMultiplexor()
   {
-  return (m_mux.multiplexed == DBC_MUX_MULTIPLEXOR);
+  return ((m_mux.multiplexed & DBC_MUX_MULTIPLEXOR) != 0);
   }
 
 bool dbcSignal::IsMultiplexSwitch()
   {
-  return (m_mux.multiplexed == DBC_MUX_MULTIPLEXED);
+  return ((m_mux.multiplexed & DBC_MUX_MULTIPLEXED) != 0);
+  }
+
+bool dbcSignal::IsExtendedMultiplexed()
+  {
+  return (IsMultiplexSwitch() &&
+          (m_mux.switchsignal != NULL || !m_mux.ranges.empty()));
   }
 
 void dbcSignal::SetMultiplexor()
   {
-  m_mux.multiplexed = DBC_MUX_MULTIPLEXOR;
+  m_mux.multiplexed = (dbcMultiplex_t)(m_mux.multiplexed | DBC_MUX_MULTIPLEXOR);
+  }
+
+void dbcSignal::ClearMultiplexor()
+  {
+  m_mux.multiplexed = (dbcMultiplex_t)(m_mux.multiplexed & ~DBC_MUX_MULTIPLEXOR);
   }
 
 uint32_t dbcSignal::GetMultiplexSwitchvalue()
@@ -690,32 +859,47 @@ uint32_t dbcSignal::GetMultiplexSwitchvalue()
   return m_mux.switchvalue;
   }
 
+dbcSignal* dbcSignal::GetMultiplexSwitchSignal()
+  {
+  return m_mux.switchsignal;
+  }
+
+const dbcMuxRangeList_t& dbcSignal::GetMultiplexRanges()
+  {
+  return m_mux.ranges;
+  }
+
 bool dbcSignal::SetMultiplexed(const uint32_t switchvalue)
   {
-  if (m_mux.multiplexed == DBC_MUX_MULTIPLEXOR)
-    {
+  m_mux.multiplexed = (dbcMultiplex_t)(m_mux.multiplexed | DBC_MUX_MULTIPLEXED);
+  m_mux.switchvalue = switchvalue;
+  m_mux.switchsignal = NULL;
+  m_mux.ranges.clear();
+  return true;
+  }
+
+/**
+ * SetMultiplexed: extended multiplexing (SG_MUL_VAL_)
+ *  The signal is active if the switchsignal value is within any of the ranges.
+ */
+bool dbcSignal::SetMultiplexed(dbcSignal* switchsignal, const dbcMuxRangeList_t& ranges)
+  {
+  if (switchsignal == this || ranges.empty())
     return false;
-    }
-  else
-    {
-    m_mux.multiplexed = DBC_MUX_MULTIPLEXED;
-    m_mux.switchvalue = switchvalue;
-    return true;
-    }
+  m_mux.multiplexed = (dbcMultiplex_t)(m_mux.multiplexed | DBC_MUX_MULTIPLEXED);
+  m_mux.switchvalue = ranges.front().min;
+  m_mux.switchsignal = switchsignal;
+  m_mux.ranges = ranges;
+  return true;
   }
 
 bool dbcSignal::ClearMultiplexed()
   {
-  if (m_mux.multiplexed == DBC_MUX_MULTIPLEXOR)
-    {
-    return false;
-    }
-  else
-    {
-    m_mux.multiplexed = DBC_MUX_NONE;
-    m_mux.switchvalue = 0;
-    return true;
-    }
+  m_mux.multiplexed = (dbcMultiplex_t)(m_mux.multiplexed & ~DBC_MUX_MULTIPLEXED);
+  m_mux.switchvalue = 0;
+  m_mux.switchsignal = NULL;
+  m_mux.ranges.clear();
+  return true;
   }
 
 int dbcSignal::GetStartBit()
@@ -813,9 +997,50 @@ void dbcSignal::SetUnit(const char* unit)
   m_unit = std::string(unit);
   }
 
+/**
+ * Encode: convert the physical value to raw (reverse factor & offset) and
+ *  insert it into the frame data. Values outside the raw range are clipped.
+ */
 void dbcSignal::Encode(dbcNumber* source, CAN_frame_t* msg)
   {
-  // TODO: An efficient encoding of the signal
+  double value = source->GetDouble();
+  double factor = m_factor.GetDouble();
+  if (factor == 0) factor = 1;
+  value = round((value - m_offset.GetDouble()) / factor);
+
+  int bits = MIN(m_signal_size, 64);
+  double rawmax, rawmin;
+  if (m_value_type == DBC_VALUETYPE_SIGNED)
+    {
+    rawmax = ldexp(1, bits-1) - 1;
+    rawmin = -ldexp(1, bits-1);
+    }
+  else
+    {
+    rawmax = ldexp(1, bits) - 1;
+    rawmin = 0;
+    }
+  if (value > rawmax) value = rawmax;
+  if (value < rawmin) value = rawmin;
+
+  EncodeRaw((uint64_t)(int64_t)value, msg);
+  }
+
+/**
+ * EncodeRaw: insert a raw (unscaled) value into the frame data.
+ *  Signed values are stored in two's complement, truncated to the signal size.
+ */
+void dbcSignal::EncodeRaw(uint64_t raw, CAN_frame_t* msg)
+  {
+  if (m_signal_size <= 0)
+    return;
+  if (m_signal_size < 64)
+    raw &= (((uint64_t)1) << m_signal_size) - 1;
+
+  if (m_byte_order == DBC_BYTEORDER_BIG_ENDIAN)
+    dbc_insert_bits_big_endian(msg->data.u8,m_start_bit,m_signal_size,raw);
+  else
+    dbc_insert_bits_little_endian(msg->data.u8,m_start_bit,m_signal_size,raw);
   }
 
 dbcNumber dbcSignal::Decode(CAN_frame_t* msg)
@@ -856,6 +1081,115 @@ OvmsMetric* dbcSignal::GetMetric()
   return m_metric;
   }
 
+/**
+ * SetAttribute: set a signal attribute (BA_ ... SG_)
+ *  The metric update filter attributes (DBC_ATTR_*) take effect immediately.
+ */
+void dbcSignal::SetAttribute(const std::string& name, const dbcNumber& value)
+  {
+  m_attributes.SetAttribute(name, value);
+
+  dbcNumber v = value;
+  if (name == DBC_ATTR_DEADBAND)
+    SetFilter(v.GetDouble(), m_deadband_rel, m_min_interval, m_avg_window);
+  else if (name == DBC_ATTR_DEADBAND_REL)
+    SetFilter(m_deadband, v.GetDouble() / 100, m_min_interval, m_avg_window);
+  else if (name == DBC_ATTR_MIN_INTERVAL)
+    SetFilter(m_deadband, m_deadband_rel, v.GetUnsignedInteger(), m_avg_window);
+  else if (name == DBC_ATTR_AVG_WINDOW)
+    SetFilter(m_deadband, m_deadband_rel, m_min_interval, v.GetSignedInteger());
+  }
+
+void dbcSignal::RemoveAttribute(const std::string& name)
+  {
+  m_attributes.RemoveAttribute(name);
+
+  if (name == DBC_ATTR_DEADBAND)
+    SetFilter(0, m_deadband_rel, m_min_interval, m_avg_window);
+  else if (name == DBC_ATTR_DEADBAND_REL)
+    SetFilter(m_deadband, 0, m_min_interval, m_avg_window);
+  else if (name == DBC_ATTR_MIN_INTERVAL)
+    SetFilter(m_deadband, m_deadband_rel, 0, m_avg_window);
+  else if (name == DBC_ATTR_AVG_WINDOW)
+    SetFilter(m_deadband, m_deadband_rel, m_min_interval, 0);
+  }
+
+/**
+ * SetFilter: configure the metric update filter
+ *  deadband:     absolute change needed to pass a new value (signal units), 0=off
+ *  deadband_rel: relative change needed (fraction of last value), 0=off
+ *  interval:     minimum time between metric updates [ms], 0=off
+ *  window:       number of samples to average before passing a value, 0/1=off
+ *  If both deadbands are set, the larger one applies.
+ */
+void dbcSignal::SetFilter(double deadband, double deadband_rel, uint32_t interval, int window)
+  {
+  m_deadband = (deadband > 0) ? deadband : 0;
+  m_deadband_rel = (deadband_rel > 0) ? deadband_rel : 0;
+  m_min_interval = interval;
+  m_avg_window = (window > 1) ? window : 0;
+  m_filter = (m_deadband > 0 || m_deadband_rel > 0 || m_min_interval > 0 || m_avg_window > 1);
+  ResetFilter();
+  }
+
+void dbcSignal::ClearFilter()
+  {
+  SetFilter(0, 0, 0, 0);
+  }
+
+void dbcSignal::ResetFilter()
+  {
+  m_avg_sum = 0;
+  m_avg_count = 0;
+  m_last_value = 0;
+  m_last_time = 0;
+  m_last_valid = false;
+  }
+
+bool dbcSignal::HasFilter()
+  {
+  return m_filter;
+  }
+
+/**
+ * FilterValue: apply the metric update filter to a decoded value
+ *  Returns true if the value shall be passed on to the metric. With an
+ *  averaging window, value is replaced by the window average.
+ *  timestamp: current time in ms (any monotonic source, may wrap)
+ */
+bool dbcSignal::FilterValue(dbcNumber& value, uint32_t timestamp)
+  {
+  if (!m_filter) return true;
+
+  double v = value.GetDouble();
+  if (m_avg_window > 1)
+    {
+    m_avg_sum += v;
+    if (++m_avg_count < m_avg_window) return false;
+    v = m_avg_sum / m_avg_count;
+    m_avg_sum = 0;
+    m_avg_count = 0;
+    if (value.IsDouble())
+      value = v;
+    else
+      value = (int32_t)lround(v);
+    }
+
+  if (m_last_valid)
+    {
+    if (m_min_interval > 0 && (uint32_t)(timestamp - m_last_time) < m_min_interval)
+      return false;
+    double threshold = MAX(m_deadband, m_deadband_rel * fabs(m_last_value));
+    if (threshold > 0 && fabs(v - m_last_value) < threshold)
+      return false;
+    }
+
+  m_last_value = v;
+  m_last_time = timestamp;
+  m_last_valid = true;
+  return true;
+  }
+
 void dbcSignal::WriteFile(dbcOutputCallback callback, void* param)
   {
   std::ostringstream ss;
@@ -873,6 +1207,13 @@ void dbcSignal::WriteFile(dbcOutputCallback callback, void* param)
       ss << m_mux.switchvalue;
       }
       break;
+    case DBC_MUX_MULTIPLEXED_MULTIPLEXOR:
+      {
+      ss << " m";
+      ss << m_mux.switchvalue;
+      ss << "M";
+      }
+      break;
     default:
       break;
     }
@@ -935,6 +1276,52 @@ void dbcSignal::WriteFileValues(dbcOutputCallback callback,
     }
   }
 
+void dbcSignal::WriteFileMuxValues(dbcOutputCallback callback,
+                                   void* param,
+                                   std::string messageid,
+                                   dbcSignal* multiplexor)
+  {
+  if (!IsExtendedMultiplexed()) return;
+
+  dbcSignal* sw = (m_mux.switchsignal) ? m_mux.switchsignal : multiplexor;
+  if (sw == NULL) return;
+
+  std::ostringstream ss;
+  ss << "SG_MUL_VAL_ ";
+  ss << messageid;
+  ss << " ";
+  ss << m_name;
+  ss << " ";
+  ss << sw->GetName();
+  if (m_mux.ranges.empty())
+    {
+    ss << " " << m_mux.switchvalue << "-" << m_mux.switchvalue;
+    }
+  else
+    {
+    bool first = true;
+    for (dbcMuxRange_t& r : m_mux.ranges)
+      {
+      ss << (first ? " " : ", ");
+      ss << r.min << "-" << r.max;
+      first = false;
+      }
+    }
+  ss << ";\n";
+  callback(param, ss.str().c_str());
+  }
+
+void dbcSignal::WriteFileAttributes(dbcOutputCallback callback,
+                                    void* param,
+                                    std::string messageid)
+  {
+  std::string object("SG_ ");
+  object.append(messageid);
+  object.append(" ");
+  object.append(m_name);
+  m_attributes.WriteFile(callback, param, object);
+  }
+
 ////////////////////////////////////////////////////////////////////////
 // dbcMessage...
 
@@ -943,17 +1330,20 @@ dbcMessage::dbcMessage()
   m_id = 0;
   m_size = 0;
   m_multiplexor = NULL;
+  m_mux_valid = false;
   }
 
 dbcMessage::dbcMessage(uint32_t id)
   {
   m_size = 0;
   m_multiplexor = NULL;
+  m_mux_valid = false;
   m_id = id;
   }
 
 dbcMessage::~dbcMessage()
   {
+  FreeMuxTables();
   }
 
 void dbcMessage::AddComment(const std::string& comment)
@@ -979,21 +1369,32 @@ bool dbcMessage::HasComment(const std::string& comment)
 void dbcMessage::AddSignal(dbcSignal* signal)
   {
   m_signals.push_back(signal);
+  InvalidateMuxTables();
   }
 
 void dbcMessage::RemoveSignal(dbcSignal* signal, bool free)
   {
+  FreeMuxTables();
   m_signals.remove(signal);
+  if (m_multiplexor == signal)
+    m_multiplexor = NULL;
+  for (dbcSignal* s : m_signals)
+    {
+    if (s->GetMultiplexSwitchSignal() == signal)
+      s->ClearMultiplexed();
+    }
   if (free) delete signal;
   }
 
 void dbcMessage::RemoveAllSignals(bool free)
   {
+  FreeMuxTables();
   for (dbcSignal* signal : m_signals)
     {
     if (free) delete signal;
     }
   m_signals.clear();
+  m_multiplexor = NULL;
   }
 
 dbcSignal* dbcMessage::FindSignal(std::string name)
@@ -1017,6 +1418,55 @@ void dbcMessage::Count(int* signals, int* bits, int* covered)
     }
   }
 
+// Estimated heap overhead per container node & string:
+#define DBC_MEM_NODE    16
+#define DBC_MEM_STRING(s) (sizeof(std::string) + (s).size() + 1)
+
+static size_t dbc_mem_strings(const std::list<std::string>& list)
+  {
+  size_t size = 0;
+  for (const std::string& s : list)
+    size += DBC_MEM_NODE + DBC_MEM_STRING(s);
+  return size;
+  }
+
+static size_t dbc_mem_attributes(const dbcAttributeEntry_t& map)
+  {
+  size_t size = 0;
+  for (auto& it : map)
+    size += DBC_MEM_NODE + DBC_MEM_STRING(it.first) + sizeof(dbcNumber);
+  return size;
+  }
+
+static size_t dbc_mem_values(const dbcValueTableEntry_t& map)
+  {
+  size_t size = 0;
+  for (auto& it : map)
+    size += DBC_MEM_NODE + sizeof(uint32_t) + DBC_MEM_STRING(it.second);
+  return size;
+  }
+
+/**
+ * GetMemoryUsage: estimated heap usage of the message including all signals
+ */
+size_t dbcMessage::GetMemoryUsage()
+  {
+  size_t size = sizeof(dbcMessage) + m_name.size() + m_transmitter_node.size();
+  size += dbc_mem_strings(m_comments.m_entrymap);
+  size += dbc_mem_attributes(m_attributes.m_entrymap);
+  size += m_mux_root.capacity() * sizeof(dbcSignal*);
+  for (dbcSignal* signal : m_signals)
+    {
+    size += DBC_MEM_NODE + sizeof(dbcSignal);
+    size += signal->GetName().size() + signal->GetUnit().size();
+    size += dbc_mem_strings(signal->m_receivers);
+    size += dbc_mem_strings(signal->m_comments.m_entrymap);
+    size += dbc_mem_values(signal->m_values.m_entrymap);
+    size += dbc_mem_attributes(signal->m_attributes.m_entrymap);
+    }
+  return size;
+  }
+
 uint32_t dbcMessage::GetID()
   {
   return m_id;
@@ -1094,11 +1544,125 @@ dbcSignal* dbcMessage::GetMultiplexorSignal()
 
 void dbcMessage::SetMultiplexorSignal(dbcSignal* signal)
   {
+  if (m_multiplexor != NULL && m_multiplexor != signal)
+    {
+    m_multiplexor->ClearMultiplexor();
+    }
   m_multiplexor = signal;
   if (signal != NULL)
     {
     signal->SetMultiplexor();
     }
+  InvalidateMuxTables();
+  }
+
+/**
+ * GetActiveSignals: collect the signals carried by a frame
+ *  Multiplexed signals are looked up via the multiplexor dispatch tables,
+ *  so only signals selected by the current (nested) switch values are
+ *  returned. Multiplexors precede the signals they select.
+ */
+void dbcMessage::GetActiveSignals(CAN_frame_t* msg, dbcSignalVector_t& active)
+  {
+  // Tables of loaded files are built by dbcfile::BuildMuxTables() and updated
+  // by dbcfile::LockFile(), this is a fallback for messages not used via a file:
+  if (!m_mux_valid) BuildMuxTables();
+  active.clear();
+  for (dbcSignal* signal : m_mux_root)
+    {
+    CollectSignal(signal, msg, active, 0);
+    }
+  }
+
+void dbcMessage::CollectSignal(dbcSignal* signal, CAN_frame_t* msg, dbcSignalVector_t& active, int depth)
+  {
+  active.push_back(signal);
+
+  dbcMuxTable* table = signal->m_muxtable;
+  if (table == NULL || depth >= DBC_MUX_MAXDEPTH) return;
+
+  uint32_t muxval = (uint32_t)signal->Decode(msg).GetSignedInteger();
+  auto it = table->m_values.find(muxval);
+  if (it != table->m_values.end())
+    {
+    for (dbcSignal* s : it->second)
+      CollectSignal(s, msg, active, depth+1);
+    }
+  for (auto& r : table->m_ranges)
+    {
+    if (muxval >= r.first.min && muxval <= r.first.max)
+      CollectSignal(r.second, msg, active, depth+1);
+    }
+  }
+
+/**
+ * BuildMuxTables: precompute the multiplexor dispatch tables
+ *  Multiplexed signals without a resolvable switch signal are treated
+ *  as always active (as before extended multiplexing support).
+ */
+void dbcMessage::BuildMuxTables()
+  {
+  FreeMuxTables();
+
+  for (dbcSignal* signal : m_signals)
+    {
+    dbcSignal* sw = NULL;
+    if (signal->IsMultiplexSwitch())
+      {
+      sw = signal->GetMultiplexSwitchSignal();
+      if (sw == NULL) sw = m_multiplexor;
+      if (sw == signal) sw = NULL;
+      }
+
+    if (sw == NULL)
+      {
+      m_mux_root.push_back(signal);
+      continue;
+      }
+
+    if (sw->m_muxtable == NULL)
+      sw->m_muxtable = new dbcMuxTable();
+    const dbcMuxRangeList_t& ranges = signal->GetMultiplexRanges();
+    if (ranges.empty())
+      {
+      uint32_t val = signal->GetMultiplexSwitchvalue();
+      sw->m_muxtable->AddSignal(signal, val, val);
+      }
+    else
+      {
+      for (const dbcMuxRange_t& r : ranges)
+        sw->m_muxtable->AddSignal(signal, r.min, r.max);
+      }
+    }
+
+  m_mux_valid = true;
+  }
+
+/**
+ * UpdateMuxTables: rebuild the dispatch tables if invalidated by changes
+ */
+void dbcMessage::UpdateMuxTables()
+  {
+  if (!m_mux_valid) BuildMuxTables();
+  }
+
+void dbcMessage::InvalidateMuxTables()
+  {
+  m_mux_valid = false;
+  }
+
+void dbcMessage::FreeMuxTables()
+  {
+  for (dbcSignal* signal : m_signals)
+    {
+    if (signal->m_muxtable)
+      {
+      delete signal->m_muxtable;
+      signal->m_muxtable = NULL;
+      }
+    }
+  m_mux_root.clear();
+  m_mux_valid = false;
   }
 
 void dbcMessage::WriteFile(dbcOutputCallback callback, void* param)
@@ -1151,6 +1715,31 @@ void dbcMessage::WriteFileValues(dbcOutputCallback callback, void* param)
     }
   }
 
+void dbcMessage::WriteFileMuxValues(dbcOutputCallback callback, void* param)
+  {
+  std::ostringstream ss;
+  ss << m_id;
+  std::string id(ss.str());
+
+  for (dbcSignal* s : m_signals)
+    {
+    s->WriteFileMuxValues(callback, param, id, m_multiplexor);
+    }
+  }
+
+void dbcMessage::WriteFileAttributes(dbcOutputCallback callback, void* param)
+  {
+  std::ostringstream ss;
+  ss << m_id;
+  std::string id(ss.str());
+  m_attributes.WriteFile(callback, param, std::string("BO_ ") + id);
+
+  for (dbcSignal* s : m_signals)
+    {
+    s->WriteFileAttributes(callback, param, id);
+    }
+  }
+
 dbcMessageTable::dbcMessageTable()
   {
   }
@@ -1244,12 +1833,24 @@ void dbcMessageTable::WriteFileComments(dbcOutputCallback callback, void* param)
     {
     it->second->WriteFileComments(callback, param);
     }
+  for (dbcMessageEntry_t::iterator it=m_entrymap.begin();
+       it != m_entrymap.end();
+       ++it)
+    {
+    it->second->WriteFileAttributes(callback, param);
+    }
   for (dbcMessageEntry_t::iterator it=m_entrymap.begin();
        it != m_entrymap.end();
        ++it)
     {
     it->second->WriteFileValues(callback, param);
     }
+  for (dbcMessageEntry_t::iterator it=m_entrymap.begin();
+       it != m_entrymap.end();
+       ++it)
+    {
+    it->second->WriteFileMuxValues(callback, param);
+    }
   }
 
 void dbcMessageTable::WriteSummary(dbcOutputCallback callback, void* param)
@@ -1266,6 +1867,8 @@ void dbcMessageTable::WriteSummary(dbcOutputCallback callback, void* param)
 dbcfile::dbcfile()
   {
   m_locks = 0;
+  m_dropped = 0;
+  m_lastmsg = NULL;
   }
 
 dbcfile::~dbcfile()
@@ -1276,6 +1879,7 @@ dbcfile::~dbcfile()
 void dbcfile::FreeAllocations()
   {
   m_version.clear();
+  m_dropped = 0;
   m_newsymbols.EmptyContent();
   m_bittiming.EmptyContent();
   m_nodes.EmptyContent();
@@ -1297,33 +1901,39 @@ bool dbcfile::LoadFile(const char* name, const char* path, FILE* fd)
     }
 #endif // #ifdef CONFIG_OVMS
 
-  void yyrestart(FILE *input_file);
-  int yyparse (void *YYPARSE_PARAM);
   bool result;
   m_path = path;
 
+  // The parser & scanner are reentrant, files can be loaded in parallel:
+  yyscan_t scanner;
+  if (yylex_init(&scanner) != 0)
+    return false;
+  dbc_parser_state_t state = {};
+  state.dbc = this;
+
   if (fd == NULL)
     {
     fd = fopen(path, "r");
     if (!fd)
       {
       ESP_LOGW(TAG,"Could not open %s for reading",path);
+      yylex_destroy(scanner);
       return false;
       }
-    FILE *yyin = fd;
-    yyrestart(yyin);
-    result = (yyparse ((void *)this) == 0);
+    yyset_in(fd, scanner);
+    result = (yyparse(scanner, &state) == 0);
     fclose(fd);
     }
   else
     {
     fseek(fd,0,SEEK_SET);
-    FILE *yyin = fd;
-    yyrestart(yyin);
-    result = (yyparse ((void *)this) == 0);
+    yyset_in(fd, scanner);
+    result = (yyparse(scanner, &state) == 0);
     fseek(fd,0,SEEK_SET);
     }
+  yylex_destroy(scanner);
 
+  if (result) BuildMuxTables();
   return result;
   }
 
@@ -1332,16 +1942,35 @@ bool dbcfile::LoadString(const char* name, const char* source, size_t length)
   FreeAllocations();
   m_name = std::string(name);
 
-  void yyrestart(FILE *input_file);
-  int yyparse (void *YYPARSE_PARAM);
+  yyscan_t scanner;
+  if (yylex_init(&scanner) != 0)
+    return false;
+  dbc_parser_state_t state = {};
+  state.dbc = this;
 
-  YY_BUFFER_STATE buffer = yy_scan_bytes(source, length);
-  bool result = (yyparse (this) == 0);
-  yy_delete_buffer(buffer);
+  YY_BUFFER_STATE buffer = yy_scan_bytes(source, length, scanner);
+  bool result = (yyparse(scanner, &state) == 0);
+  yy_delete_buffer(buffer, scanner);
+  yylex_destroy(scanner);
 
+  if (result) BuildMuxTables();
   return result;
   }
 
+/**
+ * BuildMuxTables: build the multiplexor dispatch tables of all messages
+ *  Done at load time, before the file is shared: readers (frame handlers,
+ *  decoders) use the tables without locking, so they must not be rebuilt
+ *  while the file is in use. Structural edits are refused on files locked
+ *  by other users (see dbc_app.cpp), tables invalidated by edits are
+ *  rebuilt when the next user locks the file.
+ */
+void dbcfile::BuildMuxTables()
+  {
+  for (auto& it : m_messages.m_entrymap)
+    it.second->BuildMuxTables();
+  }
+
 void dbcfile::WriteFile(dbcOutputCallback callback, void* param)
   {
   callback(param,"VERSION \"");
@@ -1394,10 +2023,54 @@ std::string dbcfile::Status()
   ss << ", ";
   ss << m_locks;
   ss << " lock(s)";
+  if (m_dropped > 0)
+    {
+    ss << ", partial: ";
+    ss << m_dropped;
+    ss << " message(s) dropped";
+    }
 
   return ss.str();
   }
 
+/**
+ * GetMemoryUsage: estimated heap usage of the DBC file content
+ */
+size_t dbcfile::GetMemoryUsage()
+  {
+  size_t size = sizeof(dbcfile) + m_name.size() + m_path.size() + m_version.size();
+  size += dbc_mem_strings(m_newsymbols.m_entrymap);
+  size += dbc_mem_strings(m_comments.m_entrymap);
+  for (auto& it : m_nodes.m_entrymap)
+    size += DBC_MEM_NODE + DBC_MEM_STRING(it.first) + sizeof(dbcNode) + dbc_mem_strings(it.second->m_comments.m_entrymap);
+  for (auto& it : m_values.m_entrymap)
+    size += DBC_MEM_NODE + DBC_MEM_STRING(it.first) + sizeof(dbcValueTable) + dbc_mem_values(it.second->m_entrymap);
+  for (auto& it : m_messages.m_entrymap)
+    size += DBC_MEM_NODE + sizeof(uint32_t) + it.second->GetMemoryUsage();
+  return size;
+  }
+
+/**
+ * TrimToMemory: drop messages (highest IDs first) until the estimated memory
+ *  usage fits the budget. Returns the number of messages dropped.
+ */
+int dbcfile::TrimToMemory(size_t budget)
+  {
+  size_t size = GetMemoryUsage();
+  int dropped = 0;
+  while (size > budget && !m_messages.m_entrymap.empty())
+    {
+    auto last = std::prev(m_messages.m_entrymap.end());
+    size -= MIN(size, DBC_MEM_NODE + sizeof(uint32_t) + last->second->GetMemoryUsage());
+    last->second->RemoveAllSignals(true);
+    m_messages.RemoveMessage(last->first, true);
+    dropped++;
+    }
+  m_dropped += dropped;
+  m_lastmsg = NULL;
+  return dropped;
+  }
+
 std::string dbcfile::GetName()
   {
   return m_name;
@@ -1413,8 +2086,16 @@ std::string dbcfile::GetVersion()
   return m_version;
   }
 
+/**
+ * LockFile: register a user of the file
+ *  Callers serialize LockFile() and structural edits via MyDBC.m_mutex.
+ *  Dispatch tables invalidated by edits are rebuilt here, before the new
+ *  user may read them concurrently to others.
+ */
 void dbcfile::LockFile()
   {
+  for (auto& it : m_messages.m_entrymap)
+    it.second->UpdateMuxTables();
   m_locks++;
   }
 
@@ -1423,7 +2104,11 @@ void dbcfile::UnlockFile()
   m_locks--;
   }
 
-bool dbcfile::IsLocked()
+/**
+ * IsLocked: check if the file is in use
+ *  own: number of locks held by the caller (i.e. 1 for the shell selection)
+ */
+bool dbcfile::IsLocked(int own /*=0*/)
   {
-  return (m_locks > 0);
+  return (m_locks > own);
   }
@@ -34,6 +34,7 @@
 #include <string>
 #include <map>
 #include <list>
+#include <vector>
 #include <functional>
 #include <iostream>
 #include "dbc_number.h"
@@ -42,19 +43,67 @@
 
 #define DBC_MAX_LINELENGTH 2048
 
+// Signal attributes (BA_ ... SG_) controlling the metric update filter
+#define DBC_ATTR_DEADBAND         "OvmsDeadband"      // Absolute deadband (signal units)
+#define DBC_ATTR_DEADBAND_REL     "OvmsDeadbandRel"   // Relative deadband (percent of last value)
+#define DBC_ATTR_MIN_INTERVAL     "OvmsMinInterval"   // Minimum update interval (ms)
+#define DBC_ATTR_AVG_WINDOW       "OvmsAvgWindow"     // Averaging window (samples)
+
+// Message & signal attributes used by the cyclic transmission scheduler
+#define DBC_ATTR_CYCLE_TIME       "GenMsgCycleTime"   // BO_: Transmission cycle time (ms)
+#define DBC_ATTR_TX_COUNTER       "OvmsTxCounter"     // SG_: 1 = rolling counter, incremented per frame
+#define DBC_ATTR_TX_CHECKSUM      "OvmsTxChecksum"    // SG_: checksum type (see dbcChecksumType_t)
+
 typedef std::function<void(void*, const char*)> dbcOutputCallback;
 
+// Maximum nesting depth for extended multiplexing:
+#define DBC_MUX_MAXDEPTH 8
+// Switch value ranges up to this size are expanded into the dispatch table:
+#define DBC_MUX_MAXEXPAND 256
+// Dispatch table size limit per multiplexor, further ranges are checked sequentially:
+#define DBC_MUX_MAXVALUES 1024
+
+class dbcSignal;
+typedef std::vector<dbcSignal*> dbcSignalVector_t;
+
 typedef enum
   {
   DBC_MUX_NONE=0,
   DBC_MUX_MULTIPLEXOR=1,
-  DBC_MUX_MULTIPLEXED=2
+  DBC_MUX_MULTIPLEXED=2,
+  DBC_MUX_MULTIPLEXED_MULTIPLEXOR=3       // Extended multiplexing: nested multiplexor
   } dbcMultiplex_t;
 
+struct dbcMuxRange_t
+  {
+  uint32_t min;
+  uint32_t max;
+  };
+typedef std::vector<dbcMuxRange_t> dbcMuxRangeList_t;
+
 struct dbcMultiplexor_t
   {
   dbcMultiplex_t multiplexed;
   uint32_t switchvalue;
+  dbcSignal* switchsignal;                // SG_MUL_VAL_ switch signal, NULL = message multiplexor
+  dbcMuxRangeList_t ranges;               // SG_MUL_VAL_ switch value ranges, empty = switchvalue
+  };
+
+typedef std::map<uint32_t, dbcSignalVector_t> dbcMuxValueMap_t;
+typedef std::list< std::pair<dbcMuxRange_t, dbcSignal*> > dbcMuxRangeMap_t;
+class dbcMuxTable
+  {
+  public:
+    dbcMuxTable();
+    ~dbcMuxTable();
+
+  public:
+    void AddSignal(dbcSignal* signal, uint32_t min, uint32_t max);
+    void EmptyContent();
+
+  public:
+    dbcMuxValueMap_t m_values;            // Switch value => signals
+    dbcMuxRangeMap_t m_ranges;            // Large switch ranges, checked sequentially
   };
 
 typedef enum
@@ -94,6 +143,30 @@ class dbcCommentTable
     dbcCommentList_t m_entrymap;
   };
 
+typedef std::map<std::string, dbcNumber> dbcAttributeEntry_t;
+class dbcAttributeTable
+  {
+  public:
+    dbcAttributeTable();
+    ~dbcAttributeTable();
+
+  public:
+    void SetAttribute(const std::string& name, const dbcNumber& value);
+    void RemoveAttribute(const std::string& name);
+    bool HasAttribute(const std::string& name);
+    dbcNumber GetAttribute(const std::string& name);
+    int GetCount();
+
+  public:
+    void EmptyContent();
+
+  public:
+    void WriteFile(dbcOutputCallback callback, void* param, std::string object);
+
+  public:
+    dbcAttributeEntry_t m_entrymap;
+  };
+
 typedef std::list<std::string> dbcNewSymbolList_t;
 class dbcNewSymbolTable
   {
@@ -275,9 +348,14 @@ class dbcSignal
     void SetName(const char* name);
     bool IsMultiplexor();
     bool IsMultiplexSwitch();
+    bool IsExtendedMultiplexed();
     void SetMultiplexor();
+    void ClearMultiplexor();
     uint32_t GetMultiplexSwitchvalue();
+    dbcSignal* GetMultiplexSwitchSignal();
+    const dbcMuxRangeList_t& GetMultiplexRanges();
     bool SetMultiplexed(const uint32_t switchvalue);
+    bool SetMultiplexed(dbcSignal* switchsignal, const dbcMuxRangeList_t& ranges);
     bool ClearMultiplexed();
     int GetStartBit();
     int GetSignalSize();
@@ -300,21 +378,34 @@ class dbcSignal
 
   public:
     void Encode(dbcNumber* source, CAN_frame_t* msg);
+    void EncodeRaw(uint64_t raw, CAN_frame_t* msg);
     dbcNumber Decode(CAN_frame_t* msg);
 
   public:
     void AssignMetric(OvmsMetric* metric);
     OvmsMetric* GetMetric();
 
+  public:
+    void SetAttribute(const std::string& name, const dbcNumber& value);
+    void RemoveAttribute(const std::string& name);
+    void SetFilter(double deadband, double deadband_rel, uint32_t interval, int window);
+    void ClearFilter();
+    void ResetFilter();
+    bool HasFilter();
+    bool FilterValue(dbcNumber& value, uint32_t timestamp);
+
   public:
     void WriteFile(dbcOutputCallback callback, void* param);
     void WriteFileComments(dbcOutputCallback callback, void* param, std::string messageid);
     void WriteFileValues(dbcOutputCallback callback, void* param, std::string messageid);
+    void WriteFileAttributes(dbcOutputCallback callback, void* param, std::string messageid);
+    void WriteFileMuxValues(dbcOutputCallback callback, void* param, std::string messageid, dbcSignal* multiplexor);
 
   public:
     dbcReceiverList_t m_receivers;
     dbcCommentTable m_comments;
     dbcValueTable m_values;
+    dbcAttributeTable m_attributes;
 
   protected:
     std::string m_name;
@@ -329,6 +420,22 @@ class dbcSignal
     dbcNumber m_maximum;
     std::string m_unit;
     OvmsMetric* m_metric;
+    dbcMuxTable* m_muxtable;      // Dispatch table if this is a multiplexor (built by dbcMessage)
+
+  friend class dbcMessage;
+
+  protected:
+    // Metric update filter:
+    bool m_filter;                // Filter active
+    double m_deadband;            // Absolute deadband, 0=off
+    double m_deadband_rel;        // Relative deadband (fraction of last value), 0=off
+    uint32_t m_min_interval;      // Minimum update interval [ms], 0=off
+    int m_avg_window;             // Averaging window [samples], 0/1=off
+    double m_avg_sum;
+    int m_avg_count;
+    double m_last_value;          // Last value passed to the metric
+    uint32_t m_last_time;         // Timestamp of last value [ms]
+    bool m_last_valid;
   };
 
 typedef std::list<dbcSignal*> dbcSignalList_t;
@@ -345,6 +452,7 @@ class dbcMessage
     void RemoveAllSignals(bool free=false);
     dbcSignal* FindSignal(std::string name);
     void Count(int* signals, int* bits, int* covered);
+    size_t GetMemoryUsage();
 
   public:
     void AddComment(const std::string& comment);
@@ -368,17 +476,32 @@ class dbcMessage
     dbcSignal* GetMultiplexorSignal();
     void SetMultiplexorSignal(dbcSignal* signal);
 
+  public:
+    void GetActiveSignals(CAN_frame_t* msg, dbcSignalVector_t& active);
+    void BuildMuxTables();
+    void UpdateMuxTables();
+    void InvalidateMuxTables();
+
+  protected:
+    void FreeMuxTables();
+    void CollectSignal(dbcSignal* signal, CAN_frame_t* msg, dbcSignalVector_t& active, int depth);
+
   public:
     void WriteFile(dbcOutputCallback callback, void* param);
     void WriteFileComments(dbcOutputCallback callback, void* param);
     void WriteFileValues(dbcOutputCallback callback, void* param);
+    void WriteFileAttributes(dbcOutputCallback callback, void* param);
+    void WriteFileMuxValues(dbcOutputCallback callback, void* param);
 
   public:
     dbcSignalList_t m_signals;
     dbcCommentTable m_comments;
+    dbcAttributeTable m_attributes;
 
   protected:
     dbcSignal* m_multiplexor;
+    dbcSignalVector_t m_mux_root;         // Signals active independent of any multiplexor
+    bool m_mux_valid;                     // Dispatch tables are up to date
     uint32_t m_id;
     std::string m_name;
     int m_size;
@@ -424,17 +547,20 @@ class dbcfile
   public:
     bool LoadFile(const char* name, const char* path, FILE *fd=NULL);
     bool LoadString(const char* name, const char* source, size_t length);
+    void BuildMuxTables();
     void WriteFile(dbcOutputCallback callback, void* param);
     void WriteSummary(dbcOutputCallback callback, void* param);
     std::string Status();
     std::string GetName();
     std::string GetPath();
     std::string GetVersion();
+    size_t GetMemoryUsage();
+    int TrimToMemory(size_t budget);
 
   public:
     void LockFile();
     void UnlockFile();
-    bool IsLocked();
+    bool IsLocked(int own=0);
 
   public:
     std::string m_name;
@@ -446,6 +572,7 @@ class dbcfile
     dbcValueTableTable m_values;
     dbcMessageTable m_messages;
     dbcCommentTable m_comments;
+    int m_dropped;                        // Messages dropped by TrimToMemory()
 
   private:
     dbcMessage* m_lastmsg;
@@ -39,6 +39,8 @@ static const char *TAG = "dbc-app";
 #include <dirent.h>
 #include "dbc.h"
 #include "dbc_app.h"
+#include "dbc_decoder.h"
+#include "dbc_scheduler.h"
 #include "ovms_config.h"
 #include "ovms_events.h"
 
@@ -55,6 +57,15 @@ void dbc_list(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, con
     writer->puts(it->second->Status().c_str());
     ++it;
     }
+
+  int budget = MyConfig.GetParamValueInt("dbc", "loader.budget", 0);
+  size_t used = 0;
+  for (auto& k : MyDBC.m_dbclist)
+    used += k.second->GetMemoryUsage();
+  writer->printf("Memory: %u kB used", used / 1024);
+  if (budget > 0)
+    writer->printf(" of %d kB budget", budget);
+  writer->printf("\nLoader: %s\n", MyDBC.m_loader.Status().c_str());
   }
 
 void dbc_load(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
@@ -188,9 +199,219 @@ void dbc_save(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, con
   writer->printf("Saved to: %s\n",dbc->m_path.c_str());
   }
 
+void dbc_decode(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  const char* fmt = cmd->GetName();
+  std::string logpath(argv[0]);
+  std::string csvpath(argv[1]);
+  std::string binpath(argv[1]);
+  csvpath.append(".csv");
+  binpath.append(".bin");
+
+  if (MyConfig.ProtectedPath(logpath) || MyConfig.ProtectedPath(csvpath) || MyConfig.ProtectedPath(binpath))
+    {
+    writer->puts("Error: protected path");
+    return;
+    }
+
+  canformat* format = MyCanFormatFactory.NewFormat(fmt);
+  if (format == NULL)
+    {
+    writer->printf("Error: Unknown CAN log format '%s'\n",fmt);
+    return;
+    }
+
+  dbcDecoder decoder;
+  std::list<dbcfile*> locked;
+  bool ok = true;
+    {
+    OvmsMutexLock ldbc(&MyDBC.m_mutex);
+    for (int k=2; k<argc; k++)
+      {
+      // <name>[:<bus>]
+      std::string name(argv[k]);
+      int bus = 0;
+      size_t sep = name.find(':');
+      if (sep != std::string::npos)
+        {
+        const char* b = name.c_str() + sep + 1;
+        if (strncmp(b, "can", 3) == 0) b += 3;
+        bus = atoi(b);
+        name.resize(sep);
+        }
+      auto f = MyDBC.m_dbclist.find(name);
+      dbcfile* dbc = (f == MyDBC.m_dbclist.end()) ? NULL : f->second;
+      if (dbc == NULL || !decoder.AddDBC(dbc, bus))
+        {
+        writer->printf("Error: Cannot use DBC file: %s\n",argv[k]);
+        ok = false;
+        break;
+        }
+      dbc->LockFile();
+      locked.push_back(dbc);
+      }
+    }
+
+  FILE *in = NULL, *csv = NULL, *bin = NULL;
+  if (ok && (in = fopen(logpath.c_str(), "r")) == NULL)
+    {
+    writer->printf("Error: Could not open log file '%s'\n",logpath.c_str());
+    ok = false;
+    }
+  if (ok && ((csv = fopen(csvpath.c_str(), "w")) == NULL || (bin = fopen(binpath.c_str(), "w")) == NULL))
+    {
+    writer->printf("Error: Could not open output files '%s.*'\n",argv[1]);
+    ok = false;
+    }
+
+  if (ok)
+    {
+    writer->printf("Decoding %s (%s) with %d signal(s)...\n", logpath.c_str(), fmt, decoder.GetColumnCount());
+    decoder.Decode(format, in, csv, bin, DBC_DECODER_THREADS);
+    writer->printf("%s\nWritten to %s, %s\n", decoder.GetStats().c_str(), csvpath.c_str(), binpath.c_str());
+    }
+
+  if (in) fclose(in);
+  if (csv) fclose(csv);
+  if (bin) fclose(bin);
+  delete format;
+    {
+    OvmsMutexLock ldbc(&MyDBC.m_mutex);
+    for (dbcfile* dbc : locked) dbc->UnlockFile();
+    }
+  }
+
+void dbc_tx_start(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  canbus* bus = (canbus*)MyPcpApp.FindDeviceByName(argv[0]);
+  if (bus == NULL)
+    {
+    writer->printf("Error: Cannot find CAN bus %s\n",argv[0]);
+    return;
+    }
+
+  dbcTxScheduler* sched;
+    {
+    // early check, done again on insert:
+    OvmsMutexLock ltx(&MyDBC.m_txmutex);
+    if (MyDBC.m_txshell.find(argv[0]) != MyDBC.m_txshell.end())
+      {
+      writer->printf("Error: TX scheduler already running on %s\n",argv[0]);
+      return;
+      }
+    }
+    {
+    OvmsMutexLock ldbc(&MyDBC.m_mutex);
+    auto f = MyDBC.m_dbclist.find(argv[1]);
+    dbcfile* dbc = (f == MyDBC.m_dbclist.end()) ? NULL : f->second;
+    if (dbc == NULL)
+      {
+      writer->printf("Cannot find DBC file: %s\n",argv[1]);
+      return;
+      }
+    sched = new dbcTxScheduler(dbc, bus);
+    }
+
+  if (argc == 2)
+    sched->AddAllMessages();
+  for (int k=2; k<argc; k++)
+    {
+    // <message>[:<cycle>]
+    std::string name(argv[k]);
+    uint32_t cycle = 0;
+    size_t sep = name.find(':');
+    if (sep != std::string::npos)
+      {
+      cycle = atoi(name.c_str() + sep + 1);
+      name.resize(sep);
+      }
+    if (!sched->AddMessage(name, cycle) && !sched->AddMessage(dbcMessageIdFromString(name.c_str()), cycle))
+      writer->printf("Warning: Cannot schedule message %s (unknown or no cycle time)\n",argv[k]);
+    }
+
+  // check & insert under one lock, so concurrent starts cannot both succeed;
+  // the scheduler is only started once it owns the map entry:
+  bool duplicate;
+    {
+    OvmsMutexLock ltx(&MyDBC.m_txmutex);
+    duplicate = (MyDBC.m_txshell.find(argv[0]) != MyDBC.m_txshell.end());
+    if (!duplicate)
+      {
+      MyDBC.m_txshell[argv[0]] = sched;
+      sched->Start();
+      }
+    }
+  if (duplicate)
+    {
+    delete sched;
+    writer->printf("Error: TX scheduler already running on %s\n",argv[0]);
+    return;
+    }
+  sched->Status(verbosity, writer);
+  }
+
+void dbc_tx_stop(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  dbcTxScheduler* sched = NULL;
+    {
+    OvmsMutexLock ltx(&MyDBC.m_txmutex);
+    auto it = MyDBC.m_txshell.find(argv[0]);
+    if (it != MyDBC.m_txshell.end())
+      {
+      sched = it->second;
+      MyDBC.m_txshell.erase(it);
+      }
+    }
+  if (sched == NULL)
+    {
+    writer->printf("Error: No TX scheduler running on %s\n",argv[0]);
+    return;
+    }
+  delete sched;
+  writer->printf("TX scheduler on %s stopped\n",argv[0]);
+  }
+
+void dbc_tx_set(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  OvmsMutexLock ltx(&MyDBC.m_txmutex);
+  auto it = MyDBC.m_txshell.find(argv[0]);
+  if (it == MyDBC.m_txshell.end())
+    {
+    writer->printf("Error: No TX scheduler running on %s\n",argv[0]);
+    return;
+    }
+  dbcNumber value(atof(argv[3]));
+  if (it->second->SetSignal(argv[1], argv[2], value) ||
+      it->second->SetSignal(dbcMessageIdFromString(argv[1]), argv[2], value))
+    writer->printf("Set %s.%s = %s\n",argv[1],argv[2],argv[3]);
+  else
+    writer->printf("Error: Cannot find scheduled message %s signal %s\n",argv[1],argv[2]);
+  }
+
+void dbc_tx_status(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  OvmsMutexLock ltx(&MyDBC.m_txmutex);
+  if (MyDBC.m_txschedulers.empty())
+    {
+    writer->puts("No TX schedulers");
+    return;
+    }
+  for (dbcTxScheduler* sched : MyDBC.m_txschedulers)
+    {
+    if (argc > 0 && strcmp(sched->GetBus()->GetName(), argv[0]) != 0)
+      continue;
+    if (strcmp(cmd->GetName(), "reset") == 0)
+      sched->ResetStats();
+    else
+      sched->Status(verbosity, writer);
+    }
+  if (strcmp(cmd->GetName(), "reset") == 0)
+    writer->puts("TX statistics reset");
+  }
+
 void dbc_autoload(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
   {
-  writer->puts("Auto-loading DBC files...");
+  writer->puts("Auto-loading DBC files in the background...");
   MyDBC.LoadDirectory("/store/dbc", false);
   MyDBC.LoadAutoExtras(false);
   }
@@ -357,6 +578,22 @@ void dbc_message_remove(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int
     }
   }
 
+/**
+ * dbc_selected_editable: check if the signal structure of the selected file may be changed
+ *  Frame handlers & decoders use the signal lists and mux dispatch tables of a
+ *  file without locking, so these must not change while other users hold a lock
+ *  on the file. Call with MyDBC.m_mutex held.
+ */
+static bool dbc_selected_editable(OvmsWriter* writer)
+  {
+  if (MyDBC.m_selected->IsLocked(1))
+    {
+    writer->puts("Error: DBC file is in use, cannot change its signals");
+    return false;
+    }
+  return true;
+  }
+
 void dbc_message_set_mux(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
   {
   if (MyDBC.m_selected == NULL)
@@ -364,6 +601,8 @@ void dbc_message_set_mux(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, in
     writer->puts("Error: No DBC selected");
     return;
     }
+  OvmsMutexLock ldbc(&MyDBC.m_mutex);
+  if (!dbc_selected_editable(writer)) return;
 
   uint32_t msgid = dbcMessageIdFromString(argv[0]);
   dbcMessage* msg = MyDBC.m_selected->m_messages.FindMessage(msgid);
@@ -398,6 +637,8 @@ void dbc_signal_clear(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int a
     writer->puts("Error: No DBC selected");
     return;
     }
+  OvmsMutexLock ldbc(&MyDBC.m_mutex);
+  if (!dbc_selected_editable(writer)) return;
 
   uint32_t msgid = dbcMessageIdFromString(argv[0]);
   dbcMessage* msg = MyDBC.m_selected->m_messages.FindMessage(msgid);
@@ -421,6 +662,8 @@ void dbc_signal_add(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int arg
     writer->puts("Error: No DBC selected");
     return;
     }
+  OvmsMutexLock ldbc(&MyDBC.m_mutex);
+  if (!dbc_selected_editable(writer)) return;
 
   uint32_t msgid = dbcMessageIdFromString(argv[0]);
   dbcMessage* msg = MyDBC.m_selected->m_messages.FindMessage(msgid);
@@ -459,6 +702,8 @@ void dbc_signal_remove(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int
     writer->puts("Error: No DBC selected");
     return;
     }
+  OvmsMutexLock ldbc(&MyDBC.m_mutex);
+  if (!dbc_selected_editable(writer)) return;
 
   uint32_t msgid = dbcMessageIdFromString(argv[0]);
   dbcMessage* msg = MyDBC.m_selected->m_messages.FindMessage(msgid);
@@ -488,6 +733,8 @@ void dbc_signal_set_mux(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int
     writer->puts("Error: No DBC selected");
     return;
     }
+  OvmsMutexLock ldbc(&MyDBC.m_mutex);
+  if (!dbc_selected_editable(writer)) return;
 
   uint32_t msgid = dbcMessageIdFromString(argv[0]);
   dbcMessage* msg = MyDBC.m_selected->m_messages.FindMessage(msgid);
@@ -514,6 +761,105 @@ void dbc_signal_set_mux(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int
     signal->ClearMultiplexed();
     writer->printf("DBC: Cleared mux for signal %s on message %s\n",argv[1],argv[0]);
     }
+  msg->InvalidateMuxTables();
+  }
+
+void dbc_signal_set_muxval(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (MyDBC.m_selected == NULL)
+    {
+    writer->puts("Error: No DBC selected");
+    return;
+    }
+  OvmsMutexLock ldbc(&MyDBC.m_mutex);
+  if (!dbc_selected_editable(writer)) return;
+
+  uint32_t msgid = dbcMessageIdFromString(argv[0]);
+  dbcMessage* msg = MyDBC.m_selected->m_messages.FindMessage(msgid);
+  if (msg == NULL)
+    {
+    writer->printf("Error: Could not find message %s\n",argv[0]);
+    return;
+    }
+
+  dbcSignal* signal = msg->FindSignal(argv[1]);
+  if (signal == NULL)
+    {
+    writer->printf("Error: Could not find signal %s on message %s\n",argv[1],argv[0]);
+    return;
+    }
+
+  dbcSignal* sw = msg->FindSignal(argv[2]);
+  if (sw == NULL || sw == signal)
+    {
+    writer->printf("Error: Invalid switch signal %s on message %s\n",argv[2],argv[0]);
+    return;
+    }
+
+  dbcMuxRangeList_t ranges;
+  for (int k=3; k<argc; k++)
+    {
+    char* end = NULL;
+    dbcMuxRange_t r;
+    r.min = r.max = (uint32_t)strtoul(argv[k], &end, 0);
+    if (end && *end == '-')
+      r.max = (uint32_t)strtoul(end+1, NULL, 0);
+    ranges.push_back(r);
+    }
+
+  signal->SetMultiplexed(sw, ranges);
+  sw->SetMultiplexor();
+  msg->InvalidateMuxTables();
+  writer->printf("DBC: Set mux %s ranges for signal %s on message %s\n",argv[2],argv[1],argv[0]);
+  }
+
+void dbc_signal_set_filter(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (MyDBC.m_selected == NULL)
+    {
+    writer->puts("Error: No DBC selected");
+    return;
+    }
+
+  uint32_t msgid = dbcMessageIdFromString(argv[0]);
+  dbcMessage* msg = MyDBC.m_selected->m_messages.FindMessage(msgid);
+  if (msg == NULL)
+    {
+    writer->printf("Error: Could not find message %s\n",argv[0]);
+    return;
+    }
+
+  dbcSignal* signal = msg->FindSignal(argv[1]);
+  if (signal == NULL)
+    {
+    writer->printf("Error: Could not find signal %s on message %s\n",argv[1],argv[0]);
+    return;
+    }
+
+  const char* attrs[] = { DBC_ATTR_DEADBAND, DBC_ATTR_DEADBAND_REL, DBC_ATTR_MIN_INTERVAL, DBC_ATTR_AVG_WINDOW };
+  for (int i=0; i<4; i++)
+    {
+    double val = (argc > i+2) ? atof(argv[i+2]) : 0;
+    if (val > 0)
+      signal->SetAttribute(attrs[i], dbcNumber(val));
+    else
+      signal->RemoveAttribute(attrs[i]);
+    }
+
+  if (signal->HasFilter())
+    writer->printf("DBC: Set filter for signal %s on message %s\n",argv[1],argv[0]);
+  else
+    writer->printf("DBC: Cleared filter for signal %s on message %s\n",argv[1],argv[0]);
+  }
+
+void dbc_config_changed(std::string event, void* data)
+  {
+  OvmsConfigParam* p = (OvmsConfigParam*)data;
+  if (p->GetName().compare("dbc")!=0) return;
+
+  OvmsMutexLock ldbc(&MyDBC.m_mutex);
+  for (auto it : MyDBC.m_dbclist)
+    MyDBC.ApplyFilterConfig(it.second);
   }
 
 dbc::dbc()
@@ -530,6 +876,19 @@ dbc::dbc()
   cmd_dbc->RegisterCommand("dump", "Dump DBC file", dbc_dump, "[<name>]", 0, 1);
   cmd_dbc->RegisterCommand("show", "Show DBC file", dbc_show, "[<name>]", 0, 1);
   cmd_dbc->RegisterCommand("autoload", "Autoload DBC files", dbc_autoload);
+  MyCanFormatFactory.RegisterCommandSet(cmd_dbc->RegisterCommand("decode", "Decode CAN log file using DBC files"),
+    "Decode CAN log file using DBC files", dbc_decode,
+    "<logfile> <outprefix> <dbc>[:<bus>] [...]\n"
+    "Writes signal values to <outprefix>.csv and <outprefix>.bin (binary columns).\n"
+    "<bus>: restrict DBC file to bus 1-4 (default all buses)", 3, 10);
+  OvmsCommand* cmd_tx = cmd_dbc->RegisterCommand("tx","DBC cyclic transmission framework");
+  cmd_tx->RegisterCommand("start", "Start cyclic transmission of DBC messages", dbc_tx_start,
+    "<bus> <dbc> [<message>[:<cycle_ms>] ...]\n"
+    "Default: all messages having a GenMsgCycleTime attribute", 2, 20);
+  cmd_tx->RegisterCommand("stop", "Stop cyclic transmission", dbc_tx_stop, "<bus>", 1, 1);
+  cmd_tx->RegisterCommand("set", "Set signal value for cyclic transmission", dbc_tx_set, "<bus> <message> <signal> <value>", 4, 4);
+  cmd_tx->RegisterCommand("status", "Show cyclic transmission status and jitter", dbc_tx_status, "[<bus>]", 0, 1);
+  cmd_tx->RegisterCommand("reset", "Reset cyclic transmission statistics", dbc_tx_status, "[<bus>]", 0, 1);
   cmd_dbc->RegisterCommand("select", "Select DBC file for editing", dbc_select, "[<name>]", 0, 1);
   cmd_dbc->RegisterCommand("deselect", "Deselect DBC file for editing", dbc_deselect);
 
@@ -538,6 +897,10 @@ dbc::dbc()
   cmd_set->RegisterCommand("timing", "Set bit timing for selected DBC file", dbc_set_timing, "<baud> <btr1> <btr2>", 3, 3);
   cmd_set->RegisterCommand("messagemux", "Set message mux for selected DBC file", dbc_message_set_mux, "<id> [<signal>]", 1, 2);
   cmd_set->RegisterCommand("signalmux", "Set signal mux for selected DBC file", dbc_signal_set_mux, "<id> <name> [<value>]", 2, 3);
+  cmd_set->RegisterCommand("signalmuxval", "Set signal extended mux for selected DBC file", dbc_signal_set_muxval, "<id> <name> <switch> <min>[-<max>] [...]", 4, 20);
+  cmd_set->RegisterCommand("signalfilter", "Set signal metric update filter for selected DBC file", dbc_signal_set_filter,
+    "<id> <name> [<deadband> [<deadband_pct> [<interval_ms> [<window>]]]]\n"
+    "Values of 0 or omitted values disable the respective filter stage", 2, 6);
 
   OvmsCommand* cmd_add = cmd_dbc->RegisterCommand("add","DBC Add framework");
   cmd_add->RegisterCommand("node", "Add node for selected DBC file", dbc_node_add, "<node>", 1, 1);
@@ -557,11 +920,16 @@ dbc::dbc()
   MyConfig.RegisterParam("dbc", "DBC Configuration", true, true);
   // Our instances:
   //   'autodirs': Space separated list of directories to auto load DBC files from
+  //   'filter.<signal>': Metric update filter override for all signals of that name:
+  //                      <deadband> [<deadband_pct> [<interval_ms> [<window>]]]
+  //   'loader.budget': Memory budget for all loaded DBC files [kB], 0 = unlimited
+  //   'loader.overbudget': 'partial' (default) = drop messages to fit, 'reject' = skip file
 
   #undef bind  // Kludgy, but works
   using std::placeholders::_1;
   using std::placeholders::_2;
   MyEvents.RegisterEvent(TAG, "sd.mounted", std::bind(&dbc_sdmounted, _1, _2));
+  MyEvents.RegisterEvent(TAG, "config.changed", std::bind(&dbc_config_changed, _1, _2));
   }
 
 dbc::~dbc()
@@ -569,10 +937,20 @@ dbc::~dbc()
   DeselectFile();
   }
 
-bool dbc::LoadFile(const char* name, const char* path)
+void dbc::RegisterTxScheduler(dbcTxScheduler* scheduler)
   {
-  OvmsMutexLock ldbc(&m_mutex);
+  OvmsMutexLock ltx(&m_txmutex);
+  m_txschedulers.push_back(scheduler);
+  }
+
+void dbc::DeregisterTxScheduler(dbcTxScheduler* scheduler)
+  {
+  OvmsMutexLock ltx(&m_txmutex);
+  m_txschedulers.remove(scheduler);
+  }
 
+bool dbc::LoadFile(const char* name, const char* path)
+  {
   dbcfile* ndbc = new dbcfile();
   if (!ndbc->LoadFile(name, path))
     {
@@ -580,28 +958,13 @@ bool dbc::LoadFile(const char* name, const char* path)
     return false;
     }
 
-  auto k = m_dbclist.find(name);
-  if (k == m_dbclist.end())
-    {
-    // Create a new entry...
-    m_dbclist[name] = ndbc;
-    }
-  else
+  ApplyFilterConfig(ndbc);
+
+  if (!Insert(name, ndbc))
     {
-    // Replace it inline...
-    if (k->second->IsLocked())
-      {
-      ESP_LOGE(TAG,"DBC file %s is locked, so cannot be replaced",name);
-      delete ndbc;
-      return false;
-      }
-    else
-      {
-      delete k->second;
-      m_dbclist[name] = ndbc;
-      }
+    delete ndbc;
+    return false;
     }
-
   return true;
   }
 
@@ -614,6 +977,24 @@ dbcfile* dbc::LoadString(const char* name, const char* content)
     return NULL;
     }
 
+  ApplyFilterConfig(ndbc);
+
+  if (!Insert(name, ndbc))
+    {
+    delete ndbc;
+    return NULL;
+    }
+  return ndbc;
+  }
+
+/**
+ * Insert: add a loaded DBC file, replacing an unlocked file of the same name
+ *  On failure, the caller keeps ownership of ndbc.
+ */
+bool dbc::Insert(const char* name, dbcfile* ndbc)
+  {
+  OvmsMutexLock ldbc(&m_mutex);
+
   auto k = m_dbclist.find(name);
   if (k == m_dbclist.end())
     {
@@ -626,8 +1007,7 @@ dbcfile* dbc::LoadString(const char* name, const char* content)
     if (k->second->IsLocked())
       {
       ESP_LOGE(TAG,"DBC file %s is locked, so cannot be replaced",name);
-      delete ndbc;
-      return NULL;
+      return false;
       }
     else
       {
@@ -636,7 +1016,23 @@ dbcfile* dbc::LoadString(const char* name, const char* content)
       }
     }
 
-  return ndbc;
+  return true;
+  }
+
+/**
+ * GetMemoryUsage: estimated heap usage of all loaded DBC files
+ *  exclude: name of a file not to count (i.e. to be replaced)
+ */
+size_t dbc::GetMemoryUsage(const char* exclude /*=NULL*/)
+  {
+  OvmsMutexLock ldbc(&m_mutex);
+  size_t size = 0;
+  for (auto& it : m_dbclist)
+    {
+    if (exclude && it.first == exclude) continue;
+    size += it.second->GetMemoryUsage();
+    }
+  return size;
   }
 
 bool dbc::Unload(const char* name)
@@ -662,9 +1058,42 @@ bool dbc::Unload(const char* name)
     }
   }
 
+/**
+ * ApplyFilterConfig: apply the 'filter.<signal>' config overrides to a DBC file
+ *  Overrides take precedence over the DBC signal attributes. Removing an
+ *  override takes effect when the DBC file is reloaded.
+ */
+void dbc::ApplyFilterConfig(dbcfile* dbcf)
+  {
+  OvmsConfigParam* param = MyConfig.CachedParam("dbc");
+  if (param == NULL) return;
+
+  for (auto& kv : param->GetMap())
+    {
+    if (!startsWith(kv.first, "filter.")) continue;
+    std::string name = kv.first.substr(7);
+
+    double deadband = 0, deadband_rel = 0;
+    unsigned int interval = 0;
+    int window = 0;
+    sscanf(kv.second.c_str(), "%lf %lf %u %d", &deadband, &deadband_rel, &interval, &window);
+
+    for (auto& msg : dbcf->m_messages.m_entrymap)
+      {
+      dbcSignal* signal = msg.second->FindSignal(name);
+      if (signal)
+        {
+        ESP_LOGD(TAG, "%s: filter override for signal %s: %s",
+          dbcf->GetName().c_str(), name.c_str(), kv.second.c_str());
+        signal->SetFilter(deadband, deadband_rel / 100, interval, window);
+        }
+      }
+    }
+  }
+
 void dbc::LoadDirectory(const char* path, bool log)
   {
-  // Load all DBC files in the specified directory
+  // Load all DBC files in the specified directory (in the background)
   DIR *dir;
   struct dirent *dp;
   if ((dir = opendir(path)) == NULL) return;
@@ -677,8 +1106,8 @@ void dbc::LoadDirectory(const char* path, bool log)
       std::string fp(path);
       fp.append("/");
       fp.append(dp->d_name);
-      if (log) ESP_LOGI(TAG,"Loading %s (%s)",name.c_str(),fp.c_str());
-      LoadFile(name.c_str(),fp.c_str());
+      if (log) ESP_LOGI(TAG,"Queueing %s (%s)",name.c_str(),fp.c_str());
+      m_loader.Queue(name,fp);
       }
     }
   closedir(dir);
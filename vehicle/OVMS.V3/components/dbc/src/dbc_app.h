@@ -32,12 +32,17 @@
 #define __DBC_APP_H__
 
 #include "dbc.h"
+#include "dbc_loader.h"
 #include "ovms_command.h"
 #include "ovms_mutex.h"
 #include "ovms_utils.h"
 
 typedef std::map<std::string, dbcfile*> dbcLoadedFiles_t;
 
+class dbcTxScheduler;
+typedef std::list<dbcTxScheduler*> dbcTxSchedulerList_t;
+typedef std::map<std::string, dbcTxScheduler*> dbcTxSchedulerMap_t;
+
 class dbc
   {
   public:
@@ -48,9 +53,12 @@ class dbc
     bool LoadFile(const char* name, const char* path);
     dbcfile* LoadString(const char* name, const char* content);
     bool Unload(const char* name);
+    bool Insert(const char* name, dbcfile* ndbc);
+    size_t GetMemoryUsage(const char* exclude=NULL);
     void LoadDirectory(const char* path, bool log=false);
     void LoadAutoExtras(bool log=false);
     dbcfile* Find(const char* name);
+    void ApplyFilterConfig(dbcfile* dbcf);
 
   public:
     bool SelectFile(dbcfile* select);
@@ -58,6 +66,10 @@ class dbc
     void DeselectFile();
     dbcfile* SelectedFile();
 
+  public:
+    void RegisterTxScheduler(dbcTxScheduler* scheduler);
+    void DeregisterTxScheduler(dbcTxScheduler* scheduler);
+
   public:
     void AutoInit();
 
@@ -65,6 +77,12 @@ class dbc
     OvmsMutex m_mutex;
     dbcLoadedFiles_t m_dbclist;
     dbcfile* m_selected;
+    dbcLoader m_loader;
+
+  public:
+    OvmsMutex m_txmutex;
+    dbcTxSchedulerList_t m_txschedulers;  // All TX schedulers (for status)
+    dbcTxSchedulerMap_t m_txshell;        // TX schedulers created by command, by bus name
   };
 
 extern dbc MyDBC;
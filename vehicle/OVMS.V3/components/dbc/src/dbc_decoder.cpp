@@ -0,0 +1,366 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Date:          18th October 2026
+;
+;    Changes:
+;    1.0  Initial release
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011       Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+#include "ovms_log.h"
+static const char *TAG = "dbc-decoder";
+
+#include <algorithm>
+#include <sstream>
+#include <string.h>
+#include "dbc_decoder.h"
+
+/**
+ * dbcDecoder: batch decoder for CAN logs
+ *
+ *  Reads a CAN log file in any canformat supported format, decodes all
+ *  frames against one or more DBC files and writes the signal values as
+ *  a CSV time series ("time,signal,value") and/or a binary column file
+ *  (see dbc_decoder.h for the layout).
+ *
+ *  The log is processed in blocks of DBC_DECODER_BLOCKSIZE frames. Each
+ *  block is split into slices decoded in parallel by worker tasks (the
+ *  calling task decodes the first slice), results are then written in
+ *  frame order.
+ */
+
+dbcDecoder::dbcDecoder()
+  {
+  m_frames = 0;
+  m_decoded = 0;
+  m_samples = 0;
+  m_time = 0;
+  for (int k=0; k<DBC_DECODER_MAXBUS; k++)
+    m_bus[k] = NULL;
+  for (int k=0; k<DBC_DECODER_MAXTHREADS; k++)
+    {
+    m_jobs[k].decoder = this;
+    m_jobs[k].frames = NULL;
+    m_jobs[k].count = 0;
+    m_jobs[k].decoded = 0;
+    m_jobs[k].start = NULL;
+    m_jobs[k].done = NULL;
+    m_jobs[k].task = NULL;
+    m_jobs[k].quit = false;
+    }
+  }
+
+dbcDecoder::~dbcDecoder()
+  {
+  }
+
+/**
+ * AddDBC: add a DBC file for decoding
+ *  Bus specific DBC files take precedence over those for all buses,
+ *  the first DBC file defining a message is used for it.
+ */
+bool dbcDecoder::AddDBC(dbcfile* dbc, int bus)
+  {
+  if (dbc == NULL || bus < 0 || bus > DBC_DECODER_MAXBUS)
+    return false;
+
+  m_dbc[bus].push_back(dbc);
+
+  // Assign columns (the mux dispatch tables are built at load time,
+  // the file may be in use by a vehicle, so they must not be rebuilt here):
+  for (auto& it : dbc->m_messages.m_entrymap)
+    {
+    dbcMessage* msg = it.second;
+    for (dbcSignal* signal : msg->m_signals)
+      {
+      if (m_columnmap.find(signal) != m_columnmap.end()) continue;
+      m_columnmap[signal] = m_columns.size();
+      m_columns.push_back(msg->GetName() + "." + signal->GetName());
+      }
+    }
+
+  return true;
+  }
+
+int dbcDecoder::GetColumnCount()
+  {
+  return m_columns.size();
+  }
+
+std::string dbcDecoder::GetStats()
+  {
+  std::ostringstream ss;
+  ss << m_frames << " frame(s) read, ";
+  ss << m_decoded << " decoded, ";
+  ss << m_samples << " value(s) in ";
+  ss << m_columns.size() << " column(s), ";
+  ss << m_time << " ms";
+  return ss.str();
+  }
+
+void dbcDecoder::WorkerTask(void *pvParameters)
+  {
+  dbcDecoderJob_t* job = (dbcDecoderJob_t*)pvParameters;
+  while (true)
+    {
+    job->start->Take();
+    if (job->quit) break;
+    job->decoder->DecodeSlice(job);
+    job->done->Give();
+    }
+  job->done->Give();
+  vTaskDelete(NULL);
+  }
+
+void dbcDecoder::DecodeSlice(dbcDecoderJob_t* job)
+  {
+  char buf[48];
+  job->samples.clear();
+  job->csv.clear();
+  job->decoded = 0;
+
+  for (size_t i=0; i<job->count; i++)
+    {
+    const CAN_log_message_t* msg = &job->frames[i];
+    CAN_frame_t frame = msg->frame;
+
+    int bus = 0;
+    for (int k=0; k<DBC_DECODER_MAXBUS; k++)
+      {
+      if (m_bus[k] != NULL && m_bus[k] == frame.origin)
+        { bus = k+1; break; }
+      }
+
+    dbcMessage* dbcmsg = NULL;
+    for (int pass=0; pass<2 && dbcmsg==NULL; pass++)
+      {
+      if (pass == 0 && bus == 0) continue;
+      for (dbcfile* dbc : m_dbc[(pass==0) ? bus : 0])
+        {
+        dbcmsg = dbc->m_messages.FindMessage(frame.FIR.B.FF, frame.MsgID);
+        if (dbcmsg) break;
+        }
+      }
+    if (dbcmsg == NULL) continue;
+    job->decoded++;
+
+    double time = msg->timestamp.tv_sec + msg->timestamp.tv_usec / 1000000.0;
+    dbcmsg->GetActiveSignals(&frame, job->active);
+    for (dbcSignal* signal : job->active)
+      {
+      auto col = m_columnmap.find(signal);
+      if (col == m_columnmap.end()) continue;
+
+      dbcDecoderSample_t sample;
+      sample.time = time;
+      sample.value = signal->Decode(&frame).GetDouble();
+      sample.column = col->second;
+      job->samples.push_back(sample);
+
+      snprintf(buf, sizeof(buf), "%ld.%06ld,", (long)msg->timestamp.tv_sec, (long)msg->timestamp.tv_usec);
+      job->csv.append(buf);
+      job->csv.append(m_columns[sample.column]);
+      snprintf(buf, sizeof(buf), ",%.10g\n", sample.value);
+      job->csv.append(buf);
+      }
+    }
+  }
+
+void dbcDecoder::WriteHeader(FILE* csv, FILE* bin)
+  {
+  if (csv)
+    {
+    fputs("time,signal,value\n", csv);
+    }
+  if (bin)
+    {
+    uint32_t version = DBC_DECODER_VERSION;
+    uint32_t columns = m_columns.size();
+    fwrite(DBC_DECODER_MAGIC, 1, strlen(DBC_DECODER_MAGIC), bin);
+    fwrite(&version, sizeof(version), 1, bin);
+    fwrite(&columns, sizeof(columns), 1, bin);
+    for (std::string& name : m_columns)
+      {
+      uint16_t len = name.size();
+      fwrite(&len, sizeof(len), 1, bin);
+      fwrite(name.data(), 1, len, bin);
+      }
+    }
+  }
+
+void dbcDecoder::WriteBlock(FILE* csv, FILE* bin, int jobs)
+  {
+  for (int k=0; k<jobs; k++)
+    {
+    m_decoded += m_jobs[k].decoded;
+    m_samples += m_jobs[k].samples.size();
+    if (csv && !m_jobs[k].csv.empty())
+      fwrite(m_jobs[k].csv.data(), 1, m_jobs[k].csv.size(), csv);
+    }
+  if (!bin) return;
+
+  // Regroup the block by column, keeping the time order per column:
+  m_merged.clear();
+  for (int k=0; k<jobs; k++)
+    m_merged.insert(m_merged.end(), m_jobs[k].samples.begin(), m_jobs[k].samples.end());
+  std::stable_sort(m_merged.begin(), m_merged.end(),
+    [](const dbcDecoderSample_t& a, const dbcDecoderSample_t& b) { return a.column < b.column; });
+
+  size_t start = 0;
+  while (start < m_merged.size())
+    {
+    size_t end = start;
+    while (end < m_merged.size() && m_merged[end].column == m_merged[start].column)
+      end++;
+    uint16_t column = m_merged[start].column;
+    uint32_t count = end - start;
+    fwrite(&column, sizeof(column), 1, bin);
+    fwrite(&count, sizeof(count), 1, bin);
+    for (size_t i=start; i<end; i++)
+      fwrite(&m_merged[i].time, sizeof(double), 1, bin);
+    for (size_t i=start; i<end; i++)
+      fwrite(&m_merged[i].value, sizeof(double), 1, bin);
+    start = end;
+    }
+  }
+
+/**
+ * Decode: decode a CAN log
+ *  format: canformat reader for the log format
+ *  in:     log file
+ *  csv:    CSV output file or NULL
+ *  bin:    binary column output file or NULL
+ *  threads: number of decoding tasks (1 - DBC_DECODER_MAXTHREADS)
+ */
+bool dbcDecoder::Decode(canformat* format, FILE* in, FILE* csv, FILE* bin, int threads)
+  {
+  if (format == NULL || in == NULL) return false;
+  if (m_columns.size() > UINT16_MAX)
+    {
+    ESP_LOGE(TAG, "Too many signals (%d)", (int)m_columns.size());
+    return false;
+    }
+
+  // put() drops all input in serve mode Discard (the factory default), we
+  // only call put(), so Simulate does not feed frames into the CAN framework:
+  format->SetServeMode(canformat::Simulate);
+
+  uint32_t starttime = esp_log_timestamp();
+  m_frames = m_decoded = m_samples = 0;
+  for (int k=0; k<DBC_DECODER_MAXBUS; k++)
+    m_bus[k] = MyCan.GetBus(k);
+  threads = MAX(1, MIN(threads, DBC_DECODER_MAXTHREADS));
+
+  // Start workers:
+  OvmsSemaphore done(threads, 0);
+  OvmsSemaphore start[DBC_DECODER_MAXTHREADS];
+  for (int k=0; k<threads; k++)
+    {
+    m_jobs[k].start = &start[k];
+    m_jobs[k].done = &done;
+    m_jobs[k].quit = false;
+    m_jobs[k].task = NULL;
+    if (k > 0)
+      {
+      xTaskCreatePinnedToCore(WorkerTask, "OVMS DBCdec", DBC_DECODER_STACKSIZE,
+        (void*)&m_jobs[k], 5, &m_jobs[k].task, CORE(k & 1));
+      if (m_jobs[k].task == NULL)
+        {
+        ESP_LOGW(TAG, "Could not start worker %d", k);
+        threads = k;
+        break;
+        }
+      }
+    }
+
+  WriteHeader(csv, bin);
+
+  uint8_t buffer[DBC_DECODER_READSIZE];
+  m_block.clear();
+  m_block.reserve(DBC_DECODER_BLOCKSIZE);
+  bool eof = false;
+  while (!eof || !m_block.empty())
+    {
+    // Read the next block:
+    while (!eof && m_block.size() < DBC_DECODER_BLOCKSIZE)
+      {
+      size_t len = fread(buffer, 1, sizeof(buffer), in);
+      if (len == 0) eof = true;
+      uint8_t* bp = buffer;
+      bool hasmore = true;
+      while (hasmore)
+        {
+        CAN_log_message_t msg;
+        memset(&msg,0,sizeof(msg));
+        hasmore = false;
+        size_t used = format->put(&msg, bp, len, &hasmore, NULL);
+        if (used > 0)
+          {
+          bp += used;
+          len -= used;
+          }
+        else
+          {
+          len = 0;
+          }
+        if ((msg.type == CAN_LogFrame_RX || msg.type == CAN_LogFrame_TX) &&
+            msg.frame.origin != NULL)
+          {
+          m_block.push_back(msg);
+          }
+        }
+      }
+    if (m_block.empty()) break;
+    m_frames += m_block.size();
+
+    // Decode slices in parallel:
+    size_t slice = (m_block.size() + threads - 1) / threads;
+    int jobs = 0;
+    for (size_t pos = 0; pos < m_block.size(); pos += slice, jobs++)
+      {
+      m_jobs[jobs].frames = &m_block[pos];
+      m_jobs[jobs].count = MIN(slice, m_block.size() - pos);
+      }
+    for (int k=1; k<jobs; k++)
+      m_jobs[k].start->Give();
+    DecodeSlice(&m_jobs[0]);
+    for (int k=1; k<jobs; k++)
+      done.Take();
+
+    WriteBlock(csv, bin, jobs);
+    m_block.clear();
+    }
+
+  // Stop workers:
+  for (int k=1; k<threads; k++)
+    {
+    m_jobs[k].quit = true;
+    m_jobs[k].start->Give();
+    done.Take();
+    }
+
+  m_time = esp_log_timestamp() - starttime;
+  ESP_LOGI(TAG, "Decoding done: %s", GetStats().c_str());
+  return true;
+  }
@@ -0,0 +1,116 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Date:          18th October 2026
+;
+;    Changes:
+;    1.0  Initial release
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011       Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+#ifndef __DBC_DECODER_H__
+#define __DBC_DECODER_H__
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <map>
+#include "dbc.h"
+#include "canformat.h"
+#include "ovms_semaphore.h"
+
+#define DBC_DECODER_BLOCKSIZE     512         // Frames per decoding block
+#define DBC_DECODER_MAXTHREADS    4           // Including the calling task
+#define DBC_DECODER_THREADS       2           // Default: one per core
+#define DBC_DECODER_MAXBUS        4           // can1 - can4
+#define DBC_DECODER_READSIZE      1024        // File read chunk size
+#define DBC_DECODER_STACKSIZE     4096        // Worker task stack size
+
+// Binary column file:
+//  Header:   "OVMSDBCC" uint32 version, uint32 columns,
+//            columns * { uint16 namelen, char name[namelen] }
+//  Chunks:   uint16 column, uint32 count, double time[count], double value[count]
+//  One chunk per column and block, all values little endian (native).
+#define DBC_DECODER_MAGIC         "OVMSDBCC"
+#define DBC_DECODER_VERSION       1
+
+struct dbcDecoderSample_t
+  {
+  double time;                                // Frame timestamp [s]
+  double value;                               // Decoded physical signal value
+  uint32_t column;                            // Column (signal) index
+  };
+typedef std::vector<dbcDecoderSample_t> dbcDecoderSampleList_t;
+
+class dbcDecoder;
+
+struct dbcDecoderJob_t
+  {
+  dbcDecoder* decoder;
+  const CAN_log_message_t* frames;            // Slice of the current block
+  size_t count;
+  uint32_t decoded;                           // Frames matching a DBC message
+  dbcDecoderSampleList_t samples;             // Decoding result, in frame order
+  std::string csv;                            // Same, formatted as CSV lines
+  dbcSignalVector_t active;                   // Signal buffer
+  OvmsSemaphore* start;
+  OvmsSemaphore* done;
+  TaskHandle_t task;
+  bool quit;
+  };
+
+class dbcDecoder
+  {
+  public:
+    dbcDecoder();
+    ~dbcDecoder();
+
+  public:
+    bool AddDBC(dbcfile* dbc, int bus=0);     // bus: 1-4, 0=all buses
+    bool Decode(canformat* format, FILE* in, FILE* csv, FILE* bin, int threads=2);
+    std::string GetStats();
+    int GetColumnCount();
+
+  protected:
+    static void WorkerTask(void *pvParameters);
+    void DecodeSlice(dbcDecoderJob_t* job);
+    void WriteHeader(FILE* csv, FILE* bin);
+    void WriteBlock(FILE* csv, FILE* bin, int jobs);
+
+  protected:
+    std::vector<dbcfile*> m_dbc[DBC_DECODER_MAXBUS+1];   // [0]=all buses
+    std::map<dbcSignal*, uint32_t> m_columnmap;
+    std::vector<std::string> m_columns;
+    canbus* m_bus[DBC_DECODER_MAXBUS];
+    dbcDecoderJob_t m_jobs[DBC_DECODER_MAXTHREADS];
+    std::vector<CAN_log_message_t> m_block;
+    dbcDecoderSampleList_t m_merged;
+
+  protected:
+    uint32_t m_frames;                        // Frames read
+    uint32_t m_decoded;                       // Frames matching a DBC message
+    uint32_t m_samples;                       // Signal values written
+    uint32_t m_time;                          // Decoding time [ms]
+  };
+
+#endif //#ifndef __DBC_DECODER_H__
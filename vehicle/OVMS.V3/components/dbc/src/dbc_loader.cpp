@@ -0,0 +1,352 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Date:          18th October 2026
+;
+;    Changes:
+;    1.0  Initial release
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011       Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+
+#include "ovms_log.h"
+static const char *TAG = "dbc-loader";
+
+#include <algorithm>
+#include <sstream>
+#include <stdio.h>
+#include <string.h>
+#include "dbc_loader.h"
+#include "dbc_app.h"
+#include "ovms.h"
+#include "ovms_config.h"
+#include "ovms_events.h"
+#include "ovms_malloc.h"
+
+/**
+ * dbcLoader: background loading of DBC files
+ *
+ *  Files are queued and loaded by up to DBC_LOADER_THREADS worker tasks
+ *  (one per core), so the caller (i.e. the boot sequence) is not blocked.
+ *  Workers read & parse the files in parallel (the flex/bison parser is
+ *  reentrant, see dbc_parser.y).
+ *  Users of a file still being loaded register a completion callback
+ *  (WhenLoaded) instead of waiting for it.
+ *
+ *  Memory budget: config 'dbc' 'loader.budget' (kB, 0 = unlimited) limits the
+ *  estimated total heap usage of all loaded DBC files. A file exceeding the
+ *  remaining budget is loaded partially (messages dropped, highest IDs first)
+ *  or, if 'loader.overbudget' is 'reject', not at all.
+ *
+ *  Events: dbc.loaded, dbc.rejected, dbc.failed (data: DBC name)
+ */
+
+dbcLoader::dbcLoader()
+  {
+  m_workers = 0;
+  m_loaded = 0;
+  m_partial = 0;
+  m_rejected = 0;
+  m_failed = 0;
+  }
+
+dbcLoader::~dbcLoader()
+  {
+  }
+
+/**
+ * Queue: queue a DBC file for loading
+ *  A file already queued under the same name is replaced.
+ */
+void dbcLoader::Queue(const std::string& name, const std::string& path)
+  {
+  OvmsMutexLock lock(&m_mutex);
+
+  for (auto& job : m_queue)
+    {
+    if (job.name == name)
+      {
+      job.path = path;
+      return;
+      }
+    }
+  m_queue.push_back({ name, path });
+
+  if (m_workers < DBC_LOADER_THREADS && m_workers < (int)m_queue.size())
+    {
+    TaskHandle_t task = NULL;
+    xTaskCreatePinnedToCore(WorkerTask, "OVMS DBCload", DBC_LOADER_STACKSIZE,
+      (void*)this, 3, &task, CORE(m_workers & 1));
+    if (task)
+      m_workers++;
+    else if (m_workers == 0)
+      {
+      ESP_LOGE(TAG, "Could not start loader task, %s not loaded", name.c_str());
+      m_queue.pop_back();
+      }
+    }
+  }
+
+bool dbcLoader::IsPending(const std::string& name)
+  {
+  OvmsMutexLock lock(&m_mutex);
+  for (auto& job : m_queue)
+    {
+    if (job.name == name) return true;
+    }
+  for (auto& active : m_active)
+    {
+    if (active == name) return true;
+    }
+  return false;
+  }
+
+/**
+ * WhenLoaded: register a callback for the completion of a pending DBC file
+ *  Returns false if the file is not queued or loading (callback not registered),
+ *  else the callback will be called by the loader task once the file has been
+ *  processed. The owner must call CancelWhenLoaded() before it is destroyed.
+ */
+bool dbcLoader::WhenLoaded(const std::string& name, void* owner, dbcLoaderCallback_t callback)
+  {
+  OvmsMutexLock lock(&m_mutex);
+  bool pending = false;
+  for (auto& job : m_queue)
+    {
+    if (job.name == name) pending = true;
+    }
+  for (auto& active : m_active)
+    {
+    if (active == name) pending = true;
+    }
+  if (pending)
+    m_waiters.push_back({ name, owner, callback });
+  return pending;
+  }
+
+/**
+ * CancelWhenLoaded: remove all callbacks of an owner
+ *  Waits for callbacks currently running to finish.
+ */
+void dbcLoader::CancelWhenLoaded(void* owner)
+  {
+  OvmsMutexLock lcb(&m_callbackmutex);
+  OvmsMutexLock lock(&m_mutex);
+  m_waiters.remove_if([owner](const dbcLoaderWaiter_t& w) { return w.owner == owner; });
+  }
+
+/**
+ * RunCallbacks: call & remove the completion callbacks for a file (loader task)
+ */
+void dbcLoader::RunCallbacks(const std::string& name)
+  {
+  OvmsMutexLock lcb(&m_callbackmutex);
+  dbcLoaderWaiterList_t done;
+    {
+    OvmsMutexLock lock(&m_mutex);
+    for (auto it = m_waiters.begin(); it != m_waiters.end(); )
+      {
+      if (it->name == name)
+        {
+        done.push_back(*it);
+        it = m_waiters.erase(it);
+        }
+      else
+        ++it;
+      }
+    }
+  if (done.empty())
+    return;
+  dbcfile* dbc = MyDBC.Find(name.c_str());
+  for (auto& w : done)
+    w.callback(name, dbc);
+  }
+
+bool dbcLoader::IsBusy()
+  {
+  OvmsMutexLock lock(&m_mutex);
+  return (m_workers > 0);
+  }
+
+std::string dbcLoader::Status()
+  {
+  std::ostringstream ss;
+  OvmsMutexLock lock(&m_mutex);
+  ss << m_queue.size() << " queued, ";
+  ss << m_active.size() << " loading, ";
+  ss << m_loaded << " loaded (" << m_partial << " partial), ";
+  ss << m_rejected << " rejected, ";
+  ss << m_failed << " failed";
+  return ss.str();
+  }
+
+void dbcLoader::WorkerTask(void *pvParameters)
+  {
+  dbcLoader* me = (dbcLoader*) pvParameters;
+  while (true)
+    {
+    dbcLoaderJob_t job;
+      {
+      OvmsMutexLock lock(&me->m_mutex);
+      if (me->m_queue.empty())
+        {
+        me->m_workers--;
+        break;
+        }
+      job = me->m_queue.front();
+      me->m_queue.pop_front();
+      me->m_active.push_back(job.name);
+      }
+
+    me->Load(job);
+
+      {
+      OvmsMutexLock lock(&me->m_mutex);
+      auto it = std::find(me->m_active.begin(), me->m_active.end(), job.name);
+      if (it != me->m_active.end())
+        me->m_active.erase(it);
+      }
+
+    me->RunCallbacks(job.name);
+    }
+  vTaskDelete(NULL);
+  }
+
+void dbcLoader::Load(const dbcLoaderJob_t& job)
+  {
+  const char* name = job.name.c_str();
+  size_t budget = MyConfig.GetParamValueInt("dbc", "loader.budget", 0) * 1024;
+  bool reject = (MyConfig.GetParamValue("dbc", "loader.overbudget", "partial") == "reject");
+
+  // Early check, avoids reading & parsing if the budget is exhausted:
+  if (budget > 0 && MyDBC.GetMemoryUsage(name) >= budget)
+    {
+    ESP_LOGW(TAG, "%s rejected: memory budget of %u kB exhausted", name, budget / 1024);
+    MyEvents.SignalEvent("dbc.rejected", (void*)name, job.name.size()+1);
+    OvmsMutexLock lock(&m_mutex);
+    m_rejected++;
+    return;
+    }
+
+  if (MyConfig.ProtectedPath(job.path))
+    {
+    ESP_LOGW(TAG, "Path %s is protected", job.path.c_str());
+    OvmsMutexLock lock(&m_mutex);
+    m_failed++;
+    return;
+    }
+
+  // Read the file into memory (in parallel to other workers parsing):
+  char* buffer = NULL;
+  size_t size = 0;
+  FILE* fd = fopen(job.path.c_str(), "r");
+  if (fd)
+    {
+    fseek(fd, 0, SEEK_END);
+    long len = ftell(fd);
+    fseek(fd, 0, SEEK_SET);
+    if (len > 0 && (buffer = (char*)ExternalRamMalloc(len)) != NULL)
+      size = fread(buffer, 1, len, fd);
+    fclose(fd);
+    }
+  if (buffer == NULL || size == 0)
+    {
+    ESP_LOGW(TAG, "Could not read %s", job.path.c_str());
+    if (buffer) free(buffer);
+    MyEvents.SignalEvent("dbc.failed", (void*)name, job.name.size()+1);
+    OvmsMutexLock lock(&m_mutex);
+    m_failed++;
+    return;
+    }
+
+  uint32_t start = esp_log_timestamp();
+  dbcfile* ndbc = new dbcfile();
+  bool ok = ndbc->LoadString(name, buffer, size);
+  free(buffer);
+  if (!ok)
+    {
+    ESP_LOGE(TAG, "%s: parsing failed", job.path.c_str());
+    delete ndbc;
+    MyEvents.SignalEvent("dbc.failed", (void*)name, job.name.size()+1);
+    OvmsMutexLock lock(&m_mutex);
+    m_failed++;
+    return;
+    }
+  ndbc->m_path = job.path;
+
+  MyDBC.ApplyFilterConfig(ndbc);
+
+  // Budget check & insert (serialized, so parallel loads cannot both pass):
+  std::string status;
+  bool rejected = false;
+  int dropped = 0;
+    {
+    OvmsMutexLock lbudget(&m_budgetmutex);
+    if (budget > 0)
+      {
+      size_t used = MyDBC.GetMemoryUsage(name);
+      size_t avail = (used < budget) ? budget - used : 0;
+      size_t need = ndbc->GetMemoryUsage();
+      if (need > avail)
+        {
+        if (!reject)
+          dropped = ndbc->TrimToMemory(avail);
+        if (reject || ndbc->m_messages.m_entrymap.empty())
+          {
+          ESP_LOGW(TAG, "%s rejected: needs %u kB, %u kB of budget available", name, need / 1024, avail / 1024);
+          rejected = true;
+          }
+        else
+          {
+          ESP_LOGW(TAG, "%s partially loaded: %d message(s) dropped to fit memory budget", name, dropped);
+          }
+        }
+      }
+    if (!rejected)
+      status = ndbc->Status();
+    if (!rejected && !MyDBC.Insert(name, ndbc))
+      {
+      delete ndbc;
+      MyEvents.SignalEvent("dbc.failed", (void*)name, job.name.size()+1);
+      OvmsMutexLock lock(&m_mutex);
+      m_failed++;
+      return;
+      }
+    }
+
+  if (rejected)
+    {
+    delete ndbc;
+    MyEvents.SignalEvent("dbc.rejected", (void*)name, job.name.size()+1);
+    OvmsMutexLock lock(&m_mutex);
+    m_rejected++;
+    return;
+    }
+
+  ESP_LOGI(TAG, "Loaded %s (%s) in %u ms: %s", name, job.path.c_str(),
+    esp_log_timestamp() - start, status.c_str());
+  MyEvents.SignalEvent("dbc.loaded", (void*)name, job.name.size()+1);
+  OvmsMutexLock lock(&m_mutex);
+  m_loaded++;
+  if (dropped > 0) m_partial++;
+  }
@@ -0,0 +1,99 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Date:          18th October 2026
+;
+;    Changes:
+;    1.0  Initial release
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011       Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+
+#ifndef __DBC_LOADER_H__
+#define __DBC_LOADER_H__
+
+#include <string>
+#include <list>
+#include <functional>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "dbc.h"
+#include "ovms_mutex.h"
+
+#define DBC_LOADER_THREADS        2           // Worker tasks (one per core)
+#define DBC_LOADER_STACKSIZE      6144        // Worker task stack size
+
+struct dbcLoaderJob_t
+  {
+  std::string name;
+  std::string path;
+  };
+typedef std::list<dbcLoaderJob_t> dbcLoaderQueue_t;
+
+// Completion callback: dbc = loaded file, NULL if rejected or failed
+typedef std::function<void(const std::string& name, dbcfile* dbc)> dbcLoaderCallback_t;
+
+struct dbcLoaderWaiter_t
+  {
+  std::string name;
+  void* owner;
+  dbcLoaderCallback_t callback;
+  };
+typedef std::list<dbcLoaderWaiter_t> dbcLoaderWaiterList_t;
+
+class dbcLoader
+  {
+  public:
+    dbcLoader();
+    ~dbcLoader();
+
+  public:
+    void Queue(const std::string& name, const std::string& path);
+    bool IsPending(const std::string& name);
+    bool WhenLoaded(const std::string& name, void* owner, dbcLoaderCallback_t callback);
+    void CancelWhenLoaded(void* owner);
+    bool IsBusy();
+    std::string Status();
+
+  protected:
+    static void WorkerTask(void *pvParameters);
+    void Load(const dbcLoaderJob_t& job);
+    void RunCallbacks(const std::string& name);
+
+  protected:
+    OvmsMutex m_mutex;
+    OvmsMutex m_budgetmutex;                  // Serializes budget check & insert
+    OvmsMutex m_callbackmutex;                // Held while running completion callbacks
+    dbcLoaderQueue_t m_queue;
+    std::list<std::string> m_active;          // Files currently being loaded
+    dbcLoaderWaiterList_t m_waiters;          // Completion callbacks
+    int m_workers;
+
+  protected:
+    uint32_t m_loaded;
+    uint32_t m_partial;
+    uint32_t m_rejected;
+    uint32_t m_failed;
+  };
+
+#endif //#ifndef __DBC_LOADER_H__
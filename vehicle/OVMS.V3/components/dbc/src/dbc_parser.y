@@ -53,7 +53,28 @@
 #define YYMAXDEPTH 1000
 %}
 
-%parse-param {void* dbcptr}
+%code requires {
+#include "dbc.h"
+
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void* yyscan_t;
+#endif
+
+// Parser state, per parse (the parser & scanner are reentrant):
+typedef struct
+  {
+  dbcfile*            dbc;
+  dbcValueTable*      value_table;
+  dbcMessage*         message;
+  dbcSignal*          signal;
+  dbcMuxRangeList_t   mux_ranges;
+  } dbc_parser_state_t;
+}
+
+%define api.pure full
+%lex-param {yyscan_t scanner}
+%parse-param {yyscan_t scanner} {dbc_parser_state_t* state}
 
 %union {
   long long                   number;
@@ -62,20 +83,21 @@
   };
 
 %{
-extern int yylex (void);
-extern char *yytext;
-extern int yylineno;
+extern int yylex(YYSTYPE* yylval_param, yyscan_t yyscanner);
+extern int yyget_lineno(yyscan_t yyscanner);
+extern char* yyget_text(yyscan_t yyscanner);
 
 static const char *TAG = "dbc-parser";
 
-extern "C"
+static void yyerror(yyscan_t scanner, dbc_parser_state_t* state, const char *msg)
   {
-  void yyerror(void* dbcptr, const char *msg)
-    {
-    ESP_LOGE(TAG,"Error in line %d '%s', symbol '%s'",
-      yylineno, msg, yytext);
-    }
+  ESP_LOGE(TAG,"Error in line %d '%s', symbol '%s'",
+    yyget_lineno(scanner), msg, yyget_text(scanner));
+  }
+
 #ifdef CONFIG_OVMS
+extern "C"
+  {
   void *yyalloc (size_t sz)
     {
     return ExternalRamMalloc(sz);
@@ -85,13 +107,8 @@ extern "C"
     {
     return ExternalRamRealloc(ptr,sz);
     }
-#endif // #ifdef CONFIG_OVMS
   }
-
-dbcfile* current_dbc = NULL;
-dbcValueTable* current_value_table = NULL;
-dbcMessage* current_message = NULL;
-dbcSignal* current_signal = NULL;
+#endif // #ifdef CONFIG_OVMS
 %}
 
 %token T_COLON
@@ -158,15 +175,10 @@ dbcSignal* current_signal = NULL;
 %type <string>                    T_ID T_STRING_VAL version_section signal_mux
 %type <number>                    T_INT_VAL signal_endian signal_sign signal_start signal_length
 %type <double_val>                T_DOUBLE_VAL double_val signal_scale signal_offset signal_min signal_max
+%type <double_val>                attribute_value
 %%
 
 dbc:
-  {
-  current_dbc = (dbcfile*)dbcptr;
-  current_value_table = NULL;
-  current_message = NULL;
-  current_signal = NULL;
-  }
   dbc_sections
   ;
 
@@ -185,7 +197,9 @@ dbc_section:
   | value_section
   | attribute_section
   | attribute_default_section
+  | attribute_value_section
   | comment_section
+  | mux_value_section
   ;
 
 /************************************************************************/
@@ -195,7 +209,7 @@ dbc_section:
 version_section: T_VERSION T_STRING_VAL
   {
   ESP_LOGD(TAG,"VERSION parsed as: %s",$2);
-  current_dbc->m_version = std::string($2);
+  state->dbc->m_version = std::string($2);
   if ($2) { free($2); $2=NULL; }
   };
 
@@ -206,7 +220,7 @@ version_section: T_VERSION T_STRING_VAL
 symbol_section:
    T_NS T_COLON symbol_list
    {
-   ESP_LOGD(TAG,"NS_ parsed %d symbols",current_dbc->m_newsymbols.GetCount());
+   ESP_LOGD(TAG,"NS_ parsed %d symbols",state->dbc->m_newsymbols.GetCount());
    }
    ;
 
@@ -215,34 +229,34 @@ symbol_list:
     ;
 
 symbol:
-    T_NS_DESC          { current_dbc->m_newsymbols.AddSymbol("NS_DESC_"); }
-  | T_CM               { current_dbc->m_newsymbols.AddSymbol("CM_"); }
-  | T_BA_DEF           { current_dbc->m_newsymbols.AddSymbol("BA_DEF_"); }
-  | T_BA               { current_dbc->m_newsymbols.AddSymbol("BA_"); }
-  | T_VAL              { current_dbc->m_newsymbols.AddSymbol("VAL_"); }
-  | T_CAT_DEF          { current_dbc->m_newsymbols.AddSymbol("CAT_DEF_"); }
-  | T_CAT              { current_dbc->m_newsymbols.AddSymbol("CAT_"); }
-  | T_FILTER           { current_dbc->m_newsymbols.AddSymbol("FILTER"); }
-  | T_BA_DEF_DEF       { current_dbc->m_newsymbols.AddSymbol("BA_DEF_DEF_"); }
-  | T_EV_DATA          { current_dbc->m_newsymbols.AddSymbol("EV_DATA_"); }
-  | T_ENVVAR_DATA      { current_dbc->m_newsymbols.AddSymbol("ENVVAR_DATA_"); }
-  | T_SGTYPE           { current_dbc->m_newsymbols.AddSymbol("SG_TYPE_"); }
-  | T_SGTYPE_VAL       { current_dbc->m_newsymbols.AddSymbol("SG_TYPE_VAL_"); }
-  | T_BA_DEF_SGTYPE    { current_dbc->m_newsymbols.AddSymbol("BA_DEF_SGTYPE_"); }
-  | T_BA_SGTYPE        { current_dbc->m_newsymbols.AddSymbol("BA_SGTYPE_"); }
-  | T_SIG_TYPE_REF     { current_dbc->m_newsymbols.AddSymbol("SIG_TYPE_REF_"); }
-  | T_VAL_TABLE        { current_dbc->m_newsymbols.AddSymbol("VAL_TABLE_"); }
-  | T_SIG_GROUP        { current_dbc->m_newsymbols.AddSymbol("SIG_GROUP_"); }
-  | T_SIG_VALTYPE      { current_dbc->m_newsymbols.AddSymbol("SIG_VALTYPE_"); }
-  | T_SIGTYPE_VALTYPE  { current_dbc->m_newsymbols.AddSymbol("SIGTYPE_VALTYPE_"); }
-  | T_BO_TX_BU         { current_dbc->m_newsymbols.AddSymbol("BO_TX_BU_"); }
-  | T_BA_DEF_REL       { current_dbc->m_newsymbols.AddSymbol("BA_DEF_REL_"); }
-  | T_BA_REL           { current_dbc->m_newsymbols.AddSymbol("BA_REL_"); }
-  | T_BA_DEF_DEF_REL   { current_dbc->m_newsymbols.AddSymbol("BA_DEF_DEF_REL_"); }
-  | T_BU_SG_REL        { current_dbc->m_newsymbols.AddSymbol("BU_SG_REL_"); }
-  | T_BU_EV_REL        { current_dbc->m_newsymbols.AddSymbol("BU_EV_REL_"); }
-  | T_BU_BO_REL        { current_dbc->m_newsymbols.AddSymbol("BU_BO_REL_"); }
-  | T_SG_MUL_VAL       { current_dbc->m_newsymbols.AddSymbol("SG_MUL_VAL_"); }
+    T_NS_DESC          { state->dbc->m_newsymbols.AddSymbol("NS_DESC_"); }
+  | T_CM               { state->dbc->m_newsymbols.AddSymbol("CM_"); }
+  | T_BA_DEF           { state->dbc->m_newsymbols.AddSymbol("BA_DEF_"); }
+  | T_BA               { state->dbc->m_newsymbols.AddSymbol("BA_"); }
+  | T_VAL              { state->dbc->m_newsymbols.AddSymbol("VAL_"); }
+  | T_CAT_DEF          { state->dbc->m_newsymbols.AddSymbol("CAT_DEF_"); }
+  | T_CAT              { state->dbc->m_newsymbols.AddSymbol("CAT_"); }
+  | T_FILTER           { state->dbc->m_newsymbols.AddSymbol("FILTER"); }
+  | T_BA_DEF_DEF       { state->dbc->m_newsymbols.AddSymbol("BA_DEF_DEF_"); }
+  | T_EV_DATA          { state->dbc->m_newsymbols.AddSymbol("EV_DATA_"); }
+  | T_ENVVAR_DATA      { state->dbc->m_newsymbols.AddSymbol("ENVVAR_DATA_"); }
+  | T_SGTYPE           { state->dbc->m_newsymbols.AddSymbol("SG_TYPE_"); }
+  | T_SGTYPE_VAL       { state->dbc->m_newsymbols.AddSymbol("SG_TYPE_VAL_"); }
+  | T_BA_DEF_SGTYPE    { state->dbc->m_newsymbols.AddSymbol("BA_DEF_SGTYPE_"); }
+  | T_BA_SGTYPE        { state->dbc->m_newsymbols.AddSymbol("BA_SGTYPE_"); }
+  | T_SIG_TYPE_REF     { state->dbc->m_newsymbols.AddSymbol("SIG_TYPE_REF_"); }
+  | T_VAL_TABLE        { state->dbc->m_newsymbols.AddSymbol("VAL_TABLE_"); }
+  | T_SIG_GROUP        { state->dbc->m_newsymbols.AddSymbol("SIG_GROUP_"); }
+  | T_SIG_VALTYPE      { state->dbc->m_newsymbols.AddSymbol("SIG_VALTYPE_"); }
+  | T_SIGTYPE_VALTYPE  { state->dbc->m_newsymbols.AddSymbol("SIGTYPE_VALTYPE_"); }
+  | T_BO_TX_BU         { state->dbc->m_newsymbols.AddSymbol("BO_TX_BU_"); }
+  | T_BA_DEF_REL       { state->dbc->m_newsymbols.AddSymbol("BA_DEF_REL_"); }
+  | T_BA_REL           { state->dbc->m_newsymbols.AddSymbol("BA_REL_"); }
+  | T_BA_DEF_DEF_REL   { state->dbc->m_newsymbols.AddSymbol("BA_DEF_DEF_REL_"); }
+  | T_BU_SG_REL        { state->dbc->m_newsymbols.AddSymbol("BU_SG_REL_"); }
+  | T_BU_EV_REL        { state->dbc->m_newsymbols.AddSymbol("BU_EV_REL_"); }
+  | T_BU_BO_REL        { state->dbc->m_newsymbols.AddSymbol("BU_BO_REL_"); }
+  | T_SG_MUL_VAL       { state->dbc->m_newsymbols.AddSymbol("SG_MUL_VAL_"); }
   ;
 
 /************************************************************************/
@@ -257,7 +271,7 @@ bit_timing_section:
   | T_BS T_COLON T_INT_VAL T_COLON T_INT_VAL T_COMMA T_INT_VAL
     {
     ESP_LOGD(TAG,"BS_ parsed %d,%d,%d",(int)$3,(int)$5,(int)$7);
-    current_dbc->m_bittiming.SetBaud($3,$5,$7);
+    state->dbc->m_bittiming.SetBaud($3,$5,$7);
     }
     ;
 
@@ -268,14 +282,14 @@ bit_timing_section:
 node_list_section:
   T_BU T_COLON node_list
   {
-  ESP_LOGD(TAG,"BU_ parsed %d nodes",current_dbc->m_nodes.GetCount());
+  ESP_LOGD(TAG,"BU_ parsed %d nodes",state->dbc->m_nodes.GetCount());
   }
   ;
 
 node_list:
   | node_list T_ID
       {
-      current_dbc->m_nodes.AddNode(new dbcNode($2));
+      state->dbc->m_nodes.AddNode(new dbcNode($2));
       free($2);
       }
     ;
@@ -288,23 +302,23 @@ value_table_section:
     T_VAL_TABLE value_table_list T_SEMICOLON
     {
     ESP_LOGD(TAG,"VAL_TABLE_ parsed %s %d values",
-      current_value_table->GetName().c_str(),
-      current_value_table->GetCount());
+      state->value_table->GetName().c_str(),
+      state->value_table->GetCount());
     }
     ;
 
 value_table_list:
     T_ID T_INT_VAL T_STRING_VAL
     {
-    current_value_table = new dbcValueTable($1);
-    current_dbc->m_values.AddValueTable($1, current_value_table);
-    current_value_table->AddValue($2, $3);
+    state->value_table = new dbcValueTable($1);
+    state->dbc->m_values.AddValueTable($1, state->value_table);
+    state->value_table->AddValue($2, $3);
     free($1); free($3);
     }
   |
     value_table_list T_INT_VAL T_STRING_VAL
     {
-    current_value_table->AddValue($2, $3);
+    state->value_table->AddValue($2, $3);
     free($3);
     }
     ;
@@ -318,11 +332,11 @@ message_section:
     T_BO T_INT_VAL T_ID T_COLON T_INT_VAL T_ID
     {
     ESP_LOGD(TAG,"BO_ parsed message %d",(int)$2);
-    current_message = new dbcMessage((uint32_t)$2);
-    current_message->SetName($3); free($3);
-    current_message->SetSize($5);
-    current_message->SetTransmitterNode($6); free($6);
-    current_dbc->m_messages.AddMessage($2,current_message);
+    state->message = new dbcMessage((uint32_t)$2);
+    state->message->SetName($3); free($3);
+    state->message->SetSize($5);
+    state->message->SetTransmitterNode($6); free($6);
+    state->dbc->m_messages.AddMessage($2,state->message);
     }
     ;
 
@@ -339,29 +353,34 @@ signal_section:
          T_STRING_VAL receiver_list
     {
     ESP_LOGD(TAG,"SG_ parsed signal %s",$2);
-    current_signal->SetName($2); free($2);
+    state->signal->SetName($2); free($2);
 
-    if (current_message == NULL)
+    if (state->message == NULL)
       {
-      yyerror(current_dbc, "SG_ not after a BO_ message");
+      yyerror(scanner, state, "SG_ not after a BO_ message");
       free($21);
-      current_signal = NULL;
+      state->signal = NULL;
       YYABORT;
       }
 
     if ($3 == NULL)
       {
-      current_signal->ClearMultiplexed();
+      state->signal->ClearMultiplexed();
       }
     else
       {
       switch($3[0])
         {
         case 'M':
-          current_message->SetMultiplexorSignal(current_signal);
+          state->message->SetMultiplexorSignal(state->signal);
           break;
         case 'm':
-          current_signal->SetMultiplexed((uint32_t)strtoul($3+1, NULL, 10));
+          {
+          /* mNN: multiplexed, mNNM: multiplexed and (nested) multiplexor */
+          char* end = NULL;
+          state->signal->SetMultiplexed((uint32_t)strtoul($3+1, &end, 10));
+          if (end && *end == 'M') state->signal->SetMultiplexor();
+          }
           break;
         default:
           /* error: unknown mux type */
@@ -370,16 +389,16 @@ signal_section:
        free($3);
        }
 
-    current_signal->SetStartSize($5,$7);
-    current_signal->SetByteOrder((dbcByteOrder_t)$9);
-    current_signal->SetValueType(($10 == 0)?DBC_VALUETYPE_UNSIGNED:DBC_VALUETYPE_SIGNED);
-    current_signal->SetFactorOffset($12,$14);
-    current_signal->SetMinMax($17,$19);
+    state->signal->SetStartSize($5,$7);
+    state->signal->SetByteOrder((dbcByteOrder_t)$9);
+    state->signal->SetValueType(($10 == 0)?DBC_VALUETYPE_UNSIGNED:DBC_VALUETYPE_SIGNED);
+    state->signal->SetFactorOffset($12,$14);
+    state->signal->SetMinMax($17,$19);
 
-    current_signal->SetUnit($21); free($21);
+    state->signal->SetUnit($21); free($21);
 
-    current_message->AddSignal(current_signal);
-    current_signal = NULL;
+    state->message->AddSignal(state->signal);
+    state->signal = NULL;
     }
     ;
 
@@ -418,8 +437,8 @@ receiver_list:
 receiver:
     T_ID
     {
-    if (current_signal == NULL) current_signal = new dbcSignal();
-    current_signal->AddReceiver(std::string($1)); free($1);
+    if (state->signal == NULL) state->signal = new dbcSignal();
+    state->signal->AddReceiver(std::string($1)); free($1);
     }
     ;
 
@@ -435,28 +454,28 @@ value_section:
 value_list:
   | T_VAL T_INT_VAL T_ID T_INT_VAL T_STRING_VAL
     {
-    dbcMessage* m = current_dbc->m_messages.FindMessage((uint32_t)$2);
+    dbcMessage* m = state->dbc->m_messages.FindMessage((uint32_t)$2);
     if (m == NULL)
       {
-      yyerror(current_dbc, "VAL_ message not found");
+      yyerror(scanner, state, "VAL_ message not found");
       free($3); free($5);
       YYABORT;
       }
-    current_signal = m->FindSignal(std::string($3));
-    if (current_signal == NULL)
+    state->signal = m->FindSignal(std::string($3));
+    if (state->signal == NULL)
       {
-      yyerror(current_dbc, "VAL_ signal not found (in message)");
+      yyerror(scanner, state, "VAL_ signal not found (in message)");
       free($3); free($5);
       YYABORT;
       }
     ESP_LOGD(TAG,"VAL_ parsed %d/%s",(int)$2,$3);
-    current_signal->AddValue((uint32_t)$4, std::string($5));
+    state->signal->AddValue((uint32_t)$4, std::string($5));
     free($3); free($5);
     }
   |
    value_list T_INT_VAL T_STRING_VAL
     {
-    current_signal->AddValue((uint32_t)$2, std::string($3));
+    state->signal->AddValue((uint32_t)$2, std::string($3));
     free($3);
     }
     ;
@@ -466,11 +485,32 @@ value_list:
 /************************************************************************/
 
 /* BA_DEF_ BO_ "GenMsgBackgroundColor" STRING ; */
+/* BA_DEF_ SG_ "OvmsDeadband" FLOAT 0 1000 ; */
+/* BA_DEF_ "BusType" STRING ; */
 attribute_section:
-    T_BA_DEF attribute_object_type T_STRING_VAL T_STRING T_SEMICOLON
-  | T_BA_DEF attribute_object_type T_STRING_VAL T_INT T_INT_VAL T_INT_VAL T_SEMICOLON
+    T_BA_DEF attribute_object_type T_STRING_VAL attribute_definition T_SEMICOLON
+    {
+    ESP_LOGD(TAG,"BA_DEF_ parsed %s",$3);
+    if ($3) free($3);
+    }
+    ;
+
+attribute_object_type:
+  | T_BU | T_BO | T_SG | T_EV
+    ;
+
+attribute_definition:
+    T_STRING
+  | T_INT double_val double_val
+  | T_HEX double_val double_val
+  | T_FLOAT double_val double_val
+  | T_ENUM attribute_enum_list
+    ;
 
-attribute_object_type: T_BU | T_BO | T_SG | T_EV
+attribute_enum_list:
+    T_STRING_VAL                              { if ($1) free($1); }
+  | attribute_enum_list T_COMMA T_STRING_VAL  { if ($3) free($3); }
+    ;
 
 /************************************************************************/
 /* attribute_default_section_list (BA_DEF_DEF_)                         */
@@ -478,8 +518,82 @@ attribute_object_type: T_BU | T_BO | T_SG | T_EV
 
 /* BA_DEF_DEF_ "GenMsgBackgroundColor" "#1e1e1e"; */
 attribute_default_section:
-    T_BA_DEF_DEF T_STRING_VAL T_STRING_VAL T_SEMICOLON
-  | T_BA_DEF_DEF T_STRING_VAL T_INT_VAL T_SEMICOLON
+    T_BA_DEF_DEF T_STRING_VAL attribute_value T_SEMICOLON
+    {
+    if ($2) free($2);
+    }
+    ;
+
+/************************************************************************/
+/* attribute_value_section (BA_)                                        */
+/************************************************************************/
+
+/* BA_ "GenMsgCycleTime" BO_ 1160 100; */
+/* BA_ "OvmsDeadband" SG_ 1160 DAS_steeringAngleRequest 0.5; */
+/* Only numeric message and signal attributes are kept, others are skipped */
+attribute_value_section:
+    T_BA T_STRING_VAL attribute_value T_SEMICOLON
+    {
+    if ($2) free($2);
+    }
+  | T_BA T_STRING_VAL T_BU T_ID attribute_value T_SEMICOLON
+    {
+    if ($2) free($2);
+    free($4);
+    }
+  | T_BA T_STRING_VAL T_EV T_ID attribute_value T_SEMICOLON
+    {
+    if ($2) free($2);
+    free($4);
+    }
+  | T_BA T_STRING_VAL T_BO T_INT_VAL attribute_value T_SEMICOLON
+    {
+    dbcMessage* m = state->dbc->m_messages.FindMessage((uint32_t)$4);
+    if (m == NULL)
+      {
+      yyerror(scanner, state, "BA_ BO_ message not found");
+      if ($2) free($2);
+      YYABORT;
+      }
+    if ($2 && !isnan($5))
+      {
+      ESP_LOGD(TAG,"BA_ BO_ parsed %d/%s",(int)$4,$2);
+      m->m_attributes.SetAttribute(std::string($2), dbcNumber($5));
+      }
+    if ($2) free($2);
+    }
+  | T_BA T_STRING_VAL T_SG T_INT_VAL T_ID attribute_value T_SEMICOLON
+    {
+    dbcMessage* m = state->dbc->m_messages.FindMessage((uint32_t)$4);
+    if (m == NULL)
+      {
+      yyerror(scanner, state, "BA_ SG_ message not found");
+      if ($2) free($2);
+      free($5);
+      YYABORT;
+      }
+    dbcSignal* s = m->FindSignal(std::string($5));
+    if (s == NULL)
+      {
+      yyerror(scanner, state, "BA_ SG_ signal not found (in message)");
+      if ($2) free($2);
+      free($5);
+      YYABORT;
+      }
+    if ($2 && !isnan($6))
+      {
+      ESP_LOGD(TAG,"BA_ SG_ parsed %d/%s/%s",(int)$4,$5,$2);
+      s->SetAttribute(std::string($2), dbcNumber($6));
+      }
+    if ($2) free($2);
+    free($5);
+    }
+    ;
+
+attribute_value:
+    double_val      { $$ = $1; }
+  | T_STRING_VAL    { $$ = NAN; if ($1) free($1); }
+    ;
 
 /************************************************************************/
 /* comment_section_list (CM_)                                           */
@@ -490,11 +604,11 @@ comment_section:
     T_CM                     T_STRING_VAL T_SEMICOLON
     {
     ESP_LOGD(TAG,"CM_ parsed %s",$2);
-    current_dbc->m_comments.AddComment($2); free($2);
+    state->dbc->m_comments.AddComment($2); free($2);
     }
   | T_CM T_BU T_ID           T_STRING_VAL T_SEMICOLON
     {
-    dbcNode* n = current_dbc->m_nodes.FindNode(std::string($3));
+    dbcNode* n = state->dbc->m_nodes.FindNode(std::string($3));
     if (n != NULL)
       {
       ESP_LOGD(TAG,"CM_ BU_ parsed %s",$3);
@@ -502,7 +616,7 @@ comment_section:
       }
     else
       {
-      yyerror(current_dbc, "BU_ node not found");
+      yyerror(scanner, state, "BU_ node not found");
       free($3); free($4);
       YYABORT;
       }
@@ -510,7 +624,7 @@ comment_section:
     }
   | T_CM T_BO T_INT_VAL      T_STRING_VAL T_SEMICOLON
     {
-    dbcMessage* m = current_dbc->m_messages.FindMessage((uint32_t)$3);
+    dbcMessage* m = state->dbc->m_messages.FindMessage((uint32_t)$3);
     if (m != NULL)
       {
       ESP_LOGD(TAG,"CM_ BO_ parsed %s",$4);
@@ -518,7 +632,7 @@ comment_section:
       }
     else
       {
-      yyerror(current_dbc, "BO_ message not found");
+      yyerror(scanner, state, "BO_ message not found");
       free($4);
       YYABORT;
       }
@@ -526,7 +640,7 @@ comment_section:
     }
   | T_CM T_SG T_INT_VAL T_ID T_STRING_VAL T_SEMICOLON
     {
-    dbcMessage* m = current_dbc->m_messages.FindMessage((uint32_t)$3);
+    dbcMessage* m = state->dbc->m_messages.FindMessage((uint32_t)$3);
     if (m != NULL)
       {
       dbcSignal* s = m->FindSignal(std::string($4));
@@ -537,14 +651,14 @@ comment_section:
         }
       else
         {
-        yyerror(current_dbc, "BO_ signal not found (in message)");
+        yyerror(scanner, state, "BO_ signal not found (in message)");
         free($4); free($5);
         YYABORT;
         }
       }
     else
       {
-      yyerror(current_dbc, "SG_ message not found");
+      yyerror(scanner, state, "SG_ message not found");
       free($4); free($5);
       YYABORT;
       }
@@ -552,8 +666,63 @@ comment_section:
     }
   | T_CM T_EV T_ID           T_STRING_VAL T_SEMICOLON
     {
-    yyerror(current_dbc, "EV_ not currently supported");
+    yyerror(scanner, state, "EV_ not currently supported");
     free($3); free($4);
     YYABORT;
     }
     ;
+
+/************************************************************************/
+/* mux_value_section (SG_MUL_VAL_)                                      */
+/************************************************************************/
+
+/* SG_MUL_VAL_ 2024 BMS_cellVoltage_12 BMS_cellIndex 12-12, 44-47; */
+mux_value_section:
+    T_SG_MUL_VAL T_INT_VAL T_ID T_ID
+    {
+    state->mux_ranges.clear();
+    }
+    mux_range_list T_SEMICOLON
+    {
+    dbcMessage* m = state->dbc->m_messages.FindMessage((uint32_t)$2);
+    if (m == NULL)
+      {
+      yyerror(scanner, state, "SG_MUL_VAL_ message not found");
+      free($3); free($4);
+      YYABORT;
+      }
+    dbcSignal* s = m->FindSignal(std::string($3));
+    dbcSignal* sw = m->FindSignal(std::string($4));
+    if (s == NULL || sw == NULL)
+      {
+      yyerror(scanner, state, "SG_MUL_VAL_ signal not found (in message)");
+      free($3); free($4);
+      YYABORT;
+      }
+    ESP_LOGD(TAG,"SG_MUL_VAL_ parsed %d/%s/%s",(int)$2,$3,$4);
+    s->SetMultiplexed(sw, state->mux_ranges);
+    sw->SetMultiplexor();
+    m->InvalidateMuxTables();
+    state->mux_ranges.clear();
+    free($3); free($4);
+    }
+    ;
+
+mux_range_list:
+    mux_range
+  | mux_range_list T_COMMA mux_range
+    ;
+
+/* Note: the tokeniser delivers "3-5" as the integers 3 and -5 */
+mux_range:
+    T_INT_VAL T_INT_VAL
+    {
+    dbcMuxRange_t r = { (uint32_t)$1, (uint32_t)(($2 < 0) ? -$2 : $2) };
+    state->mux_ranges.push_back(r);
+    }
+  | T_INT_VAL T_MINUS T_INT_VAL
+    {
+    dbcMuxRange_t r = { (uint32_t)$1, (uint32_t)$3 };
+    state->mux_ranges.push_back(r);
+    }
+    ;
@@ -0,0 +1,551 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Date:          18th October 2026
+;
+;    Changes:
+;    1.0  Initial release
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011       Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+
+#include "ovms_log.h"
+static const char *TAG = "dbc-tx";
+
+#include <string.h>
+#include "dbc_scheduler.h"
+#include "dbc_app.h"
+
+/**
+ * dbcTxScheduler: cyclic transmission of DBC messages
+ *
+ *  Each scheduled message has a shadow frame holding the current signal
+ *  values. The scheduler sends the shadow frames at their cycle times
+ *  (GenMsgCycleTime attribute or explicitly given), optionally updating a
+ *  rolling counter signal and a checksum signal for every frame sent.
+ *
+ *  Timing is done by a one shot esp_timer armed for the next due message,
+ *  so cycle times are not bound to the FreeRTOS tick. The deviation of the
+ *  actual transmission time from the schedule is recorded per message.
+ */
+
+dbcTxScheduler::dbcTxScheduler(dbcfile* dbc, canbus* bus)
+  {
+  m_dbc = dbc;
+  m_bus = bus;
+  m_running = false;
+  m_timer = NULL;
+  m_dbc->LockFile();
+
+  esp_timer_create_args_t args = {};
+  args.callback = TimerCallback;
+  args.arg = this;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "DBC TX";
+  if (esp_timer_create(&args, &m_timer) != ESP_OK)
+    {
+    ESP_LOGE(TAG, "Failed to create timer");
+    m_timer = NULL;
+    }
+  MyDBC.RegisterTxScheduler(this);
+  }
+
+dbcTxScheduler::~dbcTxScheduler()
+  {
+  MyDBC.DeregisterTxScheduler(this);
+  Stop();
+  if (m_timer)
+    {
+    WaitCallback();
+    esp_timer_delete(m_timer);
+    m_timer = NULL;
+    }
+  m_dbc->UnlockFile();
+  }
+
+dbcfile* dbcTxScheduler::GetDBC()
+  {
+  return m_dbc;
+  }
+
+canbus* dbcTxScheduler::GetBus()
+  {
+  return m_bus;
+  }
+
+dbcTxMessage_t* dbcTxScheduler::FindTx(uint32_t id)
+  {
+  for (auto& tx : m_tx)
+    {
+    if (tx.message->GetID() == id)
+      return &tx;
+    }
+  return NULL;
+  }
+
+dbcTxMessage_t* dbcTxScheduler::FindTx(const std::string& name)
+  {
+  for (auto& tx : m_tx)
+    {
+    if (tx.message->GetName() == name)
+      return &tx;
+    }
+  return NULL;
+  }
+
+/**
+ * AddMessage: add a DBC message to the schedule
+ *  cycle: cycle time [ms], 0 = use the GenMsgCycleTime attribute
+ *  Counter & checksum signals are taken from the OvmsTxCounter & OvmsTxChecksum
+ *  signal attributes, the shadow frame is initialized to zero.
+ */
+bool dbcTxScheduler::AddMessage(uint32_t id, uint32_t cycle /*=0*/)
+  {
+  dbcMessage* msg = m_dbc->m_messages.FindMessage(id);
+  if (msg == NULL)
+    {
+    ESP_LOGW(TAG, "AddMessage: message %u not found in %s", id, m_dbc->GetName().c_str());
+    return false;
+    }
+  if (cycle == 0 && msg->m_attributes.HasAttribute(DBC_ATTR_CYCLE_TIME))
+    cycle = msg->m_attributes.GetAttribute(DBC_ATTR_CYCLE_TIME).GetUnsignedInteger();
+  if (cycle == 0)
+    {
+    ESP_LOGW(TAG, "AddMessage: message %s has no cycle time", msg->GetName().c_str());
+    return false;
+    }
+  if (cycle < DBC_TX_MINCYCLE)
+    cycle = DBC_TX_MINCYCLE;
+
+  OvmsMutexLock lock(&m_mutex);
+  dbcTxMessage_t* tx = FindTx(id);
+  if (tx == NULL)
+    {
+    m_tx.emplace_back();
+    tx = &m_tx.back();
+    memset(&tx->frame, 0, sizeof(tx->frame));
+    tx->message = msg;
+    tx->frame.origin = m_bus;
+    tx->frame.FIR.U = 0;
+    tx->frame.FIR.B.DLC = MIN(msg->GetSize(), 8);
+    tx->frame.FIR.B.FF = msg->GetFormat();
+    tx->frame.MsgID = id & 0x1FFFFFFF;
+    tx->counter = NULL;
+    tx->counterval = 0;
+    tx->checksum = NULL;
+    tx->checksumtype = DBC_CHECKSUM_NONE;
+    for (dbcSignal* sig : msg->m_signals)
+      {
+      if (sig->m_attributes.HasAttribute(DBC_ATTR_TX_COUNTER) &&
+          sig->m_attributes.GetAttribute(DBC_ATTR_TX_COUNTER).GetUnsignedInteger() != 0)
+        tx->counter = sig;
+      if (sig->m_attributes.HasAttribute(DBC_ATTR_TX_CHECKSUM))
+        {
+        uint32_t type = sig->m_attributes.GetAttribute(DBC_ATTR_TX_CHECKSUM).GetUnsignedInteger();
+        if (type > DBC_CHECKSUM_NONE && type <= DBC_CHECKSUM_CRC8_SAEJ1850)
+          {
+          tx->checksum = sig;
+          tx->checksumtype = (dbcChecksumType_t) type;
+          }
+        }
+      }
+    }
+  tx->cycle = cycle;
+  tx->enabled = true;
+  tx->due = esp_timer_get_time();
+  tx->sent = tx->errors = tx->late = 0;
+  tx->jitter_min = tx->jitter_max = 0;
+  tx->jitter_sum = 0;
+
+  if (m_running)
+    ScheduleNext(esp_timer_get_time());
+  return true;
+  }
+
+bool dbcTxScheduler::AddMessage(const std::string& name, uint32_t cycle /*=0*/)
+  {
+  for (auto& it : m_dbc->m_messages.m_entrymap)
+    {
+    if (it.second->GetName() == name)
+      return AddMessage(it.first, cycle);
+    }
+  return false;
+  }
+
+/**
+ * AddAllMessages: schedule all messages having a GenMsgCycleTime
+ */
+void dbcTxScheduler::AddAllMessages()
+  {
+  for (auto& it : m_dbc->m_messages.m_entrymap)
+    {
+    dbcMessage* msg = it.second;
+    if (msg->m_attributes.HasAttribute(DBC_ATTR_CYCLE_TIME) &&
+        msg->m_attributes.GetAttribute(DBC_ATTR_CYCLE_TIME).GetUnsignedInteger() > 0)
+      AddMessage(it.first);
+    }
+  }
+
+bool dbcTxScheduler::RemoveMessage(uint32_t id)
+  {
+  OvmsMutexLock lock(&m_mutex);
+  for (auto it = m_tx.begin(); it != m_tx.end(); ++it)
+    {
+    if (it->message->GetID() == id)
+      {
+      m_tx.erase(it);
+      if (m_running)
+        ScheduleNext(esp_timer_get_time());
+      return true;
+      }
+    }
+  return false;
+  }
+
+bool dbcTxScheduler::EnableMessage(uint32_t id, bool enable /*=true*/)
+  {
+  OvmsMutexLock lock(&m_mutex);
+  dbcTxMessage_t* tx = FindTx(id);
+  if (tx == NULL)
+    return false;
+  if (enable && !tx->enabled)
+    tx->due = esp_timer_get_time();
+  tx->enabled = enable;
+  if (m_running)
+    ScheduleNext(esp_timer_get_time());
+  return true;
+  }
+
+bool dbcTxScheduler::SetCounter(uint32_t id, const std::string& signal)
+  {
+  OvmsMutexLock lock(&m_mutex);
+  dbcTxMessage_t* tx = FindTx(id);
+  if (tx == NULL)
+    return false;
+  if (signal.empty())
+    {
+    tx->counter = NULL;
+    return true;
+    }
+  dbcSignal* sig = tx->message->FindSignal(signal);
+  if (sig == NULL)
+    return false;
+  tx->counter = sig;
+  tx->counterval = 0;
+  return true;
+  }
+
+bool dbcTxScheduler::SetChecksum(uint32_t id, const std::string& signal, dbcChecksumType_t type)
+  {
+  OvmsMutexLock lock(&m_mutex);
+  dbcTxMessage_t* tx = FindTx(id);
+  if (tx == NULL)
+    return false;
+  if (signal.empty() || type == DBC_CHECKSUM_NONE)
+    {
+    tx->checksum = NULL;
+    tx->checksumtype = DBC_CHECKSUM_NONE;
+    return true;
+    }
+  dbcSignal* sig = tx->message->FindSignal(signal);
+  if (sig == NULL)
+    return false;
+  tx->checksum = sig;
+  tx->checksumtype = type;
+  return true;
+  }
+
+/**
+ * SetSignal: update a signal value in the shadow buffer
+ *  The value is sent with the next scheduled transmission of the message.
+ */
+bool dbcTxScheduler::SetSignal(uint32_t id, const std::string& signal, dbcNumber value)
+  {
+  OvmsMutexLock lock(&m_mutex);
+  dbcTxMessage_t* tx = FindTx(id);
+  if (tx == NULL)
+    return false;
+  dbcSignal* sig = tx->message->FindSignal(signal);
+  if (sig == NULL)
+    return false;
+  sig->Encode(&value, &tx->frame);
+  return true;
+  }
+
+bool dbcTxScheduler::SetSignal(const std::string& message, const std::string& signal, dbcNumber value)
+  {
+  OvmsMutexLock lock(&m_mutex);
+  dbcTxMessage_t* tx = FindTx(message);
+  if (tx == NULL)
+    return false;
+  dbcSignal* sig = tx->message->FindSignal(signal);
+  if (sig == NULL)
+    return false;
+  sig->Encode(&value, &tx->frame);
+  return true;
+  }
+
+/**
+ * SetData: replace the shadow buffer payload
+ */
+bool dbcTxScheduler::SetData(uint32_t id, const uint8_t* data, int length)
+  {
+  OvmsMutexLock lock(&m_mutex);
+  dbcTxMessage_t* tx = FindTx(id);
+  if (tx == NULL)
+    return false;
+  memcpy(tx->frame.data.u8, data, MIN(length, 8));
+  return true;
+  }
+
+void dbcTxScheduler::Start()
+  {
+  OvmsMutexLock lock(&m_mutex);
+  if (m_running || m_timer == NULL)
+    return;
+  int64_t now = esp_timer_get_time();
+  for (auto& tx : m_tx)
+    tx.due = now;
+  m_running = true;
+  ScheduleNext(now);
+  ESP_LOGI(TAG, "Started %s on %s: %d message(s)", m_dbc->GetName().c_str(), m_bus->GetName(), m_tx.size());
+  }
+
+void dbcTxScheduler::Stop()
+  {
+  OvmsMutexLock lock(&m_mutex);
+  if (!m_running)
+    return;
+  m_running = false;
+  esp_timer_stop(m_timer);
+  ESP_LOGI(TAG, "Stopped %s on %s", m_dbc->GetName().c_str(), m_bus->GetName());
+  }
+
+bool dbcTxScheduler::IsRunning()
+  {
+  return m_running;
+  }
+
+void dbcTxScheduler::ResetStats()
+  {
+  OvmsMutexLock lock(&m_mutex);
+  for (auto& tx : m_tx)
+    {
+    tx.sent = tx.errors = tx.late = 0;
+    tx.jitter_min = tx.jitter_max = 0;
+    tx.jitter_sum = 0;
+    }
+  }
+
+void dbcTxScheduler::TimerCallback(void* arg)
+  {
+  dbcTxScheduler* me = (dbcTxScheduler*) arg;
+  me->Transmit();
+  }
+
+void dbcTxScheduler::FenceCallback(void* arg)
+  {
+  OvmsSemaphore* done = (OvmsSemaphore*) arg;
+  done->Give();
+  }
+
+/**
+ * WaitCallback: wait for a Transmit() callback in progress to finish
+ *  The timer may have fired just before Stop(), with the callback not yet
+ *  holding the mutex. esp_timer callbacks are executed one after the other
+ *  by the esp_timer task, so once a fence timer started after Stop() has
+ *  fired, no Transmit() call can be running or pending anymore.
+ */
+void dbcTxScheduler::WaitCallback()
+  {
+  OvmsSemaphore done;
+  esp_timer_handle_t fence;
+  esp_timer_create_args_t args = {};
+  args.callback = FenceCallback;
+  args.arg = &done;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "DBC TX fence";
+  if (esp_timer_create(&args, &fence) != ESP_OK)
+    {
+    ESP_LOGE(TAG, "Failed to create fence timer");
+    return;
+    }
+  esp_timer_start_once(fence, 0);
+  done.Take();
+  esp_timer_delete(fence);
+  }
+
+/**
+ * ScheduleNext: arm the timer for the next due message (mutex held)
+ */
+void dbcTxScheduler::ScheduleNext(int64_t now)
+  {
+  int64_t next = INT64_MAX;
+  for (auto& tx : m_tx)
+    {
+    if (tx.enabled && tx.due < next)
+      next = tx.due;
+    }
+  esp_timer_stop(m_timer);
+  if (next == INT64_MAX)
+    return;
+  int64_t delay = next - now;
+  if (delay < 50)
+    delay = 50;
+  esp_timer_start_once(m_timer, delay);
+  }
+
+/**
+ * PrepareFrame: copy the shadow buffer and apply counter & checksum (mutex held)
+ */
+void dbcTxScheduler::PrepareFrame(dbcTxMessage_t& tx, CAN_frame_t& frame)
+  {
+  if (tx.counter)
+    tx.counter->EncodeRaw(tx.counterval, &tx.frame);
+  frame = tx.frame;
+
+  if (tx.checksum)
+    {
+    // The checksum is calculated over the payload with the checksum field
+    // cleared. A byte aligned 8 bit checksum field is excluded from the calculation.
+    uint8_t data[8];
+    int len = frame.FIR.B.DLC;
+    tx.checksum->EncodeRaw(0, &frame);
+    int start = tx.checksum->GetStartBit();
+    int skip = -1;
+    if (tx.checksum->GetSignalSize() == 8 &&
+        (tx.checksum->GetByteOrder() == DBC_BYTEORDER_BIG_ENDIAN ? (start % 8) == 7 : (start % 8) == 0))
+      skip = start / 8;
+    int n = 0;
+    for (int k=0; k<len; k++)
+      {
+      if (k != skip)
+        data[n++] = frame.data.u8[k];
+      }
+    uint8_t sum = (tx.checksumtype == DBC_CHECKSUM_XOR)
+      ? ChecksumXOR(data, n)
+      : ChecksumCRC8SAEJ1850(data, n);
+    tx.checksum->EncodeRaw(sum, &frame);
+    }
+  }
+
+/**
+ * Transmit: timer callback, send all messages due
+ */
+void dbcTxScheduler::Transmit()
+  {
+  OvmsMutexLock lock(&m_mutex);
+  if (!m_running)
+    return;
+
+  CAN_frame_t frame;
+  int64_t now = esp_timer_get_time();
+  for (auto& tx : m_tx)
+    {
+    if (!tx.enabled || tx.due > now + DBC_TX_AHEAD)
+      continue;
+
+    PrepareFrame(tx, frame);
+    int64_t sendtime = esp_timer_get_time();
+    if (m_bus->Write(&frame, 0) == ESP_OK)
+      {
+      int32_t jitter = (int32_t)(sendtime - tx.due);
+      if (tx.sent == 0 || jitter < tx.jitter_min) tx.jitter_min = jitter;
+      if (tx.sent == 0 || jitter > tx.jitter_max) tx.jitter_max = jitter;
+      tx.jitter_sum += jitter;
+      tx.sent++;
+      tx.counterval++;
+      }
+    else
+      {
+      tx.errors++;
+      }
+
+    // Keep the phase; skip cycles missed completely:
+    int64_t period = (int64_t)tx.cycle * 1000;
+    tx.due += period;
+    if (tx.due <= sendtime)
+      {
+      int64_t missed = (sendtime - tx.due) / period + 1;
+      tx.late += missed;
+      tx.due += missed * period;
+      }
+    }
+
+  ScheduleNext(esp_timer_get_time());
+  }
+
+void dbcTxScheduler::Status(int verbosity, OvmsWriter* writer)
+  {
+  OvmsMutexLock lock(&m_mutex);
+  writer->printf("%s on %s: %s, %d message(s)\n",
+    m_dbc->GetName().c_str(), m_bus->GetName(), m_running ? "running" : "stopped", m_tx.size());
+  if (m_tx.empty())
+    return;
+  writer->printf("  %-24s %8s %7s %8s %6s %6s %9s %9s %9s\n",
+    "Message", "ID", "Cycle", "Sent", "Errors", "Late", "Jit.min", "Jit.avg", "Jit.max");
+  for (auto& tx : m_tx)
+    {
+    writer->printf("  %-24.24s %8x %5ums %8u %6u %6u %7dus %7dus %7dus%s\n",
+      tx.message->GetName().c_str(), tx.frame.MsgID, tx.cycle,
+      tx.sent, tx.errors, tx.late,
+      tx.jitter_min, tx.sent ? (int32_t)(tx.jitter_sum / tx.sent) : 0, tx.jitter_max,
+      tx.enabled ? "" : " (disabled)");
+    if (verbosity >= COMMAND_RESULT_NORMAL)
+      {
+      if (tx.counter)
+        writer->printf("    counter: %s\n", tx.counter->GetName().c_str());
+      if (tx.checksum)
+        writer->printf("    checksum: %s (%s)\n", tx.checksum->GetName().c_str(),
+          (tx.checksumtype == DBC_CHECKSUM_XOR) ? "XOR" : "CRC8 SAE J1850");
+      }
+    }
+  }
+
+uint8_t dbcTxScheduler::ChecksumXOR(const uint8_t* data, int length)
+  {
+  uint8_t sum = 0;
+  for (int k=0; k<length; k++)
+    sum ^= data[k];
+  return sum;
+  }
+
+/**
+ * ChecksumCRC8SAEJ1850: CRC8 polynomial 0x1D, initial value 0xFF, final XOR 0xFF
+ */
+uint8_t dbcTxScheduler::ChecksumCRC8SAEJ1850(const uint8_t* data, int length)
+  {
+  uint8_t crc = 0xFF;
+  for (int k=0; k<length; k++)
+    {
+    crc ^= data[k];
+    for (int bit=0; bit<8; bit++)
+      {
+      if (crc & 0x80)
+        crc = (crc << 1) ^ 0x1D;
+      else
+        crc <<= 1;
+      }
+    }
+  return crc ^ 0xFF;
+  }
@@ -0,0 +1,127 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Date:          18th October 2026
+;
+;    Changes:
+;    1.0  Initial release
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011       Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+
+#ifndef __DBC_SCHEDULER_H__
+#define __DBC_SCHEDULER_H__
+
+#include <string>
+#include <vector>
+#include "esp_timer.h"
+#include "dbc.h"
+#include "can.h"
+#include "ovms_mutex.h"
+#include "ovms_semaphore.h"
+#include "ovms_command.h"
+
+#define DBC_TX_MINCYCLE           5           // Minimum cycle time [ms]
+#define DBC_TX_AHEAD              200         // Send frames due within this time [us]
+
+typedef enum
+  {
+  DBC_CHECKSUM_NONE = 0,
+  DBC_CHECKSUM_XOR,                           // XOR of all other payload bytes
+  DBC_CHECKSUM_CRC8_SAEJ1850                  // CRC8 poly 0x1D, init 0xFF, final XOR 0xFF
+  } dbcChecksumType_t;
+
+struct dbcTxMessage_t
+  {
+  dbcMessage* message;
+  CAN_frame_t frame;                          // Shadow buffer
+  uint32_t cycle;                             // Cycle time [ms]
+  int64_t due;                                // Next transmission time [us]
+  bool enabled;
+  dbcSignal* counter;                         // Rolling counter signal, NULL=none
+  uint32_t counterval;
+  dbcSignal* checksum;                        // Checksum signal, NULL=none
+  dbcChecksumType_t checksumtype;
+  // Statistics:
+  uint32_t sent;
+  uint32_t errors;                            // Transmission queue full
+  uint32_t late;                              // Cycles skipped due to overload
+  int32_t jitter_min;                         // Transmission time deviation [us]
+  int32_t jitter_max;
+  int64_t jitter_sum;
+  };
+typedef std::vector<dbcTxMessage_t> dbcTxMessageList_t;
+
+class dbcTxScheduler
+  {
+  public:
+    dbcTxScheduler(dbcfile* dbc, canbus* bus);
+    ~dbcTxScheduler();
+
+  public:
+    bool AddMessage(uint32_t id, uint32_t cycle=0);
+    bool AddMessage(const std::string& name, uint32_t cycle=0);
+    void AddAllMessages();
+    bool RemoveMessage(uint32_t id);
+    bool EnableMessage(uint32_t id, bool enable=true);
+    bool SetCounter(uint32_t id, const std::string& signal);
+    bool SetChecksum(uint32_t id, const std::string& signal, dbcChecksumType_t type);
+
+  public:
+    bool SetSignal(uint32_t id, const std::string& signal, dbcNumber value);
+    bool SetSignal(const std::string& message, const std::string& signal, dbcNumber value);
+    bool SetData(uint32_t id, const uint8_t* data, int length);
+
+  public:
+    void Start();
+    void Stop();
+    bool IsRunning();
+    void ResetStats();
+    void Status(int verbosity, OvmsWriter* writer);
+    dbcfile* GetDBC();
+    canbus* GetBus();
+
+  public:
+    static uint8_t ChecksumXOR(const uint8_t* data, int length);
+    static uint8_t ChecksumCRC8SAEJ1850(const uint8_t* data, int length);
+
+  protected:
+    static void TimerCallback(void* arg);
+    static void FenceCallback(void* arg);
+    void WaitCallback();
+    void Transmit();
+    void PrepareFrame(dbcTxMessage_t& tx, CAN_frame_t& frame);
+    void ScheduleNext(int64_t now);
+    dbcTxMessage_t* FindTx(uint32_t id);
+    dbcTxMessage_t* FindTx(const std::string& name);
+
+  protected:
+    OvmsMutex m_mutex;
+    dbcfile* m_dbc;
+    canbus* m_bus;
+    dbcTxMessageList_t m_tx;
+    esp_timer_handle_t m_timer;
+    bool m_running;
+  };
+
+#endif //#ifndef __DBC_SCHEDULER_H__
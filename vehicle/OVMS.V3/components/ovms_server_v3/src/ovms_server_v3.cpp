@@ -201,6 +201,8 @@ OvmsServerV3::OvmsServerV3(const char* name)
   m_updatetime_on = m_updatetime_idle;
   m_updatetime_charging = m_updatetime_idle;
   m_updatetime_sendall = 0;
+  m_metrics_delta = false;
+  m_metrics_delta_sync = false;
   m_notify_info_pending = false;
   m_notify_error_pending = false;
   m_notify_alert_pending = false;
@@ -214,7 +216,7 @@ OvmsServerV3::OvmsServerV3(const char* name)
   #undef bind  // Kludgy, but works
   using std::placeholders::_1;
   using std::placeholders::_2;
-  MyMetrics.RegisterListener(TAG, "*", std::bind(&OvmsServerV3::MetricModified, this, _1));
+  MyMetrics.RegisterBatchListener(TAG, std::bind(&OvmsServerV3::MetricsModified, this, _1));
 
   if (MyOvmsServerV3Reader == 0)
     {
@@ -269,7 +271,29 @@ void OvmsServerV3::TransmitAllMetrics()
     metric->ClearModified(MyOvmsServerV3Modifier);
     if (!metric->AsString().empty())
       {
-      TransmitMetric(metric);
+      TransmitMetric(metric, true);
+      }
+    metric = metric->m_next;
+    }
+  }
+
+/**
+ * TransmitDeltaKeyframes: publish keyframes for all delta encoded metrics
+ *  (new client sync, see TransmitMetric())
+ */
+void OvmsServerV3::TransmitDeltaKeyframes()
+  {
+  OvmsMutexLock mg(&m_mgconn_mutex);
+  if (!m_mgconn)
+    return;
+
+  OvmsMetric* metric = MyMetrics.m_first;
+  while (metric != NULL)
+    {
+    if (OvmsMetricDeltaEncoder::GetScale(metric) && !metric->AsString().empty())
+      {
+      metric->ClearModified(MyOvmsServerV3Modifier);
+      TransmitMetric(metric, true);
       }
     metric = metric->m_next;
     }
@@ -292,7 +316,21 @@ void OvmsServerV3::TransmitModifiedMetrics()
     }
   }
 
-void OvmsServerV3::TransmitMetric(OvmsMetric* metric)
+/**
+ * TransmitMetric: publish metric value
+ *  - keyframe: true = full update (delta encoding: send keyframe)
+ *
+ * With delta encoding enabled (server.v3 metrics.delta), vector metrics supported
+ * by the encoder (see metrics_delta.h) are published as frames to the sub topic
+ * "<metric topic>/delta" instead. Keyframes are retained, but the deltas following
+ * a retained keyframe are not, so a new subscriber will drop the deltas up to the
+ * next keyframe. To avoid that wait, a new client announcing itself on
+ * "client/<id>/active" triggers fresh keyframes (see TransmitDeltaKeyframes()).
+ * On keyframes, the full value is also published to the metric topic for clients
+ * not supporting the delta encoding. Note: the plain (retained) metric topic then
+ * only updates on keyframes, i.e. at most every metrics.delta.keyframe changes.
+ */
+void OvmsServerV3::TransmitMetric(OvmsMetric* metric, bool keyframe /*=false*/)
   {
   std::string topic(m_topic_prefix);
   topic.append("metric/");
@@ -305,6 +343,19 @@ void OvmsServerV3::TransmitMetric(OvmsMetric* metric)
         topic[i] = '/';
     }
 
+  if (m_metrics_delta && OvmsMetricDeltaEncoder::GetScale(metric))
+    {
+    std::string frame;
+    if (!m_metrics_delta_enc.Encode(metric, frame, keyframe, &keyframe))
+      return; // no change at the encoding resolution
+    std::string dtopic = topic + "/delta";
+    mg_mqtt_publish(m_mgconn, dtopic.c_str(), m_msgid++,
+      keyframe ? (MG_MQTT_QOS(0) | MG_MQTT_RETAIN) : MG_MQTT_QOS(0), frame.c_str(), frame.length());
+    ESP_LOGI(TAG,"Tx metric %s=%s",dtopic.c_str(),frame.c_str());
+    if (!keyframe)
+      return;
+    }
+
   std::string val = metric->AsString();
 
   mg_mqtt_publish(m_mgconn, topic.c_str(), m_msgid++,
@@ -564,6 +615,9 @@ void OvmsServerV3::AddClient(std::string id)
     // Create a new client
     m_clients[id] = monotonictime + 120;
     ESP_LOGI(TAG,"MQTT client %s has connected",id.c_str());
+    // Let it sync to the delta encoded metrics (see TransmitMetric):
+    if (m_metrics_delta)
+      m_metrics_delta_sync = true;
     }
   else
     {
@@ -743,7 +797,12 @@ void OvmsServerV3::SetStatus(const char* status, bool fault /*=false*/, State ne
     }
   }
 
-void OvmsServerV3::MetricModified(OvmsMetric* metric)
+/**
+ * MetricsModified: batch listener, see MetricBatch
+ *  Streams the metrics modified by a batch (e.g. a CAN frame or poll reply) under a
+ *  single connection lock. Unbatched modifications are passed one by one.
+ */
+void OvmsServerV3::MetricsModified(const MetricList& metrics)
   {
   if (!StandardMetrics.ms_s_v3_connected->AsBool()) return;
 
@@ -752,8 +811,11 @@ void OvmsServerV3::MetricModified(OvmsMetric* metric)
     OvmsMutexLock mg(&m_mgconn_mutex);
     if (!m_mgconn)
       return;
-    metric->ClearModified(MyOvmsServerV3Modifier);
-    TransmitMetric(metric);
+    for (OvmsMetric* metric : metrics)
+      {
+      metric->ClearModified(MyOvmsServerV3Modifier);
+      TransmitMetric(metric);
+      }
     }
   }
 
@@ -823,6 +885,10 @@ void OvmsServerV3::ConfigChanged(OvmsConfigParam* param)
   m_updatetime_on = MyConfig.GetParamValueInt("server.v3", "updatetime.on", m_updatetime_idle);
   m_updatetime_charging = MyConfig.GetParamValueInt("server.v3", "updatetime.charging", m_updatetime_idle);
   m_updatetime_sendall = MyConfig.GetParamValueInt("server.v3", "updatetime.sendall", 0);
+  // metrics.delta: the plain metric topics of delta encoded metrics only update on
+  //  keyframes (every metrics.delta.keyframe frames), see TransmitMetric()
+  m_metrics_delta = MyConfig.GetParamValueBool("server.v3", "metrics.delta", false);
+  m_metrics_delta_enc.SetKeyframe(MyConfig.GetParamValueInt("server.v3", "metrics.delta.keyframe", 20));
   }
 
 void OvmsServerV3::NetUp(std::string event, void* data)
@@ -903,6 +969,13 @@ void OvmsServerV3::Ticker1(std::string event, void* data)
       TransmitAllMetrics();
       m_lasttx_sendall = now;
       m_sendall = false;
+      m_metrics_delta_sync = false;
+      }
+    else if (m_metrics_delta_sync)
+      {
+      ESP_LOGI(TAG, "Transmit delta keyframes");
+      TransmitDeltaKeyframes();
+      m_metrics_delta_sync = false;
       }
 
     if (m_notify_info_pending) TransmitPendingNotificationsInfo();
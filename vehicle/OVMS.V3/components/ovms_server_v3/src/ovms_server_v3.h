@@ -36,6 +36,7 @@
 #include "ovms_server.h"
 #include "ovms_netmanager.h"
 #include "ovms_metrics.h"
+#include "metrics_delta.h"
 #include "ovms_notify.h"
 #include "ovms_config.h"
 #include "ovms_mutex.h"
@@ -51,7 +52,7 @@ class OvmsServerV3 : public OvmsServer
     ~OvmsServerV3();
 
   public:
-    void MetricModified(OvmsMetric* metric);
+    void MetricsModified(const MetricList& metrics);
     bool NotificationFilter(OvmsNotifyType* type, const char* subtype);
     bool IncomingNotification(OvmsNotifyType* type, OvmsNotifyEntry* entry);
     void EventListener(std::string event, void* data);
@@ -106,6 +107,9 @@ class OvmsServerV3 : public OvmsServer
     int m_updatetime_on;
     int m_updatetime_charging;
     int m_updatetime_sendall;
+    bool m_metrics_delta;
+    OvmsMetricDeltaEncoder m_metrics_delta_enc;
+    bool m_metrics_delta_sync;
 
     bool m_notify_info_pending;
     bool m_notify_error_pending;
@@ -122,6 +126,7 @@ class OvmsServerV3 : public OvmsServer
     void Disconnect();
     void TransmitAllMetrics();
     void TransmitModifiedMetrics();
+    void TransmitDeltaKeyframes();
     int TransmitNotificationInfo(OvmsNotifyEntry* entry);
     int TransmitNotificationError(OvmsNotifyEntry* entry);
     int TransmitNotificationAlert(OvmsNotifyEntry* entry);
@@ -139,7 +144,7 @@ class OvmsServerV3 : public OvmsServer
     void CountClients();
 
   private:
-    void TransmitMetric(OvmsMetric* metric);
+    void TransmitMetric(OvmsMetric* metric, bool keyframe=false);
   };
 
 class OvmsServerV3Init
@@ -336,6 +336,38 @@ var ws, ws_inhibit = 0;
 var metrics = {};
 var shellhist = [""], shellhpos = 0;
 var loghist = [];
+var metrics_delta = {};
+var metrics_delta_resync = false;
+
+// Decode delta encoded vector metrics in a metrics update (see metrics_delta.h):
+//  keyframe {"q":<seq>,"s":<scale>,"k":[<values>]}
+//  delta    {"q":<seq>,"s":<scale>,"d":[<index>,<value>,...]}
+// Frames are replaced by the decoded value arrays, deltas out of sequence are
+// dropped and a re-sync is requested (the server restarts with keyframes).
+function decodeMetricsDelta(update) {
+  for (var name in update) {
+    var frame = update[name], st = metrics_delta[name];
+    if (frame == null || frame.q === undefined) continue;
+    if (frame.k) {
+      st = metrics_delta[name] = { q: frame.q, v: frame.k.slice() };
+      metrics_delta_resync = false;
+    } else if (st && frame.q == st.q + 1) {
+      for (var i = 0; i+1 < frame.d.length; i += 2)
+        st.v[frame.d[i]] = frame.d[i+1];
+      st.q = frame.q;
+    } else {
+      delete metrics_delta[name];
+      delete update[name];
+      if (!metrics_delta_resync && ws && ws.readyState == WebSocket.OPEN) {
+        metrics_delta_resync = true;
+        ws.send("metrics.delta on");
+      }
+      continue;
+    }
+    update[name] = st.v.map(function(x) { return x / frame.s; });
+  }
+  return update;
+}
 const loghist_maxsize = 100;
 
 function initSocketConnection(){
@@ -346,6 +378,9 @@ function initSocketConnection(){
   }
   ws.onopen = function(ev) {
     console.log("WebSocket OPENED", ev);
+    metrics_delta = {};
+    metrics_delta_resync = false;
+    ws.send("metrics.delta on");
     $(".receiver").subscribe();
   };
   ws.onerror = function(ev) { console.log("WebSocket ERROR", ev); };
@@ -372,7 +407,7 @@ function initSocketConnection(){
         });
       }
       else if (msgtype == "metrics") {
-        $.extend(metrics, msg.metrics);
+        $.extend(metrics, decodeMetricsDelta(msg.metrics));
         $(".receiver").trigger("msg:metrics", msg.metrics);
       }
       else if (msgtype == "notify") {
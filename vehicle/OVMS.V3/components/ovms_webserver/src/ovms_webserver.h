@@ -44,6 +44,7 @@
 
 #include "ovms_events.h"
 #include "ovms_metrics.h"
+#include "metrics_delta.h"
 #include "ovms_config.h"
 #include "ovms_notify.h"
 #include "ovms_command.h"
@@ -422,6 +423,8 @@ class WebSocketHandler : public MgHandler, public OvmsWriter
     int                       m_sent = 0;
     int                       m_ack = 0;
     std::set<std::string>     m_subscriptions;
+    bool                      m_metrics_delta = false; // true = send vector metrics delta encoded
+    OvmsMetricDeltaEncoder    m_metrics_delta_enc;    // delta encoder state for this client
 };
 
 struct WebSocketSlot
@@ -538,6 +541,7 @@ class OvmsWebServer : public ExternalRamAllocated
     static void HandleShell(PageEntry_t& p, PageContext_t& c);
     static void HandleDashboard(PageEntry_t& p, PageContext_t& c);
     static void HandleBmsCellMonitor(PageEntry_t& p, PageContext_t& c);
+    static void HandleBmsHistory(PageEntry_t& p, PageContext_t& c);
     static void HandleCfgBrakelight(PageEntry_t& p, PageContext_t& c);
     static void HandleEditor(PageEntry_t& p, PageContext_t& c);
     static void HandleCfgPassword(PageEntry_t& p, PageContext_t& c);
@@ -72,6 +72,8 @@ WebSocketHandler::WebSocketHandler(mg_connection* nc, size_t slot, size_t modifi
   m_jobqueue_overflow_dropcntref = 0;
   m_job.type = WSTX_None;
   m_sent = m_ack = 0;
+  m_metrics_delta = MyConfig.GetParamValueBool("http.server", "ws.metrics.delta", false);
+  m_metrics_delta_enc.SetKeyframe(MyConfig.GetParamValueInt("http.server", "ws.metrics.delta.keyframe", 50));
   
   // Register as logging console:
   SetMonitoring(true);
@@ -127,16 +129,24 @@ void WebSocketHandler::ProcessTxJob()
       for (i=0, m=MyMetrics.m_first; i < m_sent && m != NULL; m=m->m_next, i++);
       
       // build msg:
-      std::string msg;
+      //  vector metrics supported by the delta encoder are sent as keyframe/delta
+      //  objects (see metrics_delta.h), these are decoded by the web UI (ovms.js)
+      std::string msg, frame;
       msg.reserve(2*XFER_CHUNK_SIZE+128);
       msg = "{\"metrics\":{";
       for (i=0; m && msg.size() < XFER_CHUNK_SIZE; m=m->m_next) {
         if (m->IsModifiedAndClear(m_modifier) || m_job.type == WSTX_MetricsAll) {
+          if (m_metrics_delta && OvmsMetricDeltaEncoder::GetScale(m)) {
+            if (!m_metrics_delta_enc.Encode(m, frame, m_job.type == WSTX_MetricsAll))
+              continue; // no change at the encoding resolution
+          } else {
+            frame = m->AsJSON();
+          }
           if (i) msg += ',';
           msg += '\"';
           msg += m->m_name;
           msg += "\":";
-          msg += m->AsJSON();
+          msg += frame;
           i++;
         }
       }
@@ -401,6 +411,14 @@ void WebSocketHandler::HandleIncomingMsg(std::string msg)
       if (!arg.empty()) Unsubscribe(arg);
     }
   }
+  else if (cmd == "metrics.delta") {
+    // client opt-in/out for delta encoded vector metrics (see metrics_delta.h);
+    // restart the encoding, so the next frame of each metric is a keyframe (also
+    // used by the web UI to re-sync after a sequence gap):
+    input >> arg;
+    m_metrics_delta = (arg == "on");
+    m_metrics_delta_enc.Reset();
+  }
   else {
     ESP_LOGW(TAG, "WebSocketHandler[%p]: unhandled message: '%s'", m_nc, msg.c_str());
   }
@@ -1245,6 +1245,56 @@ void OvmsWebServer::HandleBmsCellMonitor(PageEntry_t& p, PageContext_t& c)
   c.done();
 }
 
+/**
+ * HandleBmsHistory: BMS cell history export API
+ *
+ * Parameters:
+ *   level=raw|1m|10m     Resolution (default: 1m)
+ *   format=csv|bin       Output format (default: csv), see OvmsVehicle::BmsHistoryExport()
+ *   records=<n>          Newest n records only (default: all)
+ */
+void OvmsWebServer::HandleBmsHistory(PageEntry_t& p, PageContext_t& c)
+{
+  OvmsVehicle* vehicle = MyVehicleFactory.ActiveVehicle();
+  OvmsVehicle::bms_history_level_t level = OvmsVehicle::BmsHistory_1Min;
+  std::string arg = c.getvar("level");
+  bool binary = (c.getvar("format") == "bin");
+  int maxrecords = atoi(c.getvar("records").c_str());
+
+  if (!vehicle) {
+    c.head(404, "Content-Type: text/plain; charset=utf-8\r\nCache-Control: no-cache");
+    c.print("ERROR: no vehicle module selected\n");
+    c.done();
+    return;
+  }
+  if (!arg.empty() && !OvmsVehicle::BmsHistoryLevel(arg, level)) {
+    c.head(400, "Content-Type: text/plain; charset=utf-8\r\nCache-Control: no-cache");
+    c.print("ERROR: invalid level, valid: raw, 1m, 10m\n");
+    c.done();
+    return;
+  }
+
+  std::string* out = new std::string();
+  if (!vehicle->BmsHistoryExport(*out, level, binary, maxrecords)) {
+    delete out;
+    c.head(404, "Content-Type: text/plain; charset=utf-8\r\nCache-Control: no-cache");
+    c.print("ERROR: BMS history not available\n");
+    c.done();
+    return;
+  }
+
+  const char* levelname[] = { "raw", "1m", "10m" };
+  char headers[200];
+  snprintf(headers, sizeof(headers),
+    "Content-Type: %s\r\n"
+    "Content-Disposition: attachment; filename=\"bms-history-%s.%s\"\r\n"
+    "Cache-Control: no-cache",
+    binary ? "application/octet-stream" : "text/csv; charset=utf-8",
+    levelname[level], binary ? "bin" : "csv");
+  c.head(200, headers);
+  new HttpStringSender(c.nc, out);
+}
+
 /**
  * HandleCfgBrakelight: configure vehicle brake light control
  * 
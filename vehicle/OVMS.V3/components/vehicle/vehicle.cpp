@@ -63,6 +63,22 @@ OvmsVehicleFactory::OvmsVehicleFactory()
   cmd_vehicle->RegisterCommand("module","Set (or clear) vehicle module",vehicle_module,"<type>",0,1,true,vehicle_validate);
   cmd_vehicle->RegisterCommand("list","Show list of available vehicle modules",vehicle_list);
   cmd_vehicle->RegisterCommand("status","Show vehicle module status",vehicle_status);
+  OvmsCommand* cmd_poller = cmd_vehicle->RegisterCommand("poller","OBD2/UDS poller framework");
+  cmd_poller->RegisterCommand("status","Show poller status per bus",vehicle_poller_status);
+  cmd_poller->RegisterCommand("times","Show poll entry statistics",vehicle_poller_times,"[-j]\n-j = output in JSON format",0,1);
+  cmd_poller->RegisterCommand("reset","Reset poller statistics",vehicle_poller_reset);
+  OvmsCommand* cmd_frames = cmd_vehicle->RegisterCommand("frames","CAN frame handler framework");
+  cmd_frames->RegisterCommand("status","Show frame handler statistics",vehicle_frames_status);
+  cmd_frames->RegisterCommand("reset","Reset frame handler statistics",vehicle_frames_reset);
+  OvmsCommand* cmd_timers = cmd_vehicle->RegisterCommand("timers","Vehicle timer framework");
+  cmd_timers->RegisterCommand("status","Show vehicle timer statistics",vehicle_timers_status);
+  cmd_timers->RegisterCommand("reset","Reset vehicle timer statistics",vehicle_timers_reset);
+  OvmsCommand* cmd_profile = cmd_vehicle->RegisterCommand("profile","Vehicle task CPU profiling");
+  cmd_profile->RegisterCommand("status","Show CPU usage per CAN ID, poll PID & ticker",vehicle_profile_status,
+    "[<max>]\n<max> = number of entries to show (default 20, 0 = all)",0,1);
+  cmd_profile->RegisterCommand("on","Start profiling",vehicle_profile_enable);
+  cmd_profile->RegisterCommand("off","Stop profiling",vehicle_profile_enable);
+  cmd_profile->RegisterCommand("reset","Reset profile data",vehicle_profile_reset);
 
   MyCommandApp.RegisterCommand("wakeup","Wake up vehicle",vehicle_wakeup);
   MyCommandApp.RegisterCommand("homelink","Activate specified homelink button",vehicle_homelink,"<homelink> [<duration=1000ms>]",1,2);
@@ -91,6 +107,11 @@ OvmsVehicleFactory::OvmsVehicleFactory()
   cmd_bms->RegisterCommand("status","Show BMS status",bms_status);
   cmd_bms->RegisterCommand("reset","Reset BMS statistics",bms_reset);
   cmd_bms->RegisterCommand("alerts","Show BMS alerts",bms_alerts);
+  OvmsCommand* cmd_bmshist = cmd_bms->RegisterCommand("history","BMS cell history");
+  cmd_bmshist->RegisterCommand("status","Show BMS cell history status",bms_history_status);
+  cmd_bmshist->RegisterCommand("export","Export BMS cell history (bin = base64 encoded)",bms_history_export,
+    "<raw|1m|10m> [csv|bin] [<records>]",1,3);
+  cmd_bmshist->RegisterCommand("reset","Clear BMS cell history",bms_history_reset);
 
   OvmsCommand* cmd_obdii = MyCommandApp.RegisterCommand("obdii", "OBDII framework");
   for (int k=1; k <= 4; k++)
@@ -252,6 +273,19 @@ OvmsVehicle::OvmsVehicle()
   m_autonotifications = true;
   m_ready = false;
 
+  memset(m_frame_tables, 0, sizeof(m_frame_tables));
+  m_frame_filter = false;
+  m_frame_stats_time = esp_timer_get_time();
+
+  m_timer_lastid = 0;
+  m_timer_signal = NULL;
+  m_timer_signal_due = 0;
+  m_timer_stats_time = esp_timer_get_time();
+
+  m_profile = false;
+  m_profile_overflow = 0;
+  m_profile_time = esp_timer_get_time();
+
   m_poll_state = 0;
   m_poll_bus = NULL;
   m_poll_bus_default = NULL;
@@ -276,6 +310,16 @@ OvmsVehicle::OvmsVehicle()
   m_poll_sequence_cnt = 0;
   m_poll_fc_septime = 25;       // response default timing: 25 milliseconds
   m_poll_ch_keepalive = 60;     // channel keepalive default: 60 seconds
+  m_poll_ch_pool = 1;           // channel pool default: single channel
+  m_poll_reassemble = false;
+  for (int i = 0; i < VEHICLE_POLL_NBUSES; i++)
+    m_poll_engines[i] = NULL;
+  m_poll_engine = NULL;
+  m_poll_adaptive_max = 0;
+  m_poll_adaptive_cfg = -1;
+  m_poll_timer = NULL;
+  m_poll_timer_due = 0;
+  m_poll_plan_buses = 0;
 
   m_bms_voltages = NULL;
   m_bms_vmins = NULL;
@@ -316,6 +360,23 @@ OvmsVehicle::OvmsVehicle()
   m_bms_defthr_twarn      = BMS_DEFTHR_TWARN;
   m_bms_defthr_talert     = BMS_DEFTHR_TALERT;
 
+  m_bms_cfgthr_vmaxgrad   = -1;
+  m_bms_cfgthr_vmaxsddev  = -1;
+  m_bms_cfgthr_vwarn      = -1;
+  m_bms_cfgthr_valert     = -1;
+  m_bms_cfgthr_twarn      = -1;
+  m_bms_cfgthr_talert     = -1;
+  memset(&m_bms_vstats, 0, sizeof(m_bms_vstats));
+  memset(&m_bms_tstats, 0, sizeof(m_bms_tstats));
+
+  m_bms_hist_size = 0;
+  m_bms_hist_nv = 0;
+  m_bms_hist_nt = 0;
+  memset(m_bms_hist_ring, 0, sizeof(m_bms_hist_ring));
+  memset(m_bms_hist_accu, 0, sizeof(m_bms_hist_accu));
+  m_bms_hist_accudata = NULL;
+  m_bms_hist_gen = 0;
+
   m_bms_vlog_last = 0;
   m_bms_tlog_last = 0;
 
@@ -325,9 +386,12 @@ OvmsVehicle::OvmsVehicle()
   m_accel_refspeed = 0;
   m_accel_reftime = 0;
   m_accel_smoothing = 2.0;
+  m_accel_smoothed = 0;
+  m_accel_calculated = false;
 
   m_batpwr_smoothing = 2.0;
   m_batpwr_smoothed = 0;
+  m_batpwr_calculated = false;
 
   m_brakelight_enable = false;
   m_brakelight_on = 1.3;
@@ -336,6 +400,9 @@ OvmsVehicle::OvmsVehicle()
   m_brakelight_start = 0;
   m_brakelight_basepwr = 0;
   m_brakelight_ignftbrk = false;
+  m_brakelight_rxtime = 0;
+  m_brakelight_latency = -1;
+  m_brakelight_latency_max = 0;
 
   m_tpms_lastcheck = 0;
 
@@ -358,66 +425,62 @@ OvmsVehicle::~OvmsVehicle()
   if (m_can3) m_can3->SetPowerMode(Off);
   if (m_can4) m_can4->SetPowerMode(Off);
 
-  if (m_bms_voltages != NULL)
+  // Stop frame input & the vehicle task before freeing the handler tables & stores
+  // they use (the listener filter reads the frame tables in the CAN task):
+  if (m_registeredlistener)
     {
-    delete [] m_bms_voltages;
-    m_bms_voltages = NULL;
+    MyCan.DeregisterListener(m_rxqueue);
+    m_registeredlistener = false;
     }
-  if (m_bms_vmins != NULL)
+  if (m_poll_timer)
     {
-    delete [] m_bms_vmins;
-    m_bms_vmins = NULL;
+    esp_timer_stop(m_poll_timer);
+    esp_timer_delete(m_poll_timer);
+    m_poll_timer = NULL;
     }
-  if (m_bms_vmaxs != NULL)
+  vTaskDelete(m_rxtask);
+
+  // BMS history & series stores (see BmsAllocStore()):
+  m_bms_hist_mutex.Lock();
+  BmsHistoryFree();
+  m_bms_hist_mutex.Unlock();
+  if (m_bms_voltages != NULL)
     {
-    delete [] m_bms_vmaxs;
+    delete [] m_bms_voltages;
+    m_bms_voltages = NULL;
+    m_bms_vmins = NULL;
     m_bms_vmaxs = NULL;
-    }
-  if (m_bms_vdevmaxs != NULL)
-    {
-    delete [] m_bms_vdevmaxs;
     m_bms_vdevmaxs = NULL;
-    }
-  if (m_bms_valerts != NULL)
-    {
-    delete [] m_bms_valerts;
     m_bms_valerts = NULL;
     }
-
   if (m_bms_temperatures != NULL)
     {
     delete [] m_bms_temperatures;
     m_bms_temperatures = NULL;
-    }
-  if (m_bms_tmins != NULL)
-    {
-    delete [] m_bms_tmins;
     m_bms_tmins = NULL;
-    }
-  if (m_bms_tmaxs != NULL)
-    {
-    delete [] m_bms_tmaxs;
     m_bms_tmaxs = NULL;
-    }
-  if (m_bms_tdevmaxs != NULL)
-    {
-    delete [] m_bms_tdevmaxs;
     m_bms_tdevmaxs = NULL;
-    }
-  if (m_bms_talerts != NULL)
-    {
-    delete [] m_bms_talerts;
     m_bms_talerts = NULL;
     }
 
-  if (m_registeredlistener)
+  FreeFrameHandlers();
+  FreeTimers();
+
+  for (poll_async_t* async : m_poll_async)
+    delete async;
+  m_poll_async.clear();
+  for (int i = 0; i < VEHICLE_POLL_NBUSES; i++)
     {
-    MyCan.DeregisterListener(m_rxqueue);
-    m_registeredlistener = false;
+    poll_engine_t* engine = m_poll_engines[i];
+    if (!engine)
+      continue;
+    for (int k = 0; k < VEHICLE_POLL_MAXINFLIGHT; k++)
+      delete engine->req[k].async;
+    delete engine;
+    m_poll_engines[i] = NULL;
     }
 
   vQueueDelete(m_rxqueue);
-  vTaskDelete(m_rxtask);
 
   MyEvents.DeregisterEvent(TAG);
   MyMetrics.DeregisterListener(TAG);
@@ -444,29 +507,38 @@ void OvmsVehicle::RxTask()
       if (!m_ready)
         continue;
 
-      // Pass frame to poller protocol handlers:
-      if (frame.origin == m_poll_vwtp.bus && frame.MsgID == m_poll_vwtp.rxid)
+      // Vehicle task signal?
+      if (frame.origin == NULL)
         {
-        PollerVWTPReceive(&frame, frame.MsgID);
+        if (frame.MsgID == VEHICLE_SIGNAL_TIMERS)
+          TimerRun();
+        else
+          PollerRunSchedule();
+        continue;
         }
-      else if (m_poll_wait && frame.origin == m_poll_bus && m_poll_plist)
+
+      // Frame reception time for the brake light latency measurement:
+      if (m_brakelight_enable)
+        m_brakelight_rxtime = esp_timer_get_time();
+
+      // Pass frame to poller protocol handlers:
+      PollerReceive(&frame);
+
+      bool profile = m_profile;
+      uint32_t start = profile ? xthal_get_ccount() : 0;
+
+      // Pass frame to registered handler, else to standard handlers:
+      if (!DispatchFrame(&frame))
         {
-        uint32_t msgid;
-        if (m_poll_protocol == ISOTP_EXTADR)
-          msgid = frame.MsgID << 8 | frame.data.u8[0];
-        else
-          msgid = frame.MsgID;
-        if (msgid >= m_poll_moduleid_low && msgid <= m_poll_moduleid_high)
-          {
-          PollerISOTPReceive(&frame, msgid);
-          }
+        if (m_can1 == frame.origin) IncomingFrameCan1(&frame);
+        else if (m_can2 == frame.origin) IncomingFrameCan2(&frame);
+        else if (m_can3 == frame.origin) IncomingFrameCan3(&frame);
+        else if (m_can4 == frame.origin) IncomingFrameCan4(&frame);
         }
 
-      // Pass frame to standard handlers:
-      if (m_can1 == frame.origin) IncomingFrameCan1(&frame);
-      else if (m_can2 == frame.origin) IncomingFrameCan2(&frame);
-      else if (m_can3 == frame.origin) IncomingFrameCan3(&frame);
-      else if (m_can4 == frame.origin) IncomingFrameCan4(&frame);
+      if (profile)
+        ProfileRecord(ProfileKey(Profile_Frame, frame.origin->m_busnumber, frame.MsgID, frame.FIR.B.FF), start);
+      m_brakelight_rxtime = 0;
       }
     }
   }
@@ -520,10 +592,20 @@ void OvmsVehicle::RegisterCanBus(int bus, CAN_mode_t mode, CAN_speed_t speed, db
       break;
     }
 
+  RegisterListener();
+  }
+
+/**
+ * RegisterListener: internal: register the vehicle queue as a CAN listener (once)
+ *  The listener filter is only active if enabled for a bus, see SetFrameFilter().
+ */
+void OvmsVehicle::RegisterListener()
+  {
+  using std::placeholders::_1;
   if (!m_registeredlistener)
     {
     m_registeredlistener = true;
-    MyCan.RegisterListener(m_rxqueue);
+    MyCan.RegisterListener(m_rxqueue, false, std::bind(&OvmsVehicle::FrameFilter, this, _1));
     }
   }
 
@@ -545,12 +627,18 @@ void OvmsVehicle::VehicleTicker1(std::string event, void* data)
   PollerStateTicker();
   PollerSend(true);
 
-  Ticker1(m_ticker);
-  if ((m_ticker % 10) == 0) Ticker10(m_ticker);
-  if ((m_ticker % 60) == 0) Ticker60(m_ticker);
-  if ((m_ticker % 300) == 0) Ticker300(m_ticker);
-  if ((m_ticker % 600) == 0) Ticker600(m_ticker);
-  if ((m_ticker % 3600) == 0) Ticker3600(m_ticker);
+  // Recover from a lost timer signal:
+  m_timer_mutex.Lock();
+  TimerArm();
+  m_timer_mutex.Unlock();
+
+  RunTicker(1, &OvmsVehicle::Ticker1);
+  if ((m_ticker % 10) == 0) RunTicker(10, &OvmsVehicle::Ticker10);
+  if ((m_ticker % 10) == 0) BmsHistoryTicker();
+  if ((m_ticker % 60) == 0) RunTicker(60, &OvmsVehicle::Ticker60);
+  if ((m_ticker % 300) == 0) RunTicker(300, &OvmsVehicle::Ticker300);
+  if ((m_ticker % 600) == 0) RunTicker(600, &OvmsVehicle::Ticker600);
+  if ((m_ticker % 3600) == 0) RunTicker(3600, &OvmsVehicle::Ticker3600);
 
   if (StandardMetrics.ms_v_env_on->AsBool())
     {
@@ -1082,6 +1170,28 @@ void OvmsVehicle::VehicleConfigChanged(std::string event, void* data)
     m_brakelight_basepwr = MyConfig.GetParamValueFloat("vehicle", "brakelight.basepwr", 0);
     m_brakelight_ignftbrk = MyConfig.GetParamValueBool("vehicle", "brakelight.ignftbrk", false);
     m_brakelight_start = 0;
+    m_brakelight_latency = -1;
+    m_brakelight_latency_max = 0;
+
+    // BMS deviation thresholds (-1 = vehicle default):
+    m_bms_cfgthr_vmaxgrad  = MyConfig.GetParamValueFloat("vehicle", "bms.dev.voltage.maxgrad",  -1);
+    m_bms_cfgthr_vmaxsddev = MyConfig.GetParamValueFloat("vehicle", "bms.dev.voltage.maxsddev", -1);
+    m_bms_cfgthr_vwarn     = MyConfig.GetParamValueFloat("vehicle", "bms.dev.voltage.warn",     -1);
+    m_bms_cfgthr_valert    = MyConfig.GetParamValueFloat("vehicle", "bms.dev.voltage.alert",    -1);
+    m_bms_cfgthr_twarn     = MyConfig.GetParamValueFloat("vehicle", "bms.dev.temp.warn",        -1);
+    m_bms_cfgthr_talert    = MyConfig.GetParamValueFloat("vehicle", "bms.dev.temp.alert",       -1);
+
+    // BMS history size [kB] (history is reallocated on next BMS data set):
+    int bms_hist_size = MyConfig.GetParamValueInt("vehicle", "bms.history.size", 0);
+    if (bms_hist_size != m_bms_hist_size)
+      {
+      OvmsMutexLock lock(&m_bms_hist_mutex);
+      BmsHistoryFree();
+      m_bms_hist_size = bms_hist_size;
+      }
+
+    // poller adaptive throttling ceiling override:
+    m_poll_adaptive_cfg = MyConfig.GetParamValueInt("vehicle", "poller.adaptive", -1);
     }
 
   // read vehicle specific config:
@@ -1317,15 +1427,25 @@ void OvmsVehicle::MetricModified(OvmsMetric* metric)
     }
   else if (metric == StandardMetrics.ms_v_pos_acceleration)
     {
-    if (m_brakelight_enable)
+    // Acceleration set by the vehicle (if derived by CalculateAcceleration(), the
+    // brake light has already been checked on the speed sample):
+    if (m_brakelight_enable && !m_accel_calculated)
+      {
+      m_accel_refspeed = ABS(StdMetrics.ms_v_pos_speed->AsFloat(0, Kph)) * 1000 / 3600;
+      m_accel_smoothed = metric->AsFloat();
       CheckBrakelight();
+      }
     }
   else if (metric == StandardMetrics.ms_v_bat_power)
     {
-    if (m_batpwr_smoothing > 0)
-      m_batpwr_smoothed = (m_batpwr_smoothed + metric->AsFloat() * m_batpwr_smoothing) / (m_batpwr_smoothing + 1);
-    else
-      m_batpwr_smoothed = metric->AsFloat();
+    // (already smoothed if fed by CalculateBatteryPower())
+    if (!m_batpwr_calculated)
+      {
+      if (m_batpwr_smoothing > 0)
+        m_batpwr_smoothed = (m_batpwr_smoothed + metric->AsFloat() * m_batpwr_smoothing) / (m_batpwr_smoothing + 1);
+      else
+        m_batpwr_smoothed = metric->AsFloat();
+      }
     }
   else if (metric == StdMetrics.ms_v_bat_current || metric == StdMetrics.ms_v_bat_cac ||
       metric == StdMetrics.ms_v_bat_range_full)
@@ -1340,23 +1460,57 @@ void OvmsVehicle::MetricModified(OvmsMetric* metric)
  *  IF you want to let the framework calculate acceleration, call this after your regular
  *  update to StdMetrics.ms_v_pos_speed. This is optional, you can set ms_v_pos_acceleration
  *  yourself if your vehicle provides this metric.
+ *  Pass the speed sample decoded from the frame (kph, see below) to avoid reading back
+ *  the metric with unit conversion.
  */
 void OvmsVehicle::CalculateAcceleration()
   {
-  uint32_t now = esp_log_timestamp();
+  CalculateAcceleration(StdMetrics.ms_v_pos_speed->AsFloat(0, Kph));
+  }
+
+/**
+ * CalculateAcceleration: derive acceleration from a raw speed sample
+ *  @param speed_kph    Speed sample as decoded from the frame (kph, sign ignored)
+ *  The filter runs on the unrounded samples kept in m_accel_refspeed & m_accel_smoothed,
+ *  the brake light check uses these directly. ms_v_pos_acceleration gets the result.
+ */
+void OvmsVehicle::CalculateAcceleration(float speed_kph)
+  {
+  int64_t now = esp_timer_get_time();
   if (now > m_accel_reftime)
     {
-    float speed = ABS(StdMetrics.ms_v_pos_speed->AsFloat(0, Kph)) * 1000 / 3600;
-    float accel = (speed - m_accel_refspeed) / (now - m_accel_reftime) * 1000;
+    float speed = ABS(speed_kph) * (1000.0f / 3600.0f);
+    float accel = (speed - m_accel_refspeed) / (now - m_accel_reftime) * 1000000;
     // smooth out road bumps & gear box backlash:
     if (m_accel_smoothing > 0)
-      accel = (accel + StdMetrics.ms_v_pos_acceleration->AsFloat() * m_accel_smoothing) / (m_accel_smoothing + 1);
-    StdMetrics.ms_v_pos_acceleration->SetValue(TRUNCPREC(accel, 3));
+      accel = (accel + m_accel_smoothed * m_accel_smoothing) / (m_accel_smoothing + 1);
+    m_accel_smoothed = accel;
     m_accel_refspeed = speed;
     m_accel_reftime = now;
+    m_accel_calculated = true;
+    StdMetrics.ms_v_pos_acceleration->SetValue(TRUNCPREC(accel, 3));
+    if (m_brakelight_enable)
+      CheckBrakelight();
     }
   }
 
+/**
+ * CalculateBatteryPower: smooth a raw battery power sample for the regen detection
+ *  @param power_kw     Battery power sample as decoded from the frame (kW, negative = charging)
+ * Note:
+ *  Optional: call this with the value set to StdMetrics.ms_v_bat_power in your frame handler
+ *  to skip reading back the metric on each update. Without this, the smoothing is done by
+ *  the metric listener.
+ */
+void OvmsVehicle::CalculateBatteryPower(float power_kw)
+  {
+  if (m_batpwr_smoothing > 0)
+    m_batpwr_smoothed = (m_batpwr_smoothed + power_kw * m_batpwr_smoothing) / (m_batpwr_smoothing + 1);
+  else
+    m_batpwr_smoothed = power_kw;
+  m_batpwr_calculated = true;
+  }
+
 /**
  * CheckBrakelight: check for regenerative braking, control brakelight accordingly
  * Notes:
@@ -1371,13 +1525,15 @@ void OvmsVehicle::CalculateAcceleration()
  *  c) To reduce flicker the brake light has a minimum hold time of currently fixed 500 ms.
  *  d) Normal operation is "regen light XOR foot brake light", set [brakelight.ignftbrk]
  *     to true to disable this.
+ *  e) Speed & acceleration are read from the filter state (m_accel_refspeed, m_accel_smoothed),
+ *     not from the (rounded) metrics.
  * Override to customize.
  */
 void OvmsVehicle::CheckBrakelight()
   {
   uint32_t now = esp_log_timestamp();
-  float speed = ABS(StdMetrics.ms_v_pos_speed->AsFloat(0, Kph)) * 1000 / 3600;
-  float accel = StdMetrics.ms_v_pos_acceleration->AsFloat();
+  float speed = m_accel_refspeed;
+  float accel = m_accel_smoothed;
   bool car_on = StdMetrics.ms_v_env_on->AsBool();
   bool footbrake = StdMetrics.ms_v_env_footbrake->AsFloat() > 0;
   const uint32_t holdtime = 500;
@@ -1390,7 +1546,9 @@ void OvmsVehicle::CheckBrakelight()
       {
       if (SetBrakelight(1))
         {
-        ESP_LOGD(TAG, "brakelight on at speed=%.2f m/s, accel=%.2f m/s^2", speed, accel);
+        BrakelightLatency();
+        ESP_LOGD(TAG, "brakelight on at speed=%.2f m/s, accel=%.2f m/s^2, latency=%d us (max %d us)", speed, accel,
+          m_brakelight_latency, m_brakelight_latency_max);
         m_brakelight_start = now;
         StdMetrics.ms_v_env_regenbrake->SetValue(true);
         }
@@ -1408,7 +1566,9 @@ void OvmsVehicle::CheckBrakelight()
       {
       if (SetBrakelight(0))
         {
-        ESP_LOGD(TAG, "brakelight off at speed=%.2f m/s, accel=%.2f m/s^2", speed, accel);
+        BrakelightLatency();
+        ESP_LOGD(TAG, "brakelight off at speed=%.2f m/s, accel=%.2f m/s^2, latency=%d us (max %d us)", speed, accel,
+          m_brakelight_latency, m_brakelight_latency_max);
         m_brakelight_start = 0;
         StdMetrics.ms_v_env_regenbrake->SetValue(false);
         }
@@ -1418,6 +1578,25 @@ void OvmsVehicle::CheckBrakelight()
     }
   }
 
+/**
+ * BrakelightLatency: internal: record the brake light switch latency
+ *  Measured from the reception of the current frame by the vehicle task. Not available
+ *  if the brake light has been switched outside the frame processing.
+ */
+void OvmsVehicle::BrakelightLatency()
+  {
+  if (m_brakelight_rxtime && xTaskGetCurrentTaskHandle() == m_rxtask)
+    {
+    m_brakelight_latency = esp_timer_get_time() - m_brakelight_rxtime;
+    if (m_brakelight_latency > m_brakelight_latency_max)
+      m_brakelight_latency_max = m_brakelight_latency;
+    }
+  else
+    {
+    m_brakelight_latency = -1;
+    }
+  }
+
 /**
  * SetBrakelight: hardware brake light control method
  * Override for custom control, e.g. CAN.
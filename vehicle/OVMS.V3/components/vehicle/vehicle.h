@@ -33,7 +33,9 @@
 
 #include <map>
 #include <vector>
+#include <deque>
 #include <string>
+#include <functional>
 #include "can.h"
 #include "ovms_events.h"
 #include "ovms_config.h"
@@ -41,7 +43,9 @@
 #include "ovms_command.h"
 #include "metrics_standard.h"
 #include "ovms_mutex.h"
+#include "esp_timer.h"
 #include "ovms_semaphore.h"
+#include <xtensa/hal.h>
 
 using namespace std;
 struct DashboardConfig;
@@ -64,6 +68,11 @@ struct DashboardConfig;
 
 // Argument tag:
 #define POLL_TXDATA                     0xff  // poll_pid_t using xargs for external payload up to 4095 bytes
+#define POLL_MULTIDID                   0xfe  // poll_pid_t using dargs for multiple DIDs (ReadDataByIdentifier)
+
+// Poll time units (poll_pid_t.polltimeunit):
+#define POLL_TIME_SECONDS               0     // polltime[] in seconds (default)
+#define POLL_TIME_MS                    1     // polltime[] in milliseconds
 
 
 // OBD2/UDS Polling types supported:
@@ -95,6 +104,32 @@ struct DashboardConfig;
 // 
 // See OvmsVehicle::PollSingleRequest() on how to send dynamic requests with additional arguments.
 // 
+// Multiple DIDs: UDS ReadDataByIdentifier (0x22) accepts multiple DIDs per request, saving
+// a round trip per DID. To read a DID set by one request, define a poll_did_t table of the
+// DIDs and their response data lengths (excluding the DID), and use POLL_PID_DIDS:
+//  static const OvmsVehicle::poll_did_t bms_dids[] = { { 0x0101, 4 }, { 0x0102, 2 } };
+//  { 0x7e4, 0x7ec, VEHICLE_POLL_TYPE_READDATA, POLL_PID_DIDS(bms_dids), {…TIMES…}, 0, ISOTP_STD }
+// The response is passed on as separate responses per DID, DIDs omitted by the ECU are
+// passed to IncomingPollError() with NRC 0x31 (requestOutOfRange). If an ECU rejects the
+// request or the response does not match the length table, the poller switches to single
+// requests per DID for that ECU (until 'vehicle poller reset').
+// 
+// Poll times are given in seconds by default, all entries due in a second are sent in list
+// order. To poll faster than 1 Hz, set the optional polltimeunit field to POLL_TIME_MS, the
+// polltime values are then taken as milliseconds (max 65535). Millisecond entries are
+// scheduled by due time independent of the list order, and take precedence over second
+// entries due at the same time. The optional pollphase field delays the first poll of an
+// entry by the given number of milliseconds (second entries: rounded down to full seconds)
+// to spread the load of entries having the same interval:
+//   // TXID, RXID,  TYPE,    PID,          TIMES,  BUS,  PROT,       UNIT,          PHASE
+//   { 0x7e4, 0x7ec, 0x22,  0x0101, {0,200,200,0},    0,  ISOTP_STD,  POLL_TIME_MS,  0   }
+//   { 0x7e4, 0x7ec, 0x22,  0x0102, {0,200,200,0},    0,  ISOTP_STD,  POLL_TIME_MS,  100 }
+//   { 0x7e4, 0x7ec, 0x22,  0x0103, {0, 10, 10,0},    0,  ISOTP_STD,  0,             5000 }
+// 
+// PollSetPidList() compiles the list into per state schedules (entries grouped by interval),
+// so each tick only visits the entries due. The list must not be modified while set; to
+// apply changes, call PollSetPidList() again.
+// 
 // VWTP_20: this protocol implements the VW (VAG) specific "TP 2.0", which establishes
 // OSI layer 5 communication channels to devices (ECU modules) via a CAN gateway.
 // On VWTP_20 poll entries, simply set the TXID to the gateway base ID (normally 0x200)
@@ -107,14 +142,53 @@ struct DashboardConfig;
 //   { 0x200, 0x1f,  0x10,   0x89,  {…times…},    0,  VWTP_20 }
 //   { 0x200, 0x1f,  0x22, 0x04a1,  {…times…},    0 , VWTP_20 }
 // 
-// VW gateways currently do not support multiple open channels. To minimize connection
+// VW gateways may not support multiple open channels. To minimize connection
 // overhead for successive polls to an ECU, the VWTP_20 engine keeps an idle connection open
 // until the keepalive timeout occurs. So you should try to arrange your polls in interval
 // blocks/sequences to the same devices if possible.
 // 
+// If the gateway supports multiple channels, use PollSetChannelPool() to keep up to
+// VEHICLE_POLL_VWTP_CHANNELS channels per bus open: on a poll to another ECU, the idle
+// channel is parked instead of closed, and resumed without a new setup on the next poll
+// to its ECU. Parked channels are kept alive by channel tests until the keepalive timeout,
+// if the pool is full, the least recently used channel is closed.
+// 
 // To explicitly close a VWTP_20 channel, send a poll (any type) to RXID 0, that just
 // closes the channel (ECU ID 0 is an invalid destination):
 //   { 0x200,    0,     0,      0,  {…times…},    0 , VWTP_20 }
+// 
+// Multiple buses: each bus used by the poll list (see poll_pid_t.pollbus) is served by
+// a separate poller engine with its own list cursor, outstanding requests, throttling
+// and statistics. All engines are processed interleaved by the vehicle task (not in
+// parallel), so a request waiting for a slow ECU on one bus does not hold back the poll
+// list of other buses. While a response is processed, the m_poll_* request members
+// reflect the responding request.
+// Use the command 'vehicle poller status' to inspect the engines, 'vehicle poller times'
+// shows the response statistics and bus usage per poll entry.
+// 
+// Pipelining: by default, an engine waits for the response to a request before sending
+// the next. Use PollSetMaxInFlight() to allow multiple requests to distinct ECUs (TX/RX ID
+// pairs) in flight on a bus. The next due entry is held back while a request to the same
+// ECU is in flight, broadcasts and VWTP_20 requests are always sent exclusively. Each
+// request has its own response reassembly and timeout. Note: the throttling limit
+// (PollSetThrottling()) still applies to the number of requests sent per tick.
+// 
+// Adaptive throttling: PollSetAdaptiveThrottling(ceiling) replaces the static throttling
+// limit by a per bus limit adjusted from the responses (AIMD): it grows by one request per
+// round of successful responses with normal latency, and is halved on timeouts, "busy"
+// NRCs and CAN transmission failures. The limit applies to the requests sent per tick and
+// to the requests in flight (capped by PollSetMaxInFlight()). Users can override the
+// ceiling by config vehicle poller.adaptive (0 = off).
+// 
+// Response reassembly: IncomingPollReply() receives each response frame separately.
+// Call PollSetResponseReassembly(true) to let the poller collect the frames instead and
+// receive each complete response by a single IncomingPollResponse() call.
+// 
+// Asynchronous requests: PollSubmitRequest() queues a request and returns immediately,
+// the result is passed to a callback. PollSubmitBatch() / PollBatchRequest() submit a
+// set of requests and deliver all results together. Asynchronous requests are sent
+// interleaved with the poll list entries (and pipelined, see PollSetMaxInFlight()),
+// while PollSingleRequest() suspends the poll list for the request.
 
 
 #define VEHICLE_POLL_TYPE_NONE          0x00
@@ -189,6 +263,26 @@ struct DashboardConfig;
 // Number of polling states supported
 #define VEHICLE_POLL_NSTATES            4
 
+// Number of per bus poller engines (can1 … can4)
+#define VEHICLE_POLL_NBUSES             4
+
+// Max number of requests in flight per bus (see PollSetMaxInFlight())
+#define VEHICLE_POLL_MAXINFLIGHT        8
+
+// Max number of open VWTP_20 channels per bus (see PollSetChannelPool())
+#define VEHICLE_POLL_VWTP_CHANNELS      4
+
+// Vehicle task signals: empty frames (origin NULL) posted to the vehicle queue,
+// the signal is passed in the MsgID:
+#define VEHICLE_SIGNAL_POLLER           0     // Run poller schedule
+#define VEHICLE_SIGNAL_TIMERS           1     // Run vehicle timers (see StartTimer())
+
+// Max number of entries recorded by the profiler (see 'vehicle profile')
+#define VEHICLE_PROFILE_MAXENTRIES      300
+
+// Max number of frame handlers per bus (see RegisterFrameHandler())
+#define VEHICLE_FRAME_MAXHANDLERS       255
+
 // Macro for poll_pid_t termination
 #define POLL_LIST_END                   { 0, 0, 0x00, 0x00, { 0, 0, 0 }, 0, 0 }
 
@@ -196,6 +290,10 @@ struct DashboardConfig;
 #define POLL_PID_DATA(pid, datastring) \
   {.xargs={ (pid), POLL_TXDATA, sizeof(datastring)-1, reinterpret_cast<const uint8_t*>(datastring) }}
 
+// Poll list multiple DID utility (see info above):
+#define POLL_PID_DIDS(didtable) \
+  {.dargs={ 0, POLL_MULTIDID, sizeof(didtable)/sizeof((didtable)[0]), (didtable) }}
+
 // PollSingleRequest specific result codes:
 #define POLLSINGLE_OK                   0 
 #define POLLSINGLE_TIMEOUT              -1
@@ -301,7 +399,7 @@ class OvmsVehicle : public InternalRamAllocated
     void VehicleTicker1(std::string event, void* data);
     void VehicleConfigChanged(std::string event, void* data);
     void PollerSend(bool fromTicker);
-    void PollerReceive(CAN_frame_t* frame, uint32_t msgid);
+    void PollerReceive(CAN_frame_t* frame);
 
   protected:
     virtual void IncomingFrameCan1(CAN_frame_t* p_frame);
@@ -312,6 +410,7 @@ class OvmsVehicle : public InternalRamAllocated
   protected:
     virtual void PollerStateTicker();
     virtual void IncomingPollReply(canbus* bus, uint16_t type, uint16_t pid, uint8_t* data, uint8_t length, uint16_t mlremain);
+    virtual void IncomingPollResponse(canbus* bus, uint16_t type, uint16_t pid, const uint8_t* data, uint16_t length);
     virtual void IncomingPollError(canbus* bus, uint16_t type, uint16_t pid, uint16_t code);
 
   protected:
@@ -320,13 +419,18 @@ class OvmsVehicle : public InternalRamAllocated
 
   protected:
     float m_accel_refspeed;                 // Acceleration calculation: last speed measured (m/s)
-    uint32_t m_accel_reftime;               // … timestamp for refspeed (ms)
+    int64_t m_accel_reftime;                // … timestamp for refspeed (us)
     float m_accel_smoothing;                // … smoothing factor (samples, 0 = none, default 2.0)
+    float m_accel_smoothed;                 // … and smoothed acceleration (m/s², unrounded)
+    bool m_accel_calculated;                // … acceleration derived by CalculateAcceleration()
     void CalculateAcceleration();           // Call after ms_v_pos_speed update to derive acceleration
+    void CalculateAcceleration(float speed_kph);  // … or with the raw speed sample (kph)
 
   protected:
     float m_batpwr_smoothing;               // … smoothing factor (samples, 0 = none, default 2.0) …
     float m_batpwr_smoothed;                // … and smoothed value of ms_v_bat_power
+    bool m_batpwr_calculated;               // … fed by CalculateBatteryPower()
+    void CalculateBatteryPower(float power_kw);  // Optional: smooth the raw ms_v_bat_power sample (kW)
 
   protected:
     bool m_brakelight_enable;               // Regen brake light enable (default no)
@@ -336,8 +440,12 @@ class OvmsVehicle : public InternalRamAllocated
     float m_brakelight_basepwr;             // … base power area (+/- from 0 in kW, default 0)
     bool m_brakelight_ignftbrk;             // … ignore foot brake (default no)
     uint32_t m_brakelight_start;            // … activation start time
-    virtual void CheckBrakelight();         // … check vehicle metrics for regen braking state (override to customize)
+    int64_t m_brakelight_rxtime;            // … reception time of the current frame (us)
+    int32_t m_brakelight_latency;           // … last switch latency from frame reception (us, -1 = n/a)
+    int32_t m_brakelight_latency_max;       // … max switch latency (us)
+    virtual void CheckBrakelight();         // … check for regen braking state (override to customize)
     virtual bool SetBrakelight(int on);     // … hardware control method (override for non MAX7317 control)
+    void BrakelightLatency();               // … record switch latency (call after SetBrakelight() success)
 
   protected:
     virtual void CalculateRangeSpeed();     // Derive momentary range gain/loss speed in kph
@@ -431,6 +539,171 @@ class OvmsVehicle : public InternalRamAllocated
   public:
     virtual void RxTask();
 
+  // CAN frame handlers:
+  // 
+  // Instead of (or in addition to) processing all frames of a bus in IncomingFrameCanN(),
+  // vehicles can register handler methods for specific IDs or ID ranges (mask), e.g.:
+  //   RegisterFrameHandler(m_can1, 0x55b, std::bind(&OvmsVehicleFoo::IncomingSOC, this, _1));
+  //   RegisterFrameHandler(m_can1, 0x500, 0x7f0, std::bind(&OvmsVehicleFoo::IncomingBMS, this, _1));
+  // Standard IDs are looked up in a direct indexed table per bus, extended IDs are matched
+  // in registration order. If multiple handlers match an ID, the first registered wins.
+  // Frames without a handler are passed to IncomingFrameCanN() as before, so handlers
+  // can be migrated one at a time. Handlers are kept for the lifetime of the vehicle.
+  // 
+  // Once all frames of interest are served by handlers or the poller, call
+  // SetFrameFilter(bus, true) to drop unhandled frames before they enter the vehicle
+  // queue (IncomingFrameCanN() then only receives poller frames).
+  // 
+  // Use 'vehicle frames status' to show the call counts and processing times per handler.
+
+  public:
+    typedef std::function<void(CAN_frame_t* frame)> FrameHandler;
+
+  private:
+    typedef struct
+      {
+      uint32_t          id;                     // CAN ID
+      uint32_t          mask;                   // … ID bits to match
+      bool              extended;               // 29 bit ID
+      FrameHandler      handler;
+      uint32_t          calls;                  // Frames handled (since reset)
+      uint64_t          time;                   // … total processing time [us]
+      uint32_t          time_max;               // … max processing time [us]
+      } frame_handler_t;
+
+    typedef struct
+      {
+      uint8_t*          stdindex;               // Standard ID → handler number (1…), 0 = none
+      frame_handler_t** handlers;               // Handlers by number - 1
+      uint8_t           count;                  // … registered
+      bool              extended;               // Extended ID handlers registered
+      bool              filter;                 // Drop unhandled frames, see SetFrameFilter()
+      uint32_t          unhandled;              // Frames passed to IncomingFrameCanN() (since reset)
+      uint32_t          dropped;                // Frames dropped by the filter (since reset)
+      } frame_table_t;
+
+    frame_table_t     m_frame_tables[CAN_MAXBUSES];  // Handler tables by bus number
+    OvmsMutex         m_frame_mutex;          // Registration concurrency protection
+    bool              m_frame_filter;         // Filter enabled on any bus
+    int64_t           m_frame_stats_time;     // Statistics start time [us]
+
+  private:
+    frame_handler_t* FindFrameHandler(const frame_table_t* table, const CAN_frame_t* frame);
+    bool DispatchFrame(CAN_frame_t* frame);
+    bool FrameFilter(const CAN_frame_t* frame);
+    void RegisterListener();
+    void FreeFrameHandlers();
+
+  protected:
+    bool RegisterFrameHandler(canbus* bus, uint32_t id, FrameHandler handler);
+    bool RegisterFrameHandler(canbus* bus, uint32_t id, uint32_t mask, FrameHandler handler, bool extended=false);
+    void SetFrameFilter(canbus* bus, bool enable);
+
+  public:
+    void FrameHandlerStatus(int verbosity, OvmsWriter* writer);
+    void FrameHandlerResetStats();
+
+  // Vehicle timers:
+  // 
+  // Periodic and one-shot timers with millisecond resolution, executed in the vehicle
+  // task context (no locking needed against frame & poll handlers), e.g.:
+  //   m_heartbeat = StartTimer("foo.heartbeat", 100, std::bind(&OvmsVehicleFoo::SendHeartbeat, this));
+  //   m_timeout = StartTimer("foo.timeout", 5000, std::bind(&OvmsVehicleFoo::Timeout, this), false);
+  // Periodic timers are scheduled relative to their start (no drift). If a callback is
+  // late by more than a period, the missed runs are skipped. Timers can be started and
+  // stopped from any task, including from within a timer callback.
+  // 
+  // Use 'vehicle timers status' to show the runs, lateness and callback times per timer.
+
+  public:
+    typedef std::function<void()> VehicleTimerCallback;
+
+  private:
+    typedef struct
+      {
+      uint32_t          id;                     // Timer ID (> 0)
+      const char*       name;
+      uint32_t          interval;               // Period or delay [ms]
+      bool              periodic;
+      VehicleTimerCallback callback;
+      int64_t           due;                    // Next due time [us], 0 = not queued
+      bool              running;                // Callback being executed
+      bool              stopped;                // … and stopped by the callback
+      uint32_t          runs;                   // Callbacks executed (since reset)
+      uint32_t          skipped;                // … periods skipped due to lateness
+      uint64_t          late_sum;               // … total lateness [us]
+      uint32_t          late_max;               // … max lateness [us]
+      uint64_t          time_sum;               // … total callback time [us]
+      uint32_t          time_max;               // … max callback time [us]
+      } vehicle_timer_t;
+    typedef std::map<uint32_t, vehicle_timer_t*> vehicle_timer_map_t;
+    typedef std::multimap<int64_t, vehicle_timer_t*> vehicle_timer_queue_t;
+
+    OvmsRecMutex      m_timer_mutex;
+    vehicle_timer_map_t m_timers;             // Timers by ID
+    vehicle_timer_queue_t m_timer_queue;      // Timers queued by due time
+    uint32_t          m_timer_lastid;         // Last timer ID assigned
+    esp_timer_handle_t m_timer_signal;        // Signal timer for the next due time
+    int64_t           m_timer_signal_due;     // … due time [us] armed, 0 = not armed
+    int64_t           m_timer_stats_time;     // Statistics start time [us]
+
+  private:
+    void TimerQueue(vehicle_timer_t* timer);
+    void TimerUnqueue(vehicle_timer_t* timer);
+    void TimerArm();
+    void TimerRun();
+    static void TimerSignalCallback(void* arg);
+    void FreeTimers();
+
+  protected:
+    uint32_t StartTimer(const char* name, uint32_t interval_ms, VehicleTimerCallback callback, bool periodic=true);
+    bool StopTimer(uint32_t id);
+    bool IsTimerActive(uint32_t id);
+
+  public:
+    void TimerStatus(int verbosity, OvmsWriter* writer);
+    void TimerResetStats();
+
+  // Profiling:
+  // 
+  // 'vehicle profile on' records call counts and CPU cycles of the frame processing
+  // (IncomingFrameCanN() / frame handlers) per CAN ID, of the poll response processing
+  // (IncomingPollReply() & friends) per poll PID, and of the tickers. Cycle counts include
+  // the time the task was preempted. When disabled, the overhead is a flag check.
+
+  private:
+    typedef enum
+      {
+      Profile_Frame = 0,                        // CAN frame by bus & ID
+      Profile_Poll,                             // Poll response by bus, TX ID, type & PID
+      Profile_Ticker,                           // Ticker by interval
+      } profile_kind_t;
+
+    typedef struct
+      {
+      uint32_t          calls;
+      uint64_t          cycles;                 // Total CPU cycles
+      uint32_t          cycles_max;             // Max CPU cycles per call
+      } profile_entry_t;
+    typedef std::map<uint64_t, profile_entry_t> profile_map_t;
+
+    bool              m_profile;              // Profiling enabled
+    OvmsMutex         m_profile_mutex;
+    profile_map_t     m_profile_map;          // Entries by key, see ProfileKey()
+    uint32_t          m_profile_overflow;     // Calls not recorded (too many entries)
+    int64_t           m_profile_time;         // Recording start time [us]
+
+  private:
+    static uint64_t ProfileKey(profile_kind_t kind, int busnumber, uint32_t id, uint8_t type=0, uint16_t pid=0);
+    void ProfileRecord(uint64_t key, uint32_t start);
+    void RunTicker(uint32_t interval, void (OvmsVehicle::*ticker)(uint32_t));
+
+  public:
+    void ProfileEnable(bool enable);
+    bool ProfileEnabled() { return m_profile; }
+    void ProfileStatus(int verbosity, OvmsWriter* writer, int maxentries=20);
+    void ProfileReset();
+
   public:
     typedef enum
       {
@@ -489,6 +762,12 @@ class OvmsVehicle : public InternalRamAllocated
     virtual const std::string GetFeature(int key);
 
   public:
+    typedef struct
+      {
+      uint16_t did;                             // Data identifier
+      uint16_t length;                          // Response data length (bytes, excluding the DID)
+      } poll_did_t;
+
     typedef struct
       {
       uint32_t txmoduleid;                      // transmission CAN ID (address), 0x7df = OBD2 broadcast
@@ -510,12 +789,169 @@ class OvmsVehicle : public InternalRamAllocated
           uint16_t datalen;                     // payload length (bytes, max 4095)
           const uint8_t* data;                  // pointer to payload data (single/multi frame request)
           } xargs;
+        struct
+          {
+          uint16_t pid;                         // unused (DIDs are taken from the table)
+          uint8_t tag;                          // needs to be POLL_MULTIDID
+          uint16_t count;                       // number of DIDs (max 2047)
+          const poll_did_t* dids;               // pointer to DID table
+          } dargs;
         };
       uint16_t polltime[VEHICLE_POLL_NSTATES];  // poll intervals in seconds for used poll states
       uint8_t  pollbus;                         // 0 = default CAN bus from PollSetPidList(), 1…4 = specific
       uint8_t  protocol;                        // ISOTP_STD / ISOTP_EXTADR / ISOTP_EXTFRAME / VWTP_20
+      uint8_t  polltimeunit;                    // POLL_TIME_SECONDS (default) / POLL_TIME_MS
+      uint16_t pollphase;                       // Phase offset of the poll schedule in milliseconds (default 0)
       } poll_pid_t;
 
+    // Asynchronous requests, see PollSubmitRequest() & PollSubmitBatch():
+    typedef std::function<void(int result, const std::string& response)> PollCallback;
+    typedef struct
+      {
+      uint32_t    txid;                         // CAN ID to send to
+      uint32_t    rxid;                         // CAN ID to expect the response from
+      std::string request;                      // Request (type + pid + payload)
+      uint8_t     protocol;                     // ISOTP_STD / ISOTP_EXTADR / ISOTP_EXTFRAME / VWTP_20
+      int         result;                       // Result code, see PollSingleRequest()
+      std::string response;                     // Response payload (valid with result 0)
+      } poll_batch_item_t;
+    typedef std::vector<poll_batch_item_t> poll_batch_t;
+    typedef std::function<void(const poll_batch_t& batch)> PollBatchCallback;
+
+    typedef struct
+      {
+      int64_t due;                              // Next due time [ms] (esp_timer time base)
+      uint16_t interval;                        // Poll interval [ms]
+      const poll_pid_t* entry;                  // Poll list entry
+      } poll_schedule_t;
+
+    // Compiled poll list, see PollerCompileList():
+    typedef struct
+      {
+      uint16_t polltime;                        // Poll interval [s]
+      uint16_t phase;                           // Phase offset [s] (< polltime)
+      uint8_t  pollbus;                         // Bus of all entries, see poll_pid_t
+      std::vector<const poll_pid_t*> entries;   // Entries in list order
+      } poll_period_t;
+    typedef struct
+      {
+      std::vector<poll_period_t> periods;       // Second entries by interval, phase & bus
+      std::vector<const poll_pid_t*> ms;        // Millisecond entries
+      } poll_plan_t;
+
+    typedef struct
+      {
+      uint32_t sent;                            // Requests sent
+      uint32_t responses;                       // Responses completed
+      uint32_t errors;                          // Negative responses (NRC) received
+      uint32_t timeouts;                        // Requests abandoned without (complete) response
+      uint32_t txfailures;                      // Requests failed on CAN transmission
+      uint32_t backoffs;                        // Adaptive throttling rate decreases
+      uint32_t rate_responses;                  // Response count at last rate update
+      uint32_t rate_time;                       // Monotonic time of last rate update
+      float    rate;                            // Responses per second (smoothed over ~10 seconds)
+      } poll_stats_t;
+
+    // Asynchronous request (queued or in flight):
+    typedef struct
+      {
+      canbus*           bus;
+      poll_pid_t        entry;                  // Request entry (payload pointing into request)
+      std::string       request;
+      std::string       response;
+      PollCallback      callback;
+      int64_t           deadline;               // Queue timeout [us]
+      } poll_async_t;
+
+    // Request in flight, see PollerSelectRequest():
+    typedef struct
+      {
+      poll_pid_t        entry;                  // … see m_poll_* members of same name
+      uint8_t           protocol;
+      uint32_t          moduleid_sent;
+      uint32_t          moduleid_low;
+      uint32_t          moduleid_high;
+      uint16_t          type;
+      uint16_t          pid;
+      const uint8_t*    tx_data;
+      uint16_t          tx_remain;
+      uint16_t          tx_offset;
+      uint16_t          tx_frame;
+      uint16_t          ml_remain;
+      uint16_t          ml_offset;
+      uint16_t          ml_frame;
+      uint8_t           wait;                   // > 0 = slot busy
+      uint32_t          txmsgid;
+      int64_t           sent_time;              // Request start time [us] (slot only)
+      poll_async_t*     async;                  // Asynchronous request or NULL (slot only)
+      uint32_t          tx_id;                  // ISO-TP TX: consecutive frame ID (slot only)
+      uint32_t          tx_septime;             // … separation time [us]
+      uint8_t           tx_block;               // … frames left in block, 0 = unlimited
+      int64_t           tx_due;                 // … next frame due time [us], 0 = none
+      bool              tx_sending;             // … frame queued, due time set on TX callback
+      const poll_pid_t* multi;                  // Multiple DID entry sent as one request (slot only)
+      } poll_request_t;
+
+    // Per ECU response statistics (by TX ID):
+    typedef struct
+      {
+      uint32_t responses;                       // Responses completed
+      uint32_t errors;                          // Negative responses (NRC) received
+      uint32_t timeouts;                        // Requests abandoned
+      float    latency;                         // Response latency [ms] (smoothed)
+      float    latency_max;                     // Max response latency [ms]
+      bool     single_dids;                     // ECU rejected multiple DID requests
+      } poll_ecu_stats_t;
+    typedef std::map<uint32_t, poll_ecu_stats_t> poll_ecu_stats_map_t;
+
+    // Per poll entry statistics (by TX ID, type & PID, see PollerEntryStats()):
+    typedef struct
+      {
+      uint32_t sent;                            // Requests sent
+      uint32_t responses;                       // Responses completed
+      uint32_t errors;                          // Negative responses (NRC) received
+      uint32_t timeouts;                        // Requests abandoned
+      float    latency_min;                     // Response latency [ms]
+      float    latency_max;
+      float    latency_sum;                     // … sum of all responses & errors
+      uint32_t rxframes;                        // Response frames received
+      uint32_t rxbytes;                         // … frame payload bytes
+      uint32_t txframes;                        // Request & flow control frames sent
+      uint64_t busbits;                         // Estimated bus bits used by all frames
+      } poll_entry_stats_t;
+    typedef std::map<uint64_t, poll_entry_stats_t> poll_entry_stats_map_t;
+
+    // Per bus poller engine, see PollerSelectEngine() & PollerGetEngine():
+    struct poll_engine_t : public ExternalRamAllocated
+      {
+      canbus*           bus;                    // CAN bus served by this engine, NULL = unused
+      const poll_pid_t* plcur;                  // … see m_poll_* members of same name
+      uint32_t          ticker;
+      uint8_t           sequence_cnt;
+      vwtp_channel_t    vwtp;
+      vwtp_channel_t    vwtp_pool[VEHICLE_POLL_VWTP_CHANNELS-1];  // Parked VWTP_20 channels
+      poll_request_t    req[VEHICLE_POLL_MAXINFLIGHT];  // Request slots
+      uint8_t           reqidx;                 // Selected request slot
+      uint8_t           inflight_max;           // Max requests in flight, see PollSetMaxInFlight()
+      poll_stats_t      stats;
+      std::vector<poll_schedule_t> schedule;    // Millisecond entries, min-heap by due time
+      bool              schedule_valid;         // false = rebuild schedule on next send
+      bool              cycle_done;             // Second entries done for the current tick
+      std::vector<const poll_pid_t*> due;       // Second entries due at the current tick
+      uint16_t          duepos;                 // … next to send
+      bool              due_valid;              // false = collect due entries on next send
+      float             aimd_limit;             // Adaptive throttling: requests per tick / in flight
+      uint32_t          aimd_backoff_time;      // … monotonic time of last decrease
+      poll_ecu_stats_map_t ecus;                // Per ECU statistics
+      std::string       rxbuf[VEHICLE_POLL_MAXINFLIGHT];  // Response reassembly buffers
+      poll_entry_stats_map_t entries;           // Per poll entry statistics
+      int64_t           entries_time;           // … start time [us]
+      bool              async_turn;             // Next free slot goes to an asynchronous request
+      std::string       txbuf[VEHICLE_POLL_MAXINFLIGHT];  // Multiple DID request payloads
+      const poll_pid_t* multi_entry;            // Multiple DID entry sent as single requests
+      uint16_t          multi_next;             // … next DID index
+      };
+
   protected:
     OvmsRecMutex      m_poll_mutex;           // Concurrency protection for recursive calls
     uint8_t           m_poll_state;           // Current poll state
@@ -553,33 +989,109 @@ class OvmsVehicle : public InternalRamAllocated
     uint8_t           m_poll_sequence_cnt;    // Polls already sent in the current time tick (second)
     uint8_t           m_poll_fc_septime;      // Flow control separation time for multi frame responses
     uint16_t          m_poll_ch_keepalive;    // Seconds to keep an inactive channel (e.g. VWTP) alive (default: 60)
+    uint8_t           m_poll_ch_pool;         // Max open VWTP channels per bus (default: 1)
+    bool              m_poll_reassemble;      // Deliver complete responses (IncomingPollResponse())
 
   private:
     OvmsRecMutex      m_poll_single_mutex;    // PollSingleRequest() concurrency protection
     std::string*      m_poll_single_rxbuf;    // … response buffer
     int               m_poll_single_rxerr;    // … response error code (NRC) / TX failure code
     OvmsSemaphore     m_poll_single_rxdone;   // … response done (ok/error)
+    std::deque<poll_async_t*> m_poll_async;   // Asynchronous requests queued
 
   protected:
     vwtp_channel_t    m_poll_vwtp;            // VWTP channel state
 
+  protected:
+    // Each bus polled has a separate engine (interleaved on the vehicle task), each engine
+    // can have multiple requests in flight. The m_poll_* request state members above reflect the engine & request
+    // currently processed (selected) by the poller, so they can be used as before from
+    // within IncomingPollReply() & friends.
+    poll_engine_t*    m_poll_engines[VEHICLE_POLL_NBUSES];  // Allocated on first use, see PollerGetEngine()
+    poll_engine_t*    m_poll_engine;          // Currently selected engine or NULL
+    uint8_t           m_poll_adaptive_max;    // Adaptive throttling ceiling (vehicle), 0 = off
+    int               m_poll_adaptive_cfg;    // … user config override, -1 = vehicle default
+    esp_timer_handle_t m_poll_timer;          // Millisecond schedule timer
+    int64_t           m_poll_timer_due;       // … due time [us] the timer is armed for, 0 = not armed
+    poll_plan_t       m_poll_plan[VEHICLE_POLL_NSTATES];  // Compiled poll list per state
+    uint8_t           m_poll_plan_buses;      // Bit mask of pollbus values used by the list
+
+  private:
+    canbus* PollerGetBus(const poll_pid_t* entry);
+    canbus* PollerGetBus(uint8_t pollbus);
+    void PollerCompileList();
+    void PollerCollectDue();
+    poll_engine_t* PollerGetEngine(canbus* bus, bool create);
+    void PollerSelectEngine(poll_engine_t* engine);
+    void PollerStoreEngine();
+    void PollerSelectRequest(int index);
+    void PollerLoadRequest();
+    void PollerStoreRequest();
+    int PollerGetFreeRequest(poll_engine_t* engine);
+    bool PollerRequestConflicts(const poll_pid_t* entry, const poll_engine_t* engine=NULL);
+    bool PollerSendNext(bool fromTicker);
+    uint8_t PollerAdaptiveCeiling();
+    bool PollerSequenceAllowed();
+    void PollerTrackResponse(uint16_t code);
+    void PollerTrackFailure(bool txfailure);
+    void PollerBackoff();
+    void PollerDeliverReply(canbus* bus, uint8_t* data, uint8_t length);
+    void PollerDeliverError(canbus* bus, uint16_t code);
+    void PollerPrepareMultiDID(const poll_pid_t* entry);
+    void PollerSplitMultiDID(canbus* bus, const poll_pid_t* entry, std::string& response);
+    void PollerDeliverDID(canbus* bus, uint16_t did, uint8_t* data, uint16_t length);
+    void PollerMultiDIDFallback(const poll_pid_t* entry, int index);
+    poll_entry_stats_t* PollerEntryStats();
+    void PollerTrackFrame(poll_entry_stats_t* stats, const CAN_frame_t* frame, bool rx);
+    void PollerResetEngines();
+    bool PollerMatchFrame(poll_engine_t* engine, const CAN_frame_t* frame,
+                          int& index, uint32_t& msgid, vwtp_channel_t*& channel);
+    bool PollerExpectsFrame(const CAN_frame_t* frame);
+    void PollerSendBus(bool fromTicker);
+    void PollerStartEntry(const poll_pid_t* entry, bool fromTicker);
+    void PollerBuildSchedule(int64_t now);
+    void PollerArmTimer();
+    void PollerRunSchedule();
+    static void PollerTimerCallback(void* arg);
+    static void PollerBuildRequest(poll_pid_t& entry, const std::string& request);
+    bool PollerAsyncPending(canbus* bus);
+    bool PollerSendAsync(int slot, bool fromTicker);
+    bool PollerAsyncDone(int result);
+    void PollerAsyncExpire();
+
   protected:
     void PollSetPidList(canbus* bus, const poll_pid_t* plist);
     void PollSetState(uint8_t state);
     void PollSetThrottling(uint8_t sequence_max);
+    void PollSetMaxInFlight(canbus* bus, uint8_t inflight_max);
+    void PollSetAdaptiveThrottling(uint8_t ceiling);
     void PollSetResponseSeparationTime(uint8_t septime);
+    void PollSetResponseReassembly(bool enable);
     void PollSetChannelKeepalive(uint16_t keepalive_seconds);
+    void PollSetChannelPool(uint8_t channels);
     int PollSingleRequest(canbus* bus, uint32_t txid, uint32_t rxid,
                       std::string request, std::string& response,
                       int timeout_ms=3000, uint8_t protocol=ISOTP_STD);
     int PollSingleRequest(canbus* bus, uint32_t txid, uint32_t rxid,
                       uint8_t polltype, uint16_t pid, std::string& response,
                       int timeout_ms=3000, uint8_t protocol=ISOTP_STD);
+    bool PollSubmitRequest(canbus* bus, uint32_t txid, uint32_t rxid,
+                      std::string request, PollCallback callback,
+                      int timeout_ms=3000, uint8_t protocol=ISOTP_STD);
+    bool PollSubmitBatch(canbus* bus, const poll_batch_t& batch,
+                      PollBatchCallback callback, int timeout_ms=3000);
+    int PollBatchRequest(canbus* bus, poll_batch_t& batch, int timeout_ms=3000);
     const char* PollResultCodeName(int code);
 
+  public:
+    void PollerStatus(int verbosity, OvmsWriter* writer);
+    void PollerTimes(int verbosity, OvmsWriter* writer, bool json);
+    void PollerResetStats();
+
   private:
     void PollerISOTPStart(bool fromTicker);
     bool PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid);
+    void PollerISOTPTransmit();
 
   private:
     void PollerVWTPStart(bool fromTicker);
@@ -587,6 +1099,10 @@ class OvmsVehicle : public InternalRamAllocated
     void PollerVWTPEnter(vwtp_channelstate_t state);
     void PollerVWTPTicker();
     void PollerVWTPTxCallback(const CAN_frame_t* frame, bool success);
+    bool PollerVWTPSwapChannel();
+    void PollerVWTPPoolSend(vwtp_channel_t* channel, uint8_t opcode);
+    void PollerVWTPPoolClose(vwtp_channel_t* channel);
+    void PollerVWTPPoolReceive(CAN_frame_t* frame, vwtp_channel_t* channel);
 
   private:
     CanFrameCallback  m_poll_txcallback;      // Poller CAN TxCallback
@@ -599,6 +1115,26 @@ class OvmsVehicle : public InternalRamAllocated
 
 
   // BMS helpers
+  //
+  // Cell values, min/max, deviation maximums & alerts of a series are stored as a
+  // structure of arrays in one allocation per series (see BmsAllocStore()). Mean,
+  // variance (Welford), gradient sums & min/max cell are updated incrementally by
+  // each BmsSetCell…() call, so a complete series only needs the deviation check pass.
+  // The statistics use single precision (the ESP32 FPU has no double support), relative
+  // to a reference value to keep the precision, and are resynced every BMS_STATS_RESYNC.
+  protected:
+    typedef struct
+      {
+      float ref;                              // Reference value (mean at the last resync)
+      float dmean;                            // Running mean of the cell values - ref
+      float m2;                               // Running sum of squared differences from the mean
+      float isum;                             // Running sum of centered index * value (for the gradient)
+      float isqrsum;                          // Sum of squared index offsets (gradient divisor)
+      int imin;                               // Index of the min value, -1 = rescan needed
+      int imax;                               // Index of the max value, -1 = rescan needed
+      int series;                             // Series completed since the last exact resync
+      } bms_stats_t;
+
   protected:
     float* m_bms_voltages;                    // BMS voltages (current value)
     float* m_bms_vmins;                       // BMS minimum voltages seen (since reset)
@@ -634,9 +1170,23 @@ class OvmsVehicle : public InternalRamAllocated
     float m_bms_defthr_valert;                // Default voltage deviation alert threshold [V]
     float m_bms_defthr_twarn;                 // Default temperature deviation warn threshold [°C]
     float m_bms_defthr_talert;                // Default temperature deviation alert threshold [°C]
+    float m_bms_cfgthr_vmaxgrad;              // Configured voltage deviation max valid gradient [V] (-1 = default)
+    float m_bms_cfgthr_vmaxsddev;             // Configured voltage deviation max valid stddev deviation [V] (-1 = default)
+    float m_bms_cfgthr_vwarn;                 // Configured voltage deviation warn threshold [V] (-1 = default)
+    float m_bms_cfgthr_valert;                // Configured voltage deviation alert threshold [V] (-1 = default)
+    float m_bms_cfgthr_twarn;                 // Configured temperature deviation warn threshold [°C] (-1 = default)
+    float m_bms_cfgthr_talert;                // Configured temperature deviation alert threshold [°C] (-1 = default)
+    bms_stats_t m_bms_vstats;                 // Voltage series statistics
+    bms_stats_t m_bms_tstats;                 // Temperature series statistics
     uint32_t m_bms_vlog_last;                 // Last log time for voltages
     uint32_t m_bms_tlog_last;                 // Last log time for temperatures
 
+  private:
+    static float* BmsAllocStore(float* store, int readings, float** mins, float** maxs, float** devmaxs, short** alerts);
+    static void BmsStatsInit(bms_stats_t& stats, const float* values, int readings);
+    static void BmsStatsUpdate(bms_stats_t& stats, float* values, int readings, int index, float value);
+    static void BmsStatsComplete(bms_stats_t& stats, const float* values, int readings);
+
   protected:
     void BmsSetCellArrangementVoltage(int readings, int readingspermodule);
     void BmsSetCellArrangementTemperature(int readings, int readingspermodule);
@@ -661,6 +1211,68 @@ class OvmsVehicle : public InternalRamAllocated
     void BmsResetCellStats();
     virtual void BmsStatus(int verbosity, OvmsWriter* writer);
     virtual bool FormatBmsAlerts(int verbosity, OvmsWriter* writer, bool show_warnings);
+
+  // BMS cell history
+  //
+  // Records the cell voltages [mV] & temperatures [0.1 °C] of each complete series into
+  // PSRAM rings of three resolutions: raw samples, 1 minute and 10 minute min/avg/max
+  // aggregates. Enabled by config vehicle bms.history.size (total kB, 0 = off), split
+  // 25% raw / 35% 1 min / 40% 10 min. Export by 'bms history export' or /api/bms/history.
+  // Aggregation buckets are closed by the next sample or by the ticker after their period,
+  // exports are done in chunks without blocking the recording and are limited in size
+  // (newest records first).
+  public:
+    typedef enum
+      {
+      BmsHistory_Raw = 0,
+      BmsHistory_1Min,
+      BmsHistory_10Min,
+      BmsHistory_Levels
+      } bms_history_level_t;
+
+  protected:
+    typedef struct
+      {
+      uint8_t* data;                          // Record ring (PSRAM)
+      uint32_t recsize;                       // Record size [bytes]
+      uint32_t capacity;                      // Max records
+      uint32_t next;                          // Next write index
+      uint32_t count;                         // Records stored
+      uint32_t dropped;                       // Records overwritten
+      } bms_history_ring_t;
+    typedef struct
+      {
+      uint32_t start;                         // Bucket start time
+      uint32_t samples;                       // Samples aggregated (0 = empty)
+      int32_t* min;                           // Per channel minimum…
+      int32_t* max;                           // … maximum…
+      int32_t* sum;                           // … and sum
+      } bms_history_accu_t;
+
+    OvmsMutex m_bms_hist_mutex;
+    int m_bms_hist_size;                      // Configured size [kB], 0 = off
+    int m_bms_hist_nv;                        // Voltage channels of the current layout
+    int m_bms_hist_nt;                        // Temperature channels of the current layout
+    bms_history_ring_t m_bms_hist_ring[BmsHistory_Levels];
+    bms_history_accu_t m_bms_hist_accu[2];    // 1 min & 10 min aggregation buckets
+    int32_t* m_bms_hist_accudata;             // Accumulator arrays (PSRAM)
+    uint32_t m_bms_hist_gen;                  // Layout/reset generation (export consistency)
+
+  private:
+    bool BmsHistoryInit();
+    void BmsHistoryFree();
+    void BmsHistoryAdd();
+    uint8_t* BmsHistoryPut(bms_history_ring_t& ring);
+    void BmsHistoryFlush(bms_history_accu_t& accu, bms_history_ring_t& ring);
+    void BmsHistoryMerge(bms_history_accu_t& dst, bms_history_accu_t& src);
+    void BmsHistoryClose(uint32_t now);
+    void BmsHistoryTicker();
+
+  public:
+    static bool BmsHistoryLevel(const std::string& name, bms_history_level_t& level);
+    void BmsHistoryReset();
+    void BmsHistoryStatus(int verbosity, OvmsWriter* writer);
+    bool BmsHistoryExport(std::string& out, bms_history_level_t level, bool binary, int maxrecords=0);
   };
 
 template<typename Type> OvmsVehicle* CreateVehicle()
@@ -725,9 +1337,22 @@ class OvmsVehicleFactory
     static void vehicle_charge_stop(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
     static void vehicle_charge_cooldown(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
     static void vehicle_stat(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void vehicle_poller_status(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void vehicle_poller_times(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void vehicle_poller_reset(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void vehicle_frames_status(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void vehicle_frames_reset(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void vehicle_timers_status(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void vehicle_timers_reset(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void vehicle_profile_status(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void vehicle_profile_enable(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void vehicle_profile_reset(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
     static void bms_status(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
     static void bms_reset(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
     static void bms_alerts(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void bms_history_status(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void bms_history_export(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void bms_history_reset(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
     static void obdii_request(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
 
 #ifdef CONFIG_OVMS_SC_JAVASCRIPT_DUKTAPE
@@ -48,19 +48,123 @@ static const char *TAG = "vehicle";
 // Voltage stddev running average sample count:
 #define VSTDDEV_SMOOTHCNT         5
 
+// Number of series after which the running statistics are recalculated exactly
+// (to eliminate accumulated rounding errors):
+#define BMS_STATS_RESYNC          100
+
+
+/**
+ * BmsAllocStore: internal: (re)allocate a cell series store
+ *  The store is a single block holding the arrays values[], mins[], maxs[], devmaxs[]
+ *  and alerts[] of a series consecutively. Cell values are initialized to zero.
+ *  @param store        previous store (values pointer) to free or NULL
+ *  @return             new store (values pointer)
+ */
+float* OvmsVehicle::BmsAllocStore(float* store, int readings, float** mins, float** maxs,
+                                  float** devmaxs, short** alerts)
+  {
+  if (store != NULL) delete [] store;
+  int floats = 4 * readings + (readings * sizeof(short) + sizeof(float) - 1) / sizeof(float);
+  store = new float[floats];
+  memset(store, 0, floats * sizeof(float));
+  *mins = store + readings;
+  *maxs = store + 2 * readings;
+  *devmaxs = store + 3 * readings;
+  *alerts = (short*) (store + 4 * readings);
+  return store;
+  }
+
+/**
+ * BmsStatsInit: internal: calculate the series statistics from the cell values
+ */
+void OvmsVehicle::BmsStatsInit(bms_stats_t& stats, const float* values, int readings)
+  {
+  // Single pass over the offsets from the first cell (small values, so float is precise):
+  float v0 = (readings > 0) ? values[0] : 0;
+  float center = (readings - 1) * 0.5f;
+  float sum = 0, sqrsum = 0, isum = 0, isqrsum = 0;
+  int imin = 0, imax = 0;
+  for (int i=0; i<readings; i++)
+    {
+    float d = values[i] - v0;
+    sum += d;
+    sqrsum += d * d;
+    isum += (i - center) * d;
+    isqrsum += SQR(i - (readings / 2 - 0.5f));
+    if (values[i] < values[imin]) imin = i;
+    if (values[i] > values[imax]) imax = i;
+    }
+  float dmean = (readings > 0) ? sum / readings : 0;
+  stats.ref = v0 + dmean;
+  stats.dmean = 0;
+  stats.m2 = LIMIT_MIN(sqrsum - readings * dmean * dmean, 0);
+  stats.isum = isum;
+  stats.isqrsum = isqrsum;
+  stats.imin = (readings > 0) ? imin : -1;
+  stats.imax = (readings > 0) ? imax : -1;
+  stats.series = 0;
+  }
+
+/**
+ * BmsStatsUpdate: internal: replace a cell value, update the series statistics
+ *  Mean & variance use Welford's update for replacing a value in a set of fixed size,
+ *  min & max are tracked by index and only need a rescan if the min/max cell value
+ *  moves inwards.
+ */
+void OvmsVehicle::BmsStatsUpdate(bms_stats_t& stats, float* values, int readings, int index, float value)
+  {
+  float old = values[index];
+  float delta = value - old;
+  float dmean_old = stats.dmean;
+  stats.dmean += delta / readings;
+  stats.m2 += delta * ((value - stats.ref - stats.dmean) + (old - stats.ref - dmean_old));
+  stats.isum += delta * (index - (readings - 1) * 0.5f);
+
+  if (stats.imin >= 0)
+    {
+    if (index == stats.imin)
+      { if (value > old) stats.imin = -1; }
+    else if (value < values[stats.imin])
+      stats.imin = index;
+    }
+  if (stats.imax >= 0)
+    {
+    if (index == stats.imax)
+      { if (value < old) stats.imax = -1; }
+    else if (value > values[stats.imax])
+      stats.imax = index;
+    }
+
+  values[index] = value;
+  }
+
+/**
+ * BmsStatsComplete: internal: series complete, resolve min/max & resync if due
+ */
+void OvmsVehicle::BmsStatsComplete(bms_stats_t& stats, const float* values, int readings)
+  {
+  if (++stats.series >= BMS_STATS_RESYNC)
+    {
+    BmsStatsInit(stats, values, readings);
+    }
+  else if (stats.imin < 0 || stats.imax < 0)
+    {
+    int imin = 0, imax = 0;
+    for (int i=1; i<readings; i++)
+      {
+      if (values[i] < values[imin]) imin = i;
+      if (values[i] > values[imax]) imax = i;
+      }
+    stats.imin = imin;
+    stats.imax = imax;
+    }
+  }
+
 
 void OvmsVehicle::BmsSetCellArrangementVoltage(int readings, int readingspermodule)
   {
-  if (m_bms_voltages != NULL) delete m_bms_voltages;
-  m_bms_voltages = new float[readings];
-  if (m_bms_vmins != NULL) delete m_bms_vmins;
-  m_bms_vmins = new float[readings];
-  if (m_bms_vmaxs != NULL) delete m_bms_vmaxs;
-  m_bms_vmaxs = new float[readings];
-  if (m_bms_vdevmaxs != NULL) delete m_bms_vdevmaxs;
-  m_bms_vdevmaxs = new float[readings];
-  if (m_bms_valerts != NULL) delete m_bms_valerts;
-  m_bms_valerts = new short[readings];
+  m_bms_voltages = BmsAllocStore(m_bms_voltages, readings,
+    &m_bms_vmins, &m_bms_vmaxs, &m_bms_vdevmaxs, &m_bms_valerts);
   m_bms_valerts_new = 0;
 
   m_bms_bitset_v.clear();
@@ -74,16 +178,8 @@ void OvmsVehicle::BmsSetCellArrangementVoltage(int readings, int readingspermodu
 
 void OvmsVehicle::BmsSetCellArrangementTemperature(int readings, int readingspermodule)
   {
-  if (m_bms_temperatures != NULL) delete m_bms_temperatures;
-  m_bms_temperatures = new float[readings];
-  if (m_bms_tmins != NULL) delete m_bms_tmins;
-  m_bms_tmins = new float[readings];
-  if (m_bms_tmaxs != NULL) delete m_bms_tmaxs;
-  m_bms_tmaxs = new float[readings];
-  if (m_bms_tdevmaxs != NULL) delete m_bms_tdevmaxs;
-  m_bms_tdevmaxs = new float[readings];
-  if (m_bms_talerts != NULL) delete m_bms_talerts;
-  m_bms_talerts = new short[readings];
+  m_bms_temperatures = BmsAllocStore(m_bms_temperatures, readings,
+    &m_bms_tmins, &m_bms_tmaxs, &m_bms_tdevmaxs, &m_bms_talerts);
   m_bms_talerts_new = 0;
 
   m_bms_bitset_t.clear();
@@ -156,7 +252,7 @@ void OvmsVehicle::BmsSetCellVoltage(int index, float value)
   // ESP_LOGV(TAG,"BmsSetCellVoltage(%d,%f) c=%d", index, value, m_bms_bitset_cv);
   if ((index<0)||(index>=m_bms_readings_v)) return;
   if ((value<m_bms_limit_vmin)||(value>m_bms_limit_vmax)) return;
-  m_bms_voltages[index] = value;
+  BmsStatsUpdate(m_bms_vstats, m_bms_voltages, m_bms_readings_v, index, value);
 
   if (! m_bms_has_voltages)
     {
@@ -172,34 +268,19 @@ void OvmsVehicle::BmsSetCellVoltage(int index, float value)
   if (m_bms_bitset_cv == m_bms_readings_v)
     {
     // Series complete, all cell voltages acquired
-    float thr_maxgrad  = MyConfig.GetParamValueFloat("vehicle", "bms.dev.voltage.maxgrad",  m_bms_defthr_vmaxgrad);
-    float thr_maxsddev = MyConfig.GetParamValueFloat("vehicle", "bms.dev.voltage.maxsddev", m_bms_defthr_vmaxsddev);
-    float thr_warn     = MyConfig.GetParamValueFloat("vehicle", "bms.dev.voltage.warn",     m_bms_defthr_vwarn);
-    float thr_alert    = MyConfig.GetParamValueFloat("vehicle", "bms.dev.voltage.alert",    m_bms_defthr_valert);
-
-    // Get min, max, avg & standard deviation:
-    double sum=0, sqrsum=0, avg, stddev=0;
-    float min=0, max=0;
-    for (int i=0; i<m_bms_readings_v; i++)
-      {
-      sum += m_bms_voltages[i];
-      sqrsum += SQR(m_bms_voltages[i]);
-      if (min==0 || m_bms_voltages[i]<min)
-        min = m_bms_voltages[i];
-      if (max==0 || m_bms_voltages[i]>max)
-        max = m_bms_voltages[i];
-      }
-    avg = sum / m_bms_readings_v;
-    stddev = sqrt(LIMIT_MIN((sqrsum / m_bms_readings_v) - SQR(avg), 0));
-
-    // Get gradient:
-    double sumn = 0, sumd = 0;
-    for (int i=0; i<m_bms_readings_v; i++)
-      {
-      sumn += (i - (m_bms_readings_v / 2 - 0.5)) * (m_bms_voltages[i] - avg);
-      sumd += SQR(i - (m_bms_readings_v / 2 - 0.5));
-      }
-    float grad = (sumn / sumd) * m_bms_readings_v;
+    float thr_maxgrad  = (m_bms_cfgthr_vmaxgrad  >= 0) ? m_bms_cfgthr_vmaxgrad  : m_bms_defthr_vmaxgrad;
+    float thr_maxsddev = (m_bms_cfgthr_vmaxsddev >= 0) ? m_bms_cfgthr_vmaxsddev : m_bms_defthr_vmaxsddev;
+    float thr_warn     = (m_bms_cfgthr_vwarn     >= 0) ? m_bms_cfgthr_vwarn     : m_bms_defthr_vwarn;
+    float thr_alert    = (m_bms_cfgthr_valert    >= 0) ? m_bms_cfgthr_valert    : m_bms_defthr_valert;
+
+    // Get min, max, avg, standard deviation & gradient from the running statistics:
+    int n = m_bms_readings_v;
+    BmsStatsComplete(m_bms_vstats, m_bms_voltages, n);
+    float min = m_bms_voltages[m_bms_vstats.imin];
+    float max = m_bms_voltages[m_bms_vstats.imax];
+    float avg = m_bms_vstats.ref + m_bms_vstats.dmean;
+    float stddev = sqrtf(LIMIT_MIN(m_bms_vstats.m2 / n, 0));
+    float grad = (m_bms_vstats.isqrsum > 0) ? m_bms_vstats.isum / m_bms_vstats.isqrsum * n : 0;
 
     // …publish to metrics:
     StandardMetrics.ms_v_bat_pack_vmin->SetValue(min);
@@ -207,9 +288,9 @@ void OvmsVehicle::BmsSetCellVoltage(int index, float value)
     StandardMetrics.ms_v_bat_pack_vavg->SetValue(ROUNDPREC(avg, 5));
     StandardMetrics.ms_v_bat_pack_vstddev->SetValue(ROUNDPREC(stddev, 5));
     StandardMetrics.ms_v_bat_pack_vgrad->SetValue(ROUNDPREC(grad, 5));
-    StandardMetrics.ms_v_bat_cell_voltage->SetElemValues(0, m_bms_readings_v, m_bms_voltages);
-    StandardMetrics.ms_v_bat_cell_vmin->SetElemValues(0, m_bms_readings_v, m_bms_vmins);
-    StandardMetrics.ms_v_bat_cell_vmax->SetElemValues(0, m_bms_readings_v, m_bms_vmaxs);
+    StandardMetrics.ms_v_bat_cell_voltage->SetElemValues(0, n, m_bms_voltages);
+    StandardMetrics.ms_v_bat_cell_vmin->SetElemValues(0, n, m_bms_vmins);
+    StandardMetrics.ms_v_bat_cell_vmax->SetElemValues(0, n, m_bms_vmaxs);
 
     // Voltages are very volatile and may respond to a load change within the sensor query loop.
     // To detect an inconsistent series, we check for a too high gradient and/or a too high
@@ -236,29 +317,31 @@ void OvmsVehicle::BmsSetCellVoltage(int index, float value)
       series_valid = true;
       }
 
-    // Check cell deviations only if the series appears to be consistent:
+    // Check cell deviations only if the series appears to be consistent
+    // (single precision, no calls in the common case):
     if (series_valid)
       {
-      float dev;
-      for (int i=0; i<m_bms_readings_v; i++)
+      float lvl_warn = stddev + thr_warn, lvl_alert = stddev + thr_alert;
+      for (int i=0; i<n; i++)
         {
-        dev = ROUNDPREC(m_bms_voltages[i] - avg, 5);
-        if (ABS(dev) > ABS(m_bms_vdevmaxs[i]))
-          m_bms_vdevmaxs[i] = dev;
-        if (ABS(dev) >= stddev + thr_alert && m_bms_valerts[i] < 2)
+        float dev = m_bms_voltages[i] - avg;
+        float absdev = fabsf(dev);
+        if (absdev > fabsf(m_bms_vdevmaxs[i]))
+          m_bms_vdevmaxs[i] = ROUNDPREC(dev, 5);
+        short level = (absdev >= lvl_alert) ? 2 : (absdev >= lvl_warn) ? 1 : 0;
+        if (level > m_bms_valerts[i])
           {
-          m_bms_valerts[i] = 2;
-          m_bms_valerts_new++; // trigger notification
+          if (level == 2)
+            m_bms_valerts_new++; // trigger notification
+          m_bms_valerts[i] = level;
           }
-        else if (ABS(dev) >= stddev + thr_warn && m_bms_valerts[i] < 1)
-          m_bms_valerts[i] = 1;
         }
 
       // Publish deviation maximums & alerts:
       if (stddev > StandardMetrics.ms_v_bat_pack_vstddev_max->AsFloat())
         StandardMetrics.ms_v_bat_pack_vstddev_max->SetValue(stddev);
-      StandardMetrics.ms_v_bat_cell_vdevmax->SetElemValues(0, m_bms_readings_v, m_bms_vdevmaxs);
-      StandardMetrics.ms_v_bat_cell_valert->SetElemValues(0, m_bms_readings_v, m_bms_valerts);
+      StandardMetrics.ms_v_bat_cell_vdevmax->SetElemValues(0, n, m_bms_vdevmaxs);
+      StandardMetrics.ms_v_bat_cell_valert->SetElemValues(0, n, m_bms_valerts);
       }
 
     // complete:
@@ -266,6 +349,7 @@ void OvmsVehicle::BmsSetCellVoltage(int index, float value)
     m_bms_bitset_v.clear();
     m_bms_bitset_v.resize(m_bms_readings_v);
     m_bms_bitset_cv = 0;
+    BmsHistoryAdd();
     }
   else
     {
@@ -278,7 +362,7 @@ void OvmsVehicle::BmsSetCellTemperature(int index, float value)
   // ESP_LOGV(TAG,"BmsSetCellTemperature(%d,%f) c=%d", index, value, m_bms_bitset_ct);
   if ((index<0)||(index>=m_bms_readings_t)) return;
   if ((value<m_bms_limit_tmin)||(value>m_bms_limit_tmax)) return;
-  m_bms_temperatures[index] = value;
+  BmsStatsUpdate(m_bms_tstats, m_bms_temperatures, m_bms_readings_t, index, value);
 
   if (! m_bms_has_temperatures)
     {
@@ -294,38 +378,32 @@ void OvmsVehicle::BmsSetCellTemperature(int index, float value)
   if (m_bms_bitset_ct == m_bms_readings_t)
     {
     // Series complete, all cell temperatures acquired
-    float thr_warn  = MyConfig.GetParamValueFloat("vehicle", "bms.dev.temp.warn", m_bms_defthr_twarn);
-    float thr_alert = MyConfig.GetParamValueFloat("vehicle", "bms.dev.temp.alert", m_bms_defthr_talert);
+    float thr_warn  = (m_bms_cfgthr_twarn  >= 0) ? m_bms_cfgthr_twarn  : m_bms_defthr_twarn;
+    float thr_alert = (m_bms_cfgthr_talert >= 0) ? m_bms_cfgthr_talert : m_bms_defthr_talert;
 
-    // get min, max, avg & standard deviation:
-    double sum=0, sqrsum=0, avg, stddev=0;
-    float min=0, max=0;
-    for (int i=0; i<m_bms_readings_t; i++)
-      {
-      sum += m_bms_temperatures[i];
-      sqrsum += SQR(m_bms_temperatures[i]);
-      if (min==0 || m_bms_temperatures[i]<min)
-        min = m_bms_temperatures[i];
-      if (max==0 || m_bms_temperatures[i]>max)
-        max = m_bms_temperatures[i];
-      }
-    avg = sum / m_bms_readings_t;
-    stddev = sqrt(LIMIT_MIN((sqrsum / m_bms_readings_t) - SQR(avg), 0));
+    // get min, max, avg & standard deviation from the running statistics:
+    int n = m_bms_readings_t;
+    BmsStatsComplete(m_bms_tstats, m_bms_temperatures, n);
+    float min = m_bms_temperatures[m_bms_tstats.imin];
+    float max = m_bms_temperatures[m_bms_tstats.imax];
+    float avg = m_bms_tstats.ref + m_bms_tstats.dmean;
+    float stddev = sqrtf(LIMIT_MIN(m_bms_tstats.m2 / n, 0));
 
     // check cell deviations:
-    float dev;
-    for (int i=0; i<m_bms_readings_t; i++)
+    float lvl_warn = stddev + thr_warn, lvl_alert = stddev + thr_alert;
+    for (int i=0; i<n; i++)
       {
-      dev = ROUNDPREC(m_bms_temperatures[i] - avg, 2);
-      if (ABS(dev) > ABS(m_bms_tdevmaxs[i]))
-        m_bms_tdevmaxs[i] = dev;
-      if (ABS(dev) >= stddev + thr_alert && m_bms_talerts[i] < 2)
+      float dev = m_bms_temperatures[i] - avg;
+      float absdev = fabsf(dev);
+      if (absdev > fabsf(m_bms_tdevmaxs[i]))
+        m_bms_tdevmaxs[i] = ROUNDPREC(dev, 2);
+      short level = (absdev >= lvl_alert) ? 2 : (absdev >= lvl_warn) ? 1 : 0;
+      if (level > m_bms_talerts[i])
         {
-        m_bms_talerts[i] = 2;
-        m_bms_talerts_new++; // trigger notification
+        if (level == 2)
+          m_bms_talerts_new++; // trigger notification
+        m_bms_talerts[i] = level;
         }
-      else if (ABS(dev) >= stddev + thr_warn && m_bms_valerts[i] < 1)
-        m_bms_talerts[i] = 1;
       }
 
     // publish to metrics:
@@ -337,17 +415,19 @@ void OvmsVehicle::BmsSetCellTemperature(int index, float value)
     StandardMetrics.ms_v_bat_pack_tstddev->SetValue(stddev);
     if (stddev > StandardMetrics.ms_v_bat_pack_tstddev_max->AsFloat())
       StandardMetrics.ms_v_bat_pack_tstddev_max->SetValue(stddev);
-    StandardMetrics.ms_v_bat_cell_temp->SetElemValues(0, m_bms_readings_t, m_bms_temperatures);
-    StandardMetrics.ms_v_bat_cell_tmin->SetElemValues(0, m_bms_readings_t, m_bms_tmins);
-    StandardMetrics.ms_v_bat_cell_tmax->SetElemValues(0, m_bms_readings_t, m_bms_tmaxs);
-    StandardMetrics.ms_v_bat_cell_tdevmax->SetElemValues(0, m_bms_readings_t, m_bms_tdevmaxs);
-    StandardMetrics.ms_v_bat_cell_talert->SetElemValues(0, m_bms_readings_t, m_bms_talerts);
+    StandardMetrics.ms_v_bat_cell_temp->SetElemValues(0, n, m_bms_temperatures);
+    StandardMetrics.ms_v_bat_cell_tmin->SetElemValues(0, n, m_bms_tmins);
+    StandardMetrics.ms_v_bat_cell_tmax->SetElemValues(0, n, m_bms_tmaxs);
+    StandardMetrics.ms_v_bat_cell_tdevmax->SetElemValues(0, n, m_bms_tdevmaxs);
+    StandardMetrics.ms_v_bat_cell_talert->SetElemValues(0, n, m_bms_talerts);
 
     // complete:
     m_bms_has_temperatures = true;
     m_bms_bitset_t.clear();
     m_bms_bitset_t.resize(m_bms_readings_t);
     m_bms_bitset_ct = 0;
+    if (m_bms_readings_v == 0)
+      BmsHistoryAdd();
     }
   else
     {
@@ -365,7 +445,7 @@ void OvmsVehicle::BmsRestartCellVoltages()
 void OvmsVehicle::BmsRestartCellTemperatures()
   {
   m_bms_bitset_t.clear();
-  m_bms_bitset_v.resize(m_bms_readings_t);
+  m_bms_bitset_t.resize(m_bms_readings_t);
   m_bms_bitset_ct = 0;
   }
 
@@ -387,6 +467,7 @@ void OvmsVehicle::BmsResetCellVoltages(bool full /*=false*/)
     m_bms_valerts_new = 0;
     m_bms_vstddev_cnt = 0;
     m_bms_vstddev_avg = 0;
+    BmsStatsInit(m_bms_vstats, m_bms_voltages, m_bms_readings_v);
     if (full) StandardMetrics.ms_v_bat_cell_voltage->ClearValue();
     StandardMetrics.ms_v_bat_cell_vmin->ClearValue();
     StandardMetrics.ms_v_bat_cell_vmax->ClearValue();
@@ -412,6 +493,7 @@ void OvmsVehicle::BmsResetCellTemperatures(bool full /*=false*/)
       m_bms_talerts[k] = 0;
       }
     m_bms_talerts_new = 0;
+    BmsStatsInit(m_bms_tstats, m_bms_temperatures, m_bms_readings_t);
     if (full) StandardMetrics.ms_v_bat_cell_temp->ClearValue();
     StandardMetrics.ms_v_bat_cell_tmin->ClearValue();
     StandardMetrics.ms_v_bat_cell_tmax->ClearValue();
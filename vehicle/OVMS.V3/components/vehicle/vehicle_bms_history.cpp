@@ -0,0 +1,566 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Date:          14th March 2017
+;
+;    Changes:
+;    1.0  Initial release
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011        Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+#include "ovms_log.h"
+static const char *TAG = "vehicle-bmshist";
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "ovms_malloc.h"
+#include "vehicle.h"
+
+// History memory split [percent of bms.history.size]:
+#define BMS_HIST_SHARE_RAW      25
+#define BMS_HIST_SHARE_1MIN     35
+#define BMS_HIST_SHARE_10MIN    40
+
+// Export: output size limit [bytes] (the newest records fitting are exported),
+//  records copied per mutex lock:
+#define BMS_HIST_EXPORT_MAXSIZE (256*1024)
+#define BMS_HIST_EXPORT_CHUNK   4096
+
+// Binary export header (little endian), followed by the records, oldest first:
+//  Raw record:       uint32 time, uint16 value[channels]
+//  Aggregate record: uint32 time, uint16 samples, uint16 { min, avg, max }[channels]
+//  Channels: voltages [mV] (unsigned) followed by temperatures [0.1 °C] (signed)
+#define BMS_HIST_MAGIC          "OVBH"
+#define BMS_HIST_VERSION        1
+typedef struct __attribute__((packed))
+  {
+  char magic[4];
+  uint8_t version;
+  uint8_t level;                            // bms_history_level_t
+  uint16_t nv;                              // Voltage channels
+  uint16_t nt;                              // Temperature channels
+  uint16_t recsize;                         // Record size [bytes]
+  uint32_t count;                           // Records following
+  } bms_history_header_t;
+
+static const char* const bms_history_level_names[] = { "raw", "1m", "10m" };
+
+
+/**
+ * Channel value encoding: voltages as unsigned mV, temperatures as signed 0.1 °C
+ */
+static inline uint16_t EncodeVoltage(float value)
+  {
+  int32_t v = value * 1000 + 0.5f;
+  return (v < 0) ? 0 : (v > 65535) ? 65535 : v;
+  }
+
+static inline uint16_t EncodeTemperature(float value)
+  {
+  int32_t v = (value < 0) ? value * 10 - 0.5f : value * 10 + 0.5f;
+  return (uint16_t) (int16_t) ((v < -32768) ? -32768 : (v > 32767) ? 32767 : v);
+  }
+
+static inline int32_t DecodeValue(uint16_t raw, bool voltage)
+  {
+  return voltage ? (int32_t) raw : (int32_t) (int16_t) raw;
+  }
+
+
+/**
+ * BmsHistoryLevel: translate level name ("raw", "1m", "10m")
+ */
+bool OvmsVehicle::BmsHistoryLevel(const std::string& name, bms_history_level_t& level)
+  {
+  for (int i = 0; i < BmsHistory_Levels; i++)
+    {
+    if (name == bms_history_level_names[i])
+      {
+      level = (bms_history_level_t) i;
+      return true;
+      }
+    }
+  return false;
+  }
+
+/**
+ * BmsHistoryFree: internal: free history memory
+ *  Note: m_bms_hist_mutex must be held by the caller
+ */
+void OvmsVehicle::BmsHistoryFree()
+  {
+  for (int i = 0; i < BmsHistory_Levels; i++)
+    {
+    if (m_bms_hist_ring[i].data)
+      free(m_bms_hist_ring[i].data);
+    memset(&m_bms_hist_ring[i], 0, sizeof(bms_history_ring_t));
+    }
+  if (m_bms_hist_accudata)
+    free(m_bms_hist_accudata);
+  m_bms_hist_accudata = NULL;
+  memset(m_bms_hist_accu, 0, sizeof(m_bms_hist_accu));
+  m_bms_hist_nv = m_bms_hist_nt = 0;
+  m_bms_hist_gen++;
+  }
+
+/**
+ * BmsHistoryInit: internal: allocate history for the current cell arrangement
+ *  Note: m_bms_hist_mutex must be held by the caller
+ */
+bool OvmsVehicle::BmsHistoryInit()
+  {
+  BmsHistoryFree();
+
+  int nch = m_bms_readings_v + m_bms_readings_t;
+  if (m_bms_hist_size <= 0 || nch == 0)
+    return false;
+
+  const int share[BmsHistory_Levels] = { BMS_HIST_SHARE_RAW, BMS_HIST_SHARE_1MIN, BMS_HIST_SHARE_10MIN };
+  for (int i = 0; i < BmsHistory_Levels; i++)
+    {
+    bms_history_ring_t& ring = m_bms_hist_ring[i];
+    ring.recsize = (i == BmsHistory_Raw) ? 4 + 2 * nch : 6 + 6 * nch;
+    ring.capacity = (uint32_t) m_bms_hist_size * 1024 * share[i] / 100 / ring.recsize;
+    if (ring.capacity == 0)
+      {
+      ESP_LOGW(TAG, "bms.history.size %d kB too small for %d channels", m_bms_hist_size, nch);
+      BmsHistoryFree();
+      return false;
+      }
+    ring.data = (uint8_t*) ExternalRamMalloc(ring.capacity * ring.recsize);
+    if (!ring.data)
+      {
+      ESP_LOGE(TAG, "BmsHistoryInit: can't allocate %u bytes", ring.capacity * ring.recsize);
+      BmsHistoryFree();
+      return false;
+      }
+    }
+
+  m_bms_hist_accudata = (int32_t*) ExternalRamMalloc(2 * 3 * nch * sizeof(int32_t));
+  if (!m_bms_hist_accudata)
+    {
+    ESP_LOGE(TAG, "BmsHistoryInit: can't allocate accumulators");
+    BmsHistoryFree();
+    return false;
+    }
+  for (int i = 0; i < 2; i++)
+    {
+    m_bms_hist_accu[i].min = m_bms_hist_accudata + (3 * i + 0) * nch;
+    m_bms_hist_accu[i].max = m_bms_hist_accudata + (3 * i + 1) * nch;
+    m_bms_hist_accu[i].sum = m_bms_hist_accudata + (3 * i + 2) * nch;
+    }
+
+  m_bms_hist_nv = m_bms_readings_v;
+  m_bms_hist_nt = m_bms_readings_t;
+  ESP_LOGI(TAG, "BMS history: %d voltages, %d temperatures, %u raw / %u 1 min / %u 10 min records",
+    m_bms_hist_nv, m_bms_hist_nt, m_bms_hist_ring[0].capacity, m_bms_hist_ring[1].capacity,
+    m_bms_hist_ring[2].capacity);
+  return true;
+  }
+
+/**
+ * BmsHistoryReset: clear all history records
+ */
+void OvmsVehicle::BmsHistoryReset()
+  {
+  OvmsMutexLock lock(&m_bms_hist_mutex);
+  for (int i = 0; i < BmsHistory_Levels; i++)
+    {
+    m_bms_hist_ring[i].next = 0;
+    m_bms_hist_ring[i].count = 0;
+    m_bms_hist_ring[i].dropped = 0;
+    }
+  m_bms_hist_accu[0].samples = 0;
+  m_bms_hist_accu[1].samples = 0;
+  m_bms_hist_gen++;
+  }
+
+/**
+ * BmsHistoryPut: internal: get the next ring record to write
+ */
+uint8_t* OvmsVehicle::BmsHistoryPut(bms_history_ring_t& ring)
+  {
+  uint8_t* rec = ring.data + ring.next * ring.recsize;
+  if (++ring.next == ring.capacity)
+    ring.next = 0;
+  if (ring.count < ring.capacity)
+    ring.count++;
+  else
+    ring.dropped++;
+  return rec;
+  }
+
+/**
+ * BmsHistoryFlush: internal: write an aggregation bucket to a ring & clear it
+ */
+void OvmsVehicle::BmsHistoryFlush(bms_history_accu_t& accu, bms_history_ring_t& ring)
+  {
+  if (accu.samples == 0)
+    return;
+  int nch = m_bms_hist_nv + m_bms_hist_nt;
+  uint8_t* rec = BmsHistoryPut(ring);
+  uint16_t samples = (accu.samples > 65535) ? 65535 : accu.samples;
+  memcpy(rec, &accu.start, 4);
+  memcpy(rec + 4, &samples, 2);
+  uint16_t* vals = (uint16_t*) (rec + 6);
+  for (int ch = 0; ch < nch; ch++)
+    {
+    int32_t avg = (accu.sum[ch] + (int32_t) accu.samples / 2) / (int32_t) accu.samples;
+    *vals++ = (uint16_t) accu.min[ch];
+    *vals++ = (uint16_t) avg;
+    *vals++ = (uint16_t) accu.max[ch];
+    }
+  accu.samples = 0;
+  }
+
+/**
+ * BmsHistoryMerge: internal: add an aggregation bucket to a lower resolution bucket
+ */
+void OvmsVehicle::BmsHistoryMerge(bms_history_accu_t& dst, bms_history_accu_t& src)
+  {
+  int nch = m_bms_hist_nv + m_bms_hist_nt;
+  if (dst.samples == 0)
+    {
+    dst.start = src.start;
+    memcpy(dst.min, src.min, nch * sizeof(int32_t));
+    memcpy(dst.max, src.max, nch * sizeof(int32_t));
+    memcpy(dst.sum, src.sum, nch * sizeof(int32_t));
+    }
+  else
+    {
+    for (int ch = 0; ch < nch; ch++)
+      {
+      if (src.min[ch] < dst.min[ch]) dst.min[ch] = src.min[ch];
+      if (src.max[ch] > dst.max[ch]) dst.max[ch] = src.max[ch];
+      dst.sum[ch] += src.sum[ch];
+      }
+    }
+  dst.samples += src.samples;
+  }
+
+/**
+ * BmsHistoryClose: internal: write aggregation buckets whose period has ended
+ *  Note: m_bms_hist_mutex must be held by the caller
+ */
+void OvmsVehicle::BmsHistoryClose(uint32_t now)
+  {
+  bms_history_accu_t& accu1 = m_bms_hist_accu[0];
+  bms_history_accu_t& accu10 = m_bms_hist_accu[1];
+  if (accu1.samples && accu1.start / 60 != now / 60)
+    {
+    if (accu10.samples && accu10.start / 600 != accu1.start / 600)
+      BmsHistoryFlush(accu10, m_bms_hist_ring[BmsHistory_10Min]);
+    BmsHistoryMerge(accu10, accu1);
+    BmsHistoryFlush(accu1, m_bms_hist_ring[BmsHistory_1Min]);
+    }
+  if (accu10.samples && accu10.start / 600 != now / 600)
+    BmsHistoryFlush(accu10, m_bms_hist_ring[BmsHistory_10Min]);
+  }
+
+/**
+ * BmsHistoryTicker: internal: close pending aggregation buckets on timeout
+ *  Without new samples (vehicle off, polling stopped), the buckets would stay pending
+ *  until the next sample, so they are also closed here once their period has ended.
+ */
+void OvmsVehicle::BmsHistoryTicker()
+  {
+  if (m_bms_hist_size <= 0)
+    return;
+  OvmsMutexLock lock(&m_bms_hist_mutex);
+  if (m_bms_hist_ring[BmsHistory_Raw].data)
+    BmsHistoryClose(time(NULL));
+  }
+
+/**
+ * BmsHistoryAdd: internal: record the current cell values
+ *  Called on series completion, records only if all series of the vehicle are complete.
+ */
+void OvmsVehicle::BmsHistoryAdd()
+  {
+  if (m_bms_hist_size <= 0)
+    return;
+  if ((m_bms_readings_v > 0 && !m_bms_has_voltages) || (m_bms_readings_t > 0 && !m_bms_has_temperatures))
+    return;
+
+  OvmsMutexLock lock(&m_bms_hist_mutex);
+  if (!m_bms_hist_ring[BmsHistory_Raw].data || m_bms_hist_nv != m_bms_readings_v || m_bms_hist_nt != m_bms_readings_t)
+    {
+    if (!BmsHistoryInit())
+      {
+      m_bms_hist_size = -1; // failed, don't retry until config change
+      return;
+      }
+    }
+
+  int nv = m_bms_hist_nv, nch = m_bms_hist_nv + m_bms_hist_nt;
+  uint32_t now = time(NULL);
+
+  // Raw sample:
+  uint8_t* rec = BmsHistoryPut(m_bms_hist_ring[BmsHistory_Raw]);
+  memcpy(rec, &now, 4);
+  uint16_t* vals = (uint16_t*) (rec + 4);
+  for (int i = 0; i < nv; i++)
+    vals[i] = EncodeVoltage(m_bms_voltages[i]);
+  for (int i = 0; i < m_bms_hist_nt; i++)
+    vals[nv + i] = EncodeTemperature(m_bms_temperatures[i]);
+
+  // Close finished aggregation buckets:
+  BmsHistoryClose(now);
+
+  // Add sample to the 1 minute bucket:
+  bms_history_accu_t& accu1 = m_bms_hist_accu[0];
+  if (accu1.samples == 0)
+    {
+    accu1.start = now;
+    for (int ch = 0; ch < nch; ch++)
+      {
+      int32_t v = DecodeValue(vals[ch], ch < nv);
+      accu1.min[ch] = accu1.max[ch] = accu1.sum[ch] = v;
+      }
+    }
+  else
+    {
+    for (int ch = 0; ch < nch; ch++)
+      {
+      int32_t v = DecodeValue(vals[ch], ch < nv);
+      if (v < accu1.min[ch]) accu1.min[ch] = v;
+      if (v > accu1.max[ch]) accu1.max[ch] = v;
+      accu1.sum[ch] += v;
+      }
+    }
+  accu1.samples++;
+  }
+
+/**
+ * BmsHistoryStatus: output history configuration & fill levels
+ */
+void OvmsVehicle::BmsHistoryStatus(int verbosity, OvmsWriter* writer)
+  {
+  OvmsMutexLock lock(&m_bms_hist_mutex);
+  if (m_bms_hist_size == 0)
+    {
+    writer->puts("BMS history disabled (config vehicle bms.history.size = 0)");
+    return;
+    }
+  else if (m_bms_hist_size < 0)
+    {
+    writer->puts("BMS history failed to initialize, see log");
+    return;
+    }
+  if (!m_bms_hist_ring[BmsHistory_Raw].data)
+    {
+    writer->printf("BMS history: %d kB configured, waiting for first complete BMS data set\n", m_bms_hist_size);
+    return;
+    }
+
+  uint32_t now = time(NULL);
+  writer->printf("BMS history: %d kB configured, %d voltages, %d temperatures\n",
+    m_bms_hist_size, m_bms_hist_nv, m_bms_hist_nt);
+  writer->puts("Level    Records  Capacity  Dropped  Span[min]  Newest[s]");
+  for (int i = 0; i < BmsHistory_Levels; i++)
+    {
+    bms_history_ring_t& ring = m_bms_hist_ring[i];
+    uint32_t oldest = 0, newest = 0;
+    if (ring.count)
+      {
+      memcpy(&oldest, ring.data + ((ring.next + ring.capacity - ring.count) % ring.capacity) * ring.recsize, 4);
+      memcpy(&newest, ring.data + ((ring.next + ring.capacity - 1) % ring.capacity) * ring.recsize, 4);
+      }
+    writer->printf("%-6s %9u %9u %8u %10.1f %10d\n",
+      bms_history_level_names[i], ring.count, ring.capacity, ring.dropped,
+      (newest - oldest) / 60.0f, ring.count ? (int) (now - newest) : -1);
+    }
+  writer->printf("Pending: %u samples in 1 min bucket, %u in 10 min bucket\n",
+    m_bms_hist_accu[0].samples, m_bms_hist_accu[1].samples);
+  }
+
+/**
+ * BmsHistoryExport: export history records, oldest first
+ *  The records are copied in chunks, releasing the history lock in between, so the
+ *  recording isn't blocked by the export. Records overwritten while exporting are
+ *  skipped, a reset or layout change ends the export. The output is limited to the
+ *  newest records fitting into BMS_HIST_EXPORT_MAXSIZE.
+ *  @param out          Output buffer (appended)
+ *  @param level        Resolution
+ *  @param binary       true = binary format (see bms_history_header_t), false = CSV
+ *  @param maxrecords   Export only the newest n records (0 = all)
+ *  @return             false if the history is not available
+ */
+bool OvmsVehicle::BmsHistoryExport(std::string& out, bms_history_level_t level, bool binary, int maxrecords /*=0*/)
+  {
+  if (level >= BmsHistory_Levels)
+    return false;
+
+  // Get layout & range to export:
+  m_bms_hist_mutex.Lock();
+  bms_history_ring_t& ring = m_bms_hist_ring[level];
+  if (!ring.data)
+    {
+    m_bms_hist_mutex.Unlock();
+    return false;
+    }
+  uint32_t gen = m_bms_hist_gen;
+  int nv = m_bms_hist_nv, nt = m_bms_hist_nt, nch = nv + nt;
+  uint32_t recsize = ring.recsize;
+  uint32_t count = ring.count;
+  uint32_t written = ring.count + ring.dropped;   // = sequence number of the next record
+  m_bms_hist_mutex.Unlock();
+
+  bool agg = (level != BmsHistory_Raw);
+  uint32_t outsize = binary ? recsize : (agg ? 17 + 24 * nch : 12 + 8 * nch);   // max per record
+  uint32_t fitting = (BMS_HIST_EXPORT_MAXSIZE - (binary ? sizeof(bms_history_header_t) : 30 * nch)) / outsize;
+  if (maxrecords > 0 && (uint32_t) maxrecords < count)
+    count = maxrecords;
+  if (count > fitting)
+    {
+    ESP_LOGW(TAG, "BmsHistoryExport: output limited to the newest %u of %u records", fitting, count);
+    count = fitting;
+    }
+  uint32_t seq = written - count;
+
+  // CSV records are copied to a buffer for formatting outside the lock:
+  uint32_t chunkrecs = LIMIT_MIN(BMS_HIST_EXPORT_CHUNK / recsize, 1);
+  uint8_t* chunk = binary ? NULL : (uint8_t*) ExternalRamMalloc(chunkrecs * recsize);
+  if (!binary && !chunk)
+    {
+    ESP_LOGE(TAG, "BmsHistoryExport: can't allocate %u bytes", chunkrecs * recsize);
+    return false;
+    }
+
+  // Header:
+  size_t hdrpos = out.size();
+  char buf[32];
+  if (binary)
+    {
+    bms_history_header_t header;
+    memcpy(header.magic, BMS_HIST_MAGIC, 4);
+    header.version = BMS_HIST_VERSION;
+    header.level = level;
+    header.nv = nv;
+    header.nt = nt;
+    header.recsize = recsize;
+    header.count = count;
+    out.reserve(out.size() + sizeof(header) + count * recsize);
+    out.append((const char*) &header, sizeof(header));
+    }
+  else
+    {
+    out.reserve(out.size() + (count + 1) * outsize);
+    out.append(agg ? "time,samples" : "time");
+    for (int ch = 0; ch < nch; ch++)
+      {
+      const char* type = (ch < nv) ? "v" : "t";
+      int cell = ((ch < nv) ? ch : ch - nv) + 1;
+      if (agg)
+        snprintf(buf, sizeof(buf), ",%s%d_min,%s%d_avg,%s%d_max", type, cell, type, cell, type, cell);
+      else
+        snprintf(buf, sizeof(buf), ",%s%d", type, cell);
+      out.append(buf);
+      }
+    out.append("\n");
+    }
+
+  // Records:
+  uint32_t exported = 0, skipped = 0, end = seq + count;
+  while (seq != end)
+    {
+    m_bms_hist_mutex.Lock();
+    if (m_bms_hist_gen != gen)
+      {
+      m_bms_hist_mutex.Unlock();
+      ESP_LOGW(TAG, "BmsHistoryExport: history reset during export, output truncated");
+      break;
+      }
+    // Skip records overwritten since the export started:
+    uint32_t avail = ring.count + ring.dropped - seq;
+    if (avail > ring.count)
+      {
+      uint32_t lost = LIMIT_MAX(avail - ring.count, end - seq);
+      m_bms_hist_mutex.Unlock();
+      skipped += lost;
+      seq += lost;
+      continue;
+      }
+    uint32_t n = LIMIT_MAX(chunkrecs, end - seq);
+    uint32_t index = (ring.next + ring.capacity - avail) % ring.capacity;
+    for (uint32_t k = 0; k < n; k++)
+      {
+      if (binary)
+        out.append((const char*) ring.data + index * recsize, recsize);
+      else
+        memcpy(chunk + k * recsize, ring.data + index * recsize, recsize);
+      if (++index == ring.capacity) index = 0;
+      }
+    m_bms_hist_mutex.Unlock();
+    seq += n;
+    exported += n;
+    if (binary)
+      continue;
+
+    // Format CSV outside the lock:
+    for (uint32_t k = 0; k < n; k++)
+      {
+      const uint8_t* rec = chunk + k * recsize;
+      uint32_t rectime;
+      memcpy(&rectime, rec, 4);
+      if (agg)
+        {
+        uint16_t samples;
+        memcpy(&samples, rec + 4, 2);
+        snprintf(buf, sizeof(buf), "%u,%u", rectime, samples);
+        }
+      else
+        {
+        snprintf(buf, sizeof(buf), "%u", rectime);
+        }
+      out.append(buf);
+      const uint16_t* vals = (const uint16_t*) (rec + (agg ? 6 : 4));
+      for (int ch = 0; ch < nch; ch++)
+        {
+        for (int j = 0; j < (agg ? 3 : 1); j++)
+          {
+          int32_t v = DecodeValue(*vals++, ch < nv);
+          if (ch < nv)
+            snprintf(buf, sizeof(buf), ",%d.%03d", v / 1000, v % 1000);
+          else
+            snprintf(buf, sizeof(buf), ",%s%d.%d", (v < 0 && v > -10) ? "-" : "", v / 10, ABS(v) % 10);
+          out.append(buf);
+          }
+        }
+      out.append("\n");
+      }
+    }
+
+  if (chunk)
+    free(chunk);
+  if (skipped)
+    ESP_LOGW(TAG, "BmsHistoryExport: %u records overwritten during export, skipped", skipped);
+  if (binary && exported != count)
+    {
+    // Correct the record count in the header:
+    bms_history_header_t* header = (bms_history_header_t*) &out[hdrpos];
+    header->count = exported;
+    }
+  return true;
+  }
@@ -0,0 +1,322 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Date:          14th March 2017
+;
+;    Changes:
+;    1.0  Initial release
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011        Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+#include "ovms_log.h"
+static const char *TAG = "vehicle-frames";
+
+#include <stdio.h>
+#include <string.h>
+#include "vehicle.h"
+
+// Standard (11 bit) CAN ID range:
+#define FRAME_STDIDS    2048
+
+
+/**
+ * RegisterFrameHandler: register a handler for a single CAN ID
+ *  IDs above 0x7ff are registered as extended (29 bit) IDs.
+ *  
+ *  @param bus          CAN bus the frames are received on
+ *  @param id           CAN ID
+ *  @param handler      Handler (called in the vehicle task context)
+ *  @return             false = registration failed (table full / invalid arguments)
+ */
+bool OvmsVehicle::RegisterFrameHandler(canbus* bus, uint32_t id, FrameHandler handler)
+  {
+  bool extended = (id > 0x7ff);
+  return RegisterFrameHandler(bus, id, extended ? 0x1fffffff : 0x7ff, handler, extended);
+  }
+
+
+/**
+ * RegisterFrameHandler: register a handler for a CAN ID range
+ *  The handler is called for all frames with (MsgID & mask) == (id & mask).
+ *  IDs already served by a previously registered handler are not taken over.
+ *  
+ *  @param bus          CAN bus the frames are received on
+ *  @param id           CAN ID
+ *  @param mask         ID bits to match
+ *  @param handler      Handler (called in the vehicle task context)
+ *  @param extended     true = match extended (29 bit) frames, default false
+ *  @return             false = registration failed (table full / invalid arguments)
+ */
+bool OvmsVehicle::RegisterFrameHandler(canbus* bus, uint32_t id, uint32_t mask, FrameHandler handler, bool extended /*=false*/)
+  {
+  if (!bus || bus->m_busnumber < 0 || bus->m_busnumber >= CAN_MAXBUSES || !handler)
+    {
+    ESP_LOGE(TAG, "RegisterFrameHandler: ID %03x: invalid bus or handler", id);
+    return false;
+    }
+
+  OvmsMutexLock lock(&m_frame_mutex);
+  frame_table_t* table = &m_frame_tables[bus->m_busnumber];
+  if (table->count == VEHICLE_FRAME_MAXHANDLERS)
+    {
+    ESP_LOGE(TAG, "RegisterFrameHandler: %s ID %03x: too many handlers", bus->GetName(), id);
+    return false;
+    }
+  if (!table->handlers)
+    table->handlers = new frame_handler_t*[VEHICLE_FRAME_MAXHANDLERS]();
+  if (!extended && !table->stdindex)
+    table->stdindex = new uint8_t[FRAME_STDIDS]();
+
+  frame_handler_t* entry = new frame_handler_t;
+  entry->id = id & mask;
+  entry->mask = mask;
+  entry->extended = extended;
+  entry->handler = handler;
+  entry->calls = 0;
+  entry->time = 0;
+  entry->time_max = 0;
+
+  // Publish the entry before the index, lookups are done without locking:
+  table->handlers[table->count] = entry;
+  uint8_t number = ++table->count;
+
+  if (extended)
+    {
+    table->extended = true;
+    }
+  else
+    {
+    int assigned = 0;
+    for (uint32_t stdid = 0; stdid < FRAME_STDIDS; stdid++)
+      {
+      if ((stdid & mask) == entry->id && table->stdindex[stdid] == 0)
+        {
+        table->stdindex[stdid] = number;
+        assigned++;
+        }
+      }
+    if (assigned == 0)
+      ESP_LOGW(TAG, "RegisterFrameHandler: %s ID %03x mask %03x: all IDs already handled",
+        bus->GetName(), id, mask);
+    }
+
+  ESP_LOGD(TAG, "RegisterFrameHandler: %s ID %03x mask %03x: handler #%u registered",
+    bus->GetName(), id, mask, number);
+  return true;
+  }
+
+
+/**
+ * SetFrameFilter: drop frames not handled by a frame handler or the poller
+ *  The filter is applied in the CAN task, so dropped frames don't take up space in the
+ *  vehicle queue and don't cost a vehicle task cycle. Only enable the filter if the
+ *  vehicle doesn't need any other frames of the bus in IncomingFrameCanN().
+ *  
+ *  @param bus          CAN bus to filter
+ *  @param enable       true = drop unhandled frames, false = pass all frames (default)
+ */
+void OvmsVehicle::SetFrameFilter(canbus* bus, bool enable)
+  {
+  if (!bus || bus->m_busnumber < 0 || bus->m_busnumber >= CAN_MAXBUSES)
+    return;
+
+  OvmsMutexLock lock(&m_frame_mutex);
+  m_frame_tables[bus->m_busnumber].filter = enable;
+  bool filter = false;
+  for (int i = 0; i < CAN_MAXBUSES; i++)
+    filter = filter || m_frame_tables[i].filter;
+  m_frame_filter = filter;
+
+  ESP_LOGI(TAG, "SetFrameFilter: %s: unhandled frames are %s", bus->GetName(),
+    enable ? "dropped" : "passed");
+  }
+
+
+/**
+ * FindFrameHandler: internal: look up the handler for a frame
+ *  Standard IDs are looked up directly, extended IDs by registration order.
+ *  Called without locking, handlers are only added while the vehicle exists.
+ */
+OvmsVehicle::frame_handler_t* OvmsVehicle::FindFrameHandler(const frame_table_t* table, const CAN_frame_t* frame)
+  {
+  if (frame->FIR.B.FF == CAN_frame_std)
+    {
+    if (!table->stdindex)
+      return NULL;
+    uint8_t number = table->stdindex[frame->MsgID & 0x7ff];
+    return (number) ? table->handlers[number-1] : NULL;
+    }
+
+  if (!table->extended)
+    return NULL;
+  for (int i = 0; i < table->count; i++)
+    {
+    frame_handler_t* entry = table->handlers[i];
+    if (entry->extended && (frame->MsgID & entry->mask) == entry->id)
+      return entry;
+    }
+  return NULL;
+  }
+
+
+/**
+ * DispatchFrame: internal: pass a received frame to its registered handler
+ *  Called by the vehicle task for every frame received. The handler is executed
+ *  within a metric batch (see MetricBatch).
+ *  
+ *  @return             true = frame has been handled
+ */
+bool OvmsVehicle::DispatchFrame(CAN_frame_t* frame)
+  {
+  int busnumber = frame->origin->m_busnumber;
+  if (busnumber < 0 || busnumber >= CAN_MAXBUSES)
+    return false;
+  frame_table_t* table = &m_frame_tables[busnumber];
+  if (!table->count)
+    return false;
+
+  frame_handler_t* entry = FindFrameHandler(table, frame);
+  if (!entry)
+    {
+    table->unhandled++;
+    return false;
+    }
+
+  // Metric listeners are called once after the handler (included in the handler time):
+  int64_t start = esp_timer_get_time();
+  MetricBatch batch;
+  entry->handler(frame);
+  batch.Commit();
+  uint32_t time = esp_timer_get_time() - start;
+
+  entry->calls++;
+  entry->time += time;
+  if (time > entry->time_max)
+    entry->time_max = time;
+  return true;
+  }
+
+
+/**
+ * FrameFilter: internal: CAN listener filter for the vehicle queue
+ *  Called in the CAN task context for every frame received.
+ *  
+ *  @return             false = drop frame
+ */
+bool OvmsVehicle::FrameFilter(const CAN_frame_t* frame)
+  {
+  if (!m_frame_filter || !frame->origin)
+    return true;
+  int busnumber = frame->origin->m_busnumber;
+  if (busnumber < 0 || busnumber >= CAN_MAXBUSES)
+    return true;
+  frame_table_t* table = &m_frame_tables[busnumber];
+  if (!table->filter)
+    return true;
+
+  if (FindFrameHandler(table, frame) || PollerExpectsFrame(frame))
+    return true;
+  table->dropped++;
+  return false;
+  }
+
+
+/**
+ * FreeFrameHandlers: internal: remove all frame handlers (vehicle shutdown)
+ */
+void OvmsVehicle::FreeFrameHandlers()
+  {
+  OvmsMutexLock lock(&m_frame_mutex);
+  m_frame_filter = false;
+  for (int i = 0; i < CAN_MAXBUSES; i++)
+    {
+    frame_table_t* table = &m_frame_tables[i];
+    for (int k = 0; k < table->count; k++)
+      delete table->handlers[k];
+    delete [] table->handlers;
+    delete [] table->stdindex;
+    memset(table, 0, sizeof(*table));
+    }
+  }
+
+
+/**
+ * FrameHandlerStatus: output frame handler statistics
+ */
+void OvmsVehicle::FrameHandlerStatus(int verbosity, OvmsWriter* writer)
+  {
+  OvmsMutexLock lock(&m_frame_mutex);
+  float elapsed = (esp_timer_get_time() - m_frame_stats_time) / 1000000.0f;
+  if (elapsed <= 0)
+    elapsed = 1;
+
+  int tables = 0;
+  for (int i = 0; i < CAN_MAXBUSES; i++)
+    {
+    const frame_table_t* table = &m_frame_tables[i];
+    if (!table->count && !table->filter)
+      continue;
+    tables++;
+    writer->printf("can%d: %u handlers, filter %s, %u frames unhandled, %u dropped\n",
+      i+1, table->count, table->filter ? "on" : "off", table->unhandled, table->dropped);
+    if (verbosity < COMMAND_RESULT_NORMAL)
+      continue;
+    for (int k = 0; k < table->count; k++)
+      {
+      const frame_handler_t* entry = table->handlers[k];
+      writer->printf(entry->extended ? "  %08x/%08x:" : "  %03x/%03x:", entry->id, entry->mask);
+      writer->printf(" %8u calls, %7.1f/s, avg %6.1f us, max %5u us, CPU %5.2f%%\n",
+        entry->calls, entry->calls / elapsed,
+        entry->calls ? (float) entry->time / entry->calls : 0.0f,
+        entry->time_max, entry->time / (elapsed * 10000.0f));
+      }
+    }
+
+  if (tables == 0)
+    writer->puts("No frame handlers registered");
+  else
+    writer->printf("Statistics of the last %.0f seconds\n", elapsed);
+  }
+
+
+/**
+ * FrameHandlerResetStats: reset frame handler statistics
+ */
+void OvmsVehicle::FrameHandlerResetStats()
+  {
+  OvmsMutexLock lock(&m_frame_mutex);
+  for (int i = 0; i < CAN_MAXBUSES; i++)
+    {
+    frame_table_t* table = &m_frame_tables[i];
+    table->unhandled = 0;
+    table->dropped = 0;
+    for (int k = 0; k < table->count; k++)
+      {
+      frame_handler_t* entry = table->handlers[k];
+      entry->calls = 0;
+      entry->time = 0;
+      entry->time_max = 0;
+      }
+    }
+  m_frame_stats_time = esp_timer_get_time();
+  }
@@ -28,11 +28,12 @@
 ; THE SOFTWARE.
 */
 
-// #include "ovms_log.h"
-// static const char *TAG = "vehicle";
+#include "ovms_log.h"
+static const char *TAG = "vehicle-poller";
 
 #include <stdio.h>
 #include <algorithm>
+#include <memory>
 #include <ovms_command.h>
 #include <ovms_script.h>
 #include <ovms_metrics.h>
@@ -45,6 +46,12 @@
 #include <string_writer.h>
 #include "vehicle.h"
 
+// Min-heap ordering for the millisecond schedule: earliest due first, list order on ties
+static bool PollerScheduleLater(const OvmsVehicle::poll_schedule_t& a, const OvmsVehicle::poll_schedule_t& b)
+  {
+  return (a.due > b.due) || (a.due == b.due && a.entry > b.entry);
+  }
+
 
 /**
  * PollerStateTicker: check for state changes (stub, override with vehicle implementation)
@@ -59,7 +66,7 @@ void OvmsVehicle::PollerStateTicker()
 
 /**
  * IncomingPollReply: poll response handler (stub, override with vehicle implementation)
- *  This is called by PollerReceive() on each valid response frame for the current request.
+ *  This is called by the poller on each valid response frame for the current request.
  *  Be aware responses may consist of multiple frames, detectable e.g. by mlremain > 0.
  *  A typical pattern is to collect frames in a buffer until mlremain == 0.
  *  
@@ -82,17 +89,43 @@ void OvmsVehicle::PollerStateTicker()
  *    Frame number of the response, 0 = first frame / new response
  *  @member m_poll_ml_offset
  *    Byte position of this frame's payload part in the response, 0 = first frame
+ *  @member m_poll_entry
+ *    Copy of the currently processed poll entry
  *  @member m_poll_plcur
- *    Pointer to the currently processed poll entry
+ *    Poll list cursor (second entries only, already advanced to the next entry)
  */
 void OvmsVehicle::IncomingPollReply(canbus* bus, uint16_t type, uint16_t pid, uint8_t* data, uint8_t length, uint16_t mlremain)
   {
   }
 
 
+/**
+ * IncomingPollResponse: complete poll response handler (stub, override with vehicle implementation)
+ *  This is called by the poller instead of IncomingPollReply() if response reassembly
+ *  has been enabled by PollSetResponseReassembly(). It is called once per response
+ *  with the complete payload of all frames in a contiguous buffer.
+ *  
+ *  @param bus
+ *    CAN bus the current poll is done on
+ *  @param type
+ *    OBD2 mode / UDS polling type, e.g. VEHICLE_POLL_TYPE_READDTC
+ *  @param pid
+ *    PID addressed (depending on the request type, may be none / 8 bit / 16 bit)
+ *  @param data
+ *    Response payload (buffer owned by the poller, only valid during the call)
+ *  @param length
+ *    Response payload size
+ *  
+ *  The m_poll_* request members are available as for IncomingPollReply().
+ */
+void OvmsVehicle::IncomingPollResponse(canbus* bus, uint16_t type, uint16_t pid, const uint8_t* data, uint16_t length)
+  {
+  }
+
+
 /**
  * IncomingPollError: poll response error handler (stub, override with vehicle implementation)
- *  This is called by PollerReceive() on reception of an OBD/UDS Negative Response Code (NRC),
+ *  This is called by the poller on reception of an OBD/UDS Negative Response Code (NRC),
  *  except if the code is requestCorrectlyReceived-ResponsePending (0x78), which is handled
  *  by the poller. See ISO 14229 Annex A.1 for the list of NRC codes.
  *  
@@ -107,8 +140,10 @@ void OvmsVehicle::IncomingPollReply(canbus* bus, uint16_t type, uint16_t pid, ui
  *  
  *  @member m_poll_moduleid_sent
  *    The CAN ID addressed by the current request (txmoduleid)
+ *  @member m_poll_entry
+ *    Copy of the currently processed poll entry
  *  @member m_poll_plcur
- *    Pointer to the currently processed poll entry
+ *    Poll list cursor (second entries only, already advanced to the next entry)
  */
 void OvmsVehicle::IncomingPollError(canbus* bus, uint16_t type, uint16_t pid, uint16_t code)
   {
@@ -144,6 +179,7 @@ void OvmsVehicle::IncomingPollTxCallback(canbus* bus, uint32_t txid, uint16_t ty
  *  Call this to install a new polling list or restart the list.
  *  This won't change the polling state; you can change the list while keeping the state.
  *  The list is changed without waiting for pending responses to finish (except PollSingleRequests).
+ *  Asynchronous requests in flight are sent again.
  *  
  *  @param bus
  *    CAN bus to use as the default bus (for all poll entries with bus=0) or NULL to stop polling
@@ -157,12 +193,14 @@ void OvmsVehicle::PollSetPidList(canbus* bus, const poll_pid_t* plist)
   m_poll_bus = bus;
   m_poll_bus_default = bus;
   m_poll_plist = plist;
+  PollerCompileList();
   m_poll_ticker = 0;
   m_poll_sequence_cnt = 0;
   m_poll_wait = 0;
   m_poll_plcur = NULL;
   m_poll_entry = {};
   m_poll_txmsgid = 0;
+  PollerResetEngines();
   }
 
 
@@ -188,6 +226,7 @@ void OvmsVehicle::PollSetState(uint8_t state)
     m_poll_plcur = NULL;
     m_poll_entry = {};
     m_poll_txmsgid = 0;
+    PollerResetEngines();
     }
   }
 
@@ -196,7 +235,7 @@ void OvmsVehicle::PollSetState(uint8_t state)
  * PollSetThrottling: configure polling speed / niceness
  *  If multiple requests are due at the same poll tick (second), this controls how many of
  *  them will be sent in series without a delay, i.e. as soon as the response/timeout for
- *  the previous request occurred.
+ *  the previous request occurred. The limit applies to each bus separately.
  *  
  *  @param sequence_max
  *    Polls allowed to be sent in sequence per time tick (second), default 1, 0 = no limit.
@@ -210,6 +249,51 @@ void OvmsVehicle::PollSetThrottling(uint8_t sequence_max)
   }
 
 
+/**
+ * PollSetMaxInFlight: configure request pipelining for a bus
+ *  By default, the poller waits for the response (or timeout) of a request before
+ *  sending the next one on a bus. Allowing multiple requests in flight lets the
+ *  poller send requests to further ECUs while waiting, so the cycle time for a list
+ *  covering many ECUs approaches the latency of the slowest ECU instead of the sum.
+ *  Requests to the same TX/RX IDs are never sent in parallel, broadcasts and VWTP_20
+ *  requests are sent exclusively.
+ *  
+ *  @param bus
+ *    CAN bus to configure
+ *  @param inflight_max
+ *    Max requests in flight on the bus, 1 (default) … VEHICLE_POLL_MAXINFLIGHT
+ *  
+ *  The configuration is kept unchanged over calls to PollSetPidList() or PollSetState().
+ */
+void OvmsVehicle::PollSetMaxInFlight(canbus* bus, uint8_t inflight_max)
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  poll_engine_t* engine = PollerGetEngine(bus, true);
+  if (engine)
+    engine->inflight_max = LIMIT_MIN(LIMIT_MAX(inflight_max, VEHICLE_POLL_MAXINFLIGHT), 1);
+  }
+
+
+/**
+ * PollSetAdaptiveThrottling: configure automatic throttling
+ *  With adaptive throttling, the poller measures the response latencies, timeouts and
+ *  "busy" NRCs per bus and adjusts the requests per tick & in flight automatically
+ *  (additive increase, multiplicative decrease), replacing the static limit set by
+ *  PollSetThrottling(). The in flight limit is additionally capped by PollSetMaxInFlight().
+ *  The config vehicle poller.adaptive overrides the ceiling if set.
+ *  
+ *  @param ceiling
+ *    Max requests per tick, 0 = adaptive throttling off (default)
+ *  
+ *  The configuration is kept unchanged over calls to PollSetPidList() or PollSetState().
+ */
+void OvmsVehicle::PollSetAdaptiveThrottling(uint8_t ceiling)
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  m_poll_adaptive_max = ceiling;
+  }
+
+
 /**
  * PollSetResponseSeparationTime: configure ISO TP multi frame response timing
  *  See: https://en.wikipedia.org/wiki/ISO_15765-2
@@ -230,6 +314,25 @@ void OvmsVehicle::PollSetResponseSeparationTime(uint8_t septime)
   }
 
 
+/**
+ * PollSetResponseReassembly: configure response delivery
+ *  By default, the poller passes each response frame to IncomingPollReply() separately.
+ *  With reassembly enabled, the poller collects the frames of a response in a buffer
+ *  reused per request slot and calls IncomingPollResponse() once the response is
+ *  complete, so the vehicle doesn't need to do the reassembly itself.
+ *  
+ *  @param enable
+ *    true = call IncomingPollResponse(), false = call IncomingPollReply() (default)
+ *  
+ *  The configuration is kept unchanged over calls to PollSetPidList() or PollSetState().
+ */
+void OvmsVehicle::PollSetResponseReassembly(bool enable)
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  m_poll_reassemble = enable;
+  }
+
+
 /**
  * PollSetChannelKeepalive: configure keepalive timeout for channel oriented protocols
  * 
@@ -251,257 +354,1364 @@ void OvmsVehicle::PollSetChannelKeepalive(uint16_t keepalive_seconds)
 
 
 /**
- * PollerSend: internal: start next due request
+ * PollSetChannelPool: set the number of VWTP_20 channels to keep open per bus
+ *  With more than one channel, idle channels are parked on polls to other ECUs,
+ *  and resumed without a new channel setup. Parked channels are kept alive by
+ *  channel tests until the keepalive timeout (see PollSetChannelKeepalive()).
+ *  
+ *  Only use this if the gateway supports multiple open channels.
+ *  
+ *  @param channels
+ *    Max open channels per bus, 1 … VEHICLE_POLL_VWTP_CHANNELS, default/init = 1
  */
-void OvmsVehicle::PollerSend(bool fromTicker)
+void OvmsVehicle::PollSetChannelPool(uint8_t channels)
   {
   OvmsRecMutexLock lock(&m_poll_mutex);
+  m_poll_ch_pool = LIMIT_MAX(LIMIT_MIN(channels, 1), VEHICLE_POLL_VWTP_CHANNELS);
+  }
 
-  // ESP_LOGD(TAG, "PollerSend(%d): entry at[type=%02X, pid=%X], ticker=%u, wait=%u, cnt=%u/%u",
-  //          fromTicker, m_poll_plcur->type, m_poll_plcur->pid,
-  //          m_poll_ticker, m_poll_wait, m_poll_sequence_cnt, m_poll_sequence_max);
 
-  if (fromTicker)
-    {
-    // Timer ticker call: reset throttling counter, check response timeout
-    m_poll_sequence_cnt = 0;
-    if (m_poll_wait > 0) m_poll_wait--;
+/**
+ * PollerGetBus: internal: get CAN bus to use for a poll list entry
+ */
+canbus* OvmsVehicle::PollerGetBus(const poll_pid_t* entry)
+  {
+  return PollerGetBus(entry->pollbus);
+  }
 
-    // Protocol specific ticker calls:
-    PollerVWTPTicker();
+canbus* OvmsVehicle::PollerGetBus(uint8_t pollbus)
+  {
+  switch (pollbus)
+    {
+    case 1:   return m_can1;
+    case 2:   return m_can2;
+    case 3:   return m_can3;
+    case 4:   return m_can4;
+    default:  return m_poll_bus_default;
     }
-  if (m_poll_wait > 0) return;
-
-  // Check poll bus & list:
-  if (!m_poll_bus_default || !m_poll_plist || m_poll_plist->txmoduleid == 0) return;
-
-  // Restart poll list cursor:
-  if (m_poll_plcur == NULL) m_poll_plcur = m_poll_plist;
+  }
 
-  m_poll_entry = {};
 
-  while (m_poll_plcur->txmoduleid != 0)
+/**
+ * PollerGetEngine: internal: find (or assign) the poller engine for a CAN bus
+ *  Engines are allocated (in external RAM) on first use and kept, so channel states
+ *  survive list changes. Buses never polled don't use any engine memory.
+ *  
+ *  @param bus          CAN bus to look up
+ *  @param create       true = allocate an engine if none has been assigned yet
+ *  @return             Engine or NULL if none assigned/available
+ */
+OvmsVehicle::poll_engine_t* OvmsVehicle::PollerGetEngine(canbus* bus, bool create)
+  {
+  if (!bus)
+    return NULL;
+  int unused = -1;
+  for (int i = 0; i < VEHICLE_POLL_NBUSES; i++)
     {
-    if ((m_poll_plcur->polltime[m_poll_state] > 0) &&
-        ((m_poll_ticker % m_poll_plcur->polltime[m_poll_state]) == 0))
-      {
-      // We need to poll this one...
-      m_poll_entry = *m_poll_plcur;
-      m_poll_protocol = m_poll_plcur->protocol;
-      m_poll_type = m_poll_plcur->type;
-      m_poll_pid = m_poll_plcur->pid;
+    if (m_poll_engines[i] && m_poll_engines[i]->bus == bus)
+      return m_poll_engines[i];
+    else if (unused < 0 && !m_poll_engines[i])
+      unused = i;
+    }
+  if (!create || unused < 0)
+    return NULL;
+  poll_engine_t* engine = new poll_engine_t();
+  engine->bus = bus;
+  engine->inflight_max = 1;
+  engine->aimd_limit = 1;
+  engine->entries_time = esp_timer_get_time();
+  m_poll_engines[unused] = engine;
+  return engine;
+  }
 
-      switch (m_poll_plcur->pollbus)
-        {
-        case 1:
-          m_poll_bus = m_can1;
-          break;
-        case 2:
-          m_poll_bus = m_can2;
-          break;
-        case 3:
-          m_poll_bus = m_can3;
-          break;
-        case 4:
-          m_poll_bus = m_can4;
-          break;
-        default:
-          m_poll_bus = m_poll_bus_default;
-        }
 
-      // Dispatch transmission start to protocol handler:
-      if (m_poll_protocol == VWTP_20)
-        PollerVWTPStart(fromTicker);
-      else
-        PollerISOTPStart(fromTicker);
+/**
+ * PollerSelectEngine: internal: switch the m_poll_* state to an engine
+ *  The state of the previously selected engine is stored back into its slot,
+ *  the request slot last selected on the engine becomes the current request.
+ *  Must be called with m_poll_mutex held.
+ */
+void OvmsVehicle::PollerSelectEngine(poll_engine_t* engine)
+  {
+  PollerStoreEngine();
+  m_poll_engine = engine;
+  m_poll_bus = engine->bus;
+  m_poll_plcur = engine->plcur;
+  m_poll_ticker = engine->ticker;
+  m_poll_sequence_cnt = engine->sequence_cnt;
+  m_poll_vwtp = engine->vwtp;
+  PollerLoadRequest();
+  }
 
-      m_poll_plcur++;
-      m_poll_sequence_cnt++;
-      return;
-      }
 
-    // Poll entry is not due, check next
-    m_poll_plcur++;
-    }
+/**
+ * PollerStoreEngine: internal: store the m_poll_* state into the selected engine
+ *  Must be called with m_poll_mutex held.
+ */
+void OvmsVehicle::PollerStoreEngine()
+  {
+  poll_engine_t* engine = m_poll_engine;
+  if (!engine)
+    return;
+  engine->plcur = m_poll_plcur;
+  engine->ticker = m_poll_ticker;
+  engine->sequence_cnt = m_poll_sequence_cnt;
+  engine->vwtp = m_poll_vwtp;
+  PollerStoreRequest();
+  }
 
-  // Completed checking all poll entries for the current m_poll_ticker
-  // ESP_LOGD(TAG, "PollerSend(%d): cycle complete for ticker=%u", fromTicker, m_poll_ticker);
-  m_poll_plcur = m_poll_plist;
-  m_poll_ticker++;
-  if (m_poll_ticker > 3600) m_poll_ticker -= 3600;
+
+/**
+ * PollerSelectRequest: internal: switch the m_poll_* request state to a request slot
+ *  of the selected engine. Must be called with m_poll_mutex held.
+ */
+void OvmsVehicle::PollerSelectRequest(int index)
+  {
+  PollerStoreRequest();
+  m_poll_engine->reqidx = index;
+  PollerLoadRequest();
   }
 
 
 /**
- * PollerTxCallback: internal: process poll request callbacks
+ * PollerLoadRequest: internal: load the m_poll_* request state from the selected request slot
  */
-void OvmsVehicle::PollerTxCallback(const CAN_frame_t* frame, bool success)
+void OvmsVehicle::PollerLoadRequest()
   {
-  OvmsRecMutexLock lock(&m_poll_mutex);
+  poll_request_t* req = &m_poll_engine->req[m_poll_engine->reqidx];
+  m_poll_entry = req->entry;
+  m_poll_protocol = req->protocol;
+  m_poll_moduleid_sent = req->moduleid_sent;
+  m_poll_moduleid_low = req->moduleid_low;
+  m_poll_moduleid_high = req->moduleid_high;
+  m_poll_type = req->type;
+  m_poll_pid = req->pid;
+  m_poll_tx_data = req->tx_data;
+  m_poll_tx_remain = req->tx_remain;
+  m_poll_tx_offset = req->tx_offset;
+  m_poll_tx_frame = req->tx_frame;
+  m_poll_ml_remain = req->ml_remain;
+  m_poll_ml_offset = req->ml_offset;
+  m_poll_ml_frame = req->ml_frame;
+  m_poll_wait = req->wait;
+  m_poll_txmsgid = req->txmsgid;
+  }
 
-  // Check for a late callback:
-  if (!m_poll_wait || !m_poll_plist || frame->origin != m_poll_bus || frame->MsgID != m_poll_txmsgid)
+
+/**
+ * PollerStoreRequest: internal: store the m_poll_* request state into the selected request slot
+ */
+void OvmsVehicle::PollerStoreRequest()
+  {
+  if (!m_poll_engine)
     return;
+  poll_request_t* req = &m_poll_engine->req[m_poll_engine->reqidx];
+  req->entry = m_poll_entry;
+  req->protocol = m_poll_protocol;
+  req->moduleid_sent = m_poll_moduleid_sent;
+  req->moduleid_low = m_poll_moduleid_low;
+  req->moduleid_high = m_poll_moduleid_high;
+  req->type = m_poll_type;
+  req->pid = m_poll_pid;
+  req->tx_data = m_poll_tx_data;
+  req->tx_remain = m_poll_tx_remain;
+  req->tx_offset = m_poll_tx_offset;
+  req->tx_frame = m_poll_tx_frame;
+  req->ml_remain = m_poll_ml_remain;
+  req->ml_offset = m_poll_ml_offset;
+  req->ml_frame = m_poll_ml_frame;
+  req->wait = m_poll_wait;
+  req->txmsgid = m_poll_txmsgid;
+  }
 
-  // Forward to protocol handler:
-  if (m_poll_protocol == VWTP_20)
-    PollerVWTPTxCallback(frame, success);
 
-  // On failure, try to speed up the current poll timeout:
-  if (!success)
+/**
+ * PollerResetEngines: internal: restart all engines on a list or state change
+ *  Must be called with m_poll_mutex held, after resetting the m_poll_* state.
+ */
+void OvmsVehicle::PollerResetEngines()
+  {
+  for (int i = 0; i < VEHICLE_POLL_NBUSES; i++)
     {
-    m_poll_wait = 0;
-    if (m_poll_single_rxbuf)
+    poll_engine_t* engine = m_poll_engines[i];
+    if (!engine)
+      continue;
+    engine->plcur = NULL;
+    engine->ticker = 0;
+    engine->sequence_cnt = 0;
+    for (int k = 0; k < VEHICLE_POLL_MAXINFLIGHT; k++)
       {
-      m_poll_single_rxerr = POLLSINGLE_TXFAILURE;
-      m_poll_single_rxbuf = NULL;
-      m_poll_single_rxdone.Give();
+      // Asynchronous requests in flight are repeated:
+      if (engine->req[k].async)
+        m_poll_async.push_front(engine->req[k].async);
+      engine->req[k] = {};
       }
+    engine->schedule.clear();
+    engine->schedule_valid = false;
+    engine->cycle_done = false;
+    engine->due.clear();
+    engine->duepos = 0;
+    engine->due_valid = false;
+    engine->multi_entry = NULL;
     }
+  }
 
-  // Forward to application:
-  IncomingPollTxCallback(m_poll_bus, m_poll_moduleid_sent, m_poll_type, m_poll_pid, success);
+
+/**
+ * PollerCompileList: internal: compile the poll list into per state schedules
+ *  Second entries are grouped by interval, phase & bus, so a tick only needs to check
+ *  the groups for being due. Millisecond entries are collected per state for the
+ *  schedule heap. Must be called with m_poll_mutex held.
+ */
+void OvmsVehicle::PollerCompileList()
+  {
+  m_poll_plan_buses = 0;
+  for (int state = 0; state < VEHICLE_POLL_NSTATES; state++)
+    {
+    poll_plan_t& plan = m_poll_plan[state];
+    plan.periods.clear();
+    plan.ms.clear();
+    for (const poll_pid_t* entry = m_poll_plist; entry && entry->txmoduleid != 0; entry++)
+      {
+      if (state == 0)
+        m_poll_plan_buses |= 1 << LIMIT_MAX(entry->pollbus, 4);
+      uint16_t polltime = entry->polltime[state];
+      if (polltime == 0)
+        continue;
+      if (entry->polltimeunit == POLL_TIME_MS)
+        {
+        plan.ms.push_back(entry);
+        continue;
+        }
+      uint16_t phase = (entry->pollphase / 1000) % polltime;
+      auto it = std::find_if(plan.periods.begin(), plan.periods.end(),
+        [=](const poll_period_t& p)
+          { return p.polltime == polltime && p.phase == phase && p.pollbus == entry->pollbus; });
+      if (it == plan.periods.end())
+        {
+        plan.periods.push_back({ polltime, phase, entry->pollbus, {} });
+        it = plan.periods.end() - 1;
+        }
+      it->entries.push_back(entry);
+      }
+    }
   }
 
 
 /**
- * PollerReceive: internal: process poll response frame
+ * PollerCollectDue: internal: collect the second entries due at the current tick
+ *  on the selected engine, in list order.
  */
-void OvmsVehicle::PollerReceive(CAN_frame_t* frame, uint32_t msgid)
+void OvmsVehicle::PollerCollectDue()
   {
-  // obsolete
+  std::vector<const poll_pid_t*>& due = m_poll_engine->due;
+  int groups = 0;
+  due.clear();
+  for (const poll_period_t& period : m_poll_plan[m_poll_state].periods)
+    {
+    if (((m_poll_ticker + period.polltime - period.phase) % period.polltime) != 0 ||
+        PollerGetBus(period.pollbus) != m_poll_bus)
+      continue;
+    due.insert(due.end(), period.entries.begin(), period.entries.end());
+    groups++;
+    }
+  // Entries point into the list, so pointer order = list order:
+  if (groups > 1)
+    std::sort(due.begin(), due.end());
+  m_poll_engine->duepos = 0;
+  m_poll_engine->due_valid = true;
   }
 
 
 /**
- * PollSingleRequest: perform prioritized synchronous single OBD2/UDS request
- *  Pass a full OBD2/UDS request (mode/type, PID, additional payload).
- *  The request is sent immediately, aborting a running poll list request. The previous
- *  poller state is automatically restored after the request has been performed, but
- *  without any guarantee for repetition or omission of an aborted poll.
- *  On success, the response buffer will contain the response payload (may be empty).
- *  
- *  See OvmsVehicleFactory::obdii_request() for a usage example.
- *  
- *  ATT: must not be called from within the vehicle task context -- deadlock situation!
- *  
- *  @param bus          CAN bus to use for the request
- *  @param txid         CAN ID to send to (0x7df = broadcast)
- *  @param rxid         CAN ID to expect response from (broadcast: 0)
- *  @param request      Request to send (binary string) (type + pid + up to 4095 bytes payload)
- *  @param response     Response buffer (binary string) (multiple response frames assembled)
- *  @param timeout_ms   Timeout for poller/response in milliseconds
- *  @param protocol     Protocol variant: ISOTP_STD / ISOTP_EXTADR / ISOTP_EXTFRAME
+ * PollerGetFreeRequest: internal: find a free request slot on an engine
+ *  While a VWTP_20 channel is open, the engine works sequentially (slot 0).
+ *  The engine's slots need to be up to date (see PollerStoreEngine()).
  *  
- *  @return             POLLSINGLE_OK         (0)   -- success, response is valid
- *                      POLLSINGLE_TIMEOUT    (-1)  -- timeout/poller unavailable
- *                      POLLSINGLE_TXFAILURE  (-2)  -- CAN transmission failure
- *                      else                  (>0)  -- UDS NRC detail code
- *                      Note: response is only valid with return value 0
+ *  @return             Slot index or -1 if all slots allowed are busy
  */
-int OvmsVehicle::PollSingleRequest(canbus* bus, uint32_t txid, uint32_t rxid,
-                                   std::string request, std::string& response,
-                                   int timeout_ms /*=3000*/, uint8_t protocol /*=ISOTP_STD*/)
+int OvmsVehicle::PollerGetFreeRequest(poll_engine_t* engine)
   {
-  if (!m_ready)
-    return -1;
-
-  if (!m_registeredlistener)
+  int limit = LIMIT_MIN(engine->inflight_max, 1);
+  if (engine->vwtp.state != VWTP_Closed)
+    limit = 1;
+  else if (PollerAdaptiveCeiling())
+    limit = LIMIT_MAX(limit, LIMIT_MIN((int)engine->aimd_limit, 1));
+  for (int i = 0; i < limit; i++)
     {
-    m_registeredlistener = true;
-    MyCan.RegisterListener(m_rxqueue);
+    if (engine->req[i].wait == 0)
+      return i;
     }
+  return -1;
+  }
 
-  OvmsRecMutexLock slock(&m_poll_single_mutex, pdMS_TO_TICKS(timeout_ms));
-  if (!slock.IsLocked())
-    return -1;
 
-  // prepare single poll:
-  OvmsVehicle::poll_pid_t poll[] =
+/**
+ * PollerRequestConflicts: internal: check if a poll entry may be sent in parallel
+ *  to the requests in flight on an engine.
+ *  The engine's slots need to be up to date (see PollerStoreEngine()).
+ *  
+ *  @param entry        Poll entry to check
+ *  @param engine       Engine to check, default NULL = selected engine
+ *  @return             true = entry needs to wait
+ */
+bool OvmsVehicle::PollerRequestConflicts(const poll_pid_t* entry, const poll_engine_t* engine /*=NULL*/)
+  {
+  if (!engine)
+    engine = m_poll_engine;
+  // Multiple DID entries wait for a single DID sequence to complete:
+  if (entry->dargs.tag == POLL_MULTIDID && engine->multi_entry &&
+      engine->multi_entry != entry)
+    return true;
+  bool exclusive = (entry->protocol == VWTP_20 || entry->rxmoduleid == 0);
+  for (int i = 0; i < VEHICLE_POLL_MAXINFLIGHT; i++)
     {
-      { txid, rxid, 0, 0, { 999, 999, 999, 999 }, 0, protocol },
-      POLL_LIST_END
-    };
+    const poll_request_t* req = &engine->req[i];
+    if (req->wait == 0)
+      continue;
+    if (exclusive || req->protocol == VWTP_20 || req->moduleid_sent == 0x7df)
+      return true;
+    if (req->entry.txmoduleid == entry->txmoduleid ||
+        (entry->rxmoduleid >= req->moduleid_low && entry->rxmoduleid <= req->moduleid_high))
+      return true;
+    }
+  return false;
+  }
 
-  assert(request.size() > 0);
-  poll[0].type = request[0];
-  poll[0].xargs.tag = POLL_TXDATA;
 
-  if (POLL_TYPE_HAS_16BIT_PID(poll[0].type))
+/**
+ * PollerSend: internal: start next due requests
+ *  On the ticker call, all engines are run, so every bus polled has its own
+ *  requests in flight. Otherwise (i.e. after a response has been received)
+ *  only the currently selected engine continues.
+ */
+void OvmsVehicle::PollerSend(bool fromTicker)
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+
+  if (!fromTicker)
     {
-    assert(request.size() >= 3);
-    poll[0].xargs.pid = request[1] << 8 | request[2];
-    poll[0].xargs.datalen = LIMIT_MAX(request.size()-3, 4095);
-    poll[0].xargs.data = (const uint8_t*)request.data()+3;
+    PollerSendBus(false);
+    return;
     }
-  else if (POLL_TYPE_HAS_8BIT_PID(poll[0].type))
+
+  // Drop asynchronous requests not sent in time:
+  PollerAsyncExpire();
+
+  // Assign engines to all buses used by the poll list:
+  for (int pollbus = 0; pollbus <= 4; pollbus++)
     {
-    assert(request.size() >= 2);
-    poll[0].xargs.pid = request.at(1);
-    poll[0].xargs.datalen = LIMIT_MAX(request.size()-2, 4095);
-    poll[0].xargs.data = (const uint8_t*)request.data()+2;
+    if (m_poll_plan_buses & (1 << pollbus))
+      PollerGetEngine(PollerGetBus(pollbus), true);
     }
-  else
+
+  for (int i = 0; i < VEHICLE_POLL_NBUSES; i++)
     {
-    poll[0].xargs.pid = 0;
-    poll[0].xargs.datalen = LIMIT_MAX(request.size()-1, 4095);
-    poll[0].xargs.data = (const uint8_t*)request.data()+1;
+    poll_engine_t* engine = m_poll_engines[i];
+    if (!engine)
+      continue;
+
+    PollerSelectEngine(engine);
+    PollerSendBus(true);
+    PollerStoreEngine();
+
+    // Update response rate statistics:
+    poll_stats_t* stats = &engine->stats;
+    if (stats->rate_time != monotonictime)
+      {
+      uint32_t cnt = stats->responses - stats->rate_responses;
+      uint32_t secs = (stats->rate_time) ? monotonictime - stats->rate_time : 1;
+      stats->rate = (stats->rate * 9 + (float) cnt / secs) / 10;
+      stats->rate_responses = stats->responses;
+      stats->rate_time = monotonictime;
+      }
     }
 
-  // acquire poller access:
-  if (!m_poll_mutex.Lock(pdMS_TO_TICKS(timeout_ms)))
-    return -1;
+  PollerArmTimer();
+  }
 
-  // save poller state:
-  canbus*           p_bus    = m_poll_bus_default;
-  const poll_pid_t* p_list   = m_poll_plist;
-  const poll_pid_t* p_plcur  = m_poll_plcur;
-  uint32_t          p_ticker = m_poll_ticker;
 
-  // start single poll:
-  PollSetPidList(bus, poll);
-  m_poll_single_rxdone.Take(0);
-  m_poll_single_rxbuf = &response;
-  PollerSend(true);
-  m_poll_mutex.Unlock();
+/**
+ * PollerSendBus: internal: start next due requests on the currently selected engine
+ */
+void OvmsVehicle::PollerSendBus(bool fromTicker)
+  {
+  if (!m_poll_engine)
+    return;
 
-  // wait for response:
-  bool rxok = m_poll_single_rxdone.Take(pdMS_TO_TICKS(timeout_ms));
+  m_poll_bus = m_poll_engine->bus;
 
-  // restore poller state:
-  m_poll_mutex.Lock();
-  PollSetPidList(p_bus, p_list);
-  m_poll_plcur = p_plcur;
-  m_poll_ticker = p_ticker;
-  m_poll_single_rxbuf = NULL;
-  m_poll_mutex.Unlock();
+  if (fromTicker)
+    {
+    // Timer ticker call: reset throttling counter, check response timeouts
+    m_poll_sequence_cnt = 0;
+    m_poll_engine->cycle_done = false;
+    PollerStoreRequest();
+    for (int i = 0; i < VEHICLE_POLL_MAXINFLIGHT; i++)
+      {
+      if (m_poll_engine->req[i].wait == 0)
+        continue;
+      PollerSelectRequest(i);
+      if (--m_poll_wait == 0)
+        {
+        PollerTrackFailure(false);
+        PollerAsyncDone(POLLSINGLE_TIMEOUT);
+        }
+      }
 
-  return (rxok == pdFALSE) ? -1 : m_poll_single_rxerr;
+    // Protocol specific ticker calls (channels use the first request slot):
+    PollerSelectRequest(0);
+    PollerVWTPTicker();
+    }
+
+  // Fill free request slots with due requests:
+  while (PollerSendNext(fromTicker))
+    ;
   }
 
 
 /**
- * PollSingleRequest: perform prioritized synchronous single OBD2/UDS request
- *  Convenience wrapper for standard PID polls, see above for main implementation.
- *  
- *  @param bus          CAN bus to use for the request
- *  @param txid         CAN ID to send to (0x7df = broadcast)
- *  @param rxid         CAN ID to expect response from (broadcast: 0)
- *  @param polltype     OBD2/UDS poll type …
- *  @param pid          … and PID to poll
- *  @param response     Response buffer (binary string) (multiple response frames assembled)
- *  @param timeout_ms   Timeout for poller/response in milliseconds
- *  @param protocol     Protocol variant: ISOTP_STD / ISOTP_EXTADR / ISOTP_EXTFRAME
+ * PollerSendNext: internal: start next due request on the selected engine if possible
+ *  Millisecond entries are started by due time from the engine's schedule heap,
+ *  second entries are started in list order once per tick.
  *  
- *  @return             POLLSINGLE_OK         ( 0)  -- success, response is valid
- *                      POLLSINGLE_TIMEOUT    (-1)  -- timeout/poller unavailable
- *                      POLLSINGLE_TXFAILURE  (-2)  -- CAN transmission failure
- *                      else                  (>0)  -- UDS NRC detail code
- *                      Note: response is only valid with return value 0
+ *  @return             true = request started
  */
-int OvmsVehicle::PollSingleRequest(canbus* bus, uint32_t txid, uint32_t rxid,
-                                   uint8_t polltype, uint16_t pid, std::string& response,
-                                   int timeout_ms /*=3000*/, uint8_t protocol /*=ISOTP_STD*/)
+bool OvmsVehicle::PollerSendNext(bool fromTicker)
+  {
+  // ESP_LOGD(TAG, "PollerSendNext(%d): entry at[type=%02X, pid=%X], ticker=%u, cnt=%u/%u",
+  //          fromTicker, m_poll_plcur->type, m_poll_plcur->pid,
+  //          m_poll_ticker, m_poll_sequence_cnt, m_poll_sequence_max);
+
+  // Get free request slot:
+  PollerStoreEngine();
+  int slot = PollerGetFreeRequest(m_poll_engine);
+  if (slot < 0) return false;
+
+  // Asynchronous requests take turns with the poll list entries:
+  if (m_poll_engine->async_turn && PollerSendAsync(slot, fromTicker)) return true;
+
+  // Check poll bus & list:
+  if (!m_poll_bus_default || !m_poll_plist || m_poll_plist->txmoduleid == 0)
+    return PollerSendAsync(slot, fromTicker);
+
+  // Millisecond schedule: start the entry due first
+  int64_t now = esp_timer_get_time() / 1000;
+  if (!m_poll_engine->schedule_valid)
+    PollerBuildSchedule(now);
+  std::vector<poll_schedule_t>& schedule = m_poll_engine->schedule;
+  if (!schedule.empty() && schedule.front().due <= now &&
+      !PollerRequestConflicts(schedule.front().entry))
+    {
+    std::pop_heap(schedule.begin(), schedule.end(), PollerScheduleLater);
+    poll_schedule_t& next = schedule.back();
+    const poll_pid_t* entry = next.entry;
+    // Keep the phase, skip missed intervals:
+    next.due += next.interval;
+    if (next.due <= now)
+      next.due += ((now - next.due) / next.interval + 1) * next.interval;
+    std::push_heap(schedule.begin(), schedule.end(), PollerScheduleLater);
+    PollerSelectRequest(slot);
+    PollerStartEntry(entry, fromTicker);
+    m_poll_engine->async_turn = true;
+    return true;
+    }
+
+  // Multiple DID entry sent as single requests: continue with the next DID
+  if (m_poll_engine->multi_entry && PollerSequenceAllowed() &&
+      !PollerRequestConflicts(m_poll_engine->multi_entry))
+    {
+    PollerSelectRequest(slot);
+    PollerStartEntry(m_poll_engine->multi_entry, fromTicker);
+    m_poll_sequence_cnt++;
+    m_poll_engine->async_turn = true;
+    return true;
+    }
+
+  // Second entries: process the list once per tick
+  if (m_poll_engine->cycle_done || !PollerSequenceAllowed())
+    return PollerSendAsync(slot, fromTicker);
+
+  // Get entries due at this tick:
+  if (!m_poll_engine->due_valid)
+    PollerCollectDue();
+
+  if (m_poll_engine->duepos < m_poll_engine->due.size())
+    {
+    // We need to poll this one, as soon as no request to the same ECU is in flight:
+    const poll_pid_t* entry = m_poll_engine->due[m_poll_engine->duepos];
+    if (PollerRequestConflicts(entry))
+      return PollerSendAsync(slot, fromTicker);
+    PollerSelectRequest(slot);
+    PollerStartEntry(entry, fromTicker);
+    m_poll_engine->duepos++;
+    m_poll_plcur = entry + 1;
+    m_poll_sequence_cnt++;
+    m_poll_engine->async_turn = true;
+    return true;
+    }
+
+  // Completed checking all poll entries for the current m_poll_ticker
+  // ESP_LOGD(TAG, "PollerSendNext(%d): cycle complete for ticker=%u", fromTicker, m_poll_ticker);
+  m_poll_plcur = m_poll_plist;
+  m_poll_ticker++;
+  if (m_poll_ticker > 3600) m_poll_ticker -= 3600;
+  m_poll_engine->cycle_done = true;
+  m_poll_engine->due_valid = false;
+  return PollerSendAsync(slot, fromTicker);
+  }
+
+
+/**
+ * PollerAdaptiveCeiling: internal: get adaptive throttling ceiling, 0 = off
+ */
+uint8_t OvmsVehicle::PollerAdaptiveCeiling()
+  {
+  return (m_poll_adaptive_cfg >= 0) ? LIMIT_MAX(m_poll_adaptive_cfg, 255) : m_poll_adaptive_max;
+  }
+
+
+/**
+ * PollerSequenceAllowed: internal: check throttling for the next second entry
+ *  on the selected engine
+ */
+bool OvmsVehicle::PollerSequenceAllowed()
+  {
+  if (!m_poll_engine)
+    return false;
+  if (PollerAdaptiveCeiling())
+    return m_poll_sequence_cnt < LIMIT_MIN((int)m_poll_engine->aimd_limit, 1);
+  return (!m_poll_sequence_max || m_poll_sequence_cnt < m_poll_sequence_max);
+  }
+
+
+/**
+ * PollerDeliverReply: internal: pass a response frame payload to the vehicle
+ *  Calls IncomingPollReply() for each frame, or with reassembly enabled, collects the
+ *  payload in the request slot's buffer and calls IncomingPollResponse() on completion.
+ *  Responses to asynchronous requests are collected for their callback instead.
+ *  The buffer capacity is kept, so reallocations only occur on new max response sizes.
+ *  
+ *  @param bus          CAN bus of the response
+ *  @param data         Frame payload
+ *  @param length       Frame payload size
+ */
+void OvmsVehicle::PollerDeliverReply(canbus* bus, uint8_t* data, uint8_t length)
+  {
+  poll_async_t* async = m_poll_engine ? m_poll_engine->req[m_poll_engine->reqidx].async : NULL;
+  if (async)
+    {
+    if (m_poll_ml_frame == 0)
+      {
+      async->response.clear();
+      async->response.reserve(length + m_poll_ml_remain);
+      }
+    async->response.append((char*)data, length);
+    if (m_poll_ml_remain == 0)
+      PollerAsyncDone(POLLSINGLE_OK);
+    return;
+    }
+  const poll_pid_t* multi = m_poll_engine ? m_poll_engine->req[m_poll_engine->reqidx].multi : NULL;
+  if ((!m_poll_reassemble && !multi) || !m_poll_engine)
+    {
+    IncomingPollReply(bus, m_poll_type, m_poll_pid, data, length, m_poll_ml_remain);
+    return;
+    }
+  std::string& rxbuf = m_poll_engine->rxbuf[m_poll_engine->reqidx];
+  if (m_poll_ml_frame == 0)
+    {
+    rxbuf.clear();
+    rxbuf.reserve(length + m_poll_ml_remain);
+    }
+  rxbuf.append((char*)data, length);
+  if (m_poll_ml_remain == 0)
+    {
+    if (multi)
+      PollerSplitMultiDID(bus, multi, rxbuf);
+    else
+      IncomingPollResponse(bus, m_poll_type, m_poll_pid, (const uint8_t*)rxbuf.data(), rxbuf.size());
+    }
+  }
+
+
+/**
+ * PollerDeliverError: internal: pass a negative response code to the vehicle
+ *  or the callback of an asynchronous request
+ */
+void OvmsVehicle::PollerDeliverError(canbus* bus, uint16_t code)
+  {
+  if (PollerAsyncDone(code))
+    return;
+  const poll_pid_t* multi = m_poll_engine ? m_poll_engine->req[m_poll_engine->reqidx].multi : NULL;
+  if (!multi)
+    {
+    IncomingPollError(bus, m_poll_type, m_poll_pid, code);
+    }
+  else if (code == 0x12 || code == 0x13 || code == 0x14 || code == 0x31)
+    {
+    // Multiple DID request rejected (format, length or unsupported DID):
+    PollerMultiDIDFallback(multi, 0);
+    }
+  else
+    {
+    uint16_t pid = m_poll_pid;
+    for (int i = 0; i < multi->dargs.count; i++)
+      {
+      m_poll_pid = multi->dargs.dids[i].did;
+      IncomingPollError(bus, m_poll_type, m_poll_pid, code);
+      }
+    m_poll_pid = pid;
+    }
+  }
+
+
+/**
+ * PollerPrepareMultiDID: internal: prepare the request for a multiple DID entry
+ *  The DIDs are requested by one request, or by single requests if the ECU rejected
+ *  multiple DID requests before. Single DIDs are continued by PollerSendNext().
+ */
+void OvmsVehicle::PollerPrepareMultiDID(const poll_pid_t* entry)
+  {
+  poll_engine_t* engine = m_poll_engine;
+  int count = LIMIT_MAX(entry->dargs.count, 2047);
+  if (count == 0)
+    return;
+
+  if (count == 1 || engine->ecus[entry->txmoduleid].single_dids)
+    {
+    int index = (engine->multi_entry == entry) ? engine->multi_next : 0;
+    m_poll_entry.args = {};
+    m_poll_entry.args.pid = entry->dargs.dids[index].did;
+    if (index + 1 < count)
+      {
+      engine->multi_entry = entry;
+      engine->multi_next = index + 1;
+      }
+    else
+      {
+      engine->multi_entry = NULL;
+      }
+    return;
+    }
+
+  std::string& txbuf = engine->txbuf[engine->reqidx];
+  txbuf.clear();
+  for (int i = 1; i < count; i++)
+    {
+    txbuf.push_back(entry->dargs.dids[i].did >> 8);
+    txbuf.push_back(entry->dargs.dids[i].did & 0xff);
+    }
+  m_poll_entry.xargs.pid = entry->dargs.dids[0].did;
+  m_poll_entry.xargs.tag = POLL_TXDATA;
+  m_poll_entry.xargs.datalen = txbuf.size();
+  m_poll_entry.xargs.data = (const uint8_t*)txbuf.data();
+  engine->req[engine->reqidx].multi = entry;
+  }
+
+
+/**
+ * PollerSplitMultiDID: internal: pass a multiple DID response on per DID
+ *  The response (without the first DID) is split using the DID table lengths.
+ *  DIDs omitted by the ECU get an error 0x31 (requestOutOfRange), a response not
+ *  matching the table switches the ECU to single DID requests.
+ */
+void OvmsVehicle::PollerSplitMultiDID(canbus* bus, const poll_pid_t* entry, std::string& response)
+  {
+  const poll_did_t* dids = entry->dargs.dids;
+  int count = LIMIT_MAX(entry->dargs.count, 2047);
+  uint8_t* data = (uint8_t*) &response[0];
+  size_t size = response.size(), pos = 0;
+  uint16_t pid = m_poll_pid;
+  int i = 0;
+
+  while (i < count)
+    {
+    if (i > 0)
+      {
+      // Find the next DID, skipping omitted ones:
+      if (pos + 2 > size)
+        break;
+      uint16_t did = data[pos] << 8 | data[pos+1];
+      int k = i;
+      while (k < count && dids[k].did != did)
+        k++;
+      if (k == count)
+        break;
+      for (; i < k; i++)
+        {
+        m_poll_pid = dids[i].did;
+        IncomingPollError(bus, m_poll_type, m_poll_pid, 0x31);
+        }
+      pos += 2;
+      }
+    if (pos + dids[i].length > size)
+      break;
+    PollerDeliverDID(bus, dids[i].did, data + pos, dids[i].length);
+    pos += dids[i].length;
+    i++;
+    }
+  m_poll_pid = pid;
+
+  if (i < count && pos == size)
+    {
+    // Trailing DIDs omitted:
+    for (; i < count; i++)
+      IncomingPollError(bus, m_poll_type, dids[i].did, 0x31);
+    }
+  else if (i < count || pos != size)
+    {
+    ESP_LOGW(TAG, "PollerSplitMultiDID: %s ECU %03x: response mismatch at DID %04X",
+             bus->GetName(), entry->txmoduleid, (i < count) ? dids[i].did : dids[count-1].did);
+    PollerMultiDIDFallback(entry, (i < count) ? i : count);
+    }
+  }
+
+
+/**
+ * PollerDeliverDID: internal: pass a single DID response split from a multiple DID response
+ *  With reassembly, IncomingPollResponse() is called, else IncomingPollReply() in
+ *  parts of up to 255 bytes.
+ */
+void OvmsVehicle::PollerDeliverDID(canbus* bus, uint16_t did, uint8_t* data, uint16_t length)
+  {
+  uint16_t ml_frame = m_poll_ml_frame, ml_offset = m_poll_ml_offset;
+  m_poll_pid = did;
+  if (m_poll_reassemble)
+    {
+    IncomingPollResponse(bus, m_poll_type, did, data, length);
+    }
+  else
+    {
+    m_poll_ml_frame = 0;
+    m_poll_ml_offset = 0;
+    do
+      {
+      uint8_t part = LIMIT_MAX(length - m_poll_ml_offset, 255);
+      m_poll_ml_remain = length - m_poll_ml_offset - part;
+      IncomingPollReply(bus, m_poll_type, did, data + m_poll_ml_offset, part, m_poll_ml_remain);
+      m_poll_ml_offset += part;
+      m_poll_ml_frame++;
+      } while (m_poll_ml_remain > 0);
+    }
+  m_poll_ml_frame = ml_frame;
+  m_poll_ml_offset = ml_offset;
+  }
+
+
+/**
+ * PollerMultiDIDFallback: internal: switch the ECU of a multiple DID entry to single
+ *  DID requests, and request the DIDs from index on singly.
+ */
+void OvmsVehicle::PollerMultiDIDFallback(const poll_pid_t* entry, int index)
+  {
+  poll_ecu_stats_t& ecu = m_poll_engine->ecus[entry->txmoduleid];
+  if (!ecu.single_dids)
+    {
+    ESP_LOGW(TAG, "PollerMultiDIDFallback: %s ECU %03x: multiple DID request rejected, using single requests",
+             m_poll_bus->GetName(), entry->txmoduleid);
+    ecu.single_dids = true;
+    }
+  if (index < entry->dargs.count)
+    {
+    m_poll_engine->multi_entry = entry;
+    m_poll_engine->multi_next = index;
+    }
+  }
+
+
+/**
+ * PollerEntryStats: internal: get statistics of the current request's poll entry
+ *  Entries are identified by TX ID, type & PID, so the statistics persist over
+ *  poll list changes.
+ *  
+ *  @return             Statistics record or NULL if no request is selected
+ */
+OvmsVehicle::poll_entry_stats_t* OvmsVehicle::PollerEntryStats()
+  {
+  if (!m_poll_engine || m_poll_entry.txmoduleid == 0)
+    return NULL;
+  uint64_t key = (uint64_t)m_poll_entry.txmoduleid << 32 | (uint32_t)m_poll_entry.type << 16 | m_poll_entry.pid;
+  return &m_poll_engine->entries[key];
+  }
+
+
+/**
+ * PollerTrackFrame: internal: account a request/response frame in the entry statistics
+ *  The bus usage is estimated from the frame size excluding bit stuffing
+ *  (47 bits standard / 67 bits extended frame overhead incl. interframe space).
+ */
+void OvmsVehicle::PollerTrackFrame(poll_entry_stats_t* stats, const CAN_frame_t* frame, bool rx)
+  {
+  if (!stats)
+    return;
+  if (rx)
+    {
+    stats->rxframes++;
+    stats->rxbytes += frame->FIR.B.DLC;
+    }
+  else
+    {
+    stats->txframes++;
+    }
+  stats->busbits += ((frame->FIR.B.FF == CAN_frame_ext) ? 67 : 47) + 8 * frame->FIR.B.DLC;
+  }
+
+
+/**
+ * PollerTrackResponse: internal: account response completion for the current request
+ *  Updates the statistics, ECU latency and adaptive throttling rate.
+ *  
+ *  @param code         0 = positive response, else NRC
+ */
+void OvmsVehicle::PollerTrackResponse(uint16_t code)
+  {
+  poll_engine_t* engine = m_poll_engine;
+  if (!engine)
+    return;
+  poll_ecu_stats_t& ecu = engine->ecus[m_poll_entry.txmoduleid];
+  float latency = (esp_timer_get_time() - engine->req[engine->reqidx].sent_time) / 1000.0;
+  bool slow = (ecu.responses + ecu.errors > 0) && (latency > 2 * ecu.latency + 50);
+  ecu.latency = (ecu.responses + ecu.errors > 0) ? (ecu.latency * 7 + latency) / 8 : latency;
+  if (latency > ecu.latency_max)
+    ecu.latency_max = latency;
+
+  poll_entry_stats_t* stats = PollerEntryStats();
+  if (stats)
+    {
+    if (stats->responses + stats->errors == 0 || latency < stats->latency_min)
+      stats->latency_min = latency;
+    if (latency > stats->latency_max)
+      stats->latency_max = latency;
+    stats->latency_sum += latency;
+    if (code)
+      stats->errors++;
+    else
+      stats->responses++;
+    }
+
+  if (code)
+    {
+    engine->stats.errors++;
+    ecu.errors++;
+    if (code == 0x21) // busyRepeatRequest
+      PollerBackoff();
+    return;
+    }
+
+  engine->stats.responses++;
+  ecu.responses++;
+
+  // Additive increase, unless the ECU slows down:
+  uint8_t ceiling = PollerAdaptiveCeiling();
+  if (ceiling && !slow)
+    engine->aimd_limit = LIMIT_MAX(engine->aimd_limit + 1 / engine->aimd_limit, (float)ceiling);
+  }
+
+
+/**
+ * PollerTrackFailure: internal: account timeout / TX failure for the current request
+ */
+void OvmsVehicle::PollerTrackFailure(bool txfailure)
+  {
+  poll_engine_t* engine = m_poll_engine;
+  if (!engine)
+    return;
+  if (txfailure)
+    {
+    engine->stats.txfailures++;
+    }
+  else
+    {
+    engine->stats.timeouts++;
+    engine->ecus[m_poll_entry.txmoduleid].timeouts++;
+    poll_entry_stats_t* stats = PollerEntryStats();
+    if (stats)
+      stats->timeouts++;
+    }
+  PollerBackoff();
+  }
+
+
+/**
+ * PollerBackoff: internal: multiplicative decrease of the adaptive throttling rate
+ *  Applied at most once per tick, as requests in flight mostly fail together.
+ */
+void OvmsVehicle::PollerBackoff()
+  {
+  poll_engine_t* engine = m_poll_engine;
+  if (PollerAdaptiveCeiling() && engine->aimd_backoff_time != monotonictime)
+    {
+    engine->aimd_limit = LIMIT_MIN(engine->aimd_limit / 2, 1.0f);
+    engine->aimd_backoff_time = monotonictime;
+    engine->stats.backoffs++;
+    }
+  }
+
+
+/**
+ * PollerStartEntry: internal: start request for a poll list entry on the selected engine
+ */
+void OvmsVehicle::PollerStartEntry(const poll_pid_t* entry, bool fromTicker)
+  {
+  m_poll_entry = *entry;
+  m_poll_engine->req[m_poll_engine->reqidx].multi = NULL;
+  if (entry->dargs.tag == POLL_MULTIDID)
+    PollerPrepareMultiDID(entry);
+  m_poll_protocol = entry->protocol;
+  m_poll_type = entry->type;
+  m_poll_pid = m_poll_entry.pid;
+  m_poll_engine->req[m_poll_engine->reqidx].sent_time = esp_timer_get_time();
+  m_poll_engine->req[m_poll_engine->reqidx].tx_due = 0;
+  m_poll_engine->req[m_poll_engine->reqidx].tx_sending = false;
+  poll_entry_stats_t* stats = PollerEntryStats();
+  if (stats)
+    stats->sent++;
+
+  // Dispatch transmission start to protocol handler:
+  if (m_poll_protocol == VWTP_20)
+    PollerVWTPStart(fromTicker);
+  else
+    PollerISOTPStart(fromTicker);
+
+  m_poll_engine->stats.sent++;
+  }
+
+
+/**
+ * PollerBuildSchedule: internal: build millisecond schedule heap for the selected engine
+ */
+void OvmsVehicle::PollerBuildSchedule(int64_t now)
+  {
+  std::vector<poll_schedule_t>& schedule = m_poll_engine->schedule;
+  schedule.clear();
+  for (const poll_pid_t* entry : m_poll_plan[m_poll_state].ms)
+    {
+    if (PollerGetBus(entry) == m_poll_engine->bus)
+      {
+      schedule.push_back({ now + entry->pollphase, entry->polltime[m_poll_state], entry });
+      }
+    }
+  std::make_heap(schedule.begin(), schedule.end(), PollerScheduleLater);
+  m_poll_engine->schedule_valid = true;
+  }
+
+
+/**
+ * PollerArmTimer: internal: arm the schedule timer for the next millisecond entry
+ *  or ISO-TP consecutive frame due
+ *  Engines without a free request slot are skipped, they continue on a response/timeout.
+ *  The same applies if the next scheduled entry conflicts with a request in flight
+ *  (same ECU, exclusive request or pending multiple DID sequence): the schedule heap
+ *  is processed in due order, so nothing can be started before that request is done.
+ *  Must be called with m_poll_mutex held, after storing the selected engine.
+ */
+void OvmsVehicle::PollerArmTimer()
+  {
+  int64_t due = 0;
+  for (int i = 0; i < VEHICLE_POLL_NBUSES; i++)
+    {
+    poll_engine_t* engine = m_poll_engines[i];
+    if (!engine)
+      continue;
+    if (!engine->schedule.empty() && PollerGetFreeRequest(engine) >= 0 &&
+        (due == 0 || engine->schedule.front().due * 1000 < due) &&
+        !PollerRequestConflicts(engine->schedule.front().entry, engine))
+      due = engine->schedule.front().due * 1000;
+    for (int k = 0; k < VEHICLE_POLL_MAXINFLIGHT; k++)
+      {
+      if (engine->req[k].wait && engine->req[k].tx_due &&
+          (due == 0 || engine->req[k].tx_due < due))
+        due = engine->req[k].tx_due;
+      }
+    }
+
+  if (due == m_poll_timer_due)
+    return;
+
+  if (!m_poll_timer)
+    {
+    esp_timer_create_args_t args = {};
+    args.callback = &OvmsVehicle::PollerTimerCallback;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "OVMS Poller";
+    if (esp_timer_create(&args, &m_poll_timer) != ESP_OK)
+      {
+      ESP_LOGE(TAG, "PollerArmTimer: failed to create schedule timer");
+      m_poll_timer = NULL;
+      return;
+      }
+    }
+
+  esp_timer_stop(m_poll_timer);
+  m_poll_timer_due = due;
+  if (due)
+    {
+    int64_t delay = due - esp_timer_get_time();
+    esp_timer_start_once(m_poll_timer, (delay > 50) ? delay : 50);
+    }
+  }
+
+
+/**
+ * PollerTimerCallback: internal: schedule timer callback (esp_timer task)
+ *  Signals the vehicle task to run the schedule by an empty frame (origin NULL),
+ *  so requests are sent and responses handled in the vehicle task context.
+ */
+void OvmsVehicle::PollerTimerCallback(void* arg)
+  {
+  OvmsVehicle* me = (OvmsVehicle*) arg;
+  CAN_frame_t frame = {};
+  me->m_poll_timer_due = 0;
+  xQueueSend(me->m_rxqueue, &frame, 0);
+  }
+
+
+/**
+ * PollerRunSchedule: internal: continue ISO-TP transmissions, start due millisecond
+ *  entries & asynchronous requests on all engines with free slots
+ */
+void OvmsVehicle::PollerRunSchedule()
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  int64_t now_us = esp_timer_get_time();
+  int64_t now = now_us / 1000;
+
+  for (int i = 0; i < VEHICLE_POLL_NBUSES; i++)
+    {
+    poll_engine_t* engine = m_poll_engines[i];
+    if (!engine)
+      continue;
+    for (int k = 0; k < VEHICLE_POLL_MAXINFLIGHT; k++)
+      {
+      if (engine->req[k].wait && engine->req[k].tx_due && engine->req[k].tx_due <= now_us)
+        {
+        PollerSelectEngine(engine);
+        PollerSelectRequest(k);
+        PollerISOTPTransmit();
+        PollerStoreEngine();
+        }
+      }
+    if (engine->bus && PollerGetFreeRequest(engine) >= 0 &&
+        ((!engine->schedule.empty() && engine->schedule.front().due <= now) ||
+         PollerAsyncPending(engine->bus)))
+      {
+      PollerSelectEngine(engine);
+      PollerSendBus(false);
+      PollerStoreEngine();
+      }
+    }
+
+  PollerArmTimer();
+  }
+
+
+/**
+ * PollerTxCallback: internal: process poll request callbacks
+ */
+void OvmsVehicle::PollerTxCallback(const CAN_frame_t* frame, bool success)
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+
+  poll_engine_t* engine = PollerGetEngine(frame->origin, false);
+  if (!engine)
+    return;
+  PollerSelectEngine(engine);
+
+  // Find the request sent by this frame:
+  PollerStoreRequest();
+  int index;
+  for (index = 0; index < VEHICLE_POLL_MAXINFLIGHT; index++)
+    {
+    const poll_request_t* req = &engine->req[index];
+    if (req->wait && (req->txmsgid == frame->MsgID || (req->tx_sending &&
+        frame->MsgID == ((req->protocol == ISOTP_EXTADR) ? req->tx_id >> 8 : req->tx_id))))
+      break;
+    }
+  if (index == VEHICLE_POLL_MAXINFLIGHT)
+    return;
+  PollerSelectRequest(index);
+
+  // ISO-TP consecutive frame sent: the separation time to the next frame starts now
+  poll_request_t* req = &engine->req[index];
+  uint8_t pci = frame->data.u8[(m_poll_protocol == ISOTP_EXTADR) ? 1 : 0];
+  if (req->tx_sending && (pci >> 4) == ISOTP_FT_CONSECUTIVE)
+    {
+    req->tx_sending = false;
+    if (success && m_poll_wait)
+      {
+      req->tx_due = esp_timer_get_time() + req->tx_septime;
+      PollerStoreEngine();
+      PollerArmTimer();
+      return;
+      }
+    }
+
+  // Check for a late callback:
+  if (!m_poll_wait || frame->origin != m_poll_bus || frame->MsgID != m_poll_txmsgid)
+    return;
+  if (success)
+    PollerTrackFrame(PollerEntryStats(), frame, false);
+
+  // Forward to protocol handler:
+  if (m_poll_protocol == VWTP_20)
+    PollerVWTPTxCallback(frame, success);
+
+  // On failure, try to speed up the current poll timeout:
+  if (!success)
+    {
+    PollerTrackFailure(true);
+    m_poll_wait = 0;
+    if (m_poll_single_rxbuf)
+      {
+      m_poll_single_rxerr = POLLSINGLE_TXFAILURE;
+      m_poll_single_rxbuf = NULL;
+      m_poll_single_rxdone.Give();
+      }
+    PollerAsyncDone(POLLSINGLE_TXFAILURE);
+    }
+
+  // Forward to application:
+  IncomingPollTxCallback(m_poll_bus, m_poll_moduleid_sent, m_poll_type, m_poll_pid, success);
+  PollerStoreEngine();
+  PollerArmTimer();
+  }
+
+
+/**
+ * PollerMatchFrame: internal: check a received frame against the engine's expectations
+ *  Done without locking, the protocol handlers check again after locking.
+ *  
+ *  @param engine       Engine of the frame's bus
+ *  @param frame        Frame received
+ *  @param index        … set to the request slot matched
+ *  @param msgid        … set to the response ID (ISOTP_EXTADR: including the address byte)
+ *  @param channel      … set to the VWTP_20 channel matched (active or parked), else NULL
+ *  @return             true = frame is expected by the poller
+ */
+bool OvmsVehicle::PollerMatchFrame(poll_engine_t* engine, const CAN_frame_t* frame,
+                                   int& index, uint32_t& msgid, vwtp_channel_t*& channel)
+  {
+  msgid = frame->MsgID;
+  index = 0;
+  channel = NULL;
+  if (engine->vwtp.bus == frame->origin && engine->vwtp.rxid == msgid)
+    {
+    channel = &engine->vwtp;
+    return true;
+    }
+
+  for (int i = 0; i < VEHICLE_POLL_VWTP_CHANNELS-1; i++)
+    {
+    if (engine->vwtp_pool[i].state != VWTP_Closed && engine->vwtp_pool[i].rxid == msgid)
+      {
+      channel = &engine->vwtp_pool[i];
+      return true;
+      }
+    }
+
+  for (index = 0; index < VEHICLE_POLL_MAXINFLIGHT; index++)
+    {
+    const poll_request_t* req = &engine->req[index];
+    if (!req->wait)
+      continue;
+    if (req->protocol == ISOTP_EXTADR)
+      msgid = frame->MsgID << 8 | frame->data.u8[0];
+    else
+      msgid = frame->MsgID;
+    if (msgid >= req->moduleid_low && msgid <= req->moduleid_high)
+      return true;
+    }
+  return false;
+  }
+
+
+/**
+ * PollerExpectsFrame: internal: check if a frame may be needed by the poller
+ *  Used by the CAN frame filter (see SetFrameFilter()), called in the CAN task context.
+ *  While the poller is busy in the vehicle task, the engine state may not reflect a
+ *  request just sent, so all frames are passed in that case.
+ */
+bool OvmsVehicle::PollerExpectsFrame(const CAN_frame_t* frame)
+  {
+  poll_engine_t* engine = PollerGetEngine(frame->origin, false);
+  if (!engine)
+    return false;
+  OvmsRecMutexLock lock(&m_poll_mutex, 0);
+  if (!lock.IsLocked())
+    return true;
+  int index;
+  uint32_t msgid;
+  vwtp_channel_t* channel;
+  return PollerMatchFrame(engine, frame, index, msgid, channel);
+  }
+
+
+/**
+ * PollerReceive: internal: dispatch received frame to the engine of its bus
+ *  Called by the vehicle task for every frame received, so application
+ *  callbacks are executed in the vehicle task context.
+ */
+void OvmsVehicle::PollerReceive(CAN_frame_t* frame)
+  {
+  poll_engine_t* engine = PollerGetEngine(frame->origin, false);
+  if (!engine)
+    return;
+
+  int index;
+  uint32_t msgid;
+  vwtp_channel_t* channel;
+  if (!PollerMatchFrame(engine, frame, index, msgid, channel))
+    return;
+  bool vwtp = (channel == &engine->vwtp);
+  if (channel && !vwtp)
+    {
+    PollerVWTPPoolReceive(frame, channel);
+    return;
+    }
+
+  // Collect metric updates of the reply handlers, notify after releasing the lock:
+  MetricBatch batch;
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  PollerSelectEngine(engine);
+  PollerSelectRequest(index);
+  poll_entry_stats_t* stats = PollerEntryStats();
+  bool profile = m_profile;
+  uint32_t start = profile ? xthal_get_ccount() : 0;
+  uint32_t txid = m_poll_moduleid_sent;
+  uint16_t type = m_poll_type, pid = m_poll_pid;
+  bool accepted;
+  if (vwtp)
+    accepted = PollerVWTPReceive(frame, msgid);
+  else
+    accepted = PollerISOTPReceive(frame, msgid);
+  if (accepted)
+    PollerTrackFrame(stats, frame, true);
+  if (profile && accepted)
+    ProfileRecord(ProfileKey(Profile_Poll, frame->origin->m_busnumber, txid, type, pid), start);
+  PollerStoreEngine();
+  PollerArmTimer();
+  }
+
+
+/**
+ * PollSingleRequest: perform prioritized synchronous single OBD2/UDS request
+ *  Pass a full OBD2/UDS request (mode/type, PID, additional payload).
+ *  The request is sent immediately, aborting a running poll list request. The previous
+ *  poller state is automatically restored after the request has been performed, but
+ *  without any guarantee for repetition or omission of an aborted poll.
+ *  On success, the response buffer will contain the response payload (may be empty).
+ *  
+ *  See OvmsVehicleFactory::obdii_request() for a usage example.
+ *  
+ *  ATT: must not be called from within the vehicle task context -- deadlock situation!
+ *  
+ *  @param bus          CAN bus to use for the request
+ *  @param txid         CAN ID to send to (0x7df = broadcast)
+ *  @param rxid         CAN ID to expect response from (broadcast: 0)
+ *  @param request      Request to send (binary string) (type + pid + up to 4095 bytes payload)
+ *  @param response     Response buffer (binary string) (multiple response frames assembled)
+ *  @param timeout_ms   Timeout for poller/response in milliseconds
+ *  @param protocol     Protocol variant: ISOTP_STD / ISOTP_EXTADR / ISOTP_EXTFRAME
+ *  
+ *  @return             POLLSINGLE_OK         (0)   -- success, response is valid
+ *                      POLLSINGLE_TIMEOUT    (-1)  -- timeout/poller unavailable
+ *                      POLLSINGLE_TXFAILURE  (-2)  -- CAN transmission failure
+ *                      else                  (>0)  -- UDS NRC detail code
+ *                      Note: response is only valid with return value 0
+ */
+int OvmsVehicle::PollSingleRequest(canbus* bus, uint32_t txid, uint32_t rxid,
+                                   std::string request, std::string& response,
+                                   int timeout_ms /*=3000*/, uint8_t protocol /*=ISOTP_STD*/)
+  {
+  if (!m_ready)
+    return -1;
+
+  RegisterListener();
+
+  OvmsRecMutexLock slock(&m_poll_single_mutex, pdMS_TO_TICKS(timeout_ms));
+  if (!slock.IsLocked())
+    return -1;
+
+  // prepare single poll:
+  OvmsVehicle::poll_pid_t poll[] =
+    {
+      { txid, rxid, 0, 0, { 999, 999, 999, 999 }, 0, protocol },
+      POLL_LIST_END
+    };
+
+  PollerBuildRequest(poll[0], request);
+
+  // acquire poller access:
+  if (!m_poll_mutex.Lock(pdMS_TO_TICKS(timeout_ms)))
+    return -1;
+
+  // save poller state:
+  canbus*           p_bus    = m_poll_bus_default;
+  const poll_pid_t* p_list   = m_poll_plist;
+  const poll_pid_t* p_plcur[VEHICLE_POLL_NBUSES];
+  uint32_t          p_ticker[VEHICLE_POLL_NBUSES];
+  PollerStoreEngine();
+  for (int i = 0; i < VEHICLE_POLL_NBUSES; i++)
+    {
+    p_plcur[i] = m_poll_engines[i] ? m_poll_engines[i]->plcur : NULL;
+    p_ticker[i] = m_poll_engines[i] ? m_poll_engines[i]->ticker : 0;
+    }
+
+  // start single poll:
+  PollSetPidList(bus, poll);
+  m_poll_single_rxdone.Take(0);
+  m_poll_single_rxbuf = &response;
+  PollerSend(true);
+  m_poll_mutex.Unlock();
+
+  // wait for response:
+  bool rxok = m_poll_single_rxdone.Take(pdMS_TO_TICKS(timeout_ms));
+
+  // restore poller state:
+  m_poll_mutex.Lock();
+  PollSetPidList(p_bus, p_list);
+  for (int i = 0; i < VEHICLE_POLL_NBUSES; i++)
+    {
+    if (!m_poll_engines[i])
+      continue;
+    m_poll_engines[i]->plcur = p_plcur[i];
+    m_poll_engines[i]->ticker = p_ticker[i];
+    }
+  if (m_poll_engine)
+    {
+    m_poll_plcur = m_poll_engine->plcur;
+    m_poll_ticker = m_poll_engine->ticker;
+    }
+  m_poll_single_rxbuf = NULL;
+  m_poll_mutex.Unlock();
+
+  return (rxok == pdFALSE) ? -1 : m_poll_single_rxerr;
+  }
+
+
+/**
+ * PollSingleRequest: perform prioritized synchronous single OBD2/UDS request
+ *  Convenience wrapper for standard PID polls, see above for main implementation.
+ *  
+ *  @param bus          CAN bus to use for the request
+ *  @param txid         CAN ID to send to (0x7df = broadcast)
+ *  @param rxid         CAN ID to expect response from (broadcast: 0)
+ *  @param polltype     OBD2/UDS poll type …
+ *  @param pid          … and PID to poll
+ *  @param response     Response buffer (binary string) (multiple response frames assembled)
+ *  @param timeout_ms   Timeout for poller/response in milliseconds
+ *  @param protocol     Protocol variant: ISOTP_STD / ISOTP_EXTADR / ISOTP_EXTFRAME
+ *  
+ *  @return             POLLSINGLE_OK         ( 0)  -- success, response is valid
+ *                      POLLSINGLE_TIMEOUT    (-1)  -- timeout/poller unavailable
+ *                      POLLSINGLE_TXFAILURE  (-2)  -- CAN transmission failure
+ *                      else                  (>0)  -- UDS NRC detail code
+ *                      Note: response is only valid with return value 0
+ */
+int OvmsVehicle::PollSingleRequest(canbus* bus, uint32_t txid, uint32_t rxid,
+                                   uint8_t polltype, uint16_t pid, std::string& response,
+                                   int timeout_ms /*=3000*/, uint8_t protocol /*=ISOTP_STD*/)
   {
   std::string request;
   request = (char) polltype;
@@ -518,6 +1728,295 @@ int OvmsVehicle::PollSingleRequest(canbus* bus, uint32_t txid, uint32_t rxid,
   }
 
 
+/**
+ * PollerBuildRequest: internal: set up a poll entry's type, PID & payload from a request
+ *  The entry payload points into the request string, which needs to stay unchanged.
+ */
+void OvmsVehicle::PollerBuildRequest(poll_pid_t& entry, const std::string& request)
+  {
+  assert(request.size() > 0);
+  entry.type = request[0];
+  entry.xargs.tag = POLL_TXDATA;
+
+  if (POLL_TYPE_HAS_16BIT_PID(entry.type))
+    {
+    assert(request.size() >= 3);
+    entry.xargs.pid = (uint8_t)request[1] << 8 | (uint8_t)request[2];
+    entry.xargs.datalen = LIMIT_MAX(request.size()-3, 4095);
+    entry.xargs.data = (const uint8_t*)request.data()+3;
+    }
+  else if (POLL_TYPE_HAS_8BIT_PID(entry.type))
+    {
+    assert(request.size() >= 2);
+    entry.xargs.pid = (uint8_t)request[1];
+    entry.xargs.datalen = LIMIT_MAX(request.size()-2, 4095);
+    entry.xargs.data = (const uint8_t*)request.data()+2;
+    }
+  else
+    {
+    entry.xargs.pid = 0;
+    entry.xargs.datalen = LIMIT_MAX(request.size()-1, 4095);
+    entry.xargs.data = (const uint8_t*)request.data()+1;
+    }
+  }
+
+
+/**
+ * PollSubmitRequest: queue asynchronous OBD2/UDS request
+ *  Pass a full OBD2/UDS request (mode/type, PID, additional payload). The request
+ *  is queued and sent interleaved with the poll list entries as soon as the bus has
+ *  a free request slot and no other request to the same ECU is in flight. The call
+ *  returns immediately, the result is passed to the callback.
+ *  
+ *  The callback is executed in the vehicle task context with the poller locked, so it
+ *  must not block and must not call PollSingleRequest() or PollBatchRequest(). It may
+ *  submit further asynchronous requests.
+ *  
+ *  @param bus          CAN bus to use for the request
+ *  @param txid         CAN ID to send to (0x7df = broadcast)
+ *  @param rxid         CAN ID to expect response from (broadcast: 0)
+ *  @param request      Request to send (binary string) (type + pid + up to 4095 bytes payload)
+ *  @param callback     Result callback, called with result code & response
+ *                      (see PollSingleRequest() for the result codes)
+ *  @param timeout_ms   Timeout for the request to be sent in milliseconds
+ *                      (responses time out as for poll list requests)
+ *  @param protocol     Protocol variant: ISOTP_STD / ISOTP_EXTADR / ISOTP_EXTFRAME / VWTP_20
+ *  
+ *  @return             false = poller unavailable, the callback will not be called
+ */
+bool OvmsVehicle::PollSubmitRequest(canbus* bus, uint32_t txid, uint32_t rxid,
+                                    std::string request, PollCallback callback,
+                                    int timeout_ms /*=3000*/, uint8_t protocol /*=ISOTP_STD*/)
+  {
+  if (!m_ready || !bus || request.empty())
+    return false;
+
+  RegisterListener();
+
+  poll_async_t* async = new poll_async_t;
+  async->bus = bus;
+  async->request = request;
+  async->callback = callback;
+  async->deadline = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+  async->entry = { txid, rxid, 0, 0, { 0, 0, 0, 0 }, 0, protocol };
+  PollerBuildRequest(async->entry, async->request);
+
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  if (!PollerGetEngine(bus, true))
+    {
+    delete async;
+    return false;
+    }
+  m_poll_async.push_back(async);
+
+  // Signal the vehicle task to send the request as soon as possible:
+  CAN_frame_t frame = {};
+  xQueueSend(m_rxqueue, &frame, 0);
+  return true;
+  }
+
+
+/**
+ * PollSubmitBatch: queue a set of asynchronous OBD2/UDS requests
+ *  The requests are sent like PollSubmitRequest(), i.e. interleaved with the poll list,
+ *  requests to distinct ECUs may be in flight concurrently (see PollSetMaxInFlight()).
+ *  The callback receives a copy of the batch with all results filled in, after the
+ *  last request has been completed. The callback context is the same as for
+ *  PollSubmitRequest().
+ *  
+ *  @param bus          CAN bus to use for the requests
+ *  @param batch        Requests (txid, rxid, request, protocol)
+ *  @param callback     Result callback
+ *  @param timeout_ms   Timeout for each request to be sent in milliseconds
+ *  
+ *  @return             false = poller unavailable, the callback will not be called
+ */
+bool OvmsVehicle::PollSubmitBatch(canbus* bus, const poll_batch_t& batch,
+                                  PollBatchCallback callback, int timeout_ms /*=3000*/)
+  {
+  if (!m_ready || !bus || batch.empty())
+    return false;
+
+  struct batchstate_t
+    {
+    poll_batch_t      batch;
+    size_t            remain;
+    PollBatchCallback callback;
+    };
+  std::shared_ptr<batchstate_t> state = std::make_shared<batchstate_t>();
+  state->batch = batch;
+  state->remain = batch.size();
+  state->callback = callback;
+
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  for (size_t i = 0; i < batch.size(); i++)
+    {
+    const poll_batch_item_t& item = batch[i];
+    bool queued = PollSubmitRequest(bus, item.txid, item.rxid, item.request,
+      [state, i](int result, const std::string& response)
+        {
+        state->batch[i].result = result;
+        state->batch[i].response = response;
+        if (--state->remain == 0 && state->callback)
+          state->callback(state->batch);
+        },
+      timeout_ms, item.protocol);
+    if (!queued)
+      {
+      state->batch[i].result = POLLSINGLE_TIMEOUT;
+      state->batch[i].response.clear();
+      if (--state->remain == 0 && state->callback)
+        state->callback(state->batch);
+      }
+    }
+  return true;
+  }
+
+
+/**
+ * PollBatchRequest: perform a set of OBD2/UDS requests and wait for all results
+ *  Synchronous version of PollSubmitBatch(). The requests are processed concurrently
+ *  and interleaved with the poll list, so this is faster than a sequence of
+ *  PollSingleRequest() calls.
+ *  
+ *  ATT: must not be called from within the vehicle task context -- deadlock situation!
+ *  
+ *  @param bus          CAN bus to use for the requests
+ *  @param batch        Requests (txid, rxid, request, protocol), results are filled in
+ *  @param timeout_ms   Timeout for each request to be sent in milliseconds
+ *  
+ *  @return             Number of successful requests (result POLLSINGLE_OK)
+ *                      or -1 if the poller is unavailable
+ */
+int OvmsVehicle::PollBatchRequest(canbus* bus, poll_batch_t& batch, int timeout_ms /*=3000*/)
+  {
+  struct waitstate_t
+    {
+    OvmsSemaphore     done;
+    poll_batch_t      batch;
+    };
+  std::shared_ptr<waitstate_t> state = std::make_shared<waitstate_t>();
+
+  for (auto& item : batch)
+    {
+    item.result = POLLSINGLE_TIMEOUT;
+    item.response.clear();
+    }
+
+  bool queued = PollSubmitBatch(bus, batch,
+    [state](const poll_batch_t& results)
+      {
+      state->batch = results;
+      state->done.Give();
+      }, timeout_ms);
+  if (!queued)
+    return -1;
+
+  // Requests expire after the timeout, responses within two poll ticks:
+  if (!state->done.Take(pdMS_TO_TICKS(timeout_ms + 3000)))
+    return 0;
+
+  batch = state->batch;
+  int ok = 0;
+  for (auto& item : batch)
+    {
+    if (item.result == POLLSINGLE_OK)
+      ok++;
+    }
+  return ok;
+  }
+
+
+/**
+ * PollerAsyncPending: internal: check for asynchronous requests queued for a bus
+ */
+bool OvmsVehicle::PollerAsyncPending(canbus* bus)
+  {
+  for (poll_async_t* async : m_poll_async)
+    {
+    if (async->bus == bus)
+      return true;
+    }
+  return false;
+  }
+
+
+/**
+ * PollerSendAsync: internal: start the next asynchronous request for the selected engine
+ *  Requests are taken in order, except those conflicting with a request in flight.
+ *  A running PollSingleRequest() has priority.
+ *  
+ *  @param slot         Free request slot to use
+ *  @return             true = request started
+ */
+bool OvmsVehicle::PollerSendAsync(int slot, bool fromTicker)
+  {
+  if (m_poll_single_rxbuf)
+    return false;
+  for (auto it = m_poll_async.begin(); it != m_poll_async.end(); it++)
+    {
+    poll_async_t* async = *it;
+    if (async->bus != m_poll_bus || PollerRequestConflicts(&async->entry))
+      continue;
+    m_poll_async.erase(it);
+    PollerSelectRequest(slot);
+    m_poll_engine->req[slot].async = async;
+    m_poll_engine->async_turn = false;
+    PollerStartEntry(&async->entry, fromTicker);
+    return true;
+    }
+  return false;
+  }
+
+
+/**
+ * PollerAsyncDone: internal: complete the asynchronous request of the selected slot
+ *  
+ *  @param result       Result code (POLLSINGLE_*) or NRC
+ *  @return             false = no asynchronous request in the slot
+ */
+bool OvmsVehicle::PollerAsyncDone(int result)
+  {
+  if (!m_poll_engine)
+    return false;
+  poll_request_t* req = &m_poll_engine->req[m_poll_engine->reqidx];
+  poll_async_t* async = req->async;
+  if (!async)
+    return false;
+  req->async = NULL;
+  if (result != POLLSINGLE_OK)
+    async->response.clear();
+  if (async->callback)
+    async->callback(result, async->response);
+  delete async;
+  return true;
+  }
+
+
+/**
+ * PollerAsyncExpire: internal: drop asynchronous requests not sent within their timeout
+ */
+void OvmsVehicle::PollerAsyncExpire()
+  {
+  int64_t now = esp_timer_get_time();
+  for (auto it = m_poll_async.begin(); it != m_poll_async.end(); )
+    {
+    poll_async_t* async = *it;
+    if (async->deadline > now)
+      {
+      it++;
+      continue;
+      }
+    it = m_poll_async.erase(it);
+    if (async->callback)
+      async->callback(POLLSINGLE_TIMEOUT, std::string());
+    delete async;
+    // the callback may have changed the queue:
+    it = m_poll_async.begin();
+    }
+  }
+
+
 /**
  * PollResultCodeName: get text representation of result code
  */
@@ -550,3 +2049,197 @@ const char* OvmsVehicle::PollResultCodeName(int code)
     default:    return NULL;
     }
   }
+
+
+/**
+ * PollerStatus: output per bus poller engine status & statistics
+ */
+void OvmsVehicle::PollerStatus(int verbosity, OvmsWriter* writer)
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  PollerStoreEngine();
+
+  uint8_t ceiling = PollerAdaptiveCeiling();
+  if (ceiling)
+    writer->printf("Poller: state %u, %s, adaptive throttling up to %u polls/tick\n",
+      m_poll_state, (m_poll_plist && m_poll_plist->txmoduleid != 0) ? "list active" : "no list",
+      ceiling);
+  else
+    writer->printf("Poller: state %u, %s, throttling %u polls/tick\n",
+      m_poll_state, (m_poll_plist && m_poll_plist->txmoduleid != 0) ? "list active" : "no list",
+      m_poll_sequence_max);
+
+  if (verbosity >= COMMAND_RESULT_NORMAL && m_poll_plist && m_poll_plist->txmoduleid != 0)
+    {
+    const poll_plan_t& plan = m_poll_plan[m_poll_state];
+    size_t entries = 0;
+    for (const poll_period_t& period : plan.periods)
+      entries += period.entries.size();
+    writer->printf("  Schedule: %u second entries in %u interval groups, %u millisecond entries\n",
+      (unsigned) entries, (unsigned) plan.periods.size(), (unsigned) plan.ms.size());
+    }
+
+  float total = 0;
+  int engines = 0;
+  for (int i = 0; i < VEHICLE_POLL_NBUSES; i++)
+    {
+    poll_engine_t* engine = m_poll_engines[i];
+    if (!engine)
+      continue;
+    engines++;
+    total += engine->stats.rate;
+    int inflight = 0;
+    for (int k = 0; k < VEHICLE_POLL_MAXINFLIGHT; k++)
+      if (engine->req[k].wait) inflight++;
+    writer->printf("  %s: ticker %u, in flight %d/%u, sent %u, responses %u, errors %u, timeouts %u, %.1f PIDs/s\n",
+      engine->bus->GetName(), engine->ticker,
+      inflight, engine->inflight_max,
+      engine->stats.sent, engine->stats.responses, engine->stats.errors, engine->stats.timeouts,
+      engine->stats.rate);
+    if (ceiling)
+      {
+      writer->printf("    adaptive: %.1f polls/tick, %u backoffs, %s\n",
+        engine->aimd_limit, engine->stats.backoffs,
+        (engine->aimd_backoff_time && monotonictime - engine->aimd_backoff_time < 10) ? "backing off" : "increasing");
+      }
+    if (engine->stats.txfailures)
+      writer->printf("    %u TX failures\n", engine->stats.txfailures);
+    if (engine->vwtp.state != VWTP_Closed)
+      writer->printf("    VW-TP channel %02X: %s\n", engine->vwtp.moduleid,
+        (engine->vwtp.state == VWTP_Idle) ? "idle" : "active");
+    for (int k = 0; k < VEHICLE_POLL_VWTP_CHANNELS-1; k++)
+      {
+      const vwtp_channel_t* channel = &engine->vwtp_pool[k];
+      if (channel->state != VWTP_Closed)
+        writer->printf("    VW-TP channel %02X: parked, last used %u sec ago\n", channel->moduleid,
+          monotonictime - channel->lastused);
+      }
+    if (verbosity >= COMMAND_RESULT_NORMAL)
+      {
+      for (auto& it : engine->ecus)
+        {
+        writer->printf("    ECU %03x: responses %u, errors %u, timeouts %u, latency %.0f ms (max %.0f ms)%s\n",
+          it.first, it.second.responses, it.second.errors, it.second.timeouts,
+          it.second.latency, it.second.latency_max,
+          it.second.single_dids ? ", single DIDs" : "");
+        }
+      }
+    }
+
+  if (engines == 0)
+    writer->puts("  No bus polled yet");
+  else
+    writer->printf("  Total: %.1f PIDs/s\n", total);
+  }
+
+
+/**
+ * PollerTimes: output poll entry statistics
+ *  Entries are listed per bus, sorted by their share of the bus time, to identify
+ *  the polls causing the most bus (and ECU) activity.
+ *  
+ *  @param verbosity    Output channel capacity
+ *  @param writer       Output channel
+ *  @param json         true = output in JSON format
+ */
+void OvmsVehicle::PollerTimes(int verbosity, OvmsWriter* writer, bool json)
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  int64_t now = esp_timer_get_time();
+  int engines = 0;
+
+  if (json)
+    writer->puts("{\"buses\":[");
+
+  for (int i = 0; i < VEHICLE_POLL_NBUSES; i++)
+    {
+    poll_engine_t* engine = m_poll_engines[i];
+    if (!engine)
+      continue;
+
+    // Sort by bus usage:
+    std::vector<std::pair<uint64_t, poll_entry_stats_t*>> list;
+    for (auto& it : engine->entries)
+      list.push_back(std::make_pair(it.first, &it.second));
+    std::sort(list.begin(), list.end(),
+      [](const std::pair<uint64_t, poll_entry_stats_t*>& a, const std::pair<uint64_t, poll_entry_stats_t*>& b)
+        { return a.second->busbits > b.second->busbits; });
+
+    float seconds = (now - engine->entries_time) / 1000000.0;
+    float bitrate = MAP_CAN_SPEED(engine->bus->m_speed);
+    float busbits = (seconds > 0 && bitrate > 0) ? seconds * bitrate : 0;
+
+    if (json)
+      writer->printf("%s{\"bus\":\"%s\",\"time\":%.0f,\"entries\":[",
+        (engines == 0) ? "" : ",", engine->bus->GetName(), seconds);
+    else
+      writer->printf("%s: %.0f seconds\n"
+        "  TxID     Type PID   Sent  Resp  NRCs  T/Os  Latency min/avg/max ms  RX bytes  Bus time\n",
+        engine->bus->GetName(), seconds);
+    engines++;
+
+    int cnt = 0;
+    for (auto& it : list)
+      {
+      const poll_entry_stats_t* st = it.second;
+      uint32_t txid = it.first >> 32;
+      uint16_t type = (it.first >> 16) & 0xffff;
+      uint16_t pid = it.first & 0xffff;
+      uint32_t latency_cnt = st->responses + st->errors;
+      float latency_avg = latency_cnt ? st->latency_sum / latency_cnt : 0;
+      float share = busbits ? st->busbits * 100 / busbits : 0;
+      if (json)
+        {
+        writer->printf("%s{\"txid\":%u,\"type\":%u,\"pid\":%u,\"sent\":%u,\"responses\":%u,"
+          "\"errors\":%u,\"timeouts\":%u,\"latency_min\":%.1f,\"latency_avg\":%.1f,"
+          "\"latency_max\":%.1f,\"rxframes\":%u,\"rxbytes\":%u,\"txframes\":%u,\"bustime\":%.3f}",
+          (cnt == 0) ? "" : ",", txid, type, pid, st->sent, st->responses,
+          st->errors, st->timeouts, st->latency_min, latency_avg,
+          st->latency_max, st->rxframes, st->rxbytes, st->txframes, share);
+        }
+      else
+        {
+        writer->printf("  %-8x %02x   %04x %5u %5u %5u %5u  %6.0f %6.0f %6.0f  %8u  %6.2f%%\n",
+          txid, type, pid, st->sent, st->responses, st->errors, st->timeouts,
+          st->latency_min, latency_avg, st->latency_max, st->rxbytes, share);
+        }
+      cnt++;
+      }
+
+    if (json)
+      writer->puts("]}");
+    else if (cnt == 0)
+      writer->puts("  No polls done yet");
+    }
+
+  if (json)
+    writer->puts("]}");
+  else if (engines == 0)
+    writer->puts("No bus polled yet");
+  }
+
+
+/**
+ * PollerResetStats: reset per bus poller engine & entry statistics
+ *  The per ECU multiple DID fallback state is kept, only the counters are cleared.
+ */
+void OvmsVehicle::PollerResetStats()
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  int64_t now = esp_timer_get_time();
+  for (int i = 0; i < VEHICLE_POLL_NBUSES; i++)
+    {
+    poll_engine_t* engine = m_poll_engines[i];
+    if (!engine)
+      continue;
+    engine->stats = {};
+    for (auto& it : engine->ecus)
+      {
+      bool single_dids = it.second.single_dids;
+      it.second = {};
+      it.second.single_dids = single_dids;
+      }
+    engine->entries.clear();
+    engine->entries_time = now;
+    }
+  }
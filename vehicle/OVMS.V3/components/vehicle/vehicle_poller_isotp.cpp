@@ -42,12 +42,12 @@ static const char *TAG = "vehicle-isotp";
  */
 void OvmsVehicle::PollerISOTPStart(bool fromTicker)
   {
-  if (m_poll_plcur->rxmoduleid != 0)
+  if (m_poll_entry.rxmoduleid != 0)
     {
     // send to <moduleid>, listen to response from <rmoduleid>:
-    m_poll_moduleid_sent = m_poll_plcur->txmoduleid;
-    m_poll_moduleid_low = m_poll_plcur->rxmoduleid;
-    m_poll_moduleid_high = m_poll_plcur->rxmoduleid;
+    m_poll_moduleid_sent = m_poll_entry.txmoduleid;
+    m_poll_moduleid_low = m_poll_entry.rxmoduleid;
+    m_poll_moduleid_high = m_poll_entry.rxmoduleid;
     }
   else
     {
@@ -58,7 +58,7 @@ void OvmsVehicle::PollerISOTPStart(bool fromTicker)
     }
 
   ESP_LOGD(TAG, "PollerISOTPStart(%d): send [bus=%d, type=%02X, pid=%X], expecting %03x/%03x-%03x",
-           fromTicker, m_poll_plcur->pollbus, m_poll_type, m_poll_pid, m_poll_moduleid_sent,
+           fromTicker, m_poll_entry.pollbus, m_poll_type, m_poll_pid, m_poll_moduleid_sent,
            m_poll_moduleid_low, m_poll_moduleid_high);
 
   //
@@ -75,15 +75,15 @@ void OvmsVehicle::PollerISOTPStart(bool fromTicker)
   uint16_t tx_datalen;            // Payload data length
   uint16_t tx_datasent;           // Payload data length sent with this frame
 
-  if (m_poll_plcur->xargs.tag == POLL_TXDATA)
+  if (m_poll_entry.xargs.tag == POLL_TXDATA)
     {
-    tx_data = m_poll_plcur->xargs.data;
-    tx_datalen = m_poll_plcur->xargs.datalen;
+    tx_data = m_poll_entry.xargs.data;
+    tx_datalen = m_poll_entry.xargs.datalen;
     }
   else
     {
-    tx_data = m_poll_plcur->args.data;
-    tx_datalen = m_poll_plcur->args.datalen;
+    tx_data = m_poll_entry.args.data;
+    tx_datalen = m_poll_entry.args.datalen;
     }
 
   CAN_frame_t txframe = {};
@@ -112,9 +112,9 @@ void OvmsVehicle::PollerISOTPStart(bool fromTicker)
     }
 
   // Do we need to split this request into multiple frames?
-  if (POLL_TYPE_HAS_16BIT_PID(m_poll_plcur->type))
+  if (POLL_TYPE_HAS_16BIT_PID(m_poll_entry.type))
     tp_len = 3 + tx_datalen;
-  else if (POLL_TYPE_HAS_8BIT_PID(m_poll_plcur->type))
+  else if (POLL_TYPE_HAS_8BIT_PID(m_poll_entry.type))
     tp_len = 2 + tx_datalen;
   else
     tp_len = 1 + tx_datalen;
@@ -134,7 +134,7 @@ void OvmsVehicle::PollerISOTPStart(bool fromTicker)
     }
 
   // Add TP data:
-  if (POLL_TYPE_HAS_16BIT_PID(m_poll_plcur->type))
+  if (POLL_TYPE_HAS_16BIT_PID(m_poll_entry.type))
     {
     tp_data[0] = m_poll_type;
     tp_data[1] = m_poll_pid >> 8;
@@ -142,7 +142,7 @@ void OvmsVehicle::PollerISOTPStart(bool fromTicker)
     tx_datasent = LIMIT_MAX(tx_datalen, tp_datalen - 3);
     memcpy(&tp_data[3], tx_data, tx_datasent);
     }
-  else if (POLL_TYPE_HAS_8BIT_PID(m_poll_plcur->type))
+  else if (POLL_TYPE_HAS_8BIT_PID(m_poll_entry.type))
     {
     tp_data[0] = m_poll_type;
     tp_data[1] = m_poll_pid;
@@ -170,6 +170,75 @@ void OvmsVehicle::PollerISOTPStart(bool fromTicker)
   }
 
 
+/**
+ * PollerISOTPTransmit: send consecutive frames of a multi frame request (internal method)
+ *  Sends the next frames of the current request's block. Without separation time, the
+ *  block is sent at once, else the next frame is scheduled on the poller timer, so the
+ *  transmission doesn't block the vehicle task (see PollerRunSchedule()). The separation
+ *  time starts when the frame has actually been sent, i.e. on its TX callback (see
+ *  PollerTxCallback()), not when it's queued.
+ */
+void OvmsVehicle::PollerISOTPTransmit()
+  {
+  poll_request_t* req = &m_poll_engine->req[m_poll_engine->reqidx];
+  CAN_frame_t tx_frame = {};
+  uint8_t* tx_data;
+  uint8_t tx_datalen;
+  uint8_t tx_datasent;
+
+  req->tx_due = 0;
+  req->tx_sending = false;
+  tx_frame.origin = m_poll_bus;
+  tx_frame.FIR.B.DLC = 8;
+
+  if (m_poll_protocol == ISOTP_EXTFRAME)
+    tx_frame.FIR.B.FF = CAN_frame_ext;
+  else
+    tx_frame.FIR.B.FF = CAN_frame_std;
+
+  if (m_poll_protocol == ISOTP_EXTADR)
+    {
+    tx_frame.MsgID = req->tx_id >> 8;
+    tx_frame.data.u8[0] = req->tx_id & 0xff;
+    tx_data = &tx_frame.data.u8[1];
+    tx_datalen = 6;
+    }
+  else
+    {
+    tx_frame.MsgID = req->tx_id;
+    tx_data = &tx_frame.data.u8[0];
+    tx_datalen = 7;
+    }
+
+  // Send next chunk of frames:
+  while (m_poll_tx_remain > 0)
+    {
+    ++m_poll_tx_frame;
+    tx_data[0] = (ISOTP_FT_CONSECUTIVE << 4) + (m_poll_tx_frame & 0x0f);
+    tx_datasent = LIMIT_MAX(m_poll_tx_remain, tx_datalen);
+    memcpy(&tx_data[1], m_poll_tx_data+m_poll_tx_offset, tx_datasent);
+    if (tx_datasent < tx_datalen)
+      memset(&tx_data[1+tx_datasent], 0x55, tx_datalen-tx_datasent);
+    m_poll_tx_offset += tx_datasent;
+    m_poll_tx_remain -= tx_datasent;
+    m_poll_wait = 2;
+
+    // Block complete, or wait for next flow control frame:
+    bool blockdone = (m_poll_tx_remain == 0 || (req->tx_block > 0 && --req->tx_block == 0));
+    if (!blockdone && req->tx_septime > 0)
+      {
+      // Schedule the next frame from the TX callback:
+      tx_frame.callback = &m_poll_txcallback;
+      req->tx_sending = true;
+      }
+    tx_frame.Write();
+
+    if (blockdone || req->tx_sending)
+      break;
+    }
+  }
+
+
 /**
  * PollerISOTPReceive: process ISO-TP poll response frame
  */
@@ -179,7 +248,7 @@ bool OvmsVehicle::PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid)
   char *hexdump = NULL;
 
   // After locking the mutex, check again for poll expectance match:
-  if (!m_poll_wait || !m_poll_plist || frame->origin != m_poll_bus ||
+  if (!m_poll_wait || frame->origin != m_poll_bus ||
       msgid < m_poll_moduleid_low || msgid > m_poll_moduleid_high)
     {
     ESP_LOGD(TAG, "PollerISOTPReceive[%03X]: dropping expired poll response", msgid);
@@ -264,6 +333,10 @@ bool OvmsVehicle::PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid)
       return false;
       }
 
+    poll_request_t* req = &m_poll_engine->req[m_poll_engine->reqidx];
+    req->tx_due = 0;
+    req->tx_sending = false;
+
     if (tp_fc_command == 1)
       {
       // add some wait time:
@@ -278,74 +351,28 @@ bool OvmsVehicle::PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid)
     else
       {
       // continue TX:
-      CAN_frame_t tx_frame = {};
-      uint8_t* tx_data;
-      uint8_t tx_datalen;
-      uint8_t tx_datasent;
-      uint32_t txid;
-      tx_frame.origin = frame->origin;
-      tx_frame.FIR.B.DLC = 8;
-
-      if (m_poll_protocol == ISOTP_EXTFRAME)
-        tx_frame.FIR.B.FF = CAN_frame_ext;
-      else
-        tx_frame.FIR.B.FF = CAN_frame_std;
-
       if (m_poll_moduleid_sent == 0x7df)
         {
         // broadcast request: derive module ID from response ID:
         // (Note: this only works for the SAE standard ID scheme)
-        txid = frame->MsgID - 8;
+        req->tx_id = frame->MsgID - 8;
         }
       else
         {
         // use known module ID:
-        txid = m_poll_moduleid_sent;
+        req->tx_id = m_poll_moduleid_sent;
         }
 
-      if (m_poll_protocol == ISOTP_EXTADR)
-        {
-        tx_frame.MsgID = txid >> 8;
-        tx_frame.data.u8[0] = txid & 0xff;
-        tx_data = &tx_frame.data.u8[1];
-        tx_datalen = 6;
-        }
+      // Block size & separation time, see ISO 15765-2 9.6.5:
+      req->tx_block = tp_fc_framecnt;
+      if (tp_fc_septime <= 0x7f)
+        req->tx_septime = tp_fc_septime * 1000;
+      else if (tp_fc_septime >= 0xf1 && tp_fc_septime <= 0xf9)
+        req->tx_septime = (tp_fc_septime - 0xf0) * 100;
       else
-        {
-        tx_frame.MsgID = txid;
-        tx_data = &tx_frame.data.u8[0];
-        tx_datalen = 7;
-        }
-
-      // Send next chunk of frames:
-      while (m_poll_tx_remain > 0)
-        {
-        ++m_poll_tx_frame;
-        tx_data[0] = (ISOTP_FT_CONSECUTIVE << 4) + (m_poll_tx_frame & 0x0f);
-        tx_datasent = LIMIT_MAX(m_poll_tx_remain, tx_datalen);
-        memcpy(&tx_data[1], m_poll_tx_data+m_poll_tx_offset, tx_datasent);
-        if (tx_datasent < tx_datalen)
-          memset(&tx_data[1+tx_datasent], 0x55, tx_datalen-tx_datasent);
-        tx_frame.Write();
-        m_poll_tx_offset += tx_datasent;
-        m_poll_tx_remain -= tx_datasent;
-
-        if (m_poll_tx_remain == 0)
-          break;
-        if (tp_fc_framecnt > 0 && --tp_fc_framecnt == 0)
-          break;
-
-        if (tp_fc_septime > 0)
-          {
-          if (tp_fc_septime <= 127)
-            usleep(tp_fc_septime * 1000);
-          else if (tp_fc_septime > 240)
-            usleep((tp_fc_septime - 240) * 100);
-          }
-        }
+        req->tx_septime = 127000; // reserved: use the max value
 
-      if (m_poll_tx_remain > 0)
-        m_poll_wait = 2;
+      PollerISOTPTransmit();
       }
 
     return true;
@@ -439,6 +466,7 @@ bool OvmsVehicle::PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid)
       // Error: forward to application:
       ESP_LOGD(TAG, "PollerISOTPReceive[%03X]: process OBD/UDS error %02X(%X) code=%02X",
                msgid, m_poll_type, m_poll_pid, error_code);
+      PollerTrackResponse(error_code);
       // Running single poll?
       if (m_poll_single_rxbuf)
         {
@@ -448,7 +476,7 @@ bool OvmsVehicle::PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid)
         }
       else
         {
-        IncomingPollError(frame->origin, m_poll_type, m_poll_pid, error_code);
+        PollerDeliverError(frame->origin, error_code);
         }
       // abort:
       m_poll_ml_remain = 0;
@@ -458,6 +486,7 @@ bool OvmsVehicle::PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid)
     {
     // Normal matching poll response, forward to application:
     m_poll_ml_remain = tp_len - tp_datalen;
+    if (m_poll_ml_remain == 0) PollerTrackResponse(0);
     ESP_LOGD(TAG, "PollerISOTPReceive[%03X]: process OBD/UDS response %02X(%X) frm=%u len=%u off=%u rem=%u",
              msgid, m_poll_type, m_poll_pid,
              m_poll_ml_frame, response_datalen, m_poll_ml_offset, m_poll_ml_remain);
@@ -479,7 +508,7 @@ bool OvmsVehicle::PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid)
       }
     else
       {
-      IncomingPollReply(frame->origin, m_poll_type, m_poll_pid, response_data, response_datalen, m_poll_ml_remain);
+      PollerDeliverReply(frame->origin, response_data, response_datalen);
       }
     }
   else
@@ -559,10 +588,10 @@ bool OvmsVehicle::PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid)
   // Immediately send the next poll for this tick if…
   // - we are not waiting for another frame
   // - the poll was no broadcast (with potential further responses from other devices)
-  // - poll throttling is unlimited or limit isn't reached yet
+  // - poll throttling is unlimited or limit isn't reached yet, or asynchronous requests are queued
   if (m_poll_wait == 0 &&
       m_poll_moduleid_sent != 0x7df &&
-      (!m_poll_sequence_max || m_poll_sequence_cnt < m_poll_sequence_max))
+      (PollerSequenceAllowed() || PollerAsyncPending(m_poll_bus)))
     {
     PollerSend(false);
     }
@@ -45,9 +45,10 @@ void OvmsVehicle::PollerVWTPStart(bool fromTicker)
   m_poll_vwtp.lastused = monotonictime;
 
   // Check connection state:
-  if (m_poll_vwtp.bus != m_poll_bus ||
-      m_poll_vwtp.baseid != m_poll_entry.txmoduleid ||
-      m_poll_vwtp.moduleid != m_poll_entry.rxmoduleid)
+  if ((m_poll_vwtp.bus != m_poll_bus ||
+       m_poll_vwtp.baseid != m_poll_entry.txmoduleid ||
+       m_poll_vwtp.moduleid != m_poll_entry.rxmoduleid) &&
+      !PollerVWTPSwapChannel())
     {
     // close or reconnect channel:
     if (m_poll_vwtp.state != VWTP_Closed)
@@ -61,6 +62,8 @@ void OvmsVehicle::PollerVWTPStart(bool fromTicker)
       m_poll_single_rxerr = POLLSINGLE_OK;
       m_poll_single_rxdone.Give();
       }
+    else
+      PollerAsyncDone(POLLSINGLE_OK);
     return;
     }
 
@@ -360,6 +363,148 @@ void OvmsVehicle::PollerVWTPEnter(vwtp_channelstate_t state)
   }
 
 
+/**
+ * PollerVWTPSwapChannel: switch to a parked channel to the current entry's module
+ *  if available, and park the idle current channel, closing the least recently
+ *  used parked channel if the pool is full (internal method).
+ *  
+ *  @return             true = switched to an open channel
+ */
+bool OvmsVehicle::PollerVWTPSwapChannel()
+  {
+  vwtp_channel_t* pool = m_poll_engine->vwtp_pool;
+  int poolsize = m_poll_ch_pool - 1;
+  if (poolsize <= 0)
+    return false;
+
+  // Explicit close: close parked channels as well
+  if (m_poll_entry.rxmoduleid == 0)
+    {
+    for (int i = 0; i < poolsize; i++)
+      PollerVWTPPoolClose(&pool[i]);
+    return false;
+    }
+
+  if (m_poll_vwtp.state != VWTP_Idle && m_poll_vwtp.state != VWTP_Closed)
+    return false;
+
+  int found = -1, place = -1;
+  for (int i = 0; i < poolsize; i++)
+    {
+    if (pool[i].state == VWTP_Closed)
+      {
+      if (place < 0 || pool[place].state != VWTP_Closed)
+        place = i;
+      }
+    else if (pool[i].bus == m_poll_bus &&
+             pool[i].baseid == m_poll_entry.txmoduleid &&
+             pool[i].moduleid == m_poll_entry.rxmoduleid)
+      found = i;
+    else if (place < 0 || (pool[place].state != VWTP_Closed && pool[i].lastused < pool[place].lastused))
+      place = i;
+    }
+
+  if (found >= 0)
+    {
+    // Resume parked channel, park current:
+    ESP_LOGD(TAG, "PollerVWTPSwapChannel[%02X]: resume channel, park [%02X]",
+      pool[found].moduleid, m_poll_vwtp.moduleid);
+    std::swap(m_poll_vwtp, pool[found]);
+    if (pool[found].state != VWTP_Idle)
+      pool[found] = {};
+    return true;
+    }
+
+  if (m_poll_vwtp.state == VWTP_Idle)
+    {
+    // Park current channel, close least recently used one if necessary:
+    if (pool[place].state != VWTP_Closed)
+      {
+      ESP_LOGD(TAG, "PollerVWTPSwapChannel[%02X]: pool full, closing LRU channel", pool[place].moduleid);
+      PollerVWTPPoolClose(&pool[place]);
+      }
+    ESP_LOGD(TAG, "PollerVWTPSwapChannel[%02X]: park channel", m_poll_vwtp.moduleid);
+    pool[place] = m_poll_vwtp;
+    m_poll_vwtp = {};
+    m_poll_vwtp.state = VWTP_Closed;
+    }
+  return false;
+  }
+
+
+/**
+ * PollerVWTPPoolSend: send a channel control frame on a parked channel (internal)
+ */
+void OvmsVehicle::PollerVWTPPoolSend(vwtp_channel_t* channel, uint8_t opcode)
+  {
+  CAN_frame_t txframe = {};
+  txframe.FIR.B.FF = CAN_frame_std;
+  txframe.MsgID = channel->txid;
+  txframe.data.u8[0] = opcode;
+  if (opcode == 0xA1)
+    {
+    // params response, see PollerVWTPReceive() sendPong:
+    txframe.FIR.B.DLC = 6;
+    txframe.data.u8[1] = 0x0F;
+    txframe.data.u8[2] = 0x8A;
+    txframe.data.u8[3] = 0xFF;
+    txframe.data.u8[4] = 0x0A;
+    txframe.data.u8[5] = 0xFF;
+    }
+  else
+    {
+    txframe.FIR.B.DLC = 1;
+    }
+  channel->bus->Write(&txframe);
+  }
+
+
+/**
+ * PollerVWTPPoolClose: close a parked channel (internal)
+ *  The close ACK is not awaited.
+ */
+void OvmsVehicle::PollerVWTPPoolClose(vwtp_channel_t* channel)
+  {
+  if (channel->state == VWTP_Closed)
+    return;
+  ESP_LOGD(TAG, "PollerVWTPPoolClose[%02X]: close parked channel txid=%03X rxid=%03X",
+    channel->moduleid, channel->txid, channel->rxid);
+  PollerVWTPPoolSend(channel, 0xA8);
+  *channel = {};
+  channel->state = VWTP_Closed;
+  }
+
+
+/**
+ * PollerVWTPPoolReceive: process frame received on a parked channel (internal)
+ */
+void OvmsVehicle::PollerVWTPPoolReceive(CAN_frame_t* frame, vwtp_channel_t* channel)
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  if (channel->state == VWTP_Closed || channel->bus != frame->origin || channel->rxid != frame->MsgID)
+    return;
+  uint8_t opcode = frame->data.u8[0];
+  if (opcode == 0xA3)
+    {
+    // Channel ping received:
+    PollerVWTPPoolSend(channel, 0xA1);
+    }
+  else if (opcode == 0xA8)
+    {
+    // Channel abort received, send ACK & discard channel:
+    ESP_LOGD(TAG, "PollerVWTPPoolReceive[%02X]: parked channel closed by ECU", channel->moduleid);
+    PollerVWTPPoolClose(channel);
+    }
+  else if ((opcode & 0xf0) <= 0x30)
+    {
+    // Out of band data frame, send ACK/abort:
+    channel->rxseqnr++;
+    PollerVWTPPoolSend(channel, 0x90 | (channel->rxseqnr & 0x0f));
+    }
+  // A1 = channel test response: nothing to do
+  }
+
+
 /**
  * PollerVWTPTxCallback: CAN transmission result (internal)
  */
@@ -509,6 +654,8 @@ bool OvmsVehicle::PollerVWTPReceive(CAN_frame_t* frame, uint32_t msgid)
           m_poll_single_rxerr = POLLSINGLE_OK;
           m_poll_single_rxdone.Give();
           }
+        else
+          PollerAsyncDone(POLLSINGLE_OK);
         }
       else
         {
@@ -699,6 +846,7 @@ bool OvmsVehicle::PollerVWTPReceive(CAN_frame_t* frame, uint32_t msgid)
             // Error: forward to application:
             ESP_LOGD(TAG, "PollerVWTPReceive[%02X]: process OBD/UDS error %02X(%X) code=%02X",
                       m_poll_vwtp.moduleid, m_poll_type, m_poll_pid, error_code);
+            PollerTrackResponse(error_code);
             // Running single poll?
             if (m_poll_single_rxbuf)
               {
@@ -708,7 +856,7 @@ bool OvmsVehicle::PollerVWTPReceive(CAN_frame_t* frame, uint32_t msgid)
               }
             else
               {
-              IncomingPollError(frame->origin, m_poll_type, m_poll_pid, error_code);
+              PollerDeliverError(frame->origin, error_code);
               }
             // abort receive:
             m_poll_ml_remain = 0;
@@ -723,6 +871,7 @@ bool OvmsVehicle::PollerVWTPReceive(CAN_frame_t* frame, uint32_t msgid)
 
           // Normal matching poll response, forward to application:
           m_poll_ml_remain -= tp_datalen;
+          if (m_poll_ml_remain == 0) PollerTrackResponse(0);
           ESP_LOGD(TAG, "PollerVWTPReceive[%02X]: process OBD/UDS response %02X(%X) frm=%u len=%u off=%u rem=%u",
                     m_poll_vwtp.moduleid, m_poll_type, m_poll_pid,
                     m_poll_ml_frame, response_datalen, m_poll_ml_offset, m_poll_ml_remain);
@@ -744,7 +893,7 @@ bool OvmsVehicle::PollerVWTPReceive(CAN_frame_t* frame, uint32_t msgid)
             }
           else
             {
-            IncomingPollReply(frame->origin, m_poll_type, m_poll_pid, response_data, response_datalen, m_poll_ml_remain);
+            PollerDeliverReply(frame->origin, response_data, response_datalen);
             }
           }
         else
@@ -787,9 +936,9 @@ bool OvmsVehicle::PollerVWTPReceive(CAN_frame_t* frame, uint32_t msgid)
 
   // Immediately send the next poll for this tick if…
   // - we are not waiting for another frame
-  // - poll throttling is unlimited or limit isn't reached yet
+  // - poll throttling is unlimited or limit isn't reached yet, or asynchronous requests are queued
   if (m_poll_wait == 0 &&
-      (!m_poll_sequence_max || m_poll_sequence_cnt < m_poll_sequence_max))
+      (PollerSequenceAllowed() || PollerAsyncPending(m_poll_bus)))
     {
     PollerSend(false);
     }
@@ -836,4 +985,17 @@ void OvmsVehicle::PollerVWTPTicker()
     ESP_LOGD(TAG, "PollerVWTPTicker[%02X]: channel inactivity timeout", m_poll_vwtp.moduleid);
     PollerVWTPEnter(VWTP_ChannelClose);
     }
+
+  // Parked channels: close on inactivity timeout or pool reduction, else send channel test:
+  for (int i = 0; i < VEHICLE_POLL_VWTP_CHANNELS-1; i++)
+    {
+    vwtp_channel_t* channel = &m_poll_engine->vwtp_pool[i];
+    if (channel->state == VWTP_Closed)
+      continue;
+    if (i >= m_poll_ch_pool - 1 ||
+        (m_poll_ch_keepalive > 0 && channel->lastused + m_poll_ch_keepalive < monotonictime))
+      PollerVWTPPoolClose(channel);
+    else
+      PollerVWTPPoolSend(channel, 0xA3);
+    }
   }
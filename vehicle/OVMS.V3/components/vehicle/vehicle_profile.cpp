@@ -0,0 +1,194 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Date:          14th March 2017
+;
+;    Changes:
+;    1.0  Initial release
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011        Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+#include "ovms_log.h"
+static const char *TAG = "vehicle-profile";
+
+#include <stdio.h>
+#include <algorithm>
+#include "sdkconfig.h"
+#include "vehicle.h"
+
+// CPU cycles per microsecond:
+#define PROFILE_CYCLES_US       CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ
+
+
+/**
+ * ProfileKey: internal: build a profile map key
+ *  Layout: kind (2 bits) | bus number (3) | type (8) | PID (16) | ID (35)
+ *  Frames use the frame format (standard/extended) as the type.
+ */
+uint64_t OvmsVehicle::ProfileKey(profile_kind_t kind, int busnumber, uint32_t id,
+                                 uint8_t type /*=0*/, uint16_t pid /*=0*/)
+  {
+  return ((uint64_t) kind << 62) | ((uint64_t) (busnumber & 7) << 59) |
+         ((uint64_t) type << 51) | ((uint64_t) pid << 35) | id;
+  }
+
+
+/**
+ * ProfileRecord: internal: add a call to the profile
+ *  @param key          see ProfileKey()
+ *  @param start        CPU cycle count at the start of the call
+ */
+void OvmsVehicle::ProfileRecord(uint64_t key, uint32_t start)
+  {
+  uint32_t cycles = xthal_get_ccount() - start;
+  OvmsMutexLock lock(&m_profile_mutex);
+  auto it = m_profile_map.find(key);
+  if (it == m_profile_map.end())
+    {
+    if (m_profile_map.size() >= VEHICLE_PROFILE_MAXENTRIES)
+      {
+      m_profile_overflow++;
+      return;
+      }
+    it = m_profile_map.insert(std::make_pair(key, profile_entry_t())).first;
+    }
+  profile_entry_t& entry = it->second;
+  entry.calls++;
+  entry.cycles += cycles;
+  if (cycles > entry.cycles_max)
+    entry.cycles_max = cycles;
+  }
+
+
+/**
+ * RunTicker: internal: call a ticker method, profile if enabled
+ */
+void OvmsVehicle::RunTicker(uint32_t interval, void (OvmsVehicle::*ticker)(uint32_t))
+  {
+  if (!m_profile)
+    {
+    (this->*ticker)(m_ticker);
+    return;
+    }
+  uint32_t start = xthal_get_ccount();
+  (this->*ticker)(m_ticker);
+  ProfileRecord(ProfileKey(Profile_Ticker, 0, interval), start);
+  }
+
+
+/**
+ * ProfileEnable: start/stop profiling
+ *  Starting the profiler resets the profile data.
+ */
+void OvmsVehicle::ProfileEnable(bool enable)
+  {
+  if (enable && !m_profile)
+    ProfileReset();
+  m_profile = enable;
+  ESP_LOGI(TAG, "Profiling %s", enable ? "started" : "stopped");
+  }
+
+
+/**
+ * ProfileReset: clear the profile data
+ */
+void OvmsVehicle::ProfileReset()
+  {
+  OvmsMutexLock lock(&m_profile_mutex);
+  m_profile_map.clear();
+  m_profile_overflow = 0;
+  m_profile_time = esp_timer_get_time();
+  }
+
+
+/**
+ * ProfileStatus: output the profile, sorted by total CPU time
+ *  @param verbosity    Output limit
+ *  @param writer       Output channel
+ *  @param maxentries   Number of entries to show, 0 = all
+ */
+void OvmsVehicle::ProfileStatus(int verbosity, OvmsWriter* writer, int maxentries)
+  {
+  OvmsMutexLock lock(&m_profile_mutex);
+  float elapsed = (esp_timer_get_time() - m_profile_time) / 1000.0f;   // [ms]
+  if (elapsed <= 0)
+    elapsed = 1;
+
+  std::vector<std::pair<uint64_t, profile_entry_t>> entries(m_profile_map.begin(), m_profile_map.end());
+  std::sort(entries.begin(), entries.end(),
+    [](const std::pair<uint64_t, profile_entry_t>& a, const std::pair<uint64_t, profile_entry_t>& b)
+      { return a.second.cycles > b.second.cycles; });
+
+  uint64_t total = 0;
+  for (auto& it : entries)
+    total += it.second.cycles;
+
+  writer->printf("Profiling %s: %.0f seconds recorded, %u entries",
+    m_profile ? "on" : "off", elapsed / 1000, (unsigned) entries.size());
+  if (m_profile_overflow)
+    writer->printf(", %u calls not recorded (too many entries)", m_profile_overflow);
+  writer->printf("\nTotal: %.1f ms = %.2f%% CPU\n",
+    (float) total / PROFILE_CYCLES_US / 1000, (float) total / PROFILE_CYCLES_US / 1000 / elapsed * 100);
+  if (entries.empty())
+    return;
+
+  writer->puts("Type    Bus   ID        PID          Calls  Avg[us]  Max[us]  Total[ms]   CPU%");
+  int count = 0;
+  for (auto& it : entries)
+    {
+    if (maxentries > 0 && ++count > maxentries)
+      {
+      writer->printf("... %d more entries\n", (int) entries.size() - maxentries);
+      break;
+      }
+    uint64_t key = it.first;
+    const profile_entry_t& entry = it.second;
+    profile_kind_t kind = (profile_kind_t) (key >> 62);
+    int busnumber = (key >> 59) & 7;
+    uint8_t type = (key >> 51) & 0xff;
+    uint16_t pid = (key >> 35) & 0xffff;
+    uint32_t id = key & 0x1fffffff;
+
+    char idbuf[12], pidbuf[12];
+    pidbuf[0] = 0;
+    if (kind == Profile_Frame)
+      snprintf(idbuf, sizeof(idbuf), (type == CAN_frame_ext) ? "%08x" : "%03x", id);
+    else if (kind == Profile_Poll)
+      {
+      snprintf(idbuf, sizeof(idbuf), (id > 0x7ff) ? "%08x" : "%03x", id);
+      snprintf(pidbuf, sizeof(pidbuf), "%02x:%04x", type, pid);
+      }
+    else
+      snprintf(idbuf, sizeof(idbuf), "%u", id);
+
+    float ms = (float) entry.cycles / PROFILE_CYCLES_US / 1000;
+    writer->printf("%-7s %-5s %-9s %-9s %8u %8.1f %8.1f %10.1f %6.2f\n",
+      (kind == Profile_Frame) ? "frame" : (kind == Profile_Poll) ? "poll" : "ticker",
+      (kind == Profile_Ticker) ? "-" : (busnumber == 0) ? "can1" : (busnumber == 1) ? "can2" :
+        (busnumber == 2) ? "can3" : (busnumber == 3) ? "can4" : "can5",
+      idbuf, pidbuf, entry.calls,
+      (float) entry.cycles / entry.calls / PROFILE_CYCLES_US,
+      (float) entry.cycles_max / PROFILE_CYCLES_US,
+      ms, ms / elapsed * 100);
+    }
+  }
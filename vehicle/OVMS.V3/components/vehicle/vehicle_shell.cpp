@@ -43,6 +43,7 @@
 #endif // #ifdef CONFIG_OVMS_COMP_WEBSERVER
 #include <ovms_peripherals.h>
 #include <string_writer.h>
+#include "crypt_base64.h"
 #include "vehicle.h"
 
 
@@ -417,6 +418,144 @@ void OvmsVehicleFactory::vehicle_stat(int verbosity, OvmsWriter* writer, OvmsCom
     }
   }
 
+void OvmsVehicleFactory::vehicle_poller_status(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (MyVehicleFactory.m_currentvehicle != NULL)
+    {
+    MyVehicleFactory.m_currentvehicle->PollerStatus(verbosity, writer);
+    }
+  else
+    {
+    writer->puts("No vehicle module selected");
+    }
+  }
+
+void OvmsVehicleFactory::vehicle_poller_times(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  bool json = false;
+  if (argc > 0)
+    {
+    if (strcmp(argv[0], "-j") != 0)
+      {
+      cmd->PutUsage(writer);
+      return;
+      }
+    json = true;
+    }
+
+  if (MyVehicleFactory.m_currentvehicle != NULL)
+    {
+    MyVehicleFactory.m_currentvehicle->PollerTimes(verbosity, writer, json);
+    }
+  else
+    {
+    writer->puts("No vehicle module selected");
+    }
+  }
+
+void OvmsVehicleFactory::vehicle_poller_reset(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (MyVehicleFactory.m_currentvehicle != NULL)
+    {
+    MyVehicleFactory.m_currentvehicle->PollerResetStats();
+    writer->puts("Poller statistics have been reset.");
+    }
+  else
+    {
+    writer->puts("No vehicle module selected");
+    }
+  }
+
+void OvmsVehicleFactory::vehicle_frames_status(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (MyVehicleFactory.m_currentvehicle != NULL)
+    {
+    MyVehicleFactory.m_currentvehicle->FrameHandlerStatus(verbosity, writer);
+    }
+  else
+    {
+    writer->puts("No vehicle module selected");
+    }
+  }
+
+void OvmsVehicleFactory::vehicle_frames_reset(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (MyVehicleFactory.m_currentvehicle != NULL)
+    {
+    MyVehicleFactory.m_currentvehicle->FrameHandlerResetStats();
+    writer->puts("Frame handler statistics have been reset.");
+    }
+  else
+    {
+    writer->puts("No vehicle module selected");
+    }
+  }
+
+void OvmsVehicleFactory::vehicle_timers_status(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (MyVehicleFactory.m_currentvehicle != NULL)
+    {
+    MyVehicleFactory.m_currentvehicle->TimerStatus(verbosity, writer);
+    }
+  else
+    {
+    writer->puts("No vehicle module selected");
+    }
+  }
+
+void OvmsVehicleFactory::vehicle_timers_reset(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (MyVehicleFactory.m_currentvehicle != NULL)
+    {
+    MyVehicleFactory.m_currentvehicle->TimerResetStats();
+    writer->puts("Vehicle timer statistics have been reset.");
+    }
+  else
+    {
+    writer->puts("No vehicle module selected");
+    }
+  }
+
+void OvmsVehicleFactory::vehicle_profile_status(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (MyVehicleFactory.m_currentvehicle != NULL)
+    {
+    int maxentries = (argc > 0) ? atoi(argv[0]) : 20;
+    MyVehicleFactory.m_currentvehicle->ProfileStatus(verbosity, writer, maxentries);
+    }
+  else
+    {
+    writer->puts("No vehicle module selected");
+    }
+  }
+
+void OvmsVehicleFactory::vehicle_profile_enable(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (MyVehicleFactory.m_currentvehicle != NULL)
+    {
+    bool enable = (strcmp(cmd->GetName(), "on") == 0);
+    MyVehicleFactory.m_currentvehicle->ProfileEnable(enable);
+    writer->printf("Profiling is now %s\n", enable ? "on" : "off");
+    }
+  else
+    {
+    writer->puts("No vehicle module selected");
+    }
+  }
+
+void OvmsVehicleFactory::vehicle_profile_reset(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (MyVehicleFactory.m_currentvehicle != NULL)
+    {
+    MyVehicleFactory.m_currentvehicle->ProfileReset();
+    writer->puts("Profile data has been reset.");
+    }
+  else
+    {
+    writer->puts("No vehicle module selected");
+    }
+  }
+
 void OvmsVehicleFactory::bms_status(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
   {
   if (MyVehicleFactory.m_currentvehicle != NULL)
@@ -454,6 +593,79 @@ void OvmsVehicleFactory::bms_alerts(int verbosity, OvmsWriter* writer, OvmsComma
     }
   }
 
+void OvmsVehicleFactory::bms_history_status(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (MyVehicleFactory.m_currentvehicle != NULL)
+    {
+    MyVehicleFactory.m_currentvehicle->BmsHistoryStatus(verbosity, writer);
+    }
+  else
+    {
+    writer->puts("No vehicle module selected");
+    }
+  }
+
+void OvmsVehicleFactory::bms_history_export(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (MyVehicleFactory.m_currentvehicle == NULL)
+    {
+    writer->puts("No vehicle module selected");
+    return;
+    }
+
+  OvmsVehicle::bms_history_level_t level;
+  if (!OvmsVehicle::BmsHistoryLevel(argv[0], level))
+    {
+    writer->puts("ERROR: invalid level, valid: raw, 1m, 10m");
+    return;
+    }
+  bool binary = false;
+  if (argc > 1)
+    {
+    if (strcmp(argv[1], "bin") == 0)
+      binary = true;
+    else if (strcmp(argv[1], "csv") != 0)
+      {
+      writer->puts("ERROR: invalid format, valid: csv, bin");
+      return;
+      }
+    }
+  int maxrecords = (argc > 2) ? atoi(argv[2]) : 0;
+
+  std::string out;
+  if (!MyVehicleFactory.m_currentvehicle->BmsHistoryExport(out, level, binary, maxrecords))
+    {
+    writer->puts("BMS history not available, see: bms history status");
+    return;
+    }
+  if (binary)
+    {
+    out = base64encode(out);
+    for (size_t pos = 0; pos < out.size(); pos += 76)
+      {
+      writer->write(out.data() + pos, std::min<size_t>(76, out.size() - pos));
+      writer->puts("");
+      }
+    }
+  else
+    {
+    writer->write(out.data(), out.size());
+    }
+  }
+
+void OvmsVehicleFactory::bms_history_reset(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (MyVehicleFactory.m_currentvehicle != NULL)
+    {
+    MyVehicleFactory.m_currentvehicle->BmsHistoryReset();
+    writer->puts("BMS history cleared.");
+    }
+  else
+    {
+    writer->puts("No vehicle module selected");
+    }
+  }
+
 
 void OvmsVehicleFactory::obdii_request(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
   {
@@ -0,0 +1,323 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Date:          14th March 2017
+;
+;    Changes:
+;    1.0  Initial release
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011        Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+#include "ovms_log.h"
+static const char *TAG = "vehicle-timers";
+
+#include <stdio.h>
+#include "vehicle.h"
+
+
+/**
+ * StartTimer: start a periodic or one-shot timer
+ *  The callback is executed in the vehicle task context.
+ *  
+ *  @param name         Timer name (static string, used for the statistics)
+ *  @param interval_ms  Period (periodic) or delay (one-shot) in milliseconds
+ *  @param callback     Callback, e.g. std::bind(&OvmsVehicleFoo::Method, this)
+ *  @param periodic     true (default) = periodic timer, false = one-shot
+ *  @return             Timer ID or 0 on error
+ */
+uint32_t OvmsVehicle::StartTimer(const char* name, uint32_t interval_ms, VehicleTimerCallback callback,
+                                 bool periodic /*=true*/)
+  {
+  if (!callback || (periodic && interval_ms == 0))
+    {
+    ESP_LOGE(TAG, "StartTimer: %s: invalid interval or callback", name);
+    return 0;
+    }
+
+  OvmsRecMutexLock lock(&m_timer_mutex);
+  vehicle_timer_t* timer = new vehicle_timer_t();
+  if (++m_timer_lastid == 0)
+    m_timer_lastid = 1;
+  timer->id = m_timer_lastid;
+  timer->name = name;
+  timer->interval = interval_ms;
+  timer->periodic = periodic;
+  timer->callback = callback;
+  timer->due = esp_timer_get_time() + (int64_t) interval_ms * 1000;
+  m_timers[timer->id] = timer;
+  TimerQueue(timer);
+  TimerArm();
+
+  ESP_LOGD(TAG, "StartTimer: %s: #%u started, %s %u ms", name, timer->id,
+    periodic ? "period" : "delay", interval_ms);
+  return timer->id;
+  }
+
+
+/**
+ * StopTimer: stop and remove a timer
+ *  May be called from within the timer callback.
+ *  
+ *  @param id           Timer ID as returned by StartTimer()
+ *  @return             false = timer not found (already stopped or one-shot done)
+ */
+bool OvmsVehicle::StopTimer(uint32_t id)
+  {
+  OvmsRecMutexLock lock(&m_timer_mutex);
+  auto it = m_timers.find(id);
+  if (it == m_timers.end())
+    return false;
+  vehicle_timer_t* timer = it->second;
+  m_timers.erase(it);
+  TimerUnqueue(timer);
+  if (timer->running)
+    timer->stopped = true;    // deleted by TimerRun() after the callback
+  else
+    delete timer;
+  TimerArm();
+  return true;
+  }
+
+
+/**
+ * IsTimerActive: check if a timer is running (periodic) or pending (one-shot)
+ */
+bool OvmsVehicle::IsTimerActive(uint32_t id)
+  {
+  OvmsRecMutexLock lock(&m_timer_mutex);
+  return (m_timers.find(id) != m_timers.end());
+  }
+
+
+/**
+ * TimerQueue / TimerUnqueue: internal: add/remove a timer to/from the due time queue
+ *  Must be called with m_timer_mutex held.
+ */
+void OvmsVehicle::TimerQueue(vehicle_timer_t* timer)
+  {
+  m_timer_queue.insert(std::make_pair(timer->due, timer));
+  }
+
+void OvmsVehicle::TimerUnqueue(vehicle_timer_t* timer)
+  {
+  auto range = m_timer_queue.equal_range(timer->due);
+  for (auto it = range.first; it != range.second; ++it)
+    {
+    if (it->second == timer)
+      {
+      m_timer_queue.erase(it);
+      return;
+      }
+    }
+  }
+
+
+/**
+ * TimerArm: internal: arm the signal timer for the next timer due
+ *  Must be called with m_timer_mutex held.
+ */
+void OvmsVehicle::TimerArm()
+  {
+  int64_t due = m_timer_queue.empty() ? 0 : m_timer_queue.begin()->first;
+  if (due == m_timer_signal_due)
+    return;
+
+  if (!m_timer_signal)
+    {
+    esp_timer_create_args_t args = {};
+    args.callback = &OvmsVehicle::TimerSignalCallback;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "OVMS Vehicle timers";
+    if (esp_timer_create(&args, &m_timer_signal) != ESP_OK)
+      {
+      ESP_LOGE(TAG, "TimerArm: failed to create signal timer");
+      m_timer_signal = NULL;
+      return;
+      }
+    }
+
+  esp_timer_stop(m_timer_signal);
+  m_timer_signal_due = due;
+  if (due)
+    {
+    int64_t delay = due - esp_timer_get_time();
+    esp_timer_start_once(m_timer_signal, (delay > 50) ? delay : 50);
+    }
+  }
+
+
+/**
+ * TimerSignalCallback: internal: signal timer callback (esp_timer task)
+ *  Signals the vehicle task to run the timers due.
+ *  If the signal gets lost (queue full), the vehicle ticker re-arms the timer.
+ */
+void OvmsVehicle::TimerSignalCallback(void* arg)
+  {
+  OvmsVehicle* me = (OvmsVehicle*) arg;
+  CAN_frame_t frame = {};
+  frame.MsgID = VEHICLE_SIGNAL_TIMERS;
+  me->m_timer_signal_due = 0;
+  xQueueSend(me->m_rxqueue, &frame, 0);
+  }
+
+
+/**
+ * TimerRun: internal: execute the timer callbacks due (vehicle task)
+ *  Callbacks are executed without holding the timer lock, within a metric batch.
+ */
+void OvmsVehicle::TimerRun()
+  {
+  m_timer_mutex.Lock();
+  int64_t now = esp_timer_get_time();
+  while (!m_timer_queue.empty() && m_timer_queue.begin()->first <= now)
+    {
+    vehicle_timer_t* timer = m_timer_queue.begin()->second;
+    m_timer_queue.erase(m_timer_queue.begin());
+    uint32_t late = now - timer->due;
+    timer->running = true;
+    m_timer_mutex.Unlock();
+
+    int64_t start = esp_timer_get_time();
+    MetricBatch batch;
+    timer->callback();
+    batch.Commit();
+    uint32_t time = esp_timer_get_time() - start;
+
+    m_timer_mutex.Lock();
+    timer->running = false;
+    now = esp_timer_get_time();
+    if (timer->stopped)
+      {
+      delete timer;
+      continue;
+      }
+
+    timer->runs++;
+    timer->late_sum += late;
+    if (late > timer->late_max)
+      timer->late_max = late;
+    timer->time_sum += time;
+    if (time > timer->time_max)
+      timer->time_max = time;
+
+    if (!timer->periodic)
+      {
+      m_timers.erase(timer->id);
+      delete timer;
+      continue;
+      }
+
+    // Schedule next period, skip periods missed:
+    int64_t interval = (int64_t) timer->interval * 1000;
+    timer->due += interval;
+    if (timer->due <= now)
+      {
+      uint32_t missed = (now - timer->due) / interval + 1;
+      timer->skipped += missed;
+      timer->due += missed * interval;
+      }
+    TimerQueue(timer);
+    }
+
+  TimerArm();
+  m_timer_mutex.Unlock();
+  }
+
+
+/**
+ * FreeTimers: internal: stop & remove all timers (vehicle shutdown)
+ */
+void OvmsVehicle::FreeTimers()
+  {
+  OvmsRecMutexLock lock(&m_timer_mutex);
+  if (m_timer_signal)
+    {
+    esp_timer_stop(m_timer_signal);
+    esp_timer_delete(m_timer_signal);
+    m_timer_signal = NULL;
+    }
+  m_timer_signal_due = 0;
+  m_timer_queue.clear();
+  for (auto& it : m_timers)
+    {
+    if (it.second->running)
+      it.second->stopped = true;
+    else
+      delete it.second;
+    }
+  m_timers.clear();
+  }
+
+
+/**
+ * TimerStatus: output timer statistics
+ */
+void OvmsVehicle::TimerStatus(int verbosity, OvmsWriter* writer)
+  {
+  OvmsRecMutexLock lock(&m_timer_mutex);
+  if (m_timers.empty())
+    {
+    writer->puts("No timers active");
+    return;
+    }
+
+  int64_t now = esp_timer_get_time();
+  writer->printf("Timers: %u active, statistics of the last %.0f seconds\n",
+    (unsigned) m_timers.size(), (now - m_timer_stats_time) / 1000000.0f);
+  for (auto& it : m_timers)
+    {
+    const vehicle_timer_t* timer = it.second;
+    writer->printf("  #%u %s: %s %u ms, due in %d ms\n",
+      timer->id, timer->name, timer->periodic ? "period" : "one-shot",
+      timer->interval, (int) ((timer->due - now) / 1000));
+    if (verbosity >= COMMAND_RESULT_NORMAL && timer->runs)
+      {
+      writer->printf("    %u runs, late avg %.2f max %.2f ms, callback avg %.2f max %.2f ms, %u skipped\n",
+        timer->runs,
+        (float) timer->late_sum / timer->runs / 1000, timer->late_max / 1000.0f,
+        (float) timer->time_sum / timer->runs / 1000, timer->time_max / 1000.0f,
+        timer->skipped);
+      }
+    }
+  }
+
+
+/**
+ * TimerResetStats: reset timer statistics
+ */
+void OvmsVehicle::TimerResetStats()
+  {
+  OvmsRecMutexLock lock(&m_timer_mutex);
+  for (auto& it : m_timers)
+    {
+    vehicle_timer_t* timer = it.second;
+    timer->runs = 0;
+    timer->skipped = 0;
+    timer->late_sum = 0;
+    timer->late_max = 0;
+    timer->time_sum = 0;
+    timer->time_max = 0;
+    }
+  m_timer_stats_time = esp_timer_get_time();
+  }
@@ -40,6 +40,7 @@ OvmsVehicleDBC::OvmsVehicleDBC()
 
 OvmsVehicleDBC::~OvmsVehicleDBC()
   {
+  MyDBC.m_loader.CancelWhenLoaded(this);
   if (m_can1) m_can1->DetachDBC();
   if (m_can2) m_can2->DetachDBC();
   if (m_can3) m_can3->DetachDBC();
@@ -54,9 +55,34 @@ bool OvmsVehicleDBC::RegisterCanBusDBC(int bus, CAN_mode_t mode, const char* nam
   return true;
   }
 
+/**
+ * RegisterCanBusDBCLoaded: register a CAN bus using a loaded DBC file
+ *  If the file is still being loaded in the background, the registration
+ *  is deferred to the loader's completion callback (returns true).
+ */
 bool OvmsVehicleDBC::RegisterCanBusDBCLoaded(int bus, CAN_mode_t mode, const char* dbcloaded)
   {
   dbcfile* ndbc = MyDBC.Find(dbcloaded);
+  if (ndbc==NULL)
+    {
+    auto callback = [this, bus, mode](const std::string& name, dbcfile* dbc)
+      {
+      if (dbc == NULL)
+        ESP_LOGE(TAG,"DBC %s could not be loaded, can%d not registered",name.c_str(),bus);
+      else
+        {
+        ESP_LOGI(TAG,"DBC %s loaded, registering can%d",name.c_str(),bus);
+        OvmsVehicle::RegisterCanBus(bus, mode, (CAN_speed_t)(dbc->m_bittiming.GetBaudRate()/1000),dbc);
+        }
+      };
+    if (MyDBC.m_loader.WhenLoaded(dbcloaded, this, callback))
+      {
+      ESP_LOGI(TAG,"DBC %s is being loaded, can%d registration deferred",dbcloaded,bus);
+      return true;
+      }
+    // the load may have completed in between:
+    ndbc = MyDBC.Find(dbcloaded);
+    }
   if (ndbc==NULL) return false;
   OvmsVehicle::RegisterCanBus(bus, mode, (CAN_speed_t)(ndbc->m_bittiming.GetBaudRate()/1000),ndbc);
   return true;
@@ -88,23 +114,19 @@ void OvmsVehicleDBC::IncomingFrame(canbus* bus, CAN_frame_t* frame)
   dbcMessage* msg = dbc->m_messages.FindMessage(frame->FIR.B.FF, frame->MsgID);
   if (msg)
     {
-    dbcSignal* mux = msg->GetMultiplexorSignal();
-    uint32_t muxval;
-    if (mux)
-      {
-      dbcNumber r = mux->Decode(frame);
-      muxval = r.GetSignedInteger();
-      }
-    for (dbcSignal* sig : msg->m_signals)
+    MetricBatch batch;
+    uint32_t now = esp_log_timestamp();
+    msg->GetActiveSignals(frame, m_active_signals);
+    for (dbcSignal* sig : m_active_signals)
       {
       OvmsMetric* m = sig->GetMetric();
       if (m)
         {
-        if ((mux==NULL)||(sig->GetMultiplexSwitchvalue() == muxval))
-          {
-          dbcNumber r = sig->Decode(frame);
+        dbcNumber r = sig->Decode(frame);
+        if (sig->FilterValue(r, now))
           m->SetValue(r);
-          }
+        else if (m->IsDefined())
+          m->SetModified(false);  // keep metric fresh, but don't notify listeners
         }
       }
     }
@@ -53,6 +53,9 @@ class OvmsVehicleDBC : public OvmsVehicle
 
   protected:
     virtual void IncomingFrame(canbus* bus, CAN_frame_t* frame);
+
+  protected:
+    dbcSignalVector_t m_active_signals;     // IncomingFrame signal buffer
   };
 
 class OvmsVehiclePureDBC : public OvmsVehicleDBC
@@ -258,6 +258,7 @@ void OvmsVehicleRenaultTwizy::IncomingFrameCan1(CAN_frame_t* p_frame)
           // publish metrics:
           *StdMetrics.ms_v_bat_current = (float) twizy_current / 4;
           *StdMetrics.ms_v_bat_power = (float) twizy_power * 64 / 10000;
+          CalculateBatteryPower((float) twizy_power * 64 / 10000);
           
           // do we need to take base power consumption into account?
           // i.e. for lights etc. -- varies...
@@ -544,7 +545,7 @@ void OvmsVehicleRenaultTwizy::IncomingFrameCan1(CAN_frame_t* p_frame)
         
         twizy_speed = u;
         *StdMetrics.ms_v_pos_speed = (float) twizy_speed / 100;
-        CalculateAcceleration();
+        CalculateAcceleration((float) twizy_speed / 100);
       }
       
       break; // case 0x599
@@ -239,6 +239,7 @@ void OvmsVehicleSmartED::ObdInitPoll() {
   PollSetState(0);
   PollSetThrottling(5);
   PollSetResponseSeparationTime(10);
+  PollSetResponseReassembly(true);
 
   // init commands:
   OvmsCommand* cmd;
@@ -252,154 +253,126 @@ void OvmsVehicleSmartED::ObdInitPoll() {
 }
 
 /**
- * Incoming poll reply messages
+ * Incoming poll responses (complete, reassembled by the poller)
  */
-void OvmsVehicleSmartED::IncomingPollReply(canbus* bus, uint16_t type, uint16_t pid, uint8_t* data, uint8_t length, uint16_t remain) {
-  string& rxbuf = smarted_obd_rxbuf;
-  static uint16_t last_pid = -1;
+void OvmsVehicleSmartED::IncomingPollResponse(canbus* bus, uint16_t type, uint16_t pid, const uint8_t* data, uint16_t length) {
+  const char* rxdata = (const char*)data;
   
-  if (pid != last_pid) {
-    //ESP_LOGD(TAG, "pid: %04x length: %d m_poll_ml_remain: %d m_poll_ml_frame: %d", pid, length, m_poll_ml_remain, m_poll_ml_frame);
-    last_pid = pid;
-    m_poll_ml_frame=0;
-  }
-  
-  // init / fill rx buffer:
-  if (m_poll_ml_frame == 0) {
-    rxbuf.clear();
-    rxbuf.reserve(length + remain);
-  }
-  rxbuf.append((char*)data, length);
-  
-  if (remain)
-    return;
-  
-  // char *buf = NULL;
-  // size_t rlen = rxbuf.size(), offset = 0;
-  // do {
-    // rlen = FormatHexDump(&buf, rxbuf.data() + offset, rlen, 16);
-    // offset += 16;
-    // ESP_LOGW(TAG, "OBD2: reply [%02x %02x]: %s", type, pid, buf ? buf : "-");
-  // } while (rlen);
-  // if (buf)
-    // free(buf);
-  
-  // complete:
   switch (pid) {
     case 0x0201: // rqBattTemperatures
-      PollReply_BMS_BattTemp(rxbuf.data(), rxbuf.size());
+      PollReply_BMS_BattTemp(rxdata, length);
       break;
     case 0x0202: // rqBattModuleTemperatures
-      PollReply_BMS_ModuleTemp(rxbuf.data(), rxbuf.size());
+      PollReply_BMS_ModuleTemp(rxdata, length);
       break;
     case 0x0203: //rqBattAmps
-      PollReply_BMS_BattAmps(rxbuf.data(), rxbuf.size());
+      PollReply_BMS_BattAmps(rxdata, length);
       break;
     case 0x0204: //rqBattHVstatus
-      PollReply_BMS_BattHVstatus(rxbuf.data(), rxbuf.size());
+      PollReply_BMS_BattHVstatus(rxdata, length);
       break;
     case 0x0207: //rqBattADCref
-      PollReply_BMS_BattADCref(rxbuf.data(), rxbuf.size());
+      PollReply_BMS_BattADCref(rxdata, length);
       break;
     case 0x0208: // rqBattVolts
-      PollReply_BMS_BattVolts(rxbuf.data(), rxbuf.size());
+      PollReply_BMS_BattVolts(rxdata, length);
       break;
     case 0x0209: // rqBattIsolation
-      PollReply_BMS_BattIsolation(rxbuf.data(), rxbuf.size());
+      PollReply_BMS_BattIsolation(rxdata, length);
       break;
     case 0x0310: // rqBattCapacity
-      PollReply_BMS_BattCapacity(rxbuf.data(), rxbuf.size());
+      PollReply_BMS_BattCapacity(rxdata, length);
       break;
     case 0x030B: // rqBattHVContactorCyclesLeft
-      PollReply_BMS_BattHVContactorCyclesLeft(rxbuf.data(), rxbuf.size());
+      PollReply_BMS_BattHVContactorCyclesLeft(rxdata, length);
       break;
     case 0x030C: // rqBattHVContactorMax
-      PollReply_BMS_BattHVContactorMax(rxbuf.data(), rxbuf.size());
+      PollReply_BMS_BattHVContactorMax(rxdata, length);
       break;
     case 0xD000: // rqBattHVContactorState
-      PollReply_BMS_BattHVContactorState(rxbuf.data(), rxbuf.size());
+      PollReply_BMS_BattHVContactorState(rxdata, length);
       break;
     case 0x0304: // rqBattDate
-      PollReply_BMS_BattDate(rxbuf.data(), rxbuf.size());
+      PollReply_BMS_BattDate(rxdata, length);
       break;
     case 0xF18C: // rqBattProdDate
-      PollReply_BMS_BattProdDate(rxbuf.data(), rxbuf.size());
+      PollReply_BMS_BattProdDate(rxdata, length);
       break;
     case 0xF150: //rqBattHWrev
-      PollReply_BMS_BattHWrev(rxbuf.data(), rxbuf.size());
+      PollReply_BMS_BattHWrev(rxdata, length);
       break;
     case 0xF151: //rqBattSWrev
-      PollReply_BMS_BattSWrev(rxbuf.data(), rxbuf.size());
+      PollReply_BMS_BattSWrev(rxdata, length);
       break;
     case 0xF190: // rqBattVIN
-      PollReply_BMS_BattVIN(rxbuf.data(), rxbuf.size());
+      PollReply_BMS_BattVIN(rxdata, length);
       break;
     case 0xF111: // rqChargerPN_HW
-      PollReply_NLG6_ChargerPN_HW(rxbuf.data(), rxbuf.size());
+      PollReply_NLG6_ChargerPN_HW(rxdata, length);
       break;
     case 0x0226: // rqChargerVoltages
-      PollReply_NLG6_ChargerVoltages(rxbuf.data(), rxbuf.size());
+      PollReply_NLG6_ChargerVoltages(rxdata, length);
       break;
     case 0x0225: // rqChargerAmps
-      PollReply_NLG6_ChargerAmps(rxbuf.data(), rxbuf.size());
+      PollReply_NLG6_ChargerAmps(rxdata, length);
       break;
     case 0x022A: // rqChargerSelCurrent
-      PollReply_NLG6_ChargerSelCurrent(rxbuf.data(), rxbuf.size());
+      PollReply_NLG6_ChargerSelCurrent(rxdata, length);
       break;
     case 0x0223: // rqChargerTemperatures
-      PollReply_NLG6_ChargerTemperatures(rxbuf.data(), rxbuf.size());
+      PollReply_NLG6_ChargerTemperatures(rxdata, length);
       break;
     case 0x1001:
-      PollReply_CEPC_VC(rxbuf.data(), rxbuf.size());
+      PollReply_CEPC_VC(rxdata, length);
       break;
     case 0x2047: // rqCoolingTemp
-      PollReply_CEPC_CoolingTemp(rxbuf.data(), rxbuf.size());
+      PollReply_CEPC_CoolingTemp(rxdata, length);
       break;
     case 0x230A: // rqCoolingPumpTemp
-      PollReply_CEPC_CoolingPumpTemp(rxbuf.data(), rxbuf.size());
+      PollReply_CEPC_CoolingPumpTemp(rxdata, length);
       break;
     case 0x2308: // rqCoolingPumpLV
-      PollReply_CEPC_CoolingPumpLV(rxbuf.data(), rxbuf.size());
+      PollReply_CEPC_CoolingPumpLV(rxdata, length);
       break;
     case 0x2309: // rqCoolingPumpAmps
-      PollReply_CEPC_CoolingPumpAmps(rxbuf.data(), rxbuf.size());
+      PollReply_CEPC_CoolingPumpAmps(rxdata, length);
       break;
     case 0xD032: // rqCoolingPumpRPM
-      PollReply_CEPC_CoolingPumpRPM(rxbuf.data(), rxbuf.size());
+      PollReply_CEPC_CoolingPumpRPM(rxdata, length);
       break;
     case 0x6309: // rqCoolingPumpOTR
-      PollReply_CEPC_CoolingPumpOTR(rxbuf.data(), rxbuf.size());
+      PollReply_CEPC_CoolingPumpOTR(rxdata, length);
       break;
     case 0xD041: // rqCoolingFanRPM
-      PollReply_CEPC_CoolingFanRPM(rxbuf.data(), rxbuf.size());
+      PollReply_CEPC_CoolingFanRPM(rxdata, length);
       break;
     case 0x630A: // rqCoolingFanOTR
-      PollReply_CEPC_CoolingFanOTR(rxbuf.data(), rxbuf.size());
+      PollReply_CEPC_CoolingFanOTR(rxdata, length);
       break;
     case 0x6321: // rqBatteryHeaterOTR
-      PollReply_CEPC_BatteryHeaterOTR(rxbuf.data(), rxbuf.size());
+      PollReply_CEPC_BatteryHeaterOTR(rxdata, length);
       break;
     case 0xD302: // rqBatteryHeaterON
-      PollReply_CEPC_BatteryHeaterON(rxbuf.data(), rxbuf.size());
+      PollReply_CEPC_BatteryHeaterON(rxdata, length);
       break;
     case 0x6303: // rqVacuumPumpOTR
-      PollReply_CEPC_VacuumPumpOTR(rxbuf.data(), rxbuf.size());
+      PollReply_CEPC_VacuumPumpOTR(rxdata, length);
       break;
     case 0x2041: // rqVacuumPumpPress1
-      PollReply_CEPC_VacuumPumpPress1(rxbuf.data(), rxbuf.size());
+      PollReply_CEPC_VacuumPumpPress1(rxdata, length);
       break;
     case 0x2043: // rqVacuumPumpPress2
-      PollReply_CEPC_VacuumPumpPress2(rxbuf.data(), rxbuf.size());
+      PollReply_CEPC_VacuumPumpPress2(rxdata, length);
       break;
     case 0x6308: // DT_Batterie_Alterszustand
-      PollReply_CEPC_BatteryAgeCondition(rxbuf.data(), rxbuf.size());
+      PollReply_CEPC_BatteryAgeCondition(rxdata, length);
       break;
     // Unknown: output
     default: {
       char *buf = NULL;
-      size_t rlen = rxbuf.size(), offset = 0;
+      size_t rlen = length, offset = 0;
       do {
-        rlen = FormatHexDump(&buf, rxbuf.data() + offset, rlen, 16);
+        rlen = FormatHexDump(&buf, rxdata + offset, rlen, 16);
         offset += 16;
         ESP_LOGW(TAG, "OBD2: unhandled reply [%02x %02x]: %s", type, pid, buf ? buf : "-");
       } while (rlen);
@@ -413,6 +386,7 @@ void OvmsVehicleSmartED::IncomingPollReply(canbus* bus, uint16_t type, uint16_t
   if (!smarted_obd_rxwait.IsAvail()) {
     // yes: stop poller & signal response
     PollSetPidList(m_can1, NULL);
+    smarted_obd_rxbuf.assign(rxdata, length);
     smarted_obd_rxerr = 0;
     smarted_obd_rxwait.Give();
   }
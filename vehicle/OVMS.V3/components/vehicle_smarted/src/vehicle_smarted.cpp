@@ -492,6 +492,7 @@ void OvmsVehicleSmartED::IncomingFrameCan1(CAN_frame_t* p_frame) {
       float HVP = ((HV * HVA) / 1000.0) * -1.0f;
       StandardMetrics.ms_v_bat_voltage->SetValue(HV, Volts);
       StandardMetrics.ms_v_bat_power->SetValue(HVP);
+      CalculateBatteryPower(HVP);
       break;
     }
     case 0x3D5: //LV Voltage
@@ -546,7 +547,7 @@ void OvmsVehicleSmartED::IncomingFrameCan1(CAN_frame_t* p_frame) {
       StandardMetrics.ms_v_env_handbrake->SetValue(d[0]);
       float velocity = (d[2] * 256 + d[3]) / 18.0;
       StandardMetrics.ms_v_pos_speed->SetValue(velocity, Kph);
-      CalculateAcceleration();
+      CalculateAcceleration(velocity);
       break;
     }
     case 0x236: // paddels recu up and down
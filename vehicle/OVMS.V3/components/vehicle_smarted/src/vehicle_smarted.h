@@ -62,7 +62,7 @@ class OvmsVehicleSmartED : public OvmsVehicle
   public:
     void IncomingFrameCan1(CAN_frame_t* p_frame);
     void IncomingFrameCan2(CAN_frame_t* p_frame);
-    void IncomingPollReply(canbus* bus, uint16_t type, uint16_t pid, uint8_t* data, uint8_t length, uint16_t mlremain);
+    void IncomingPollResponse(canbus* bus, uint16_t type, uint16_t pid, const uint8_t* data, uint16_t length);
     void IncomingPollError(canbus* bus, uint16_t type, uint16_t pid, uint16_t code);
     char m_vin[18];
 
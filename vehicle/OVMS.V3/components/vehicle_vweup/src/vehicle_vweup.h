@@ -247,8 +247,6 @@ public:
   void CCOn();
   void CCOnP();
   void CCOff();
-  static void ccCountdown(TimerHandle_t timer);
-  static void sendOcuHeartbeat(TimerHandle_t timer);
 
 private:
   void SendCommand(RemoteCommand);
@@ -283,8 +281,8 @@ public:
 
 private:
   RemoteCommand vweup_remote_command; // command to send, see RemoteCommandTimer()
-  TimerHandle_t m_sendOcuHeartbeat;
-  TimerHandle_t m_ccCountdown;
+  uint32_t m_sendOcuHeartbeat;              // Vehicle timer ID, 0 = not running
+  uint32_t m_ccCountdown;                   // Vehicle timer ID, 0 = not running
 
 
   // --------------------------------------------------------------------------
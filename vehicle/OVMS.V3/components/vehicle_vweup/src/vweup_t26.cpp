@@ -134,18 +134,6 @@ static const char *TAG = "v-vweup";
 #include "ovms_events.h"
 #include "ovms_metrics.h"
 
-void OvmsVehicleVWeUp::sendOcuHeartbeat(TimerHandle_t timer)
-{
-  OvmsVehicleVWeUp *vweup = (OvmsVehicleVWeUp *)pvTimerGetTimerID(timer);
-  vweup->SendOcuHeartbeat();
-}
-
-void OvmsVehicleVWeUp::ccCountdown(TimerHandle_t timer)
-{
-  OvmsVehicleVWeUp *vweup = (OvmsVehicleVWeUp *)pvTimerGetTimerID(timer);
-  vweup->CCCountdown();
-}
-
 void OvmsVehicleVWeUp::T26Init()
 {
   ESP_LOGI(TAG, "Starting connection: T26A (Comfort CAN)");
@@ -158,6 +146,8 @@ void OvmsVehicleVWeUp::T26Init()
   vin_part2 = false;
   vin_part3 = false;
   vweup_remote_climate_ticker = 0;
+  m_sendOcuHeartbeat = 0;
+  m_ccCountdown = 0;
   ocu_awake = false;
   ocu_working = false;
   ocu_what = false;
@@ -269,14 +259,12 @@ void OvmsVehicleVWeUp::vehicle_vweup_car_on(bool turnOn)
     ResetTripCounters();
     // Turn off possibly running climate control timer
     if (ocu_awake) {
-      xTimerStop(m_sendOcuHeartbeat, 0);
-      xTimerDelete(m_sendOcuHeartbeat, 0);
-      m_sendOcuHeartbeat = NULL;
+      StopTimer(m_sendOcuHeartbeat);
+      m_sendOcuHeartbeat = 0;
     }
     if (cc_count != 0) {
-      xTimerStop(m_ccCountdown, 0);
-      xTimerDelete(m_ccCountdown, 0);
-      m_ccCountdown = NULL;
+      StopTimer(m_ccCountdown);
+      m_ccCountdown = 0;
     }
     ocu_awake = false;
     ocu_working = false;
@@ -534,13 +522,11 @@ void OvmsVehicleVWeUp::IncomingFrameCan3(CAN_frame_t *p_frame)
       if (d[1] == 0x31 && ocu_awake) {
         // We should go to sleep, no matter what
         ESP_LOGI(TAG, "Comfort CAN calls for sleep");
-        xTimerStop(m_sendOcuHeartbeat, 0);
-        xTimerDelete(m_sendOcuHeartbeat, 0);
-        m_sendOcuHeartbeat = NULL;
+        StopTimer(m_sendOcuHeartbeat);
+        m_sendOcuHeartbeat = 0;
         if (cc_count != 0) {
-          xTimerStop(m_ccCountdown, 0);
-          xTimerDelete(m_ccCountdown, 0);
-          m_ccCountdown = NULL;
+          StopTimer(m_ccCountdown);
+          m_ccCountdown = 0;
         }
         ocu_awake = false;
         ocu_working = false;
@@ -667,8 +653,7 @@ void OvmsVehicleVWeUp::SendCommand(RemoteCommand command)
 
       ESP_LOGI(TAG, "Enable Climate Control");
 
-      m_ccCountdown = xTimerCreate("VW e-Up CC Countdown", 1000 / portTICK_PERIOD_MS, pdTRUE, this, ccCountdown);
-      xTimerStart(m_ccCountdown, 0);
+      m_ccCountdown = StartTimer("vweup.cc.countdown", 1000, std::bind(&OvmsVehicleVWeUp::CCCountdown, this));
 
       signal_ok = true;
       break;
@@ -794,8 +779,7 @@ OvmsVehicle::vehicle_command_t OvmsVehicleVWeUp::CommandWakeup()
 
     vTaskDelay(50 / portTICK_PERIOD_MS);
 
-    m_sendOcuHeartbeat = xTimerCreate("VW e-Up OCU heartbeat", 1000 / portTICK_PERIOD_MS, pdTRUE, this, sendOcuHeartbeat);
-    xTimerStart(m_sendOcuHeartbeat, 0);
+    m_sendOcuHeartbeat = StartTimer("vweup.ocu.heartbeat", 1000, std::bind(&OvmsVehicleVWeUp::SendOcuHeartbeat, this));
 
     ESP_LOGI(TAG, "Sent Wakeup Command - stage 2");
     StandardMetrics.ms_v_env_charging12v->SetValue(true);
@@ -902,9 +886,8 @@ void OvmsVehicleVWeUp::CCCountdown()
   }
   if (cc_count == 10) {
     CCOn();
-    xTimerStop(m_ccCountdown, 0);
-    xTimerDelete(m_ccCountdown, 0);
-    m_ccCountdown = NULL;
+    StopTimer(m_ccCountdown);
+    m_ccCountdown = 0;
     ocu_wait = false;
     ocu_awake = true;
     cc_count = 0;
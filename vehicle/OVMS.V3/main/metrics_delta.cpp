@@ -0,0 +1,145 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Date:          14th March 2017
+;
+;    Changes:
+;    1.0  Initial release
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011        Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "metrics_delta.h"
+
+OvmsMetricDeltaEncoder::OvmsMetricDeltaEncoder(int keyframe)
+  {
+  SetKeyframe(keyframe);
+  }
+
+OvmsMetricDeltaEncoder::~OvmsMetricDeltaEncoder()
+  {
+  }
+
+/**
+ * GetScale: get integer scale for a delta encoded metric
+ *  - returns 0 if the metric is not delta encoded
+ *  - the BMS cell vectors use mV, 1/10 °C and plain integers (alert levels),
+ *    the voltage deviations use 1/10 mV (typically only a few mV)
+ */
+int OvmsMetricDeltaEncoder::GetScale(OvmsMetric* metric)
+  {
+  if (strncmp(metric->m_name, "v.b.c.", 6) != 0)
+    return 0;
+  switch (metric->GetUnits())
+    {
+    case Volts:     return (strcmp(metric->m_name, "v.b.c.voltage.dev.max") == 0) ? 10000 : 1000;
+    case Celcius:   return 10;
+    default:        return 1;
+    }
+  }
+
+void OvmsMetricDeltaEncoder::SetKeyframe(int keyframe)
+  {
+  m_keyframe = (keyframe > 0) ? keyframe : 1;
+  }
+
+/**
+ * Encode: build next frame for a metric
+ *  - keyframe: true = force keyframe (i.e. on full updates)
+ *  - iskeyframe: optional output, true if the frame built is a keyframe
+ *  - returns false if the metric is not delta encoded or has no changes
+ *    at the scale resolution (frame is left untouched in this case)
+ */
+bool OvmsMetricDeltaEncoder::Encode(OvmsMetric* metric, std::string& frame, bool keyframe, bool* iskeyframe)
+  {
+  int scale = GetScale(metric);
+  std::vector<int32_t> value;
+  if (scale == 0 || !metric->AsScaledVector(value, scale))
+    return false;
+
+  auto it = m_state.find(metric);
+  if (it == m_state.end())
+    {
+    it = m_state.insert(std::make_pair(metric, state_t())).first;
+    it->second.seq = 0;
+    it->second.count = 0;
+    keyframe = true;
+    }
+  state_t& st = it->second;
+
+  size_t changed = 0;
+  if (!keyframe && st.value.size() != value.size())
+    keyframe = true;
+  if (!keyframe)
+    {
+    for (size_t i = 0; i < value.size(); i++)
+      {
+      if (value[i] != st.value[i])
+        changed++;
+      }
+    if (changed == 0)
+      return false;
+    // a delta needs two numbers per element, so fall back to a keyframe
+    // if it would not be smaller or if the keyframe interval is reached:
+    if (2 * changed >= value.size() || st.count + 1 >= m_keyframe)
+      keyframe = true;
+    }
+
+  char buf[32];
+  st.seq++;
+  snprintf(buf, sizeof(buf), "{\"q\":%u,\"s\":%d,\"%c\":[",
+    (unsigned) st.seq, scale, keyframe ? 'k' : 'd');
+  frame.clear();
+  frame.reserve(strlen(buf) + (keyframe ? value.size() : changed * 2) * 6 + 2);
+  frame = buf;
+
+  bool first = true;
+  for (size_t i = 0; i < value.size(); i++)
+    {
+    if (keyframe)
+      snprintf(buf, sizeof(buf), "%s%d", first ? "" : ",", (int) value[i]);
+    else if (value[i] != st.value[i])
+      snprintf(buf, sizeof(buf), "%s%u,%d", first ? "" : ",", (unsigned) i, (int) value[i]);
+    else
+      continue;
+    frame += buf;
+    first = false;
+    }
+  frame += "]}";
+
+  st.count = keyframe ? 0 : st.count + 1;
+  st.value.swap(value);
+  if (iskeyframe)
+    *iskeyframe = keyframe;
+  return true;
+  }
+
+/**
+ * Reset: forget all states, next frames will be keyframes
+ *  (use when the receiver has lost its state, i.e. on reconnects)
+ */
+void OvmsMetricDeltaEncoder::Reset()
+  {
+  m_state.clear();
+  }
@@ -0,0 +1,87 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Date:          14th March 2017
+;
+;    Changes:
+;    1.0  Initial release
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011        Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+#ifndef __METRICS_DELTA_H__
+#define __METRICS_DELTA_H__
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "ovms_metrics.h"
+
+/**
+ * OvmsMetricDeltaEncoder: delta encoding of vector metrics
+ *
+ * Large vector metrics (i.e. the BMS cell vectors "v.b.c.*") are sent as a
+ * sequence of JSON frames instead of the full comma separated value string.
+ * Element values are transmitted as integers, multiplied by the scale "s"
+ * (value = int / s). Frames carry a sequence number "q" counting up by one
+ * per frame sent for the metric.
+ *
+ *   Keyframe:  {"q":<seq>,"s":<scale>,"k":[<v0>,<v1>,...]}
+ *   Delta:     {"q":<seq>,"s":<scale>,"d":[<index>,<value>,<index>,<value>,...]}
+ *
+ * A keyframe carries the full vector and is sent on the first transmission,
+ * on vector size changes, every <keyframe> frames and whenever a delta would
+ * not be smaller. A delta carries only the elements changed (at the scale
+ * resolution) since the previous frame. If nothing changed at that
+ * resolution, no frame is produced.
+ *
+ * Decoders apply a delta only if its sequence number follows the last frame
+ * applied, else ignore deltas until the next keyframe.
+ *
+ * Each receiver needs its own encoder instance, the encoder is not thread safe.
+ */
+
+class OvmsMetricDeltaEncoder
+  {
+  public:
+    OvmsMetricDeltaEncoder(int keyframe = 20);
+    ~OvmsMetricDeltaEncoder();
+
+  public:
+    static int GetScale(OvmsMetric* metric);
+    void SetKeyframe(int keyframe);
+    bool Encode(OvmsMetric* metric, std::string& frame, bool keyframe = false, bool* iskeyframe = NULL);
+    void Reset();
+
+  protected:
+    struct state_t
+      {
+      uint32_t seq;                         // last frame sequence number
+      int count;                            // frames since last keyframe
+      std::vector<int32_t> value;           // last values sent
+      };
+    std::map<OvmsMetric*, state_t> m_state;
+    int m_keyframe;                         // keyframe interval [frames]
+  };
+
+#endif //#ifndef __METRICS_DELTA_H__
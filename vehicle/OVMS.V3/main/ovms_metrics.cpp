@@ -36,6 +36,7 @@ static const char *TAG = "metrics";
 #include <sstream>
 #include <functional>
 #include <map>
+#include <algorithm>
 #include "ovms.h"
 #include "ovms_metrics.h"
 #include "ovms_command.h"
@@ -165,6 +166,32 @@ void metrics_persist(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int ar
   writer->printf("%d of %d slots used\n", pmetrics.used, NUM_PERSISTENT_VALUES);
   }
 
+void metrics_stats(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (argc > 0)
+    {
+    if (strcmp(argv[0], "-r") != 0)
+      {
+      cmd->PutUsage(writer);
+      return;
+      }
+    MyMetrics.ResetStats();
+    writer->puts("Metric statistics have been reset");
+    return;
+    }
+  uint32_t elapsed = monotonictime - MyMetrics.m_stat_time;
+  if (elapsed == 0) elapsed = 1;
+  writer->printf("Statistics of the last %u seconds:\n", elapsed);
+  writer->printf("  Modifications:  %10u  %8.1f/s\n", MyMetrics.m_stat_modified,
+    (float) MyMetrics.m_stat_modified / elapsed);
+  writer->printf("  - coalesced:    %10u  %8.1f/s\n", MyMetrics.m_stat_coalesced,
+    (float) MyMetrics.m_stat_coalesced / elapsed);
+  writer->printf("  Listener calls: %10u  %8.1f/s\n", MyMetrics.m_stat_listener_calls,
+    (float) MyMetrics.m_stat_listener_calls / elapsed);
+  writer->printf("  Batches:        %10u  %8.1f/s\n", MyMetrics.m_stat_batches,
+    (float) MyMetrics.m_stat_batches / elapsed);
+  }
+
 void metrics_set(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
   {
   if (MyMetrics.Set(argv[0],argv[1]))
@@ -407,6 +434,46 @@ MetricCallbackEntry::~MetricCallbackEntry()
   {
   }
 
+MetricBatchCallbackEntry::MetricBatchCallbackEntry(const char* caller, MetricBatchCallback callback)
+  {
+  m_caller = caller;
+  m_callback = callback;
+  }
+
+MetricBatchCallbackEntry::~MetricBatchCallbackEntry()
+  {
+  }
+
+MetricBatch::MetricBatch()
+  {
+  m_task = xTaskGetCurrentTaskHandle();
+  m_active = MyMetrics.BatchOpen(this);
+  }
+
+MetricBatch::~MetricBatch()
+  {
+  Commit();
+  }
+
+/**
+ * Commit: close the batch and notify the listeners about the metrics modified
+ *  Called automatically when the batch goes out of scope. No-op for nested batches.
+ */
+void MetricBatch::Commit()
+  {
+  if (!m_active)
+    return;
+  m_active = false;
+  MyMetrics.BatchClose(this);
+  if (m_metrics.empty())
+    return;
+  for (OvmsMetric* metric : m_metrics)
+    MyMetrics.NotifyListeners(metric);
+  MyMetrics.NotifyBatchListeners(m_metrics);
+  MyMetrics.m_stat_batches++;
+  m_metrics.clear();
+  }
+
 OvmsMetrics::OvmsMetrics()
   {
   ESP_LOGI(TAG, "Initialising METRICS (1810)");
@@ -414,6 +481,8 @@ OvmsMetrics::OvmsMetrics()
   m_nextmodifier = 1;
   m_first = NULL;
   m_trace = false;
+  m_batch_count = 0;
+  ResetStats();
 
   // Register our commands
   OvmsCommand* cmd_metric = MyCommandApp.RegisterCommand("metrics","METRICS framework");
@@ -427,6 +496,8 @@ OvmsMetrics::OvmsMetrics()
   cmd_metric->RegisterCommand("persist","Show persistent metrics info", metrics_persist, "[-r]\n"
       "-r = reset persistent metrics", 0, 1);
   cmd_metric->RegisterCommand("set","Set the value of a metric",metrics_set, "<metric> <value>", 2, 2);
+  cmd_metric->RegisterCommand("stats","Show metric notification statistics", metrics_stats, "[-r]\n"
+      "-r = reset statistics", 0, 1);
   OvmsCommand* cmd_metrictrace = cmd_metric->RegisterCommand("trace","METRIC trace framework");
   cmd_metrictrace->RegisterCommand("on","Turn metric tracing ON",metrics_trace);
   cmd_metrictrace->RegisterCommand("off","Turn metric tracing OFF",metrics_trace);
@@ -624,8 +695,24 @@ void OvmsMetrics::RegisterListener(const char* caller, const char* name, MetricC
   ml->push_back(new MetricCallbackEntry(caller,callback));
   }
 
+void OvmsMetrics::RegisterBatchListener(const char* caller, MetricBatchCallback callback)
+  {
+  m_batch_listeners.push_back(new MetricBatchCallbackEntry(caller,callback));
+  }
+
 void OvmsMetrics::DeregisterListener(const char* caller)
   {
+  for (auto it = m_batch_listeners.begin(); it != m_batch_listeners.end(); )
+    {
+    if ((*it)->m_caller == caller)
+      {
+      delete *it;
+      it = m_batch_listeners.erase(it);
+      }
+    else
+      ++it;
+    }
+
   MetricCallbackMap::iterator itm=m_listeners.begin();
   while (itm!=m_listeners.end())
     {
@@ -657,6 +744,22 @@ void OvmsMetrics::DeregisterListener(const char* caller)
   }
 
 void OvmsMetrics::NotifyModified(OvmsMetric* metric)
+  {
+  m_stat_modified++;
+
+  // Defer to the open batch of the current task, if any:
+  if (m_batch_count > 0 && BatchAdd(metric))
+    return;
+
+  NotifyListeners(metric);
+  if (!m_batch_listeners.empty())
+    {
+    MetricList metrics(1, metric);
+    NotifyBatchListeners(metrics);
+    }
+  }
+
+void OvmsMetrics::NotifyListeners(OvmsMetric* metric)
   {
   if (m_trace &&
       strcmp(metric->m_name, "m.monotonic") != 0 &&
@@ -681,6 +784,7 @@ void OvmsMetrics::NotifyModified(OvmsMetric* metric)
           {
           MetricCallbackEntry* ec = *itc;
           ec->m_callback(metric);
+          m_stat_listener_calls++;
           }
         }
       }
@@ -688,6 +792,69 @@ void OvmsMetrics::NotifyModified(OvmsMetric* metric)
     }
   }
 
+void OvmsMetrics::NotifyBatchListeners(const MetricList& metrics)
+  {
+  for (MetricBatchCallbackEntry* ec : m_batch_listeners)
+    {
+    ec->m_callback(metrics);
+    m_stat_listener_calls++;
+    }
+  }
+
+/**
+ * BatchOpen: register a batch for the current task
+ *  @return     false = the task already has an open batch (nested batch)
+ */
+bool OvmsMetrics::BatchOpen(MetricBatch* batch)
+  {
+  OvmsMutexLock lock(&m_batch_mutex);
+  for (MetricBatch* open : m_batches)
+    {
+    if (open->m_task == batch->m_task)
+      return false;
+    }
+  m_batches.push_back(batch);
+  m_batch_count++;
+  return true;
+  }
+
+void OvmsMetrics::BatchClose(MetricBatch* batch)
+  {
+  OvmsMutexLock lock(&m_batch_mutex);
+  m_batches.remove(batch);
+  m_batch_count = m_batches.size();
+  }
+
+/**
+ * BatchAdd: add a modified metric to the open batch of the current task
+ *  @return     false = no batch open for the current task
+ */
+bool OvmsMetrics::BatchAdd(OvmsMetric* metric)
+  {
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  OvmsMutexLock lock(&m_batch_mutex);
+  for (MetricBatch* batch : m_batches)
+    {
+    if (batch->m_task != task)
+      continue;
+    if (std::find(batch->m_metrics.begin(), batch->m_metrics.end(), metric) == batch->m_metrics.end())
+      batch->m_metrics.push_back(metric);
+    else
+      m_stat_coalesced++;
+    return true;
+    }
+  return false;
+  }
+
+void OvmsMetrics::ResetStats()
+  {
+  m_stat_modified = 0;
+  m_stat_coalesced = 0;
+  m_stat_listener_calls = 0;
+  m_stat_batches = 0;
+  m_stat_time = monotonictime;
+  }
+
 size_t OvmsMetrics::RegisterModifier()
   {
   return m_nextmodifier++;
@@ -877,6 +1044,17 @@ void OvmsMetric::ClearModified(size_t modifier)
   m_modified &= ~(1ul << modifier);
   }
 
+/**
+ * AsScaledVector: get vector elements multiplied by scale & rounded to integers
+ *  (used by the delta encoder, see metrics_delta.h)
+ *  - returns false for scalar metrics
+ */
+bool OvmsMetric::AsScaledVector(std::vector<int32_t>& dest, int scale)
+  {
+  dest.clear();
+  return false;
+  }
+
 OvmsMetricInt::OvmsMetricInt(const char* name, uint16_t autostale, metric_unit_t units, bool persist)
   : OvmsMetric(name, autostale, units, persist)
   {
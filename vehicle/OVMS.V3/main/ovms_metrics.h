@@ -41,6 +41,7 @@
 #include <set>
 #include <vector>
 #include <atomic>
+#include <type_traits>
 #include "ovms_utils.h"
 #include "ovms_mutex.h"
 #include "dbc_number.h"
@@ -174,6 +175,7 @@ class OvmsMetric
     virtual bool IsModifiedAndClear(size_t modifier);
     virtual void ClearModified(size_t modifier);
     virtual void SetModified(bool changed=true);
+    virtual bool AsScaledVector(std::vector<int32_t>& dest, int scale);
 
   public:
     OvmsMetric* m_next;
@@ -819,6 +821,37 @@ class OvmsMetricVector : public OvmsMetric
       return m_value;
       }
 
+    bool AsScaledVector(std::vector<int32_t>& dest, int scale)
+      {
+      return AsScaledVector(dest, scale, std::is_arithmetic<ElemType>());
+      }
+
+  protected:
+    // AsScaledVector() needs numerical elements, i.e. not for string vectors:
+    bool AsScaledVector(std::vector<int32_t>& dest, int scale, std::false_type)
+      {
+      dest.clear();
+      return false;
+      }
+
+    bool AsScaledVector(std::vector<int32_t>& dest, int scale, std::true_type)
+      {
+      OvmsMutexLock lock(&m_mutex);
+      if (!IsDefined())
+        {
+        dest.clear();
+        return true;
+        }
+      dest.resize(m_value.size());
+      for (size_t i = 0; i < m_value.size(); i++)
+        {
+        float val = (float)m_value[i] * scale;
+        dest[i] = (int32_t)(val + ((val < 0) ? -0.5f : 0.5f));
+        }
+      return true;
+      }
+
+  public:
     ElemType GetElemValue(size_t n)
       {
       ElemType val{};
@@ -918,6 +951,53 @@ class MetricCallbackEntry
 typedef std::list<MetricCallbackEntry*> MetricCallbackList;
 typedef std::map<const char*, MetricCallbackList*, CmpStrOp> MetricCallbackMap;
 
+typedef std::vector<OvmsMetric*> MetricList;
+typedef std::function<void(const MetricList&)> MetricBatchCallback;
+
+class MetricBatchCallbackEntry
+  {
+  public:
+    MetricBatchCallbackEntry(const char* caller, MetricBatchCallback callback);
+    virtual ~MetricBatchCallbackEntry();
+
+  public:
+    const char *m_caller;
+    MetricBatchCallback m_callback;
+  };
+
+typedef std::list<MetricBatchCallbackEntry*> MetricBatchCallbackList;
+
+// MetricBatch: collect the metric modifications done by the current task and
+//  notify the listeners once on commit (when the batch goes out of scope):
+//    {
+//    MetricBatch batch;
+//    StandardMetrics.ms_v_bat_voltage->SetValue(voltage);
+//    StandardMetrics.ms_v_bat_current->SetValue(current);
+//    } // <- listeners are called here
+//  Metric values are updated immediately, only the notifications are deferred. Each
+//  metric modified within the batch is notified once, with its final value. Batch
+//  listeners (see RegisterBatchListener()) receive the set of metrics by a single call.
+//  Batches can be nested, the outermost batch of a task commits.
+class MetricBatch
+  {
+  public:
+    MetricBatch();
+    ~MetricBatch();
+
+  private:
+    MetricBatch(const MetricBatch&) = delete;
+    MetricBatch& operator=(const MetricBatch&) = delete;
+
+  public:
+    void Commit();
+    size_t Size() { return m_metrics.size(); }
+
+  public:
+    TaskHandle_t m_task;                      // Task owning the batch
+    bool m_active;                            // false = nested or committed
+    MetricList m_metrics;                     // Metrics modified (in order)
+  };
+
 class OvmsMetrics
   {
   public:
@@ -969,11 +1049,37 @@ class OvmsMetrics
 
   public:
     void RegisterListener(const char* caller, const char* name, MetricCallback callback);
+    void RegisterBatchListener(const char* caller, MetricBatchCallback callback);
     void DeregisterListener(const char* caller);
     void NotifyModified(OvmsMetric* metric);
 
+  protected:
+    void NotifyListeners(OvmsMetric* metric);
+    void NotifyBatchListeners(const MetricList& metrics);
+
   protected:
     MetricCallbackMap m_listeners;
+    MetricBatchCallbackList m_batch_listeners;
+
+  protected:
+    friend class MetricBatch;
+    bool BatchOpen(MetricBatch* batch);
+    void BatchClose(MetricBatch* batch);
+    bool BatchAdd(OvmsMetric* metric);
+
+  protected:
+    std::list<MetricBatch*> m_batches;        // Open batches (max one per task)
+    std::atomic_int m_batch_count;            // … count (lock free check)
+    OvmsMutex m_batch_mutex;
+
+  public:
+    // Notification statistics, see 'metrics stats':
+    uint32_t m_stat_modified;                 // Modifications notified
+    uint32_t m_stat_coalesced;                // … merged into a prior modification in a batch
+    uint32_t m_stat_listener_calls;           // Listener callbacks executed
+    uint32_t m_stat_batches;                  // Batches committed
+    uint32_t m_stat_time;                     // Statistics start (monotonictime)
+    void ResetStats();
 
   public:
     size_t RegisterModifier();
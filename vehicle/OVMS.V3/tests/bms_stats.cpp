@@ -0,0 +1,236 @@
+/*
+ * Host check & benchmark for the BMS series statistics
+ *
+ * Exercises the incremental statistics of components/vehicle/vehicle_bms.cpp
+ * (BmsStatsInit(), BmsStatsUpdate(), BmsStatsComplete()) outside the module:
+ *
+ *  - check: random cell updates, each complete series is compared against a
+ *    full recalculation (mean, standard deviation, gradient, min/max cell)
+ *  - benchmark: time per series of the incremental statistics vs. the full
+ *    (double) recalculation done per series before (see BmsSetCellVoltage()) and
+ *    a single pass float recalculation, and the time spent at series completion
+ *    (i.e. in the frame handler receiving the last cell of a series)
+ *
+ * The statistics code is extracted from the sources by bms_stats.pl, which
+ * builds & runs this file, see there for usage.
+ *
+ * Host results (x86-64, g++ -O2):
+ *   max error avg 2.8e-7, stddev 4.7e-7, gradient 2.9e-7 (float), min/max exact
+ *    96 cells: full 0.6 us/series, float single pass 0.6, incremental 1.4, completion 0.02
+ *   192 cells: full 1.2-1.4 us/series, float single pass 0.8-1.1, incremental 2.9, completion 0.02
+ *   400 cells: full 2.6 us/series, float single pass 2.0, incremental 5.9, completion 0.03
+ *
+ * Note: host timings are indicative only, the host has hardware double math, the
+ * ESP32 does double math in software (single precision in hardware). No module
+ * measurements are available; use 'vehicle profile' to measure on the module.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+
+#define SQR(n) ((n)*(n))
+#define LIMIT_MIN(n,lim) ((n) < (lim) ? (lim) : (n))
+
+class OvmsVehicle
+  {
+  public:
+#include "bms_stats_type.inc"
+    static void BmsStatsInit(bms_stats_t& stats, const float* values, int readings);
+    static void BmsStatsUpdate(bms_stats_t& stats, float* values, int readings, int index, float value);
+    static void BmsStatsComplete(bms_stats_t& stats, const float* values, int readings);
+  };
+
+#include "bms_stats_impl.inc"
+
+typedef OvmsVehicle::bms_stats_t bms_stats_t;
+
+struct series_t
+  {
+  double avg, stddev, grad;
+  float min, max;
+  };
+
+// Full recalculation as done per series before the incremental statistics:
+static void FullStats(series_t& s, const float* values, int n)
+  {
+  double sum = 0, sqrsum = 0;
+  float min = 0, max = 0;
+  for (int i=0; i<n; i++)
+    {
+    sum += values[i];
+    sqrsum += SQR(values[i]);
+    if (min==0 || values[i]<min) min = values[i];
+    if (max==0 || values[i]>max) max = values[i];
+    }
+  s.avg = sum / n;
+  s.stddev = sqrt(LIMIT_MIN((sqrsum / n) - SQR(s.avg), 0));
+  double sumn = 0, sumd = 0;
+  for (int i=0; i<n; i++)
+    {
+    sumn += (i - (n / 2 - 0.5)) * (values[i] - s.avg);
+    sumd += SQR(i - (n / 2 - 0.5));
+    }
+  s.grad = (sumn / sumd) * n;
+  s.min = min;
+  s.max = max;
+  }
+
+// Series result from the incremental statistics (see BmsSetCellVoltage()):
+static void IncStats(series_t& s, bms_stats_t& st, const float* values, int n)
+  {
+  OvmsVehicle::BmsStatsComplete(st, values, n);
+  s.min = values[st.imin];
+  s.max = values[st.imax];
+  s.avg = st.ref + st.dmean;
+  s.stddev = sqrtf(LIMIT_MIN(st.m2 / n, 0));
+  s.grad = (st.isqrsum > 0) ? st.isum / st.isqrsum * n : 0;
+  }
+
+// Single pass float recalculation (the alternative to the incremental statistics):
+static void FloatStats(series_t& s, const float* values, int n)
+  {
+  float v0 = values[0], center = (n - 1) * 0.5f;
+  float sum = 0, sqrsum = 0, isum = 0, isqrsum = 0;
+  int imin = 0, imax = 0;
+  for (int i=0; i<n; i++)
+    {
+    float d = values[i] - v0;
+    sum += d;
+    sqrsum += d * d;
+    isum += (i - center) * d;
+    isqrsum += SQR(i - (n / 2 - 0.5f));
+    if (values[i] < values[imin]) imin = i;
+    if (values[i] > values[imax]) imax = i;
+    }
+  float dmean = sum / n;
+  s.avg = v0 + dmean;
+  s.stddev = sqrtf(LIMIT_MIN(sqrsum / n - dmean * dmean, 0));
+  s.grad = isum / isqrsum * n;
+  s.min = values[imin];
+  s.max = values[imax];
+  }
+
+// Cell voltage sample: 3.6-3.9 V, slight gradient, 1 mV resolution
+static float Sample(int i, int n)
+  {
+  return (3600 + rand() % 300 + (20 * i) / n) / 1000.0f;
+  }
+
+static bool Check(int n, int series)
+  {
+  std::vector<float> values(n);
+  for (int i=0; i<n; i++)
+    values[i] = Sample(i, n);
+  bms_stats_t st;
+  OvmsVehicle::BmsStatsInit(st, values.data(), n);
+
+  double err_avg = 0, err_stddev = 0, err_grad = 0;
+  int err_minmax = 0;
+  for (int k=0; k<series; k++)
+    {
+    // Update cells in random order, some cells multiple times:
+    for (int u=0; u<n; u++)
+      {
+      int i = rand() % n;
+      OvmsVehicle::BmsStatsUpdate(st, values.data(), n, i, Sample(i, n));
+      }
+    series_t inc, ref;
+    IncStats(inc, st, values.data(), n);
+    FullStats(ref, values.data(), n);
+    // (the single pass stddev of FullStats() loses precision, use two passes here)
+    double m2 = 0;
+    for (int i=0; i<n; i++)
+      m2 += SQR(values[i] - ref.avg);
+    ref.stddev = sqrt(m2 / n);
+    err_avg = fmax(err_avg, fabs(inc.avg - ref.avg));
+    err_stddev = fmax(err_stddev, fabs(inc.stddev - ref.stddev));
+    err_grad = fmax(err_grad, fabs(inc.grad - ref.grad));
+    if (inc.min != ref.min || inc.max != ref.max)
+      err_minmax++;
+    }
+
+  // Tolerance: single precision, an order below the 5 digits published (ROUNDPREC(x, 5)):
+  bool ok = (err_avg < 1e-6 && err_stddev < 1e-6 && err_grad < 1e-6 && err_minmax == 0);
+  printf("check %3d cells, %d series: max error avg %.2g, stddev %.2g, grad %.2g, min/max %d: %s\n",
+    n, series, err_avg, err_stddev, err_grad, err_minmax, ok ? "OK" : "FAIL");
+  return ok;
+  }
+
+static double Elapsed(std::chrono::steady_clock::time_point start)
+  {
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+  }
+
+static void Bench(int n, int series)
+  {
+  std::vector<float> values(n), updates(n * series);
+  for (size_t i=0; i<updates.size(); i++)
+    updates[i] = Sample(i % n, n);
+  series_t s;
+  volatile double sink = 0;
+
+  // Before: store values, full recalculation per series
+  for (int i=0; i<n; i++) values[i] = updates[i];
+  auto start = std::chrono::steady_clock::now();
+  for (int k=0; k<series; k++)
+    {
+    for (int i=0; i<n; i++)
+      values[i] = updates[k*n+i];
+    FullStats(s, values.data(), n);
+    sink += s.stddev + s.grad;
+    }
+  double t_full = Elapsed(start) / series;
+
+  // Alternative: single pass float recalculation per series
+  start = std::chrono::steady_clock::now();
+  for (int k=0; k<series; k++)
+    {
+    for (int i=0; i<n; i++)
+      values[i] = updates[k*n+i];
+    FloatStats(s, values.data(), n);
+    sink += s.stddev + s.grad;
+    }
+  double t_float = Elapsed(start) / series;
+
+  // After: incremental update per cell, O(1) series completion
+  for (int i=0; i<n; i++) values[i] = updates[i];
+  bms_stats_t st;
+  OvmsVehicle::BmsStatsInit(st, values.data(), n);
+  start = std::chrono::steady_clock::now();
+  for (int k=0; k<series; k++)
+    {
+    for (int i=0; i<n; i++)
+      OvmsVehicle::BmsStatsUpdate(st, values.data(), n, i, updates[k*n+i]);
+    IncStats(s, st, values.data(), n);
+    sink += s.stddev + s.grad;
+    }
+  double t_inc = Elapsed(start) / series;
+
+  // Series completion only (includes the periodic exact resync):
+  start = std::chrono::steady_clock::now();
+  for (int k=0; k<series; k++)
+    {
+    IncStats(s, st, values.data(), n);
+    sink += s.stddev + s.grad;
+    }
+  double t_done = Elapsed(start) / series;
+
+  printf("bench %3d cells: full recalculation %.2f us/series (float single pass %.2f),"
+    " incremental %.2f us/series (%.3f us/cell, completion %.3f us)\n",
+    n, t_full, t_float, t_inc, (t_inc - t_done) / n, t_done);
+  }
+
+int main(int argc, char* argv[])
+  {
+  int series = (argc > 1) ? atoi(argv[1]) : 10000;
+  srand(1);
+  bool ok = true;
+  for (int n : { 96, 97, 192, 400 })
+    ok &= Check(n, 1000);
+  for (int n : { 96, 192, 400 })
+    Bench(n, series);
+  return ok ? 0 : 1;
+  }
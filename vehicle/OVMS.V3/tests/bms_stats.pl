@@ -0,0 +1,69 @@
+#!/usr/bin/perl
+#
+# Host check & benchmark for the BMS series statistics
+#
+# Extracts the statistics code (bms_stats_t, BmsStatsInit(), BmsStatsUpdate(),
+# BmsStatsComplete()) from the vehicle sources, builds bms_stats.cpp with it and
+# runs the check (incremental vs. full recalculation for 96, 97, 192 & 400 cells)
+# and the benchmark (time per series for 96, 192 & 400 cells).
+#
+# Usage: bms_stats.pl [options]
+#   --cxx <compiler>    Host C++ compiler (default: c++)
+#   --series <n>        Benchmark series per cell count (default: 10000)
+#   --keep              Keep the build directory
+#
+# Exit code 0 = check passed.
+
+use strict;
+use warnings;
+use File::Basename;
+use File::Temp qw(tempdir);
+use Getopt::Long;
+
+my %opt = ( 'cxx' => 'c++', 'series' => 10000, 'keep' => 0 );
+GetOptions(\%opt, 'cxx=s', 'series=i', 'keep!') && @ARGV == 0
+  or die "Usage: $0 [--cxx <compiler>] [--series <n>] [--keep]\n";
+
+my $tests = dirname(__FILE__);
+my $src = "$tests/../components/vehicle";
+my $dir = tempdir('bms_stats_XXXX', TMPDIR => 1, CLEANUP => !$opt{'keep'});
+
+sub slurp
+  {
+  open(my $f, '<', $_[0]) or die "$_[0]: $!\n";
+  local $/;
+  return <$f>;
+  }
+
+sub spew
+  {
+  open(my $f, '>', $_[0]) or die "$_[0]: $!\n";
+  print $f $_[1];
+  }
+
+# bms_stats_t from vehicle.h:
+my $h = slurp("$src/vehicle.h");
+$h =~ /^(\s*typedef struct\s*\{[^}]*\}\s*bms_stats_t;)/m
+  or die "vehicle.h: bms_stats_t not found\n";
+spew("$dir/bms_stats_type.inc", "$1\n");
+
+# BMS_STATS_RESYNC & the statistics functions from vehicle_bms.cpp:
+my $c = slurp("$src/vehicle_bms.cpp");
+my $impl = '';
+$c =~ /^(#define BMS_STATS_RESYNC\b.*)$/m
+  or die "vehicle_bms.cpp: BMS_STATS_RESYNC not found\n";
+$impl .= "$1\n\n";
+foreach my $fn (qw(BmsStatsInit BmsStatsUpdate BmsStatsComplete))
+  {
+  $c =~ /^(void OvmsVehicle::$fn\(.*?\n  \}\n)/ms
+    or die "vehicle_bms.cpp: $fn not found\n";
+  $impl .= "$1\n";
+  }
+spew("$dir/bms_stats_impl.inc", $impl);
+
+# Build & run:
+my @cmd = ($opt{'cxx'}, '-std=c++11', '-O2', '-Wall', "-I$dir", '-o', "$dir/bms_stats",
+  "$tests/bms_stats.cpp");
+system(@cmd) == 0 or die "Build failed: @cmd\n";
+print "Build directory: $dir\n" if ($opt{'keep'});
+exit(system("$dir/bms_stats", $opt{'series'}) == 0 ? 0 : 1);
@@ -0,0 +1,216 @@
+/*
+ * brakelight: regen brake light benchmark on the host
+ *
+ * Usage: brakelight [-n <samples>] [-c <cycles>] [-f <ms>] [-v <level>] metric|raw
+ *   -n <samples>   Speed samples for the CPU time measurement (default 200000)
+ *   -c <cycles>    Cruise / deceleration cycles for the latency measurement (default 3)
+ *   -f <ms>        Speed frame interval (default 20)
+ *   -v <level>     Log level (default 2 = warnings)
+ *
+ * Runs the vehicle framework with a Smart ED style speed frame (ID 0x200, kph * 18)
+ * and the regen brake light enabled (SetBrakelight() only records the switch).
+ * The frame handler sets ms_v_pos_speed and then derives the acceleration by
+ *   metric: CalculateAcceleration(), reading back the speed metric
+ *   raw:    CalculateAcceleration(kph), filtering the decoded frame sample
+ *
+ * CPU: calls the frame handler <samples> times with a speed ramp (60 → 0 kph) and
+ *   reports the time per frame.
+ * Latency: sends the frames at the frame interval via the virtual bus, each cycle
+ *   cruising at 60 kph for 1 second and decelerating by 2 m/s² for 1.5 seconds.
+ *   Reports the delay from the first decelerating frame to the brake light switch
+ *   (mostly the acceleration smoothing) and the switch latency measured by the vehicle
+ *   task from the frame reception (see OvmsVehicle::BrakelightLatency()).
+ *
+ *   Host results (x86-64, -O2, 20 ms frames, accel.smoothing 2, 3 runs each):
+ *     metric:  0.18-0.20 µs/frame, brake light on after 40-42 ms, switch latency 9-12 µs
+ *     raw:     0.19-0.23 µs/frame, brake light on after 40-41 ms, switch latency 10-18 µs
+ *   I.e. no difference beyond the noise: the detection delay is given by the frame
+ *   interval & smoothing (2 frames), the switch itself takes microseconds either way.
+ *
+ * Build & run: make -C tests/host brakelight && tests/host/build/brakelight raw
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <chrono>
+#include "vehicle.h"
+#include "host.h"
+
+static bool sample_raw = false;
+
+/**
+ * OvmsVehicleBrakeTest: speed frame decoder & brake light recorder
+ */
+class OvmsVehicleBrakeTest : public OvmsVehicle
+  {
+  public:
+    OvmsVehicleBrakeTest();
+
+  public:
+    void IncomingFrameCan1(CAN_frame_t* p_frame);
+    bool SetBrakelight(int on);
+
+  public:
+    volatile int m_switches;
+    volatile int m_light;
+    volatile int64_t m_switch_time;
+    volatile int32_t m_switch_latency;
+  };
+
+OvmsVehicleBrakeTest::OvmsVehicleBrakeTest()
+  {
+  m_switches = 0;
+  m_light = 0;
+  m_switch_time = 0;
+  m_switch_latency = -1;
+  RegisterCanBus(1, CAN_MODE_ACTIVE, CAN_SPEED_500KBPS);
+  }
+
+void OvmsVehicleBrakeTest::IncomingFrameCan1(CAN_frame_t* p_frame)
+  {
+  uint8_t *d = p_frame->data.u8;
+  if (p_frame->MsgID != 0x200)
+    return;
+  float velocity = (d[2] * 256 + d[3]) / 18.0;
+  StandardMetrics.ms_v_pos_speed->SetValue(velocity, Kph);
+  if (sample_raw)
+    CalculateAcceleration(velocity);
+  else
+    CalculateAcceleration();
+  }
+
+bool OvmsVehicleBrakeTest::SetBrakelight(int on)
+  {
+  m_switch_time = esp_timer_get_time();
+  m_switch_latency = (m_brakelight_rxtime) ? m_switch_time - m_brakelight_rxtime : -1;
+  m_light = on;
+  m_switches++;
+  return true;
+  }
+
+static void SpeedFrame(CAN_frame_t* frame, float kph)
+  {
+  int v = (int)(kph * 18 + 0.5);
+  memset(frame, 0, sizeof(*frame));
+  frame->origin = HostCanGetBus(1);
+  frame->FIR.B.DLC = 8;
+  frame->MsgID = 0x200;
+  frame->data.u8[2] = (v >> 8) & 0xff;
+  frame->data.u8[3] = v & 0xff;
+  }
+
+/**
+ * RunCPU: frame handler time per speed sample
+ */
+static void RunCPU(OvmsVehicleBrakeTest* vehicle, int samples)
+  {
+  CAN_frame_t frame;
+  double us = 0;
+  int64_t last = 0;
+  for (int k = 0; k < samples; k++)
+    {
+    // CalculateAcceleration() skips samples within the same microsecond:
+    while (esp_timer_get_time() == last)
+      ;
+    last = esp_timer_get_time();
+    SpeedFrame(&frame, 60.0f * (samples - k) / samples);
+    auto start = std::chrono::steady_clock::now();
+    vehicle->IncomingFrameCan1(&frame);
+    auto end = std::chrono::steady_clock::now();
+    us += std::chrono::duration<double, std::micro>(end - start).count();
+    }
+  printf("CPU: %d frames, %.3f us/frame, %d brake light switches\n", samples, us / samples,
+    (int)vehicle->m_switches);
+  }
+
+/**
+ * RunLatency: speed profile via the virtual bus, see above
+ */
+static int RunLatency(OvmsVehicleBrakeTest* vehicle, int cycles, int interval)
+  {
+  const float cruise = 60, decel = 2.0;
+  const int cruise_frames = 1000 / interval, brake_frames = 1500 / interval;
+  hostcan* bus = HostCanGetBus(1);
+  CAN_frame_t frame;
+  int detected = 0;
+
+  for (int cycle = 1; cycle <= cycles; cycle++)
+    {
+    // cruise, wait for the brake light to turn off:
+    for (int k = 0; k < cruise_frames; k++)
+      {
+      SpeedFrame(&frame, cruise);
+      bus->Receive(&frame);
+      usleep(interval * 1000);
+      }
+    // decelerate:
+    int64_t start = esp_timer_get_time();
+    int64_t switched = 0;
+    int32_t latency = -1;
+    for (int k = 1; k <= brake_frames; k++)
+      {
+      SpeedFrame(&frame, cruise - decel * 3.6f * k * interval / 1000);
+      bus->Receive(&frame);
+      usleep(interval * 1000);
+      if (!switched && vehicle->m_light)
+        {
+        switched = vehicle->m_switch_time;
+        latency = vehicle->m_switch_latency;
+        }
+      }
+    if (switched)
+      {
+      detected++;
+      printf("Cycle %d: brake light on after %.0f ms, switch latency %d us\n",
+        cycle, (switched - start) / 1000.0, latency);
+      }
+    else
+      printf("Cycle %d: brake light not switched on\n", cycle);
+    }
+  return (detected == cycles) ? 0 : 1;
+  }
+
+static void usage()
+  {
+  fprintf(stderr, "Usage: brakelight [-n <samples>] [-c <cycles>] [-f <ms>] [-v <level>] metric|raw\n");
+  }
+
+int main(int argc, char* argv[])
+  {
+  int samples = 200000, cycles = 3, interval = 20, loglevel = ESP_LOG_WARN;
+  int opt;
+  while ((opt = getopt(argc, argv, "n:c:f:v:")) != -1)
+    {
+    switch (opt)
+      {
+      case 'n': samples = atoi(optarg); break;
+      case 'c': cycles = atoi(optarg); break;
+      case 'f': interval = atoi(optarg); break;
+      case 'v': loglevel = atoi(optarg); break;
+      default: usage(); return 1;
+      }
+    }
+  const char* mode = (optind < argc) ? argv[optind] : "";
+  sample_raw = (strcmp(mode, "raw") == 0);
+  if ((!sample_raw && strcmp(mode, "metric") != 0) || interval < 1 || samples < 1)
+    {
+    usage();
+    return 1;
+    }
+
+  HostStart(loglevel);
+  HostCanInit(1);
+
+  MyConfig.SetParamValueBool("vehicle", "brakelight.enable", true);
+  MyVehicleFactory.RegisterVehicle<OvmsVehicleBrakeTest>("HOST", "Host benchmark");
+  MyVehicleFactory.SetVehicle("HOST");
+  OvmsVehicleBrakeTest* vehicle = (OvmsVehicleBrakeTest*)MyVehicleFactory.m_currentvehicle;
+  StandardMetrics.ms_v_env_on->SetValue(true);
+
+  printf("Mode: %s\n", mode);
+  RunCPU(vehicle, samples);
+  int result = RunLatency(vehicle, cycles, interval);
+  HostExit(result);
+  }
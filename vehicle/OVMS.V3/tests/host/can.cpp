@@ -0,0 +1,454 @@
+/*
+ * Host CAN framework
+ *
+ * The CAN system controller & bus base class following components/can/src/can.cpp
+ * (frame/TX callback dispatching, listeners, frame callbacks), without the
+ * shell commands, loggers & players. The virtual bus driver hostcan passes
+ * frames written to a TX handler and acknowledges them via the CAN task.
+ */
+
+#include "ovms_log.h"
+static const char *TAG = "can";
+
+#include <string.h>
+#include <sys/time.h>
+#include "can.h"
+#include "dbc.h"
+#include "metrics_standard.h"
+#include "host.h"
+
+can MyCan __attribute__ ((init_priority (4510)));
+
+
+////////////////////////////////////////////////////////////////////////
+// can - the CAN system controller
+////////////////////////////////////////////////////////////////////////
+
+static const char* const CAN_log_type_names[] = {
+  "-",
+  "RX",
+  "TX",
+  "TX_Queue",
+  "TX_Fail",
+  "Error",
+  "Status",
+  "Comment",
+  "Info",
+  "Event"
+  };
+
+const char* GetCanLogTypeName(CAN_log_type_t type)
+  {
+  return CAN_log_type_names[type];
+  }
+
+static const char* const CAN_errorstate_names[] = {
+  "none",
+  "active",
+  "warning",
+  "passive",
+  "busoff"
+  };
+
+const char* GetCanErrorStateName(CAN_errorstate_t error_state)
+  {
+  return CAN_errorstate_names[error_state];
+  }
+
+void can::CAN_rxtask(void *pvParameters)
+  {
+  can *me = (can*)pvParameters;
+  CAN_queue_msg_t msg;
+
+  while(1)
+    {
+    if (xQueueReceive(me->m_rxqueue,&msg, (portTickType)portMAX_DELAY)==pdTRUE)
+      {
+      switch(msg.type)
+        {
+        case CAN_frame:
+          me->IncomingFrame(&msg.body.frame);
+          break;
+        case CAN_txcallback:
+          msg.body.bus->TxCallback(&msg.body.frame, true);
+          break;
+        case CAN_txfailedcallback:
+          msg.body.bus->TxCallback(&msg.body.frame, false);
+          break;
+        default:
+          break;
+        }
+      }
+    }
+  }
+
+can::can()
+  {
+  m_logger_id = 1;
+  m_player_id = 1;
+  for (int k=0;k<CAN_MAXBUSES;k++) m_buslist[k] = NULL;
+  m_rxqueue = xQueueCreate(CONFIG_OVMS_HW_CAN_RX_QUEUE_SIZE,sizeof(CAN_queue_msg_t));
+  xTaskCreatePinnedToCore(CAN_rxtask, "OVMS CanRx", 2*2048, (void*)this, 23, &m_rxtask, CORE(0));
+  }
+
+can::~can()
+  {
+  }
+
+canbus* can::GetBus(int busnumber)
+  {
+  if ((busnumber<0)||(busnumber>=CAN_MAXBUSES)) return NULL;
+
+  canbus* found = m_buslist[busnumber];
+  if (found != NULL) return found;
+
+  char cbus[5];
+  strcpy(cbus,"can");
+  cbus[3] = busnumber+'1';
+  cbus[4] = 0;
+  found = (canbus*)MyPcpApp.FindDeviceByName(cbus);
+  if (found)
+    {
+    m_buslist[busnumber] = found;
+    }
+  return found;
+  }
+
+void can::IncomingFrame(CAN_frame_t* p_frame)
+  {
+  p_frame->origin->m_status.packets_rx++;
+  p_frame->origin->m_watchdog_timer = monotonictime;
+
+  ExecuteCallbacks(p_frame, false, true /*ignored*/);
+  NotifyListeners(p_frame, false);
+  }
+
+void can::RegisterListener(QueueHandle_t queue, bool txfeedback, CanListenerFilter filter)
+  {
+  CanListener_t& listener = m_listeners[queue];
+  listener.txfeedback = txfeedback;
+  listener.filter = filter;
+  }
+
+void can::DeregisterListener(QueueHandle_t queue)
+  {
+  auto it = m_listeners.find(queue);
+  if (it != m_listeners.end())
+    m_listeners.erase(it);
+  }
+
+void can::NotifyListeners(const CAN_frame_t* frame, bool tx)
+  {
+  for (CanListenerMap_t::iterator it = m_listeners.begin(); it != m_listeners.end(); ++it)
+    {
+    if (tx && !it->second.txfeedback)
+      continue;
+    if (it->second.filter && !it->second.filter(frame))
+      continue;
+    xQueueSend(it->first,frame,0);
+    }
+  }
+
+void can::RegisterCallback(const char* caller, CanFrameCallback callback, bool txfeedback)
+  {
+  if (txfeedback)
+    m_txcallbacks.push_back(new CanFrameCallbackEntry(caller, callback));
+  else
+    m_rxcallbacks.push_back(new CanFrameCallbackEntry(caller, callback));
+  }
+
+void can::DeregisterCallback(const char* caller)
+  {
+  m_rxcallbacks.remove_if([caller](CanFrameCallbackEntry* entry){ return strcmp(entry->m_caller, caller)==0; });
+  m_txcallbacks.remove_if([caller](CanFrameCallbackEntry* entry){ return strcmp(entry->m_caller, caller)==0; });
+  }
+
+int can::ExecuteCallbacks(const CAN_frame_t* frame, bool tx, bool success)
+  {
+  int cnt = 0;
+  if (tx)
+    {
+    if (frame->callback)
+      {
+      (*(frame->callback))(frame, success);
+      cnt++;
+      }
+    for (auto entry : m_txcallbacks)
+      {
+      entry->m_callback(frame, success);
+      cnt++;
+      }
+    }
+  else
+    {
+    for (auto entry : m_rxcallbacks)
+      {
+      entry->m_callback(frame, success);
+      cnt++;
+      }
+    }
+  return cnt;
+  }
+
+// No loggers & players on the host:
+void can::LogFrame(canbus* bus, CAN_log_type_t type, const CAN_frame_t* frame) {}
+void can::LogStatus(canbus* bus, CAN_log_type_t type, const CAN_status_t* status) {}
+void can::LogInfo(canbus* bus, CAN_log_type_t type, const char* text) {}
+bool can::HasLogger() { return false; }
+bool can::HasPlayer() { return false; }
+
+
+////////////////////////////////////////////////////////////////////////
+// canbus - the definition of a CAN bus
+////////////////////////////////////////////////////////////////////////
+
+canbus::canbus(const char* name)
+  : pcp(name)
+  {
+  m_busnumber = name[strlen(name)-1] - '1';
+  m_txqueue = xQueueCreate(CONFIG_OVMS_HW_CAN_TX_QUEUE_SIZE, sizeof(CAN_frame_t));
+  m_mode = CAN_MODE_OFF;
+  m_speed = CAN_SPEED_1000KBPS;
+  m_dbcfile = NULL;
+  m_tx_frame = {};
+  ClearStatus();
+  }
+
+canbus::~canbus()
+  {
+  vQueueDelete(m_txqueue);
+  }
+
+esp_err_t canbus::Start(CAN_mode_t mode, CAN_speed_t speed)
+  {
+  ClearStatus();
+  return ESP_FAIL;
+  }
+
+esp_err_t canbus::Start(CAN_mode_t mode, CAN_speed_t speed, dbcfile *dbcfile)
+  {
+  if (m_dbcfile) DetachDBC();
+  if (dbcfile) AttachDBC(dbcfile);
+  return Start(mode, speed);
+  }
+
+esp_err_t canbus::Stop()
+  {
+  if (m_dbcfile) DetachDBC();
+  return ESP_FAIL;
+  }
+
+esp_err_t canbus::ViewRegisters()
+  {
+  return ESP_ERR_NOT_SUPPORTED;
+  }
+
+esp_err_t canbus::WriteReg( uint8_t reg, uint8_t value )
+  {
+  return ESP_FAIL;
+  }
+
+void canbus::ClearStatus()
+  {
+  memset(&m_status, 0, sizeof(m_status));
+  m_status_chksum = 0;
+  m_watchdog_timer = monotonictime;
+  }
+
+// No DBC registry on the host, files are attached directly:
+void canbus::AttachDBC(dbcfile *dbcfile)
+  {
+  if (m_dbcfile) DetachDBC();
+  m_dbcfile = dbcfile;
+  m_dbcfile->LockFile();
+  }
+
+bool canbus::AttachDBC(const char *name)
+  {
+  return false;
+  }
+
+void canbus::DetachDBC()
+  {
+  if (m_dbcfile)
+    {
+    m_dbcfile->UnlockFile();
+    m_dbcfile = NULL;
+    }
+  }
+
+dbcfile* canbus::GetDBC()
+  {
+  return m_dbcfile;
+  }
+
+void canbus::BusTicker10(std::string event, void* data)
+  {
+  }
+
+bool canbus::AsynchronousInterruptHandler(CAN_frame_t* frame, uint32_t* framesReceived)
+  {
+  return false;
+  }
+
+void canbus::TxCallback(CAN_frame_t* p_frame, bool success)
+  {
+  if (success)
+    {
+    m_status.packets_tx++;
+    MyCan.ExecuteCallbacks(p_frame, true, success);
+    MyCan.NotifyListeners(p_frame, true);
+    }
+  else
+    {
+    m_status.tx_fails++;
+    MyCan.ExecuteCallbacks(p_frame, true, success);
+    }
+  }
+
+void canbus::LogFrame(CAN_log_type_t type, const CAN_frame_t* frame) {}
+void canbus::LogStatus(CAN_log_type_t type) {}
+void canbus::LogInfo(CAN_log_type_t type, const char* text) {}
+
+esp_err_t canbus::Write(const CAN_frame_t* p_frame, TickType_t maxqueuewait /*=0*/)
+  {
+  m_tx_frame = *p_frame; // save a local copy of this frame to be used later in txcallback
+  m_tx_frame.origin = this;
+  return ESP_OK;
+  }
+
+esp_err_t canbus::QueueWrite(const CAN_frame_t* p_frame, TickType_t maxqueuewait /*=0*/)
+  {
+  return ESP_FAIL;
+  }
+
+esp_err_t canbus::WriteExtended(uint32_t id, uint8_t length, uint8_t *data, TickType_t maxqueuewait /*=0*/)
+  {
+  if (length > 8)
+    {
+    abort();
+    }
+
+  CAN_frame_t frame;
+  memset(&frame, 0, sizeof(frame));
+
+  frame.origin = this;
+  frame.FIR.U = 0;
+  frame.FIR.B.DLC = length;
+  frame.FIR.B.FF = CAN_frame_ext;
+  frame.MsgID = id;
+  memcpy(frame.data.u8, data, length);
+  return this->Write(&frame, maxqueuewait);
+  }
+
+esp_err_t canbus::WriteStandard(uint16_t id, uint8_t length, uint8_t *data, TickType_t maxqueuewait /*=0*/)
+  {
+  if (length > 8)
+    {
+    abort();
+    }
+
+  CAN_frame_t frame;
+  memset(&frame, 0, sizeof(frame));
+
+  frame.origin = this;
+  frame.FIR.U = 0;
+  frame.FIR.B.DLC = length;
+  frame.FIR.B.FF = CAN_frame_std;
+  frame.MsgID = id;
+  memcpy(frame.data.u8, data, length);
+  return this->Write(&frame, maxqueuewait);
+  }
+
+esp_err_t CAN_frame_t::Write(canbus* bus /*=NULL*/, TickType_t maxqueuewait /*=0*/)
+  {
+  if (!bus)
+    bus = origin;
+  return bus ? bus->Write(this, maxqueuewait) : ESP_FAIL;
+  }
+
+
+////////////////////////////////////////////////////////////////////////
+// hostcan - virtual bus driver
+////////////////////////////////////////////////////////////////////////
+
+static hostcan* host_buses[CAN_MAXBUSES] = {};
+
+hostcan::hostcan(const char* name)
+  : canbus(name)
+  {
+  m_txhandler = NULL;
+  }
+
+hostcan::~hostcan()
+  {
+  }
+
+esp_err_t hostcan::Start(CAN_mode_t mode, CAN_speed_t speed)
+  {
+  m_mode = mode;
+  m_speed = speed;
+  m_powermode = On;
+  ClearStatus();
+  ESP_LOGD(TAG, "%s started (%s, %d kbps)", m_name, (mode == CAN_MODE_ACTIVE) ? "active" : "listen", (int)speed);
+  return ESP_OK;
+  }
+
+esp_err_t hostcan::Stop()
+  {
+  canbus::Stop();
+  m_mode = CAN_MODE_OFF;
+  m_powermode = Off;
+  return ESP_OK;
+  }
+
+/**
+ * Write: pass the frame to the TX handler & schedule the TX callback
+ *  The frame is considered sent when written: there is no bus arbitration or
+ *  TX buffer, the TX callback is run by the CAN task like on the module.
+ */
+esp_err_t hostcan::Write(const CAN_frame_t* p_frame, TickType_t maxqueuewait /*=0*/)
+  {
+  if (m_mode != CAN_MODE_ACTIVE)
+    {
+    ESP_LOGW(TAG, "%s: cannot write in mode %d", m_name, (int)m_mode);
+    return ESP_FAIL;
+    }
+
+  canbus::Write(p_frame, maxqueuewait);
+
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  if (m_txhandler)
+    m_txhandler(&m_tx_frame, &now);
+
+  CAN_queue_msg_t msg;
+  msg.type = CAN_txcallback;
+  msg.body.frame = m_tx_frame;
+  msg.body.bus = this;
+  return (xQueueSend(MyCan.m_rxqueue, &msg, maxqueuewait) == pdTRUE) ? ESP_OK : ESP_FAIL;
+  }
+
+void hostcan::Receive(const CAN_frame_t* frame)
+  {
+  CAN_queue_msg_t msg;
+  msg.type = CAN_frame;
+  msg.body.frame = *frame;
+  msg.body.frame.origin = this;
+  msg.body.frame.callback = NULL;
+  if (xQueueSend(MyCan.m_rxqueue, &msg, 0) != pdTRUE)
+    m_status.rxbuf_overflow++;
+  }
+
+void HostCanInit(int count)
+  {
+  // Note: pcp keeps the name pointer
+  static const char* name[CAN_MAXBUSES] = {"can1", "can2", "can3", "can4", "can5"};
+  for (int k = 0; k < count && k < CAN_MAXBUSES; k++)
+    host_buses[k] = new hostcan(name[k]);
+  }
+
+hostcan* HostCanGetBus(int bus)
+  {
+  return (bus >= 1 && bus <= CAN_MAXBUSES) ? host_buses[bus-1] : NULL;
+  }
@@ -0,0 +1,127 @@
+/*
+ * dbcdecode: decode CAN log files using DBC files on the host
+ *
+ * Usage: dbcdecode [-t <threads>] <format> <logfile> <outprefix> <dbcfile>[:<bus>] [...]
+ *
+ * Host build of the module command 'dbc decode', see components/dbc/src/dbc_decoder.h.
+ * Writes the signal values to <outprefix>.csv and <outprefix>.bin (binary columns).
+ * <format>: CAN log format, e.g. crtd, gvret-a, pcap
+ * <bus>: restrict the DBC file to bus 1-4 (default all buses)
+ *
+ * Build: make -C tests/host dbcdecode
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <list>
+#include "dbc.h"
+#include "dbc_decoder.h"
+#include "canformat.h"
+#include "host.h"
+
+static void usage()
+  {
+  fprintf(stderr,
+    "Usage: dbcdecode [-t <threads>] <format> <logfile> <outprefix> <dbcfile>[:<bus>] [...]\n"
+    "Formats:");
+  for (auto& f : MyCanFormatFactory.m_fmap)
+    fprintf(stderr, " %s", f.first);
+  fprintf(stderr, "\n");
+  }
+
+int main(int argc, char* argv[])
+  {
+  int threads = DBC_DECODER_THREADS;
+  int opt;
+  while ((opt = getopt(argc, argv, "t:")) != -1)
+    {
+    if (opt == 't')
+      threads = atoi(optarg);
+    else
+      {
+      usage();
+      return 1;
+      }
+    }
+  argc -= optind;
+  argv += optind;
+  if (argc < 4)
+    {
+    usage();
+    return 1;
+    }
+
+  HostStart(ESP_LOG_WARN);
+  HostCanInit(DBC_DECODER_MAXBUS);
+
+  const char* fmt = argv[0];
+  std::string logpath(argv[1]);
+  std::string csvpath(argv[2]);
+  std::string binpath(argv[2]);
+  csvpath.append(".csv");
+  binpath.append(".bin");
+
+  canformat* format = MyCanFormatFactory.NewFormat(fmt);
+  if (format == NULL)
+    {
+    fprintf(stderr, "Error: Unknown CAN log format '%s'\n", fmt);
+    usage();
+    HostExit(1);
+    }
+
+  dbcDecoder decoder;
+  std::list<dbcfile*> dbcs;
+  for (int k=3; k<argc; k++)
+    {
+    // <path>[:<bus>]
+    std::string path(argv[k]);
+    int bus = 0;
+    size_t sep = path.rfind(':');
+    if (sep != std::string::npos)
+      {
+      const char* b = path.c_str() + sep + 1;
+      if (strncmp(b, "can", 3) == 0) b += 3;
+      bus = atoi(b);
+      path.resize(sep);
+      }
+    dbcfile* dbc = new dbcfile();
+    if (!dbc->LoadFile(path.c_str(), path.c_str()) || !decoder.AddDBC(dbc, bus))
+      {
+      fprintf(stderr, "Error: Cannot use DBC file: %s\n", argv[k]);
+      HostExit(1);
+      }
+    dbc->LockFile();
+    dbcs.push_back(dbc);
+    }
+
+  FILE* in = fopen(logpath.c_str(), "r");
+  if (in == NULL)
+    {
+    fprintf(stderr, "Error: Could not open log file '%s'\n", logpath.c_str());
+    HostExit(1);
+    }
+  FILE* csv = fopen(csvpath.c_str(), "w");
+  FILE* bin = fopen(binpath.c_str(), "w");
+  if (csv == NULL || bin == NULL)
+    {
+    fprintf(stderr, "Error: Could not open output files '%s.*'\n", argv[2]);
+    HostExit(1);
+    }
+
+  printf("Decoding %s (%s) with %d signal(s)...\n", logpath.c_str(), fmt, decoder.GetColumnCount());
+  bool ok = decoder.Decode(format, in, csv, bin, threads);
+  printf("%s\nWritten to %s, %s\n", decoder.GetStats().c_str(), csvpath.c_str(), binpath.c_str());
+
+  fclose(in);
+  fclose(csv);
+  fclose(bin);
+  delete format;
+  for (dbcfile* dbc : dbcs)
+    {
+    dbc->UnlockFile();
+    delete dbc;
+    }
+  HostExit(ok ? 0 : 1);
+  }
@@ -0,0 +1,852 @@
+/*
+ * Host framework services
+ *
+ * Reduced implementations of the framework services not built on the host,
+ * based on the framework headers (see host.h):
+ *
+ *  - logging to stderr with a global level
+ *  - memory allocation (no external RAM, all allocations are on the heap)
+ *  - events: event task & queue, ticker.* events from a housekeeping task
+ *  - config: in memory only, no file system
+ *  - commands: the command tree & execution, no console/log file management
+ *  - notifications: printed to stderr
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sstream>
+#include <mutex>
+#include "ovms.h"
+#include "ovms_log.h"
+#include "ovms_malloc.h"
+#include "ovms_command.h"
+#include "ovms_config.h"
+#include "ovms_events.h"
+#include "ovms_notify.h"
+#include "esp_timer.h"
+#include "ovms_metrics.h"
+#include "metrics_standard.h"
+#include "host.h"
+
+static const char *TAG = "host";
+
+uint32_t monotonictime = 0;
+
+OvmsCommandApp MyCommandApp __attribute__ ((init_priority (1000)));
+OvmsEvents MyEvents __attribute__ ((init_priority (1200)));
+OvmsConfig MyConfig __attribute__ ((init_priority (1400)));
+OvmsNotify MyNotify __attribute__ ((init_priority (1820)));
+
+
+////////////////////////////////////////////////////////////////////////
+// Logging
+////////////////////////////////////////////////////////////////////////
+
+static esp_log_level_t host_loglevel = ESP_LOG_WARN;
+static std::mutex host_log_mutex;
+
+void esp_log_level_set(const char* tag, esp_log_level_t level)
+  {
+  if (strcmp(tag, "*") == 0)
+    host_loglevel = level;
+  }
+
+uint32_t esp_log_timestamp(void)
+  {
+  return (uint32_t)(esp_timer_get_time() / 1000);
+  }
+
+void esp_log_writev(esp_log_level_t level, const char* tag, const char* format, va_list args)
+  {
+  if (level > host_loglevel) return;
+  std::lock_guard<std::mutex> lock(host_log_mutex);
+  vfprintf(stderr, format, args);
+  }
+
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...)
+  {
+  va_list args;
+  va_start(args, format);
+  esp_log_writev(level, tag, format, args);
+  va_end(args);
+  }
+
+const char* esp_err_to_name(esp_err_t code)
+  {
+  switch (code)
+    {
+    case ESP_OK:                  return "ESP_OK";
+    case ESP_FAIL:                return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:          return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:     return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:   return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_NOT_FOUND:       return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED:   return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:         return "ESP_ERR_TIMEOUT";
+    default:                      return "UNKNOWN ERROR";
+    }
+  }
+
+
+////////////////////////////////////////////////////////////////////////
+// Memory
+////////////////////////////////////////////////////////////////////////
+
+void* ExternalRamMalloc(size_t sz)              { return malloc(sz); }
+void* ExternalRamCalloc(size_t count, size_t size) { return calloc(count, size); }
+void* ExternalRamRealloc(void *ptr, size_t size) { return realloc(ptr, size); }
+void* InternalRamMalloc(size_t sz)              { return malloc(sz); }
+void* InternalRamCalloc(size_t count, size_t size) { return calloc(count, size); }
+void* InternalRamRealloc(void *ptr, size_t size) { return realloc(ptr, size); }
+
+void* ExternalRamAllocated::operator new(std::size_t sz)    { return ::operator new(sz); }
+void* ExternalRamAllocated::operator new[](std::size_t sz)  { return ::operator new[](sz); }
+char* ExternalRamAllocated::strdup(const char* src)         { return ::strdup(src); }
+int ExternalRamAllocated::vasprintf(char** strp, const char* fmt, va_list ap) { return ::vasprintf(strp, fmt, ap); }
+int ExternalRamAllocated::asprintf(char** strp, const char* fmt, ...)
+  {
+  va_list args;
+  va_start(args, fmt);
+  int res = ::vasprintf(strp, fmt, args);
+  va_end(args);
+  return res;
+  }
+
+void* InternalRamAllocated::operator new(std::size_t sz)    { return ::operator new(sz); }
+void* InternalRamAllocated::operator new[](std::size_t sz)  { return ::operator new[](sz); }
+char* InternalRamAllocated::strdup(const char* src)         { return ::strdup(src); }
+int InternalRamAllocated::vasprintf(char** strp, const char* fmt, va_list ap) { return ::vasprintf(strp, fmt, ap); }
+int InternalRamAllocated::asprintf(char** strp, const char* fmt, ...)
+  {
+  va_list args;
+  va_start(args, fmt);
+  int res = ::vasprintf(strp, fmt, args);
+  va_end(args);
+  return res;
+  }
+
+
+////////////////////////////////////////////////////////////////////////
+// Events
+////////////////////////////////////////////////////////////////////////
+
+// Registrations may be done from any task, dispatching is done by the event task:
+static std::recursive_mutex host_events_mutex;
+
+EventCallbackEntry::EventCallbackEntry(std::string caller, EventCallback callback)
+  {
+  m_caller = caller;
+  m_callback = callback;
+  }
+
+EventCallbackEntry::~EventCallbackEntry()
+  {
+  }
+
+void EventStdFree(const char* event, void* data)
+  {
+  free(data);
+  }
+
+static void HostEventTask(void *pvParameters)
+  {
+  OvmsEvents* me = (OvmsEvents*)pvParameters;
+  me->EventTask();
+  }
+
+OvmsEvents::OvmsEvents()
+  {
+  m_trace = false;
+  m_current_callback = NULL;
+  m_current_started = 0;
+  m_taskqueue = xQueueCreate(60, sizeof(event_queue_t));
+  m_taskid = NULL;
+  }
+
+OvmsEvents::~OvmsEvents()
+  {
+  }
+
+void OvmsEvents::EventTask()
+  {
+  event_queue_t msg;
+  while (true)
+    {
+    if (xQueueReceive(m_taskqueue, &msg, portMAX_DELAY) == pdTRUE && msg.type == EVENT_signal)
+      {
+      m_current_event = msg.body.signal.event;
+      HandleQueueSignalEvent(&msg);
+      m_current_event.clear();
+      }
+    }
+  }
+
+void OvmsEvents::HandleQueueSignalEvent(event_queue_t* msg)
+  {
+  std::lock_guard<std::recursive_mutex> lock(host_events_mutex);
+  const char* names[2] = { msg->body.signal.event, "*" };
+  for (const char* name : names)
+    {
+    auto k = m_map.find(name);
+    if (k == m_map.end() || !k->second) continue;
+    for (EventCallbackEntry* entry : *k->second)
+      {
+      m_current_started = monotonictime;
+      m_current_callback = entry;
+      entry->m_callback(m_current_event, msg->body.signal.data);
+      m_current_callback = NULL;
+      }
+    }
+  FreeQueueSignalEvent(msg);
+  }
+
+void OvmsEvents::FreeQueueSignalEvent(event_queue_t* msg)
+  {
+  if (msg->body.signal.donefn != NULL)
+    msg->body.signal.donefn(msg->body.signal.event, msg->body.signal.data);
+  free(msg->body.signal.event);
+  }
+
+void OvmsEvents::RegisterEvent(std::string caller, std::string event, EventCallback callback)
+  {
+  std::lock_guard<std::recursive_mutex> lock(host_events_mutex);
+  EventCallbackList*& el = m_map[event];
+  if (!el) el = new EventCallbackList();
+  el->push_back(new EventCallbackEntry(caller, callback));
+  }
+
+void OvmsEvents::DeregisterEvent(std::string caller)
+  {
+  std::lock_guard<std::recursive_mutex> lock(host_events_mutex);
+  for (auto itm = m_map.begin(); itm != m_map.end(); )
+    {
+    EventCallbackList* el = itm->second;
+    el->remove_if([&caller](EventCallbackEntry* ec)
+      {
+      if (ec->m_caller != caller) return false;
+      delete ec;
+      return true;
+      });
+    if (el->empty())
+      {
+      itm = m_map.erase(itm);
+      delete el;
+      }
+    else
+      {
+      ++itm;
+      }
+    }
+  }
+
+static void HostEventDelayed(void* arg)
+  {
+  event_queue_t* msg = (event_queue_t*)arg;
+  if (xQueueSend(MyEvents.m_taskqueue, msg, 0) != pdTRUE)
+    MyEvents.FreeQueueSignalEvent(msg);
+  delete msg;
+  }
+
+bool OvmsEvents::ScheduleEvent(event_queue_t* msg, uint32_t delay_ms)
+  {
+  esp_timer_create_args_t args = {};
+  args.callback = HostEventDelayed;
+  args.arg = new event_queue_t(*msg);
+  args.name = "event";
+  esp_timer_handle_t timer;
+  if (esp_timer_create(&args, &timer) != ESP_OK)
+    {
+    delete (event_queue_t*)args.arg;
+    return false;
+    }
+  // Note: one shot timers are not deleted, the host leaks them
+  esp_timer_start_once(timer, (uint64_t)delay_ms * 1000);
+  return true;
+  }
+
+void OvmsEvents::SignalEvent(std::string event, void* data, event_signal_done_fn callback, uint32_t delay_ms)
+  {
+  event_queue_t msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.type = EVENT_signal;
+  msg.body.signal.event = ::strdup(event.c_str());
+  msg.body.signal.data = data;
+  msg.body.signal.donefn = callback;
+  bool queued = (delay_ms == 0)
+    ? (xQueueSend(m_taskqueue, &msg, 0) == pdTRUE)
+    : ScheduleEvent(&msg, delay_ms);
+  if (!queued)
+    {
+    ESP_LOGE(TAG, "SignalEvent: queue overflow, event '%s' dropped", msg.body.signal.event);
+    FreeQueueSignalEvent(&msg);
+    }
+  }
+
+void OvmsEvents::SignalEvent(std::string event, void* data, size_t length, uint32_t delay_ms)
+  {
+  void* copy = NULL;
+  if (data != NULL)
+    {
+    copy = malloc(length);
+    memcpy(copy, data, length);
+    }
+  SignalEvent(event, copy, copy ? EventStdFree : NULL, delay_ms);
+  }
+
+// Housekeeping ticker, see Housekeeping::Ticker1():
+static void HostTickerTask(void *pvParameters)
+  {
+  TickType_t last = xTaskGetTickCount();
+  uint32_t tick = 0;
+  while (true)
+    {
+    TickType_t next = last + pdMS_TO_TICKS(1000);
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(next - now) > 0)
+      vTaskDelay(next - now);
+    last = next;
+    tick++;
+    monotonictime++;
+    StandardMetrics.ms_m_monotonic->SetValue((int)monotonictime);
+    MyEvents.SignalEvent("ticker.1", NULL);
+    if ((tick % 10)==0) MyEvents.SignalEvent("ticker.10", NULL);
+    if ((tick % 60)==0) MyEvents.SignalEvent("ticker.60", NULL);
+    if ((tick % 300)==0) MyEvents.SignalEvent("ticker.300", NULL);
+    if ((tick % 600)==0) MyEvents.SignalEvent("ticker.600", NULL);
+    if ((tick % 3600)==0) MyEvents.SignalEvent("ticker.3600", NULL);
+    }
+  }
+
+void HostStart(int loglevel)
+  {
+  host_loglevel = (esp_log_level_t)loglevel;
+  xTaskCreatePinnedToCore(HostEventTask, "OVMS Events", 8192, &MyEvents, 5, &MyEvents.m_taskid, 1);
+  xTaskCreatePinnedToCore(HostTickerTask, "OVMS Ticker", 4096, NULL, 5, NULL, 1);
+  MyEvents.SignalEvent("system.start", NULL);
+  }
+
+void HostExit(int status)
+  {
+  fflush(stdout);
+  fflush(stderr);
+  _exit(status);
+  }
+
+
+////////////////////////////////////////////////////////////////////////
+// Config (in memory)
+////////////////////////////////////////////////////////////////////////
+
+OvmsConfigParam::OvmsConfigParam(std::string name, std::string title, bool writable, bool readable)
+  {
+  m_name = name;
+  m_title = title;
+  m_writable = writable;
+  m_readable = readable;
+  m_loaded = true;
+  }
+
+OvmsConfigParam::~OvmsConfigParam()
+  {
+  }
+
+void OvmsConfigParam::SetValue(std::string instance, std::string value)
+  {
+  m_map[instance] = value;
+  MyEvents.SignalEvent("config.changed", this);
+  }
+
+bool OvmsConfigParam::DeleteInstance(std::string instance)
+  {
+  if (m_map.erase(instance) == 0) return false;
+  MyEvents.SignalEvent("config.changed", this);
+  return true;
+  }
+
+std::string OvmsConfigParam::GetValue(std::string instance)
+  {
+  auto it = m_map.find(instance);
+  return (it == m_map.end()) ? "" : it->second;
+  }
+
+bool OvmsConfigParam::IsDefined(std::string instance)
+  {
+  return m_map.find(instance) != m_map.end();
+  }
+
+std::string OvmsConfigParam::GetName()
+  {
+  return m_name;
+  }
+
+bool OvmsConfigParam::Writable()
+  {
+  return m_writable;
+  }
+
+bool OvmsConfigParam::Readable()
+  {
+  return m_readable;
+  }
+
+OvmsConfig::OvmsConfig()
+  {
+  m_mounted = true;
+  }
+
+OvmsConfig::~OvmsConfig()
+  {
+  }
+
+void OvmsConfig::RegisterParam(std::string name, std::string title, bool writable, bool readable)
+  {
+  OvmsMutexLock lock(&m_store_lock);
+  if (m_map.find(name) == m_map.end())
+    m_map[name] = new OvmsConfigParam(name, title, writable, readable);
+  }
+
+void OvmsConfig::DeregisterParam(std::string name)
+  {
+  OvmsMutexLock lock(&m_store_lock);
+  auto it = m_map.find(name);
+  if (it != m_map.end())
+    {
+    delete it->second;
+    m_map.erase(it);
+    }
+  }
+
+OvmsConfigParam* OvmsConfig::CachedParam(std::string param)
+  {
+  OvmsMutexLock lock(&m_store_lock);
+  auto it = m_map.find(param);
+  return (it == m_map.end()) ? NULL : it->second;
+  }
+
+void OvmsConfig::SetParamValue(std::string param, std::string instance, std::string value)
+  {
+  OvmsConfigParam* p = CachedParam(param);
+  if (!p)
+    {
+    RegisterParam(param, param);
+    p = CachedParam(param);
+    }
+  p->SetValue(instance, value);
+  }
+
+void OvmsConfig::SetParamValueInt(std::string param, std::string instance, int value)
+  {
+  SetParamValue(param, instance, std::to_string(value));
+  }
+
+void OvmsConfig::SetParamValueFloat(std::string param, std::string instance, float value)
+  {
+  std::ostringstream ss;
+  ss << value;
+  SetParamValue(param, instance, ss.str());
+  }
+
+void OvmsConfig::SetParamValueBool(std::string param, std::string instance, bool value)
+  {
+  SetParamValue(param, instance, value ? "yes" : "no");
+  }
+
+void OvmsConfig::DeleteInstance(std::string param, std::string instance)
+  {
+  OvmsConfigParam* p = CachedParam(param);
+  if (p) p->DeleteInstance(instance);
+  }
+
+std::string OvmsConfig::GetParamValue(std::string param, std::string instance, std::string defvalue)
+  {
+  OvmsConfigParam* p = CachedParam(param);
+  if (!p || !p->IsDefined(instance)) return defvalue;
+  return p->GetValue(instance);
+  }
+
+int OvmsConfig::GetParamValueInt(std::string param, std::string instance, int defvalue)
+  {
+  std::string value = GetParamValue(param, instance);
+  return value.empty() ? defvalue : atoi(value.c_str());
+  }
+
+float OvmsConfig::GetParamValueFloat(std::string param, std::string instance, float defvalue)
+  {
+  std::string value = GetParamValue(param, instance);
+  return value.empty() ? defvalue : atof(value.c_str());
+  }
+
+bool OvmsConfig::GetParamValueBool(std::string param, std::string instance, bool defvalue)
+  {
+  std::string value = GetParamValue(param, instance);
+  if (value.empty()) return defvalue;
+  return (value == "yes" || value == "1" || value == "true");
+  }
+
+bool OvmsConfig::IsDefined(std::string param, std::string instance)
+  {
+  OvmsConfigParam* p = CachedParam(param);
+  return p && p->IsDefined(instance);
+  }
+
+bool OvmsConfig::ProtectedPath(std::string path)
+  {
+  return (path.find("/store") == 0);
+  }
+
+ConfigParamMap OvmsConfig::GetParamMap(std::string param)
+  {
+  OvmsConfigParam* p = CachedParam(param);
+  return p ? p->GetMap() : ConfigParamMap();
+  }
+
+bool OvmsConfig::ismounted()
+  {
+  return m_mounted;
+  }
+
+
+////////////////////////////////////////////////////////////////////////
+// Commands
+////////////////////////////////////////////////////////////////////////
+
+bool CompareCharPtr::operator()(const char* a, const char* b)
+  {
+  return strcmp(a, b) < 0;
+  }
+
+OvmsWriter::OvmsWriter()
+  {
+  m_issecure = true;
+  m_insert = NULL;
+  m_userData = NULL;
+  m_monitoring = false;
+  }
+
+OvmsWriter::~OvmsWriter()
+  {
+  }
+
+void OvmsWriter::Exit()
+  {
+  }
+
+bool OvmsWriter::IsSecure()
+  {
+  return m_issecure;
+  }
+
+void OvmsWriter::SetSecure(bool secure)
+  {
+  m_issecure = secure;
+  }
+
+void OvmsWriter::RegisterInsertCallback(InsertCallback cb, void* ctx)
+  {
+  m_insert = cb;
+  m_userData = ctx;
+  }
+
+void OvmsWriter::DeregisterInsertCallback(InsertCallback cb)
+  {
+  if (m_insert == cb)
+    {
+    m_insert = NULL;
+    m_userData = NULL;
+    }
+  }
+
+OvmsCommand* OvmsCommandMap::FindUniquePrefix(const char* key)
+  {
+  size_t len = strlen(key);
+  OvmsCommand* found = NULL;
+  for (iterator it = begin(); it != end(); ++it)
+    {
+    if (strncmp(it->first, key, len) == 0)
+      {
+      if (len == strlen(it->first))
+        return it->second;
+      if (found)
+        return NULL;
+      found = it->second;
+      }
+    }
+  return found;
+  }
+
+OvmsCommand* OvmsCommandMap::FindCommand(const char* key)
+  {
+  iterator it = find(key);
+  return (it == end()) ? NULL : it->second;
+  }
+
+OvmsCommand::OvmsCommand()
+  {
+  m_name = "";
+  m_title = "";
+  m_execute = NULL;
+  m_validate = NULL;
+  m_usage_template = "";
+  m_min = m_max = 0;
+  m_secure = false;
+  m_parent = NULL;
+  }
+
+OvmsCommand::OvmsCommand(const char* name, const char* title, void (*execute)(int, OvmsWriter*, OvmsCommand*, int, const char* const*),
+                         const char *usage, int min, int max, bool secure,
+                         int (*validate)(OvmsWriter*, OvmsCommand*, int, const char* const*, bool))
+  {
+  m_name = name;
+  m_title = title;
+  m_execute = execute;
+  m_usage_template = usage ? usage : "";
+  m_min = min;
+  m_max = max;
+  m_secure = secure;
+  m_validate = validate;
+  m_parent = NULL;
+  }
+
+OvmsCommand::~OvmsCommand()
+  {
+  for (auto it = m_children.begin(); it != m_children.end(); ++it)
+    delete it->second;
+  m_children.clear();
+  }
+
+OvmsCommand* OvmsCommand::RegisterCommand(const char* name, const char* title, void (*execute)(int, OvmsWriter*, OvmsCommand*, int, const char* const*),
+                                          const char *usage, int min, int max, bool secure,
+                                          int (*validate)(OvmsWriter*, OvmsCommand*, int, const char* const*, bool))
+  {
+  OvmsCommand* cmd = FindCommand(name);
+  if (cmd == NULL)
+    {
+    cmd = new OvmsCommand(name, title, execute, usage, min, max, secure, validate);
+    m_children[name] = cmd;
+    cmd->m_parent = this;
+    }
+  return cmd;
+  }
+
+bool OvmsCommand::UnregisterCommand(const char* name)
+  {
+  if (name == NULL)
+    return m_parent ? m_parent->UnregisterCommand(m_name) : false;
+  auto pos = m_children.find(name);
+  if (pos == m_children.end())
+    return false;
+  OvmsCommand* cmd = pos->second;
+  m_children.erase(pos);
+  delete cmd;
+  return true;
+  }
+
+const char* OvmsCommand::GetName()
+  {
+  return m_name;
+  }
+
+const char* OvmsCommand::GetTitle()
+  {
+  return m_title;
+  }
+
+const char* OvmsCommand::GetUsage(OvmsWriter* writer)
+  {
+  return m_usage_template;
+  }
+
+void OvmsCommand::PutUsage(OvmsWriter* writer)
+  {
+  std::string path;
+  for (OvmsCommand* cmd = this; cmd && cmd->m_parent; cmd = cmd->m_parent)
+    path = std::string(cmd->m_name) + (path.empty() ? "" : " ") + path;
+  writer->printf("Usage: %s %s\n", path.c_str(), m_usage_template);
+  }
+
+OvmsCommand* OvmsCommand::GetParent()
+  {
+  return m_parent;
+  }
+
+OvmsCommand* OvmsCommand::FindCommand(const char* name)
+  {
+  return m_children.FindCommand(name);
+  }
+
+void OvmsCommand::Execute(int verbosity, OvmsWriter* writer, int argc, const char * const * argv)
+  {
+  if (m_execute && (m_children.empty() || argc == 0))
+    {
+    if (argc < m_min || argc > m_max || (argc > 0 && strcmp(argv[argc-1],"?")==0))
+      PutUsage(writer);
+    else
+      m_execute(verbosity, writer, this, argc, argv);
+    return;
+    }
+  if (m_validate && argc >= m_min)
+    {
+    int used = m_validate(writer, this, argc > m_max ? m_max : argc, argv, false);
+    if (used < 0)
+      {
+      PutUsage(writer);
+      return;
+      }
+    argc -= used;
+    argv += used;
+    }
+  if (argc <= 0)
+    {
+    if (m_execute)
+      m_execute(verbosity, writer, this, argc, argv);
+    else
+      writer->puts("Subcommand required");
+    return;
+    }
+  OvmsCommand* cmd = m_children.FindUniquePrefix(argv[0]);
+  if (!cmd)
+    {
+    writer->puts("Unrecognised command");
+    return;
+    }
+  cmd->Execute(verbosity, writer, argc-1, ++argv);
+  }
+
+OvmsCommandApp::OvmsCommandApp()
+  {
+  m_logfile = NULL;
+  m_logfile_size = 0;
+  m_logfile_maxsize = 0;
+  m_logtask = NULL;
+  m_logtask_queue = NULL;
+  m_logtask_dropcnt = 0;
+  m_logfile_cyclecnt = 0;
+  m_logtask_linecnt = 0;
+  m_logtask_fsynctime = 0;
+  m_logtask_laststamp = 0;
+  m_expiretask = NULL;
+  }
+
+OvmsCommandApp::~OvmsCommandApp()
+  {
+  }
+
+OvmsCommand* OvmsCommandApp::RegisterCommand(const char* name, const char* title, void (*execute)(int, OvmsWriter*, OvmsCommand*, int, const char* const*),
+                                             const char *usage, int min, int max, bool secure)
+  {
+  return m_root.RegisterCommand(name, title, execute, usage, min, max, secure);
+  }
+
+bool OvmsCommandApp::UnregisterCommand(const char* name)
+  {
+  return m_root.UnregisterCommand(name);
+  }
+
+OvmsCommand* OvmsCommandApp::FindCommand(const char* name)
+  {
+  return m_root.FindCommand(name);
+  }
+
+void OvmsCommandApp::Execute(int verbosity, OvmsWriter* writer, int argc, const char * const * argv)
+  {
+  m_root.Execute(verbosity, writer, argc, argv);
+  }
+
+int OvmsCommandApp::Log(const char* fmt, va_list args)
+  {
+  return vfprintf(stderr, fmt, args);
+  }
+
+int OvmsCommandApp::Log(const char* fmt, ...)
+  {
+  va_list args;
+  va_start(args, fmt);
+  int res = Log(fmt, args);
+  va_end(args);
+  return res;
+  }
+
+void OvmsCommandApp::Log(LogBuffers* message)
+  {
+  }
+
+HostWriter::HostWriter(FILE* out)
+  {
+  m_out = out;
+  }
+
+int HostWriter::puts(const char* s)
+  {
+  fputs(s, m_out);
+  fputc('\n', m_out);
+  return 0;
+  }
+
+int HostWriter::printf(const char* fmt, ...)
+  {
+  va_list args;
+  va_start(args, fmt);
+  int res = vfprintf(m_out, fmt, args);
+  va_end(args);
+  return res;
+  }
+
+ssize_t HostWriter::write(const void *buf, size_t nbyte)
+  {
+  return fwrite(buf, 1, nbyte, m_out);
+  }
+
+void HostExecute(OvmsWriter* writer, const std::string& cmdline, int verbosity)
+  {
+  std::istringstream ss(cmdline);
+  std::vector<std::string> args;
+  std::string arg;
+  while (ss >> arg)
+    args.push_back(arg);
+  std::vector<const char*> argv;
+  for (std::string& a : args)
+    argv.push_back(a.c_str());
+  MyCommandApp.Execute(verbosity, writer, argv.size(), argv.data());
+  }
+
+
+////////////////////////////////////////////////////////////////////////
+// Notifications
+////////////////////////////////////////////////////////////////////////
+
+OvmsNotify::OvmsNotify()
+  {
+  m_nextreader = 1;
+  m_trace = false;
+  }
+
+OvmsNotify::~OvmsNotify()
+  {
+  }
+
+uint32_t OvmsNotify::NotifyString(const char* type, const char* subtype, const char* value)
+  {
+  ESP_LOGI(TAG, "Notify %s/%s: %s", type, subtype, value);
+  return 0;
+  }
+
+uint32_t OvmsNotify::NotifyStringf(const char* type, const char* subtype, const char* fmt, ...)
+  {
+  char* buffer = NULL;
+  va_list args;
+  va_start(args, fmt);
+  int len = ::vasprintf(&buffer, fmt, args);
+  va_end(args);
+  if (len < 0) return 0;
+  uint32_t res = NotifyString(type, subtype, buffer);
+  free(buffer);
+  return res;
+  }
+
+uint32_t OvmsNotify::NotifyCommand(const char* type, const char* subtype, const char* cmd)
+  {
+  ESP_LOGI(TAG, "Notify %s/%s: command '%s' (not executed)", type, subtype, cmd);
+  return 0;
+  }
@@ -0,0 +1,773 @@
+/*
+ * Host FreeRTOS & esp_timer emulation
+ *
+ * Provides the FreeRTOS task, queue, semaphore & timer API and the ESP-IDF
+ * esp_timer API used by the framework sources built on the host (see
+ * tests/host/Makefile), based on host threads:
+ *
+ *  - tasks are detached threads, priorities & core affinity are ignored;
+ *    vTaskDelete() on another task takes effect when that task blocks next
+ *  - the tick rate is CONFIG_FREERTOS_HZ (100 Hz) like on the module, blocking
+ *    calls time out on tick boundaries
+ *  - esp_timer & FreeRTOS timer callbacks are run by one timer task, in due
+ *    time order, like by the esp_timer task on the module
+ *  - xthal_get_ccount() counts host time at the module CPU clock rate
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/timers.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "rom/rtc.h"
+#include "xtensa/hal.h"
+
+typedef std::chrono::steady_clock host_clock;
+// Framework objects start tasks & timers in their constructors, so the
+// emulation state is initialized first:
+#define HOST_INIT __attribute__ ((init_priority (101)))
+
+static const host_clock::time_point host_start HOST_INIT = host_clock::now();
+
+static int64_t host_time_us()
+  {
+  return std::chrono::duration_cast<std::chrono::microseconds>(host_clock::now() - host_start).count();
+  }
+
+// Deadline for a blocking call (TickType_t timeout), steady clock based:
+static host_clock::time_point host_deadline(TickType_t ticks)
+  {
+  if (ticks == portMAX_DELAY)
+    return host_clock::time_point::max();
+  return host_clock::now() + std::chrono::milliseconds((int64_t)ticks * portTICK_PERIOD_MS);
+  }
+
+
+////////////////////////////////////////////////////////////////////////
+// Tasks
+////////////////////////////////////////////////////////////////////////
+
+struct host_task
+  {
+  std::string name;
+  UBaseType_t priority;
+  UBaseType_t number;
+  std::atomic<bool> deleted;
+  };
+
+// Thrown to unwind a deleted task:
+struct host_task_exit {};
+
+static std::mutex host_tasks_mutex;
+static std::vector<host_task*> host_tasks HOST_INIT;
+static UBaseType_t host_task_number = 0;
+static thread_local host_task* host_current = NULL;
+
+static host_task* host_task_new(const char* name, UBaseType_t priority)
+  {
+  host_task* task = new host_task;
+  task->name = name ? name : "";
+  task->priority = priority;
+  task->deleted = false;
+  std::lock_guard<std::mutex> lock(host_tasks_mutex);
+  task->number = ++host_task_number;
+  host_tasks.push_back(task);
+  return task;
+  }
+
+static void host_task_remove(host_task* task)
+  {
+  std::lock_guard<std::mutex> lock(host_tasks_mutex);
+  for (auto it = host_tasks.begin(); it != host_tasks.end(); ++it)
+    {
+    if (*it == task)
+      {
+      host_tasks.erase(it);
+      break;
+      }
+    }
+  }
+
+static host_task* host_task_current()
+  {
+  if (!host_current)
+    host_current = host_task_new("main", 1);
+  return host_current;
+  }
+
+// Called by blocking functions, unwinds the task if it has been deleted:
+static void host_task_check()
+  {
+  if (host_current && host_current->deleted)
+    throw host_task_exit();
+  }
+
+/**
+ * host_wait: wait on a condition with deadline
+ *  Wakes up every tick to check for deletion of the calling task.
+ *  Returns the predicate result.
+ */
+template <typename Pred>
+static bool host_wait(std::unique_lock<std::mutex>& lock, std::condition_variable& cv,
+                      host_clock::time_point deadline, Pred pred)
+  {
+  while (!pred())
+    {
+    host_task_check();
+    host_clock::time_point now = host_clock::now();
+    if (now >= deadline)
+      return false;
+    host_clock::time_point slice = now + std::chrono::milliseconds(portTICK_PERIOD_MS);
+    cv.wait_until(lock, (slice < deadline) ? slice : deadline);
+    }
+  return true;
+  }
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pvTaskCode, const char* pcName,
+  uint32_t usStackDepth, void* pvParameters, UBaseType_t uxPriority,
+  TaskHandle_t* pvCreatedTask, BaseType_t xCoreID)
+  {
+  host_task* task = host_task_new(pcName, uxPriority);
+  if (pvCreatedTask)
+    *pvCreatedTask = task;
+  std::thread thread([task, pvTaskCode, pvParameters]()
+    {
+    host_current = task;
+    try
+      {
+      pvTaskCode(pvParameters);
+      fprintf(stderr, "host: task '%s' returned\n", task->name.c_str());
+      }
+    catch (host_task_exit&)
+      {
+      }
+    host_task_remove(task);
+    // Note: the handle is not freed, as it may still be referenced by the
+    //  creator (FreeRTOS reuses the memory, the host simply leaks it)
+    });
+  thread.detach();
+  return pdPASS;
+  }
+
+BaseType_t xTaskCreate(TaskFunction_t pvTaskCode, const char* pcName,
+  uint32_t usStackDepth, void* pvParameters, UBaseType_t uxPriority,
+  TaskHandle_t* pvCreatedTask)
+  {
+  return xTaskCreatePinnedToCore(pvTaskCode, pcName, usStackDepth, pvParameters,
+    uxPriority, pvCreatedTask, tskNO_AFFINITY);
+  }
+
+void vTaskDelete(TaskHandle_t xTaskToDelete)
+  {
+  if (xTaskToDelete == NULL || xTaskToDelete == host_current)
+    throw host_task_exit();
+  xTaskToDelete->deleted = true;
+  }
+
+void vTaskDelay(const TickType_t xTicksToDelay)
+  {
+  host_task_check();
+  if (xTicksToDelay == 0)
+    std::this_thread::yield();
+  else
+    std::this_thread::sleep_for(std::chrono::milliseconds((int64_t)xTicksToDelay * portTICK_PERIOD_MS));
+  host_task_check();
+  }
+
+void vTaskSuspend(TaskHandle_t xTaskToSuspend)
+  {
+  }
+
+void vTaskResume(TaskHandle_t xTaskToResume)
+  {
+  }
+
+TickType_t xTaskGetTickCount(void)
+  {
+  return (TickType_t)(host_time_us() / (1000 * portTICK_PERIOD_MS));
+  }
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+  {
+  return host_task_current();
+  }
+
+TaskHandle_t xTaskGetHandle(const char* pcNameToQuery)
+  {
+  std::lock_guard<std::mutex> lock(host_tasks_mutex);
+  for (host_task* task : host_tasks)
+    {
+    if (task->name == pcNameToQuery)
+      return task;
+    }
+  return NULL;
+  }
+
+char* pcTaskGetTaskName(TaskHandle_t xTaskToQuery)
+  {
+  host_task* task = xTaskToQuery ? xTaskToQuery : host_task_current();
+  return (char*)task->name.c_str();
+  }
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask)
+  {
+  return 0;
+  }
+
+UBaseType_t uxTaskGetNumberOfTasks(void)
+  {
+  std::lock_guard<std::mutex> lock(host_tasks_mutex);
+  return host_tasks.size();
+  }
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t* const pxTaskStatusArray,
+  const UBaseType_t uxArraySize, uint32_t* const pulTotalRunTime)
+  {
+  std::lock_guard<std::mutex> lock(host_tasks_mutex);
+  UBaseType_t cnt = 0;
+  for (host_task* task : host_tasks)
+    {
+    if (cnt >= uxArraySize) break;
+    TaskStatus_t* ts = &pxTaskStatusArray[cnt++];
+    memset(ts, 0, sizeof(*ts));
+    ts->xHandle = task;
+    ts->pcTaskName = task->name.c_str();
+    ts->xTaskNumber = task->number;
+    ts->eCurrentState = eBlocked;
+    ts->uxCurrentPriority = ts->uxBasePriority = task->priority;
+    ts->xCoreID = tskNO_AFFINITY;
+    }
+  if (pulTotalRunTime)
+    *pulTotalRunTime = 0;
+  return cnt;
+  }
+
+
+////////////////////////////////////////////////////////////////////////
+// Critical sections & system
+////////////////////////////////////////////////////////////////////////
+
+static std::recursive_mutex host_critical;
+
+void vPortEnterCritical(portMUX_TYPE* mux)
+  {
+  host_critical.lock();
+  }
+
+void vPortExitCritical(portMUX_TYPE* mux)
+  {
+  host_critical.unlock();
+  }
+
+BaseType_t xPortGetCoreID(void)
+  {
+  return 0;
+  }
+
+size_t xPortGetFreeHeapSize(void)
+  {
+  return 4*1024*1024;
+  }
+
+uint32_t esp_get_free_heap_size(void)
+  {
+  return xPortGetFreeHeapSize();
+  }
+
+uint32_t esp_random(void)
+  {
+  return (uint32_t)random();
+  }
+
+void esp_restart(void)
+  {
+  fprintf(stderr, "host: esp_restart() called\n");
+  exit(1);
+  }
+
+RESET_REASON rtc_get_reset_reason(int cpu_no)
+  {
+  return POWERON_RESET;
+  }
+
+char* itoa(int value, char* str, int base)
+  {
+  char* p = str;
+  unsigned int v = (value < 0 && base == 10) ? -value : value;
+  if (value < 0 && base == 10) *p++ = '-';
+  char* start = p;
+  do
+    {
+    int d = v % base;
+    *p++ = (d < 10) ? '0' + d : 'a' + d - 10;
+    v /= base;
+    } while (v);
+  *p = 0;
+  for (char* e = p - 1; start < e; start++, e--)
+    {
+    char c = *start; *start = *e; *e = c;
+    }
+  return str;
+  }
+
+unsigned xthal_get_ccount(void)
+  {
+  int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(host_clock::now() - host_start).count();
+  return (unsigned)(ns * CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ / 1000);
+  }
+
+
+////////////////////////////////////////////////////////////////////////
+// Queues
+////////////////////////////////////////////////////////////////////////
+
+struct host_queue
+  {
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<uint8_t> buffer;
+  UBaseType_t itemsize;
+  UBaseType_t length;
+  UBaseType_t head;
+  UBaseType_t count;
+  };
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize)
+  {
+  host_queue* q = new host_queue;
+  q->buffer.resize(uxQueueLength * uxItemSize);
+  q->itemsize = uxItemSize;
+  q->length = uxQueueLength;
+  q->head = 0;
+  q->count = 0;
+  return q;
+  }
+
+void vQueueDelete(QueueHandle_t xQueue)
+  {
+  delete xQueue;
+  }
+
+static BaseType_t host_queue_send(QueueHandle_t q, const void* item, TickType_t ticks, bool front)
+  {
+  std::unique_lock<std::mutex> lock(q->mutex);
+  if (!host_wait(lock, q->cv, host_deadline(ticks), [q]() { return q->count < q->length; }))
+    return errQUEUE_FULL;
+  UBaseType_t pos;
+  if (front)
+    {
+    q->head = (q->head + q->length - 1) % q->length;
+    pos = q->head;
+    }
+  else
+    {
+    pos = (q->head + q->count) % q->length;
+    }
+  memcpy(&q->buffer[pos * q->itemsize], item, q->itemsize);
+  q->count++;
+  q->cv.notify_all();
+  return pdPASS;
+  }
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void* pvItemToQueue, TickType_t xTicksToWait)
+  {
+  return host_queue_send(xQueue, pvItemToQueue, xTicksToWait, false);
+  }
+
+BaseType_t xQueueSendToBack(QueueHandle_t xQueue, const void* pvItemToQueue, TickType_t xTicksToWait)
+  {
+  return host_queue_send(xQueue, pvItemToQueue, xTicksToWait, false);
+  }
+
+BaseType_t xQueueSendToFront(QueueHandle_t xQueue, const void* pvItemToQueue, TickType_t xTicksToWait)
+  {
+  return host_queue_send(xQueue, pvItemToQueue, xTicksToWait, true);
+  }
+
+static BaseType_t host_queue_receive(QueueHandle_t q, void* buffer, TickType_t ticks, bool peek)
+  {
+  std::unique_lock<std::mutex> lock(q->mutex);
+  if (!host_wait(lock, q->cv, host_deadline(ticks), [q]() { return q->count > 0; }))
+    return errQUEUE_EMPTY;
+  memcpy(buffer, &q->buffer[q->head * q->itemsize], q->itemsize);
+  if (!peek)
+    {
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    q->cv.notify_all();
+    }
+  return pdPASS;
+  }
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void* pvBuffer, TickType_t xTicksToWait)
+  {
+  return host_queue_receive(xQueue, pvBuffer, xTicksToWait, false);
+  }
+
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void* pvBuffer, TickType_t xTicksToWait)
+  {
+  return host_queue_receive(xQueue, pvBuffer, xTicksToWait, true);
+  }
+
+BaseType_t xQueueReset(QueueHandle_t xQueue)
+  {
+  std::lock_guard<std::mutex> lock(xQueue->mutex);
+  xQueue->head = 0;
+  xQueue->count = 0;
+  xQueue->cv.notify_all();
+  return pdPASS;
+  }
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue)
+  {
+  std::lock_guard<std::mutex> lock(xQueue->mutex);
+  return xQueue->count;
+  }
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t xQueue)
+  {
+  std::lock_guard<std::mutex> lock(xQueue->mutex);
+  return xQueue->length - xQueue->count;
+  }
+
+
+////////////////////////////////////////////////////////////////////////
+// Semaphores & mutexes
+////////////////////////////////////////////////////////////////////////
+
+// Semaphores are queues without items like on FreeRTOS (SemaphoreHandle_t == QueueHandle_t):
+struct host_semaphore : public host_queue
+  {
+  UBaseType_t max;
+  bool ismutex;
+  bool recursive;
+  host_task* holder;
+  UBaseType_t depth;
+  };
+
+static SemaphoreHandle_t host_semaphore_new(UBaseType_t max, UBaseType_t count, bool ismutex, bool recursive)
+  {
+  host_semaphore* s = new host_semaphore;
+  s->itemsize = 0;
+  s->length = max;
+  s->head = 0;
+  s->count = count;
+  s->max = max;
+  s->ismutex = ismutex;
+  s->recursive = recursive;
+  s->holder = NULL;
+  s->depth = 0;
+  return s;
+  }
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+  {
+  return host_semaphore_new(1, 0, false, false);
+  }
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount)
+  {
+  return host_semaphore_new(uxMaxCount, uxInitialCount, false, false);
+  }
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+  {
+  return host_semaphore_new(1, 1, true, false);
+  }
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void)
+  {
+  return host_semaphore_new(1, 1, true, true);
+  }
+
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore)
+  {
+  delete (host_semaphore*)xSemaphore;
+  }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime)
+  {
+  host_semaphore* s = (host_semaphore*)xSemaphore;
+  std::unique_lock<std::mutex> lock(s->mutex);
+  if (s->recursive && s->holder == host_task_current())
+    {
+    s->depth++;
+    return pdTRUE;
+    }
+  if (!host_wait(lock, s->cv, host_deadline(xBlockTime), [s]() { return s->count > 0; }))
+    return pdFALSE;
+  s->count--;
+  if (s->ismutex)
+    {
+    s->holder = host_task_current();
+    s->depth = 1;
+    }
+  return pdTRUE;
+  }
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore)
+  {
+  host_semaphore* s = (host_semaphore*)xSemaphore;
+  std::lock_guard<std::mutex> lock(s->mutex);
+  if (s->ismutex)
+    {
+    if (s->holder != host_task_current())
+      return pdFALSE;
+    if (--s->depth > 0)
+      return pdTRUE;
+    s->holder = NULL;
+    }
+  if (s->count >= s->max)
+    return pdFALSE;
+  s->count++;
+  s->cv.notify_all();
+  return pdTRUE;
+  }
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t xMutex, TickType_t xBlockTime)
+  {
+  return xSemaphoreTake(xMutex, xBlockTime);
+  }
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t xMutex)
+  {
+  return xSemaphoreGive(xMutex);
+  }
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t xSemaphore)
+  {
+  host_semaphore* s = (host_semaphore*)xSemaphore;
+  std::lock_guard<std::mutex> lock(s->mutex);
+  return s->count;
+  }
+
+TaskHandle_t xSemaphoreGetMutexHolder(SemaphoreHandle_t xSemaphore)
+  {
+  host_semaphore* s = (host_semaphore*)xSemaphore;
+  std::lock_guard<std::mutex> lock(s->mutex);
+  return s->holder;
+  }
+
+
+////////////////////////////////////////////////////////////////////////
+// Timer task: esp_timer & FreeRTOS software timers
+////////////////////////////////////////////////////////////////////////
+
+struct host_esp_timer
+  {
+  esp_timer_cb_t callback;
+  void* arg;
+  std::string name;
+  int64_t due;                // [us], 0 = not armed
+  int64_t period;             // [us], 0 = one shot
+  };
+
+struct host_timer
+  {
+  esp_timer_handle_t timer;
+  TimerCallbackFunction_t callback;
+  void* id;
+  TickType_t period;
+  bool autoreload;
+  };
+
+static std::mutex host_timers_mutex;
+static std::condition_variable host_timers_cv HOST_INIT;
+static std::multimap<int64_t, host_esp_timer*> host_timers_due HOST_INIT;
+static bool host_timers_running = false;
+
+static void host_timer_unlink(host_esp_timer* timer)
+  {
+  if (timer->due == 0) return;
+  auto range = host_timers_due.equal_range(timer->due);
+  for (auto it = range.first; it != range.second; ++it)
+    {
+    if (it->second == timer)
+      {
+      host_timers_due.erase(it);
+      break;
+      }
+    }
+  timer->due = 0;
+  }
+
+static void host_timer_link(host_esp_timer* timer, int64_t due)
+  {
+  timer->due = due ? due : 1;
+  host_timers_due.insert(std::make_pair(timer->due, timer));
+  host_timers_cv.notify_all();
+  }
+
+static void host_timer_task(void* arg)
+  {
+  std::unique_lock<std::mutex> lock(host_timers_mutex);
+  while (true)
+    {
+    if (host_timers_due.empty())
+      {
+      host_timers_cv.wait(lock);
+      continue;
+      }
+    int64_t now = host_time_us();
+    auto it = host_timers_due.begin();
+    if (it->first > now)
+      {
+      host_timers_cv.wait_for(lock, std::chrono::microseconds(it->first - now));
+      continue;
+      }
+    host_esp_timer* timer = it->second;
+    host_timers_due.erase(it);
+    timer->due = 0;
+    if (timer->period)
+      host_timer_link(timer, now + timer->period);
+    esp_timer_cb_t callback = timer->callback;
+    void* cbarg = timer->arg;
+    lock.unlock();
+    callback(cbarg);
+    lock.lock();
+    }
+  }
+
+static void host_timer_start_task()
+  {
+  // Called with host_timers_mutex locked
+  if (host_timers_running) return;
+  host_timers_running = true;
+  xTaskCreatePinnedToCore(host_timer_task, "esp_timer", 4096, NULL, 22, NULL, 0);
+  }
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* create_args, esp_timer_handle_t* out_handle)
+  {
+  if (!create_args || !create_args->callback || !out_handle)
+    return ESP_ERR_INVALID_ARG;
+  host_esp_timer* timer = new host_esp_timer;
+  timer->callback = create_args->callback;
+  timer->arg = create_args->arg;
+  timer->name = create_args->name ? create_args->name : "";
+  timer->due = 0;
+  timer->period = 0;
+  *out_handle = timer;
+  std::lock_guard<std::mutex> lock(host_timers_mutex);
+  host_timer_start_task();
+  return ESP_OK;
+  }
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+  {
+  std::lock_guard<std::mutex> lock(host_timers_mutex);
+  if (timer->due) return ESP_ERR_INVALID_STATE;
+  timer->period = 0;
+  host_timer_link(timer, host_time_us() + timeout_us);
+  return ESP_OK;
+  }
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+  {
+  std::lock_guard<std::mutex> lock(host_timers_mutex);
+  if (timer->due) return ESP_ERR_INVALID_STATE;
+  timer->period = period;
+  host_timer_link(timer, host_time_us() + period);
+  return ESP_OK;
+  }
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+  {
+  std::lock_guard<std::mutex> lock(host_timers_mutex);
+  if (!timer->due) return ESP_ERR_INVALID_STATE;
+  host_timer_unlink(timer);
+  timer->period = 0;
+  return ESP_OK;
+  }
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+  {
+  std::lock_guard<std::mutex> lock(host_timers_mutex);
+  if (timer->due) return ESP_ERR_INVALID_STATE;
+  delete timer;
+  return ESP_OK;
+  }
+
+int64_t esp_timer_get_time(void)
+  {
+  return host_time_us();
+  }
+
+static void host_freertos_timer_callback(void* arg)
+  {
+  host_timer* timer = (host_timer*)arg;
+  timer->callback(timer);
+  }
+
+TimerHandle_t xTimerCreate(const char* pcTimerName, const TickType_t xTimerPeriod,
+  const UBaseType_t uxAutoReload, void* const pvTimerID, TimerCallbackFunction_t pxCallbackFunction)
+  {
+  host_timer* timer = new host_timer;
+  timer->callback = pxCallbackFunction;
+  timer->id = pvTimerID;
+  timer->period = xTimerPeriod;
+  timer->autoreload = uxAutoReload;
+  esp_timer_create_args_t args = {};
+  args.callback = host_freertos_timer_callback;
+  args.arg = timer;
+  args.name = pcTimerName;
+  esp_timer_create(&args, &timer->timer);
+  return timer;
+  }
+
+BaseType_t xTimerStart(TimerHandle_t xTimer, TickType_t xTicksToWait)
+  {
+  esp_timer_stop(xTimer->timer);
+  uint64_t us = (uint64_t)xTimer->period * portTICK_PERIOD_MS * 1000;
+  if (xTimer->autoreload)
+    esp_timer_start_periodic(xTimer->timer, us);
+  else
+    esp_timer_start_once(xTimer->timer, us);
+  return pdPASS;
+  }
+
+BaseType_t xTimerStop(TimerHandle_t xTimer, TickType_t xTicksToWait)
+  {
+  esp_timer_stop(xTimer->timer);
+  return pdPASS;
+  }
+
+BaseType_t xTimerReset(TimerHandle_t xTimer, TickType_t xTicksToWait)
+  {
+  return xTimerStart(xTimer, xTicksToWait);
+  }
+
+BaseType_t xTimerChangePeriod(TimerHandle_t xTimer, TickType_t xNewPeriod, TickType_t xTicksToWait)
+  {
+  xTimer->period = xNewPeriod;
+  return xTimerStart(xTimer, xTicksToWait);
+  }
+
+BaseType_t xTimerDelete(TimerHandle_t xTimer, TickType_t xTicksToWait)
+  {
+  // Note: the timer may be deleted from its own callback, so the handle is kept
+  esp_timer_stop(xTimer->timer);
+  return pdPASS;
+  }
+
+BaseType_t xTimerIsTimerActive(TimerHandle_t xTimer)
+  {
+  std::lock_guard<std::mutex> lock(host_timers_mutex);
+  return xTimer->timer->due != 0;
+  }
+
+void* pvTimerGetTimerID(TimerHandle_t xTimer)
+  {
+  return xTimer->id;
+  }
@@ -0,0 +1,87 @@
+/*
+ * Host framework for tests & tools, see tests/host/Makefile
+ *
+ * The framework sources (metrics, mutexes, buffers, pcp) and the component
+ * sources under test are built unchanged. The ESP-IDF & FreeRTOS APIs and the
+ * framework services the host build doesn't include (events, config, command
+ * shell, notifications, CAN controller) are provided by freertos.cpp,
+ * framework.cpp and can.cpp in a reduced form.
+ */
+
+#ifndef __HOST_H__
+#define __HOST_H__
+
+#include <string>
+#include "ovms_command.h"
+#include "can.h"
+
+/**
+ * HostStart: start the framework services
+ *  Starts the event task & the housekeeping ticker (ticker.* events & monotonictime).
+ *  Log output goes to stderr, loglevel: 0=none … 5=verbose
+ */
+void HostStart(int loglevel);
+
+/**
+ * HostExit: flush output & exit without running the static destructors
+ *  The framework objects are never destroyed on the module and don't support it.
+ */
+void HostExit(int status);
+
+/**
+ * HostWriter: OvmsWriter printing to stdout
+ */
+class HostWriter : public OvmsWriter
+  {
+  public:
+    HostWriter(FILE* out=stdout);
+
+  public:
+    int puts(const char* s);
+    int printf(const char* fmt, ...);
+    ssize_t write(const void *buf, size_t nbyte);
+    bool IsInteractive() { return false; }
+
+  protected:
+    FILE* m_out;
+  };
+
+/**
+ * HostExecute: execute a shell command (e.g. "vehicle poller status")
+ */
+void HostExecute(OvmsWriter* writer, const std::string& cmdline, int verbosity=COMMAND_RESULT_VERBOSE);
+
+/**
+ * hostcan: virtual CAN bus driver
+ *  Frames written are passed to the TX handler (e.g. a simulator link) and
+ *  acknowledged by a TX callback from the CAN task, like by a bus driver on
+ *  the module. Received frames are passed to the framework by Receive().
+ */
+typedef std::function<void(const CAN_frame_t* frame, const struct timeval* time)> HostCanTxHandler;
+
+class hostcan : public canbus
+  {
+  public:
+    hostcan(const char* name);
+    ~hostcan();
+
+  public:
+    esp_err_t Start(CAN_mode_t mode, CAN_speed_t speed);
+    esp_err_t Stop();
+    esp_err_t Write(const CAN_frame_t* p_frame, TickType_t maxqueuewait=0);
+
+  public:
+    void SetTxHandler(HostCanTxHandler handler) { m_txhandler = handler; }
+    void Receive(const CAN_frame_t* frame);
+
+  protected:
+    HostCanTxHandler m_txhandler;
+  };
+
+/**
+ * HostCanInit: create the virtual buses can1 … can<count>
+ */
+void HostCanInit(int count);
+hostcan* HostCanGetBus(int bus);      // 1 … count
+
+#endif //#ifndef __HOST_H__
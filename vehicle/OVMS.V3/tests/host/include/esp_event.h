@@ -0,0 +1,15 @@
+/*
+ * Host ESP-IDF emulation: system events are not delivered on the host
+ */
+
+#ifndef __HOST_ESP_EVENT_H__
+#define __HOST_ESP_EVENT_H__
+
+#include "esp_err.h"
+
+typedef struct
+  {
+  int event_id;
+  } system_event_t;
+
+#endif // __HOST_ESP_EVENT_H__
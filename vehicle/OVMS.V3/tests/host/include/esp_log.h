@@ -0,0 +1,46 @@
+/*
+ * Host ESP-IDF emulation: logging
+ *
+ * Log output goes to stderr, the level is set by esp_log_level_set()
+ * (default: ESP_LOG_WARN, see tests/host/framework.cpp).
+ */
+
+#ifndef __HOST_ESP_LOG_H__
+#define __HOST_ESP_LOG_H__
+
+#include <stdint.h>
+#include <stdarg.h>
+
+typedef enum
+  {
+  ESP_LOG_NONE,
+  ESP_LOG_ERROR,
+  ESP_LOG_WARN,
+  ESP_LOG_INFO,
+  ESP_LOG_DEBUG,
+  ESP_LOG_VERBOSE
+  } esp_log_level_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void esp_log_level_set(const char* tag, esp_log_level_t level);
+uint32_t esp_log_timestamp(void);
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...)
+  __attribute__ ((format (printf, 3, 4)));
+void esp_log_writev(esp_log_level_t level, const char* tag, const char* format, va_list args);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define LOG_FORMAT(letter, format)  #letter " (%u) %s: " format "\n"
+
+#define ESP_LOGE( tag, format, ... ) esp_log_write(ESP_LOG_ERROR,   tag, LOG_FORMAT(E, format), esp_log_timestamp(), tag, ##__VA_ARGS__)
+#define ESP_LOGW( tag, format, ... ) esp_log_write(ESP_LOG_WARN,    tag, LOG_FORMAT(W, format), esp_log_timestamp(), tag, ##__VA_ARGS__)
+#define ESP_LOGI( tag, format, ... ) esp_log_write(ESP_LOG_INFO,    tag, LOG_FORMAT(I, format), esp_log_timestamp(), tag, ##__VA_ARGS__)
+#define ESP_LOGD( tag, format, ... ) esp_log_write(ESP_LOG_DEBUG,   tag, LOG_FORMAT(D, format), esp_log_timestamp(), tag, ##__VA_ARGS__)
+#define ESP_LOGV( tag, format, ... ) esp_log_write(ESP_LOG_VERBOSE, tag, LOG_FORMAT(V, format), esp_log_timestamp(), tag, ##__VA_ARGS__)
+
+#endif // __HOST_ESP_LOG_H__
@@ -0,0 +1,23 @@
+/*
+ * Host ESP-IDF emulation: system functions
+ */
+
+#ifndef __HOST_ESP_SYSTEM_H__
+#define __HOST_ESP_SYSTEM_H__
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void esp_restart(void);
+uint32_t esp_get_free_heap_size(void);
+uint32_t esp_random(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __HOST_ESP_SYSTEM_H__
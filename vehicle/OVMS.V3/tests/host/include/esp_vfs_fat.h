@@ -0,0 +1,18 @@
+/*
+ * Host ESP-IDF emulation: FAT file system mount configuration (unused)
+ */
+
+#ifndef __HOST_ESP_VFS_FAT_H__
+#define __HOST_ESP_VFS_FAT_H__
+
+#include <stddef.h>
+#include "esp_err.h"
+
+typedef struct
+  {
+  bool format_if_mount_failed;
+  int max_files;
+  size_t allocation_unit_size;
+  } esp_vfs_fat_mount_config_t;
+
+#endif // __HOST_ESP_VFS_FAT_H__
@@ -0,0 +1,74 @@
+/*
+ * Host FreeRTOS emulation, see tests/host/freertos.cpp
+ *
+ * Tasks are host threads, queues & semaphores are built on std::mutex &
+ * std::condition_variable, the tick rate is CONFIG_FREERTOS_HZ like on the
+ * module. Only the API used by the sources built on the host is provided.
+ */
+
+#ifndef __HOST_FREERTOS_H__
+#define __HOST_FREERTOS_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>                      // MIN(), MAX() like in the ESP-IDF build
+#include <assert.h>                         // … included indirectly by the ESP-IDF headers
+#include <math.h>
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// newlib extension used by the framework:
+char* itoa(int value, char* str, int base);
+
+typedef uint32_t TickType_t;
+typedef TickType_t portTickType;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef BaseType_t portBASE_TYPE;
+typedef uint32_t StackType_t;
+
+#define configTICK_RATE_HZ          CONFIG_FREERTOS_HZ
+#define configMAX_TASK_NAME_LEN     16
+#define configMAX_PRIORITIES        25
+#define portMAX_DELAY               ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS          ((TickType_t)1000 / configTICK_RATE_HZ)
+#define portTICK_RATE_MS            portTICK_PERIOD_MS
+#define pdMS_TO_TICKS(xTimeInMs)    ((TickType_t)(((TickType_t)(xTimeInMs) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000))
+
+#define pdFALSE                     ((BaseType_t)0)
+#define pdTRUE                      ((BaseType_t)1)
+#define pdPASS                      pdTRUE
+#define pdFAIL                      pdFALSE
+#define errQUEUE_EMPTY              ((BaseType_t)0)
+#define errQUEUE_FULL               ((BaseType_t)0)
+
+#define tskNO_AFFINITY              0x7fffffff
+#define portNUM_PROCESSORS          2
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
+
+typedef struct { int owner; int count; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED { 0, 0 }
+void vPortEnterCritical(portMUX_TYPE* mux);
+void vPortExitCritical(portMUX_TYPE* mux);
+#define portENTER_CRITICAL(mux)     vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux)      vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux)  vPortExitCritical(mux)
+
+BaseType_t xPortGetCoreID(void);
+size_t xPortGetFreeHeapSize(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __HOST_FREERTOS_H__
@@ -0,0 +1,13 @@
+/*
+ * Host FreeRTOS emulation: event groups are not used by the host build
+ */
+
+#ifndef __HOST_FREERTOS_EVENT_GROUPS_H__
+#define __HOST_FREERTOS_EVENT_GROUPS_H__
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_event_group* EventGroupHandle_t;
+typedef TickType_t EventBits_t;
+
+#endif // __HOST_FREERTOS_EVENT_GROUPS_H__
@@ -0,0 +1,37 @@
+/*
+ * Host FreeRTOS emulation: semaphores & mutexes, see tests/host/freertos.cpp
+ */
+
+#ifndef __HOST_FREERTOS_SEMPHR_H__
+#define __HOST_FREERTOS_SEMPHR_H__
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount);
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void);
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore);
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t xMutex, TickType_t xBlockTime);
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t xMutex);
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t xSemaphore);
+TaskHandle_t xSemaphoreGetMutexHolder(SemaphoreHandle_t xSemaphore);
+
+#define xSemaphoreGiveFromISR(s,w) xSemaphoreGive(s)
+#define xSemaphoreTakeFromISR(s,w) xSemaphoreTake((s),0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __HOST_FREERTOS_SEMPHR_H__
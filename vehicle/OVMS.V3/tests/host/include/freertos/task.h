@@ -0,0 +1,68 @@
+/*
+ * Host FreeRTOS emulation: tasks, see tests/host/freertos.cpp
+ */
+
+#ifndef __HOST_FREERTOS_TASK_H__
+#define __HOST_FREERTOS_TASK_H__
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct host_task* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+typedef enum
+  {
+  eRunning = 0,
+  eReady,
+  eBlocked,
+  eSuspended,
+  eDeleted
+  } eTaskState;
+
+typedef struct
+  {
+  TaskHandle_t xHandle;
+  const char* pcTaskName;
+  UBaseType_t xTaskNumber;
+  eTaskState eCurrentState;
+  UBaseType_t uxCurrentPriority;
+  UBaseType_t uxBasePriority;
+  uint32_t ulRunTimeCounter;
+  StackType_t* pxStackBase;
+  uint32_t usStackHighWaterMark;
+  BaseType_t xCoreID;
+  } TaskStatus_t;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pvTaskCode, const char* pcName,
+  uint32_t usStackDepth, void* pvParameters, UBaseType_t uxPriority,
+  TaskHandle_t* pvCreatedTask, BaseType_t xCoreID);
+BaseType_t xTaskCreate(TaskFunction_t pvTaskCode, const char* pcName,
+  uint32_t usStackDepth, void* pvParameters, UBaseType_t uxPriority,
+  TaskHandle_t* pvCreatedTask);
+void vTaskDelete(TaskHandle_t xTaskToDelete);
+void vTaskDelay(const TickType_t xTicksToDelay);
+void vTaskSuspend(TaskHandle_t xTaskToSuspend);
+void vTaskResume(TaskHandle_t xTaskToResume);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+TaskHandle_t xTaskGetHandle(const char* pcNameToQuery);
+char* pcTaskGetTaskName(TaskHandle_t xTaskToQuery);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask);
+UBaseType_t uxTaskGetNumberOfTasks(void);
+UBaseType_t uxTaskGetSystemState(TaskStatus_t* const pxTaskStatusArray,
+  const UBaseType_t uxArraySize, uint32_t* const pulTotalRunTime);
+
+#define xTaskGetNumberOfTasks uxTaskGetNumberOfTasks
+#define xTaskGetSystemState uxTaskGetSystemState
+#define pcTaskGetName pcTaskGetTaskName
+#define taskYIELD() vTaskDelay(0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __HOST_FREERTOS_TASK_H__
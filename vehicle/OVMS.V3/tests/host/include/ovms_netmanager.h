@@ -0,0 +1,10 @@
+/*
+ * Host build: network manager replacement, see sdkconfig.h
+ */
+
+#ifndef __OVMS_NETMANAGER_H__
+#define __OVMS_NETMANAGER_H__
+
+struct mg_connection;
+
+#endif //#ifndef __OVMS_NETMANAGER_H__
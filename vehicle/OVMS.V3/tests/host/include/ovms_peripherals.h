@@ -0,0 +1,14 @@
+/*
+ * Host build: peripherals replacement, there are no module peripherals on the host
+ */
+
+#ifndef __PERIPHERALS_H__
+#define __PERIPHERALS_H__
+
+class Peripherals
+  {
+  };
+
+extern Peripherals* MyPeripherals;
+
+#endif //#ifndef __PERIPHERALS_H__
@@ -0,0 +1,25 @@
+/*
+ * Host ESP-IDF emulation: reset reason, the host always does a power on reset
+ */
+
+#ifndef __HOST_ROM_RTC_H__
+#define __HOST_ROM_RTC_H__
+
+typedef enum
+  {
+  NO_MEAN = 0,
+  POWERON_RESET = 1,
+  SW_RESET = 3,
+  } RESET_REASON;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+RESET_REASON rtc_get_reset_reason(int cpu_no);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __HOST_ROM_RTC_H__
@@ -0,0 +1,25 @@
+/*
+ * Host build configuration, see tests/host/Makefile
+ *
+ * Mirrors the module defaults (support/sdkconfig.default.hw31) for the options
+ * used by the sources built on the host. Components not built on the host are
+ * left undefined (web server, scripting, MAX7317, TPMS, …).
+ */
+
+#ifndef __SDKCONFIG_H__
+#define __SDKCONFIG_H__
+
+#define CONFIG_OVMS 1
+#define CONFIG_FREERTOS_HZ 100
+#define CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ 240
+#define CONFIG_SPIRAM_SUPPORT 1
+#define CONFIG_OVMS_HW_CAN_RX_QUEUE_SIZE 60
+#define CONFIG_OVMS_HW_CAN_TX_QUEUE_SIZE 30
+#define CONFIG_OVMS_VEHICLE_CAN_RX_QUEUE_SIZE 60
+#define CONFIG_OVMS_VEHICLE_RXTASK_STACK 8192
+
+// Declares the CAN log connection interface used by the log formats,
+// the network manager is replaced by include/ovms_netmanager.h:
+#define CONFIG_OVMS_SC_GPL_MONGOOSE 1
+
+#endif // __SDKCONFIG_H__
@@ -0,0 +1,12 @@
+/*
+ * Host ESP-IDF emulation: wear levelling handle (unused)
+ */
+
+#ifndef __HOST_WEAR_LEVELLING_H__
+#define __HOST_WEAR_LEVELLING_H__
+
+#include <stdint.h>
+
+typedef int32_t wl_handle_t;
+
+#endif // __HOST_WEAR_LEVELLING_H__
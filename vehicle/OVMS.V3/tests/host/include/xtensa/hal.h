@@ -0,0 +1,24 @@
+/*
+ * Host emulation of the Xtensa cycle counter, see tests/host/freertos.cpp
+ *
+ * Counts at CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ based on the host clock, so
+ * cycle figures (e.g. 'vehicle profile') are host times scaled to the
+ * module clock rate, not module cycle counts.
+ */
+
+#ifndef __HOST_XTENSA_HAL_H__
+#define __HOST_XTENSA_HAL_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+unsigned xthal_get_ccount(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __HOST_XTENSA_HAL_H__
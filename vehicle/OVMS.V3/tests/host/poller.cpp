@@ -0,0 +1,625 @@
+/*
+ * poller: poller benchmark & tests against the ECU simulator on the host
+ *
+ * Usage: poller [options] bench|isotp [-- <sim_ecu.pl options>]
+ *   -d <seconds>   Measurement duration (default 20)
+ *   -b <buses>     Buses polled, 1 or 2 (default 2)
+ *   -n <entries>   Poll list entries per bus (default 2)
+ *   -p <ms>        Poll interval in milliseconds, 0 = 1 second (default 1)
+ *   -m             Poll the multi frame response DID (10 frames, paced by the poller's
+ *                  response separation time, default 25 ms)
+ *   -i <n>         Requests in flight per bus (PollSetMaxInFlight(), default 1)
+ *   -s <path>      Simulator script (default ../sim_ecu.pl)
+ *   -t <path>      Simulator table (default poller_bench.txt / ../sim_ecu_fc.txt)
+ *   -v <level>     Log level (default 2 = warnings)
+ *
+ * Runs the vehicle framework & poller sources on virtual buses (see host.h) connected
+ * to tests/sim_ecu.pl in stdio mode, i.e. the simulator receives the poller requests
+ * and sends the responses as CRTD log lines like via the module's CAN log server.
+ *
+ * bench: polls the list entries (alternating between the two ECUs of a bus, see
+ *   poller_bench.txt) without throttling and counts the responses completed after a
+ *   warmup of 3 seconds. The simulator runs with --seed 1 and no jitter or loss, so the
+ *   result only depends on the simulated latency (default 10 ms, add --latency <ms>
+ *   after "--" to change) and the host.
+ *   With the default 1 ms interval, the entries are always due, so the poller runs at
+ *   its maximum rate. With -p 0, the list is polled once per second: a list not done
+ *   within the second is continued on the next ticker, i.e. the rate drops to half.
+ *   -p 0 also builds against poller versions without millisecond scheduling, e.g. for
+ *   before/after comparisons (make VEHICLE=<dir>, see Makefile).
+ *
+ *   Per bus engines, before (7487013) / after, 1 second lists, 2 buses, 10 ms latency:
+ *     -p 0 -n 40                 80.0 /  80.0 PIDs/s   (both lists done within the second)
+ *     -p 0 -n 60                 60.0 / 120.0 PIDs/s   (before: one engine needs 1.3 s)
+ *     -p 0 -n 100                65.5 / 100.0 PIDs/s
+ *     -p 0 -n 20 -- --loss 2     11.1 /  19.2 PIDs/s   (before: timeouts stall both buses)
+ *     -p 0 -n 60 -b 1            60.0 /  60.0 PIDs/s   (single bus: unchanged)
+ *
+ * isotp: ISO-TP multi frame request transmission tests, see isotp_tests below. Each test
+ *   restarts the simulator with the flow control (block size & separation time) to
+ *   test, sends a write request by PollSingleRequest() and checks the response, the
+ *   number of consecutive frames, the frames per block and the separation times of the
+ *   frames sent. Exits with status 1 if a test fails.
+ *
+ * Build & run: make -C tests/host bench / test
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "vehicle.h"
+#include "host.h"
+
+#define BENCH_WARMUP    3
+
+static int bench_buses = 2;
+
+/**
+ * SimLink: tests/sim_ecu.pl child process connected to the virtual buses
+ */
+class SimLink
+  {
+  public:
+    SimLink();
+    ~SimLink();
+
+  public:
+    bool Start(const char* script, const char* table, const std::vector<std::string>& args);
+    void Stop();
+    void Transmit(int bus, const CAN_frame_t* frame, const struct timeval* time);
+
+  public:
+    // Frame recording (both directions):
+    typedef struct
+      {
+      double      time;                   // [s], TX: TX completion, RX: reception
+      bool        tx;                     // true = sent by the poller
+      uint32_t    id;
+      uint8_t     data[8];
+      } frame_t;
+    void StartRecording();
+    std::vector<frame_t> StopRecording();
+
+  protected:
+    void ReaderTask();
+    void Record(bool tx, const CAN_frame_t* frame, const struct timeval* time);
+
+  protected:
+    pid_t       m_pid;
+    FILE*       m_tx;
+    FILE*       m_rx;
+    std::mutex  m_txmutex;
+    std::thread m_reader;
+    std::mutex  m_recmutex;
+    bool        m_recording;
+    std::vector<frame_t> m_recorded;
+  };
+
+SimLink::SimLink()
+  {
+  m_pid = -1;
+  m_tx = NULL;
+  m_rx = NULL;
+  m_recording = false;
+  }
+
+SimLink::~SimLink()
+  {
+  Stop();
+  }
+
+bool SimLink::Start(const char* script, const char* table, const std::vector<std::string>& args)
+  {
+  int tx[2], rx[2];
+  if (pipe(tx) < 0 || pipe(rx) < 0)
+    return false;
+
+  std::vector<const char*> argv = { "perl", script, "--stdio", "--stats", "0", "--seed", "1" };
+  for (const std::string& arg : args)
+    argv.push_back(arg.c_str());
+  argv.push_back(table);
+  argv.push_back(NULL);
+
+  m_pid = fork();
+  if (m_pid < 0)
+    return false;
+  if (m_pid == 0)
+    {
+    dup2(tx[0], 0);
+    dup2(rx[1], 1);
+    close(tx[0]); close(tx[1]);
+    close(rx[0]); close(rx[1]);
+    execvp(argv[0], (char* const*)argv.data());
+    perror(script);
+    _exit(127);
+    }
+
+  close(tx[0]);
+  close(rx[1]);
+  m_tx = fdopen(tx[1], "w");
+  m_rx = fdopen(rx[0], "r");
+  for (int bus = 1; bus <= 2; bus++)
+    {
+    HostCanGetBus(bus)->SetTxHandler([this, bus](const CAN_frame_t* frame, const struct timeval* time)
+      {
+      Transmit(bus, frame, time);
+      });
+    }
+  m_reader = std::thread(&SimLink::ReaderTask, this);
+  return true;
+  }
+
+/**
+ * Stop: close the simulator input & wait for the simulator to exit
+ *  The simulator prints its statistics on EOF.
+ */
+void SimLink::Stop()
+  {
+  if (m_pid <= 0)
+    return;
+  for (int bus = 1; bus <= 2; bus++)
+    HostCanGetBus(bus)->SetTxHandler(NULL);
+  m_txmutex.lock();
+  fclose(m_tx);
+  m_tx = NULL;
+  m_txmutex.unlock();
+  if (m_reader.joinable())
+    m_reader.join();
+  fclose(m_rx);
+  m_rx = NULL;
+  waitpid(m_pid, NULL, 0);
+  m_pid = -1;
+  }
+
+/**
+ * Transmit: send a frame to the simulator as a CRTD log line
+ *  The time is the TX completion time, like in the module's CAN log.
+ */
+void SimLink::Transmit(int bus, const CAN_frame_t* frame, const struct timeval* time)
+  {
+  char line[100];
+  bool ext = (frame->FIR.B.FF == CAN_frame_ext);
+  int len = snprintf(line, sizeof(line), "%ld.%06ld %dT%s %0*X",
+    (long)time->tv_sec, (long)time->tv_usec, bus, ext ? "29" : "11", ext ? 8 : 3, frame->MsgID);
+  for (int k = 0; k < frame->FIR.B.DLC && k < 8; k++)
+    len += snprintf(line+len, sizeof(line)-len, " %02X", frame->data.u8[k]);
+  Record(true, frame, time);
+  std::lock_guard<std::mutex> lock(m_txmutex);
+  if (m_tx)
+    {
+    fprintf(m_tx, "%s\n", line);
+    fflush(m_tx);
+    }
+  }
+
+/**
+ * ReaderTask: pass the simulator frames to the virtual buses as received frames
+ */
+void SimLink::ReaderTask()
+  {
+  char line[200];
+  while (fgets(line, sizeof(line), m_rx))
+    {
+    // <time> <bus>R<11|29> <id> <data>…
+    char* p = strchr(line, ' ');
+    if (!p) continue;
+    int bus = strtol(p+1, &p, 10);
+    if (*p != 'R' && *p != 'T') continue;
+    bool ext = (p[1] == '2');
+    hostcan* can = HostCanGetBus(bus);
+    if (!can) continue;
+
+    CAN_frame_t frame = {};
+    frame.FIR.B.FF = ext ? CAN_frame_ext : CAN_frame_std;
+    frame.MsgID = strtoul(p+3, &p, 16);
+    int dlc = 0;
+    char* end;
+    while (dlc < 8)
+      {
+      unsigned long b = strtoul(p, &end, 16);
+      if (end == p) break;
+      frame.data.u8[dlc++] = b;
+      p = end;
+      }
+    frame.FIR.B.DLC = dlc;
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    Record(false, &frame, &now);
+    can->Receive(&frame);
+    }
+  }
+
+void SimLink::StartRecording()
+  {
+  std::lock_guard<std::mutex> lock(m_recmutex);
+  m_recorded.clear();
+  m_recording = true;
+  }
+
+std::vector<SimLink::frame_t> SimLink::StopRecording()
+  {
+  std::lock_guard<std::mutex> lock(m_recmutex);
+  m_recording = false;
+  return std::move(m_recorded);
+  }
+
+void SimLink::Record(bool tx, const CAN_frame_t* frame, const struct timeval* time)
+  {
+  std::lock_guard<std::mutex> lock(m_recmutex);
+  if (!m_recording)
+    return;
+  frame_t rec;
+  rec.time = time->tv_sec + time->tv_usec / 1000000.0;
+  rec.tx = tx;
+  rec.id = frame->MsgID;
+  memcpy(rec.data, frame->data.u8, 8);
+  m_recorded.push_back(rec);
+  }
+
+/**
+ * OvmsVehicleHostTest: vehicle polling the benchmark list & counting the responses
+ */
+class OvmsVehicleHostTest : public OvmsVehicle
+  {
+  public:
+    OvmsVehicleHostTest();
+
+  public:
+    void IncomingPollReply(canbus* bus, uint16_t type, uint16_t pid, uint8_t* data, uint8_t length, uint16_t mlremain);
+    void IncomingPollError(canbus* bus, uint16_t type, uint16_t pid, uint16_t code);
+    void Poll(std::vector<poll_pid_t>& list);
+    using OvmsVehicle::PollSetThrottling;
+    using OvmsVehicle::PollSingleRequest;
+#ifdef VEHICLE_POLL_MAXINFLIGHT
+    using OvmsVehicle::PollSetMaxInFlight;
+#endif
+
+  public:
+    std::atomic<unsigned> m_responses[2];
+    std::atomic<unsigned> m_errors;
+  };
+
+OvmsVehicleHostTest::OvmsVehicleHostTest()
+  {
+  m_responses[0] = m_responses[1] = 0;
+  m_errors = 0;
+  for (int bus = 1; bus <= bench_buses; bus++)
+    RegisterCanBus(bus, CAN_MODE_ACTIVE, CAN_SPEED_500KBPS);
+  }
+
+void OvmsVehicleHostTest::IncomingPollReply(canbus* bus, uint16_t type, uint16_t pid, uint8_t* data, uint8_t length, uint16_t mlremain)
+  {
+  if (mlremain == 0)
+    m_responses[(bus == m_can2) ? 1 : 0]++;
+  }
+
+void OvmsVehicleHostTest::IncomingPollError(canbus* bus, uint16_t type, uint16_t pid, uint16_t code)
+  {
+  m_errors++;
+  }
+
+void OvmsVehicleHostTest::Poll(std::vector<poll_pid_t>& list)
+  {
+  PollSetPidList(m_can1, list.empty() ? NULL : list.data());
+  }
+
+
+/**
+ * RunBench: poller throughput benchmark, see above
+ */
+static int RunBench(OvmsVehicleHostTest* vehicle, SimLink& sim, int duration, int buses,
+                    int entries, int interval, bool multiframe, int inflight)
+  {
+#ifndef POLL_TIME_MS
+  if (interval != 0)
+    {
+    fprintf(stderr, "Error: millisecond poll intervals not available, use -p 0\n");
+    return 1;
+    }
+#endif
+
+  // Poll list: entries alternating between the two ECUs per bus
+  std::vector<OvmsVehicle::poll_pid_t> list;
+  for (int bus = 1; bus <= buses; bus++)
+    {
+    for (int k = 0; k < entries; k++)
+      {
+      OvmsVehicle::poll_pid_t entry;
+      memset(&entry, 0, sizeof(entry));
+      entry.txmoduleid = (k & 1) ? 0x7e4 : 0x7e0;
+      entry.rxmoduleid = entry.txmoduleid + 8;
+      entry.type = VEHICLE_POLL_TYPE_READDATA;
+      entry.pid = multiframe ? 0x0208 : 0x0101;
+      entry.polltime[0] = interval ? interval : 1;
+#ifdef POLL_TIME_MS
+      entry.polltimeunit = interval ? POLL_TIME_MS : POLL_TIME_SECONDS;
+#endif
+      entry.pollbus = bus;
+      entry.protocol = ISOTP_STD;
+      list.push_back(entry);
+      }
+    }
+  list.push_back(POLL_LIST_END);
+
+  vehicle->PollSetThrottling(0);
+#ifdef VEHICLE_POLL_MAXINFLIGHT
+  for (int bus = 1; bus <= buses; bus++)
+    vehicle->PollSetMaxInFlight(HostCanGetBus(bus), inflight);
+#else
+  if (inflight != 1)
+    fprintf(stderr, "Warning: PollSetMaxInFlight() not available, ignoring -i\n");
+#endif
+  vehicle->Poll(list);
+
+  printf("Polling %d entries (%s frame) every %d ms on %d bus(es), %d in flight, for %d+%d seconds...\n",
+    entries, multiframe ? "multi" : "single", interval ? interval : 1000, buses, inflight,
+    BENCH_WARMUP, duration);
+  sleep(BENCH_WARMUP);
+  unsigned start[2] = { vehicle->m_responses[0], vehicle->m_responses[1] };
+  unsigned errors = vehicle->m_errors;
+  sleep(duration);
+  unsigned count[2] = { vehicle->m_responses[0] - start[0], vehicle->m_responses[1] - start[1] };
+  errors = vehicle->m_errors - errors;
+
+#ifdef VEHICLE_POLL_NBUSES
+  HostWriter writer;
+  HostExecute(&writer, "vehicle poller status");
+  HostExecute(&writer, "vehicle poller times");
+#endif
+
+  std::vector<OvmsVehicle::poll_pid_t> none;
+  vehicle->Poll(none);
+  fflush(stdout);
+  sim.Stop();
+
+  for (int bus = 1; bus <= buses; bus++)
+    printf("can%d: %u responses, %.1f PIDs/s\n", bus, count[bus-1], (double)count[bus-1] / duration);
+  printf("Total: %.1f PIDs/s, %u errors\n", (double)(count[0] + count[1]) / duration, errors);
+  return 0;
+  }
+
+/**
+ * ISO-TP multi frame request tests
+ *  The requests are sent to the "bms" (7e4 → 7ec) or "charger" (18da44f1 → 18daf144)
+ *  ECU of sim_ecu_fc.txt, which answer write requests to F190 by "6e f1 90", i.e. the
+ *  response has no data besides the type & PID.
+ */
+typedef struct
+  {
+  const char* name;
+  int         bs;                         // Flow control block size
+  uint8_t     stmin;                      // Flow control separation time code
+  int         length;                     // Request length
+  bool        ext;                        // true = 29 bit IDs (ISOTP_EXTFRAME)
+  } isotp_test_t;
+
+static const isotp_test_t isotp_tests[] =
+  {
+  { "no block size, no separation time",  0, 0x00,  63, false },
+  { "separation time 10 ms",              0, 0x0a,  63, false },
+  { "block size 4, 5 ms",                 4, 0x05,  63, false },
+  { "block size 2, 127 ms",               2, 0x7f,  63, false },
+  { "separation time 100 us (f1)",        0, 0xf1,  63, false },
+  { "separation time 200 us (f2)",        0, 0xf2,  63, false },
+  { "separation time 300 us (f3)",        0, 0xf3,  63, false },
+  { "separation time 400 us (f4)",        0, 0xf4,  63, false },
+  { "separation time 500 us (f5)",        0, 0xf5,  63, false },
+  { "separation time 600 us (f6)",        0, 0xf6,  63, false },
+  { "separation time 700 us (f7)",        0, 0xf7,  63, false },
+  { "separation time 800 us (f8)",        0, 0xf8,  63, false },
+  { "separation time 900 us (f9)",        0, 0xf9,  63, false },
+  { "block size 1, 500 us (f5)",          1, 0xf5,  63, false },
+  { "block size 3, 100 us (f1)",          3, 0xf1,  63, false },
+  { "reserved code 80 = 127 ms",          0, 0x80,  63, false },
+  { "reserved code f0 = 127 ms",          0, 0xf0,  63, false },
+  { "reserved code fa = 127 ms",          0, 0xfa,  63, false },
+  { "reserved code ff = 127 ms",          4, 0xff,  63, false },
+  // 28 frames at 127 ms take 3.6 seconds, longer than the poll timeout (two ticks),
+  // so the request only succeeds if the timeout is restarted by each frame sent:
+  { "timeout restart per frame",          0, 0x7f, 200, false },
+  { "29 bit, block size 4, 5 ms",         4, 0x05,  63, true },
+  { "29 bit, block size 3, 300 us (f3)",  3, 0xf3,  63, true },
+  };
+
+// Separation time [s] by ISO 15765-2 code:
+static double isotp_septime(uint8_t code)
+  {
+  if (code <= 0x7f)
+    return code / 1000.0;
+  else if (code >= 0xf1 && code <= 0xf9)
+    return (code - 0xf0) / 10000.0;
+  else
+    return 0.127;
+  }
+
+static bool RunISOTPTest(OvmsVehicleHostTest* vehicle, SimLink& sim, const char* script,
+                         const char* table, const std::vector<std::string>& simargs,
+                         const isotp_test_t* test)
+  {
+  char code[4];
+  snprintf(code, sizeof(code), "%02x", test->stmin);
+  std::vector<std::string> args = simargs;
+  args.insert(args.end(), { "--bs", std::to_string(test->bs), "--stmin", code });
+  if (!sim.Start(script, table, args))
+    {
+    printf("FAIL %s: cannot start simulator '%s'\n", test->name, script);
+    return false;
+    }
+
+  uint32_t txid = test->ext ? 0x18da44f1 : 0x7e4;
+  uint32_t rxid = test->ext ? 0x18daf144 : 0x7ec;
+  std::string request("\x2e\xf1\x90", 3);
+  for (int k = 3; k < test->length; k++)
+    request += (char)k;
+  std::string response;
+
+  sim.StartRecording();
+  int res = vehicle->PollSingleRequest(HostCanGetBus(1), txid, rxid, request, response, 10000,
+    test->ext ? ISOTP_EXTFRAME : ISOTP_STD);
+  std::vector<SimLink::frame_t> frames = sim.StopRecording();
+  sim.Stop();
+
+  // Check the response:
+  std::string error;
+  char buf[100];
+  if (res != 0)
+    {
+    snprintf(buf, sizeof(buf), "request failed, result %d", res);
+    error = buf;
+    }
+  else if (!response.empty())
+    error = "unexpected response data";
+
+  // Check the consecutive frames: count, frames per block & separation times within
+  // the blocks (1 us timestamp resolution). The median separation must not exceed
+  // the separation time by more than 0.5 ms or 5% (host scheduling), e.g. if a
+  // 100-900 us code was taken as milliseconds or as reserved:
+  double septime = isotp_septime(test->stmin);
+  int cfs = 0, block = 0;
+  double last = 0;
+  std::vector<double> gaps;
+  for (const SimLink::frame_t& frame : frames)
+    {
+    if (!frame.tx && frame.id == rxid && (frame.data[0] >> 4) == ISOTP_FT_FLOWCTRL)
+      {
+      block = 0;
+      }
+    else if (frame.tx && frame.id == txid && (frame.data[0] >> 4) == ISOTP_FT_CONSECUTIVE)
+      {
+      cfs++;
+      if (++block > 1)
+        gaps.push_back(frame.time - last);
+      if (test->bs && block > test->bs && error.empty())
+        {
+        snprintf(buf, sizeof(buf), "%d frames sent in a block of %d", block, test->bs);
+        error = buf;
+        }
+      last = frame.time;
+      }
+    }
+  int cfs_expected = (test->length - 6 + 6) / 7;
+  if (error.empty() && cfs != cfs_expected)
+    {
+    snprintf(buf, sizeof(buf), "%d consecutive frames sent, expected %d", cfs, cfs_expected);
+    error = buf;
+    }
+  double gapmin = 0, gapmedian = 0;
+  if (!gaps.empty())
+    {
+    std::sort(gaps.begin(), gaps.end());
+    gapmin = gaps.front();
+    gapmedian = gaps[gaps.size() / 2];
+    }
+  if (error.empty() && !gaps.empty() && gapmin < septime - 0.000001)
+    {
+    snprintf(buf, sizeof(buf), "separation %.3f ms below STmin %.3f ms", gapmin * 1000, septime * 1000);
+    error = buf;
+    }
+  if (error.empty() && !gaps.empty() && gapmedian > septime + MAX(0.0005, septime * 0.05))
+    {
+    snprintf(buf, sizeof(buf), "median separation %.3f ms exceeds STmin %.3f ms", gapmedian * 1000, septime * 1000);
+    error = buf;
+    }
+
+  printf("%s %s: %d frames, separation min %.3f / median %.3f ms%s%s\n",
+    error.empty() ? "PASS" : "FAIL", test->name, cfs, gapmin * 1000, gapmedian * 1000,
+    error.empty() ? "" : " -- ", error.c_str());
+  fflush(stdout);
+  return error.empty();
+  }
+
+static int RunISOTPTests(OvmsVehicleHostTest* vehicle, SimLink& sim, const char* script,
+                         const char* table, const std::vector<std::string>& simargs)
+  {
+  int failed = 0, count = sizeof(isotp_tests) / sizeof(isotp_tests[0]);
+  for (int k = 0; k < count; k++)
+    {
+    if (!RunISOTPTest(vehicle, sim, script, table, simargs, &isotp_tests[k]))
+      failed++;
+    }
+  printf("%d of %d tests passed\n", count - failed, count);
+  return failed ? 1 : 0;
+  }
+
+static void usage()
+  {
+  fprintf(stderr,
+    "Usage: poller [-d <seconds>] [-b <buses>] [-n <entries>] [-p <ms>] [-m] [-i <n>]\n"
+    "              [-s <sim_ecu.pl>] [-t <table>] [-v <level>] bench|isotp [-- <simulator options>]\n");
+  }
+
+int main(int argc, char* argv[])
+  {
+  int duration = 20, buses = 2, entries = 2, interval = 1, inflight = 1, loglevel = ESP_LOG_WARN;
+  bool multiframe = false;
+  const char* script = "../sim_ecu.pl";
+  const char* table = NULL;
+  int opt;
+  while ((opt = getopt(argc, argv, "d:b:n:p:mi:s:t:v:")) != -1)
+    {
+    switch (opt)
+      {
+      case 'd': duration = atoi(optarg); break;
+      case 'b': buses = atoi(optarg); break;
+      case 'n': entries = atoi(optarg); break;
+      case 'p': interval = atoi(optarg); break;
+      case 'm': multiframe = true; break;
+      case 'i': inflight = atoi(optarg); break;
+      case 's': script = optarg; break;
+      case 't': table = optarg; break;
+      case 'v': loglevel = atoi(optarg); break;
+      default: usage(); return 1;
+      }
+    }
+  const char* mode = (optind < argc) ? argv[optind] : "";
+  bool bench = (strcmp(mode, "bench") == 0);
+  if ((!bench && strcmp(mode, "isotp") != 0) || buses < 1 || buses > 2 || duration < 1)
+    {
+    usage();
+    return 1;
+    }
+  if (!table)
+    table = bench ? "poller_bench.txt" : "../sim_ecu_fc.txt";
+  std::vector<std::string> simargs;
+  for (int k = optind+1; k < argc; k++)
+    {
+    if (strcmp(argv[k], "--") != 0)
+      simargs.push_back(argv[k]);
+    }
+
+  signal(SIGPIPE, SIG_IGN);
+  HostStart(loglevel);
+  HostCanInit(2);
+
+  bench_buses = buses;
+  MyVehicleFactory.RegisterVehicle<OvmsVehicleHostTest>("HOST", "Host benchmark");
+  MyVehicleFactory.SetVehicle("HOST");
+  OvmsVehicleHostTest* vehicle = (OvmsVehicleHostTest*)MyVehicleFactory.m_currentvehicle;
+
+  SimLink sim;
+  int result;
+  if (bench)
+    {
+    if (!sim.Start(script, table, simargs))
+      {
+      fprintf(stderr, "Error: cannot start simulator '%s'\n", script);
+      HostExit(1);
+      }
+    result = RunBench(vehicle, sim, duration, buses, entries, interval, multiframe, inflight);
+    }
+  else
+    {
+    result = RunISOTPTests(vehicle, sim, script, table, simargs);
+    }
+  HostExit(result);
+  }
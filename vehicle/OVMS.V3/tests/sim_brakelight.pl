@@ -0,0 +1,161 @@
+#!/usr/bin/perl
+#
+# Regen brake light latency test: vehicle speed simulator
+#
+# Sends the speed frames of a vehicle to the module's CAN log TCP server (CRTD format)
+# following a cruise / deceleration profile, so the brake light path (speed frame
+# -> CalculateAcceleration() -> CheckBrakelight() -> SetBrakelight()) is exercised by
+# the real vehicle module code (for a host run without a module, see tests/host/brakelight.cpp).
+# Module setup example (Smart ED):
+#
+#   vehicle module SE
+#   config set vehicle brakelight.enable yes
+#   can can1 start active 500000
+#   can log start tcpserver simulate crtd :3000
+#   metrics set v.e.on yes
+#   log level debug vehicle
+#
+# In simulate mode, the speed frames are passed to the module's CAN framework as
+# received frames and are not sent on the bus, so this is a manual test on a module
+# (not connected to a vehicle), there is no host virtual bus.
+#
+# The module logs each brake light switch with the latency from the reception of the
+# frame by the vehicle task to the completed port change, e.g.:
+#
+#   D (123456) vehicle: brakelight on at speed=13.61 m/s, accel=-1.45 m/s^2, latency=412 us (max 530 us)
+#
+# That figure does not include the delivery of the frame to the vehicle task (CAN
+# driver or log server & queue) and the output hardware, end to end measurement of
+# these needs a scope on the CAN bus and brake light output.
+#
+# The simulator prints the time of each deceleration start and of the first frame
+# exceeding the activation threshold (accel.smoothing delays detection by some frames).
+#
+# Usage: sim_brakelight.pl [options]
+#   --host <name>       Module host name (default: devbench.local)
+#   --port <port>       CAN log server port (default: 3000)
+#   --vehicle <type>    Frame encoding: smarted, mitsubishi, twizy (default: smarted)
+#   --bus <n>           CAN bus number (default: 1)
+#   --interval <ms>     Speed frame interval (default: 20)
+#   --speed <kph>       Cruise speed (default: 60)
+#   --decel <m/s²>      Deceleration (default: 2.0)
+#   --threshold <m/s²>  Activation threshold to report (default: 1.3 = brakelight.on)
+#   --cruise <s>        Cruise time per cycle (default: 3)
+#   --brake <s>         Deceleration time per cycle (default: 2)
+#   --cycles <n>        Number of cycles (default: 5)
+#   --verbose           Log all frames
+
+use strict;
+use warnings;
+use IPC::Open2;
+use IO::Select;
+use Getopt::Long;
+use Time::HiRes qw(time sleep);
+
+my %opt =
+  (
+  'host' => 'devbench.local',
+  'port' => 3000,
+  'vehicle' => 'smarted',
+  'bus' => 1,
+  'interval' => 20,
+  'speed' => 60,
+  'decel' => 2.0,
+  'threshold' => 1.3,
+  'cruise' => 3,
+  'brake' => 2,
+  'cycles' => 5,
+  'verbose' => 0
+  );
+GetOptions(\%opt, 'host=s', 'port=i', 'vehicle=s', 'bus=i', 'interval=f', 'speed=f',
+  'decel=f', 'threshold=f', 'cruise=f', 'brake=f', 'cycles=i', 'verbose!')
+  && @ARGV == 0
+  or die "Usage: $0 [options]\n";
+
+# Speed frame encoders: kph => [ id, bytes ]
+my %encoders =
+  (
+  'smarted' => sub
+    {
+    my $v = int($_[0] * 18 + 0.5);
+    return (0x200, 0, 0, ($v >> 8) & 0xff, $v & 0xff, 0, 0, 0, 0);
+    },
+  'mitsubishi' => sub
+    {
+    return (0x412, 0, int($_[0] + 0.5) & 0xff, 0, 0, 0, 0, 0, 0);
+    },
+  'twizy' => sub
+    {
+    my $v = int($_[0] * 100 + 0.5);
+    return (0x599, 0, 0, 0, 0, 0, 0, ($v >> 8) & 0xff, $v & 0xff);
+    },
+  );
+my $encode = $encoders{$opt{'vehicle'}}
+  or die "Unknown vehicle '$opt{vehicle}', valid: " . join(', ', sort keys %encoders) . "\n";
+
+#
+# Connect to module
+#
+my ($chld_out, $chld_in);
+my $pid = open2($chld_out, $chld_in, "nc $opt{host} $opt{port}");
+select $chld_in; $| = 1;
+select STDOUT; $| = 1;
+print "Simulation running with pid #$pid, vehicle $opt{vehicle}\n";
+
+my $sel = IO::Select->new($chld_out);
+my $started = time;
+
+sub send_speed
+  {
+  my ($kph) = @_;
+  my ($id, @data) = $encode->($kph);
+  my $line = sprintf("0.0 %dR11 %03X %s", $opt{'bus'}, $id, join(' ', map { sprintf("%02X", $_) } @data));
+  print $chld_in "$line\n";
+  printf "%10.3f TX %s  (%.2f kph)\n", time - $started, $line, $kph if ($opt{'verbose'});
+  # discard module traffic:
+  while ($sel->can_read(0))
+    {
+    last if (!sysread($chld_out, my $buf, 4096));
+    }
+  }
+
+#
+# Run profile
+#
+my $interval = $opt{'interval'} / 1000;
+my $next = time;
+for my $cycle (1..$opt{'cycles'})
+  {
+  # cruise:
+  my $end = $next + $opt{'cruise'};
+  while ($next < $end)
+    {
+    sleep($next - time) if ($next > time);
+    send_speed($opt{'speed'});
+    $next += $interval;
+    }
+
+  # decelerate:
+  my $t0 = $next;
+  my $reported = 0;
+  printf "%10.3f cycle %d: deceleration start at %.1f kph, %.2f m/s²\n",
+    $t0 - $started, $cycle, $opt{'speed'}, $opt{'decel'};
+  $end = $next + $opt{'brake'};
+  while ($next < $end)
+    {
+    sleep($next - time) if ($next > time);
+    my $kph = $opt{'speed'} - $opt{'decel'} * ($next - $t0 + $interval) * 3.6;
+    $kph = 0 if ($kph < 0);
+    send_speed($kph);
+    if (!$reported && $opt{'decel'} >= $opt{'threshold'})
+      {
+      printf "%10.3f cycle %d: threshold %.2f m/s² exceeded, first frame above threshold\n",
+        time - $started, $cycle, $opt{'threshold'};
+      $reported = 1;
+      }
+    $next += $interval;
+    }
+  }
+
+printf "%10.3f done, %d cycles\n", time - $started, $opt{'cycles'};
+kill 'TERM', $pid;
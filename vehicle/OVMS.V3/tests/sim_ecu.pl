@@ -0,0 +1,474 @@
+#!/usr/bin/perl
+#
+# ECU simulator for OBD-II / UDS poller tests & benchmarks
+#
+# Simulates ISO-TP (ISO 15765-2) and VW-TP 2.0 ECUs answering the requests of the
+# module's poller from a response table. Like sim_voltampera.pl, the simulator
+# connects to the module's CAN log TCP server (CRTD format), so the real poller code
+# on the module is exercised. Module setup example:
+#
+#   can can1 start active 500000
+#   can log start tcpserver simulate crtd :3000
+#
+# In simulate mode, the simulated responses are passed to the module's CAN framework
+# as received frames and are not sent on the bus. The module's requests still go out
+# on the physical bus though, so it needs another node acknowledging them (e.g. a
+# second module bus or a CAN adapter in normal mode), and must not be connected to a
+# vehicle.
+#
+# With --stdio, the simulator talks CRTD on STDIN/STDOUT instead (messages go to
+# STDERR). The host poller harness (tests/host/poller.cpp) uses this to run the
+# poller sources against the simulator over a virtual bus, see tests/host/Makefile.
+#
+# Use 'vehicle poller status' and 'vehicle poller times' on the module to get the
+# poller side throughput & latency figures, the simulator prints its request
+# statistics every --stats seconds and on exit (Ctrl-C).
+#
+# For multi frame requests sent by the module, the simulator sends flow control
+# frames as given by --bs & --stmin and checks the consecutive frame separation within
+# a block, based on the module's CAN log timestamps (TX completion). See sim_ecu_fc.txt
+# for a test table.
+#
+# Usage: sim_ecu.pl [options] <table file>
+#   --host <name>       Module host name (default: devbench.local)
+#   --port <port>       CAN log server port (default: 3000)
+#   --stdio             Use STDIN/STDOUT instead of the CAN log server
+#   --latency <ms>      Response latency (default: 10)
+#   --jitter <ms>       Random additional response latency (default: 0)
+#   --loss <percent>    Requests lost, i.e. not answered (default: 0)
+#   --busy <percent>    Requests answered by NRC busyRepeatRequest (default: 0)
+#   --bs <n>            ISO-TP flow control block size (default: 0 = unlimited)
+#   --stmin <code>      ISO-TP flow control separation time code (default: 0)
+#   --vwtp-bs <n>       VW-TP block size offered (default: 15)
+#   --stats <seconds>   Statistics output interval (default: 10, 0 = off)
+#   --seed <n>          Random number seed (for reproducible loss/busy/jitter runs)
+#   --verbose           Log all frames
+#
+# Table file, see sim_ecu.txt for an example:
+#   ecu <name> isotp <request id> <response id> [<bus>]
+#   ecu <name> vwtp <module address> <base id> [<bus>]
+#   <name> <request bytes> [*] = <response bytes> [fill <n>]
+#   <name> <request bytes> [*] = nrc <code>
+#
+# All values are hex. A '*' matches any request payload following the given bytes,
+# 'fill <n>' appends <n> pattern bytes to the response (for long responses).
+# Requests without a table entry are answered by NRC requestOutOfRange (0x31).
+
+use strict;
+use warnings;
+use IPC::Open2;
+use IO::Select;
+use Getopt::Long;
+use Time::HiRes qw(time);
+
+my %opt =
+  (
+  'host' => 'devbench.local',
+  'port' => 3000,
+  'stdio' => 0,
+  'latency' => 10,
+  'jitter' => 0,
+  'loss' => 0,
+  'busy' => 0,
+  'bs' => 0,
+  'stmin' => 0,
+  'vwtp-bs' => 15,
+  'stats' => 10,
+  'verbose' => 0
+  );
+GetOptions(\%opt, 'host=s', 'port=i', 'stdio!', 'latency=f', 'jitter=f', 'loss=f', 'busy=f',
+  'bs=i', 'stmin=s', 'vwtp-bs=i', 'stats=i', 'seed=i', 'verbose!')
+  && @ARGV == 1
+  or die "Usage: $0 [options] <table file>\n";
+$opt{'stmin'} = hex($opt{'stmin'});
+srand($opt{'seed'}) if (defined $opt{'seed'});
+
+my %ecus;     # by name
+my %rxmap;    # "<bus>:<id>" => ECU receiving on this ID
+my %vwtpmap;  # "<bus>:<base id>:<module>" => VW-TP ECU
+
+# Hex string to byte list, tokens may hold multiple bytes ("22 0101"):
+sub hexbytes
+  {
+  return map { hex } map { /(..?)/g } split(' ', $_[0]);
+  }
+
+#
+# Read table
+#
+open(my $tbl, '<', $ARGV[0]) or die "$ARGV[0]: $!\n";
+while (<$tbl>)
+  {
+  s/#.*//;
+  next if (/^\s*$/);
+  my @f = split;
+  if ($f[0] eq 'ecu')
+    {
+    my ($name,$type,$a,$b,$bus) = @f[1..5];
+    my $e = { 'name' => $name, 'type' => $type, 'bus' => ($bus || 1), 'table' => [],
+              'requests' => 0, 'responses' => 0, 'nrcs' => 0, 'lost' => 0, 'bytes' => 0,
+              'cfs' => 0, 'cfgap' => undef, 'cfshort' => 0 };
+    if ($type eq 'isotp')
+      {
+      $e->{'reqid'} = hex($a);
+      $e->{'respid'} = hex($b);
+      $e->{'ext'} = ($e->{'reqid'} > 0x7ff) ? 1 : 0;
+      $rxmap{"$e->{bus}:$e->{reqid}"} = $e;
+      }
+    elsif ($type eq 'vwtp')
+      {
+      $e->{'module'} = hex($a);
+      $e->{'baseid'} = hex($b);
+      $e->{'ext'} = 0;
+      $vwtpmap{"$e->{bus}:$e->{baseid}:$e->{module}"} = $e;
+      }
+    else
+      {
+      die "$ARGV[0]:$.: unknown ECU type '$type'\n";
+      }
+    $ecus{$name} = $e;
+    }
+  else
+    {
+    my $e = $ecus{$f[0]} or die "$ARGV[0]:$.: unknown ECU '$f[0]'\n";
+    my ($req,$resp) = split(/=/, join(' ', @f[1..$#f]), 2);
+    die "$ARGV[0]:$.: missing response\n" if (!defined $resp);
+    my $wild = ($req =~ s/\*//);
+    my @resp;
+    if ($resp =~ /^\s*nrc\s+(\S+)/)
+      {
+      @resp = (0x7f, -1, hex($1));   # -1: request type
+      }
+    else
+      {
+      my $fill = ($resp =~ s/fill\s+(\S+)//) ? hex($1) : 0;
+      @resp = hexbytes($resp);
+      push @resp, map { $_ & 0xff } (1..$fill);
+      }
+    push @{$e->{'table'}}, { 'req' => [ hexbytes($req) ], 'wild' => $wild, 'resp' => \@resp };
+    }
+  }
+close($tbl);
+die "No ECUs defined\n" if (!%ecus);
+
+#
+# Connect to module
+#
+my ($chld_out, $chld_in, $log);
+if ($opt{'stdio'})
+  {
+  ($chld_out, $chld_in, $log) = (\*STDIN, \*STDOUT, \*STDERR);
+  select $chld_in; $| = 1;
+  select $log; $| = 1;
+  print "Simulation running on stdio, ", scalar(keys %ecus), " ECUs\n";
+  }
+else
+  {
+  my $pid = open2($chld_out, $chld_in, "nc $opt{host} $opt{port}");
+  $log = \*STDOUT;
+  select $chld_in; $| = 1;
+  select $log; $| = 1;
+  print "Simulation running with pid #$pid, ", scalar(keys %ecus), " ECUs\n";
+  }
+
+my @queue;    # [ time, line ] sorted by time
+my $started = time;
+my $laststats = $started;
+
+$SIG{INT} = $SIG{TERM} = sub { stats(); exit 0; };
+
+sub schedule
+  {
+  my ($t, $line) = @_;
+  my $i = @queue;
+  $i-- while ($i > 0 && $queue[$i-1]->[0] > $t);
+  splice(@queue, $i, 0, [ $t, $line ]);
+  }
+
+sub frame
+  {
+  my ($e, $t, $id, @data) = @_;
+  push @data, 0x55 while (@data < 8 && $e->{'type'} eq 'isotp');
+  my $line = sprintf("0.0 %dR%s %0*X %s", $e->{'bus'}, $e->{'ext'} ? '29' : '11',
+    $e->{'ext'} ? 8 : 3, $id, join(' ', map { sprintf("%02X", $_) } @data));
+  schedule($t, $line);
+  }
+
+sub latency
+  {
+  return time + ($opt{'latency'} + rand($opt{'jitter'})) / 1000;
+  }
+
+sub stmin
+  {
+  my ($code) = @_;
+  return $code / 1000 if ($code <= 0x7f);
+  return ($code - 0xf0) / 10000 if ($code >= 0xf1 && $code <= 0xf9);
+  return 0.127;
+  }
+
+sub stats
+  {
+  my $secs = time - $started;
+  printf "Statistics after %.0f seconds:\n", $secs;
+  foreach my $e (sort { $a->{'name'} cmp $b->{'name'} } values %ecus)
+    {
+    printf "  %-12s %6d requests (%.1f/s), %6d responses, %5d NRCs, %5d lost, %8d bytes sent\n",
+      $e->{'name'}, $e->{'requests'}, $secs ? $e->{'requests'} / $secs : 0,
+      $e->{'responses'}, $e->{'nrcs'}, $e->{'lost'}, $e->{'bytes'};
+    printf "  %-12s %6d consecutive frames received, min separation %.3f ms, %d below STmin\n",
+      '', $e->{'cfs'}, $e->{'cfgap'} * 1000, $e->{'cfshort'}
+      if (defined $e->{'cfgap'});
+    }
+  }
+
+#
+# Request processing
+#
+sub request
+  {
+  my ($e, @req) = @_;
+  $e->{'requests'}++;
+  if (rand(100) < $opt{'loss'})
+    {
+    $e->{'lost'}++;
+    return;
+    }
+
+  my @resp;
+  if (rand(100) < $opt{'busy'})
+    {
+    @resp = (0x7f, $req[0], 0x21);
+    }
+  else
+    {
+    @resp = (0x7f, $req[0], 0x31);
+    ENTRY: foreach my $r (@{$e->{'table'}})
+      {
+      my @m = @{$r->{'req'}};
+      next if (@req < @m || (!$r->{'wild'} && @req != @m));
+      for (my $i = 0; $i < @m; $i++)
+        {
+        next ENTRY if ($req[$i] != $m[$i]);
+        }
+      @resp = map { ($_ < 0) ? $req[0] : $_ } @{$r->{'resp'}};
+      last;
+      }
+    }
+
+  if ($resp[0] == 0x7f) { $e->{'nrcs'}++; } else { $e->{'responses'}++; }
+  $e->{'bytes'} += @resp;
+  print "$e->{name}: request ", join(' ', map { sprintf("%02X", $_) } @req),
+    " => ", join(' ', map { sprintf("%02X", $_) } @resp), "\n" if ($opt{'verbose'});
+
+  if ($e->{'type'} eq 'vwtp') { vwtp_send($e, latency(), @resp); }
+  else { isotp_send($e, latency(), @resp); }
+  }
+
+#
+# ISO-TP
+#
+sub isotp_send
+  {
+  my ($e, $t, @resp) = @_;
+  if (@resp <= 7)
+    {
+    frame($e, $t, $e->{'respid'}, scalar(@resp), @resp);
+    }
+  else
+    {
+    my $len = @resp;
+    frame($e, $t, $e->{'respid'}, 0x10 | ($len >> 8), $len & 0xff, splice(@resp, 0, 6));
+    $e->{'txbuf'} = \@resp;
+    $e->{'txsn'} = 1;
+    $e->{'txtime'} = $t;
+    }
+  }
+
+sub isotp_send_block
+  {
+  my ($e, $bs, $st) = @_;
+  my $t = ($e->{'txtime'} > time) ? $e->{'txtime'} : time;
+  my $n = 0;
+  while (@{$e->{'txbuf'}})
+    {
+    frame($e, $t, $e->{'respid'}, 0x20 | ($e->{'txsn'}++ & 0x0f), splice(@{$e->{'txbuf'}}, 0, 7));
+    last if ($bs && ++$n >= $bs);
+    $t += $st;
+    }
+  $e->{'txtime'} = $t;
+  delete $e->{'txbuf'} if (!@{$e->{'txbuf'}});
+  }
+
+sub isotp_receive
+  {
+  my ($e, $ts, @d) = @_;
+  my $type = $d[0] >> 4;
+  if ($type == 0)
+    {
+    request($e, @d[1..($d[0] & 0x0f)]);
+    }
+  elsif ($type == 1)
+    {
+    $e->{'rxlen'} = (($d[0] & 0x0f) << 8) | $d[1];
+    $e->{'rxbuf'} = [ @d[2..7] ];
+    $e->{'rxbs'} = $opt{'bs'};
+    $e->{'rxcfts'} = undef;
+    frame($e, time, $e->{'respid'}, 0x30, $opt{'bs'}, $opt{'stmin'});
+    }
+  elsif ($type == 2 && $e->{'rxbuf'})
+    {
+    # Check flow control compliance, the separation time applies within a block:
+    $e->{'cfs'}++;
+    if (defined $e->{'rxcfts'})
+      {
+      my $gap = $ts - $e->{'rxcfts'};
+      $e->{'cfgap'} = $gap if (!defined $e->{'cfgap'} || $gap < $e->{'cfgap'});
+      $e->{'cfshort'}++ if ($gap < stmin($opt{'stmin'}) - 0.000001); # 1 us log resolution
+      print "$e->{name}: consecutive frame separation ", sprintf("%.3f", $gap * 1000), " ms\n"
+        if ($opt{'verbose'});
+      }
+    $e->{'rxcfts'} = $ts;
+    push @{$e->{'rxbuf'}}, @d[1..7];
+    if (@{$e->{'rxbuf'}} >= $e->{'rxlen'})
+      {
+      my @req = splice(@{$e->{'rxbuf'}}, 0, $e->{'rxlen'});
+      delete $e->{'rxbuf'};
+      request($e, @req);
+      }
+    elsif ($opt{'bs'} && --$e->{'rxbs'} == 0)
+      {
+      $e->{'rxbs'} = $opt{'bs'};
+      $e->{'rxcfts'} = undef;
+      frame($e, time, $e->{'respid'}, 0x30, $opt{'bs'}, $opt{'stmin'});
+      }
+    }
+  elsif ($type == 3 && $e->{'txbuf'})
+    {
+    isotp_send_block($e, $d[1], stmin($d[2])) if (($d[0] & 0x0f) == 0);
+    delete $e->{'txbuf'} if (($d[0] & 0x0f) == 2);
+    }
+  }
+
+#
+# VW-TP 2.0
+#
+sub vwtp_setup
+  {
+  my ($e, @d) = @_;
+  # distinct channel IDs per module, based on the tester RX ID offered:
+  $e->{'txid'} = ($d[4] | (($d[5] & 0x0f) << 8)) + $e->{'module'};
+  $e->{'rxid'} = 0x740 + $e->{'module'};
+  $e->{'txseq'} = 0;
+  $rxmap{"$e->{bus}:$e->{rxid}"} = $e;
+  frame($e, latency(), $e->{'baseid'} + $e->{'module'},
+    0x00, 0xd0, $e->{'txid'} & 0xff, $e->{'txid'} >> 8, $e->{'rxid'} & 0xff, $e->{'rxid'} >> 8, 0x01);
+  }
+
+sub vwtp_params
+  {
+  my ($e) = @_;
+  # block size, ACK timeout 100 ms, frame interval 1 ms:
+  frame($e, time, $e->{'txid'}, 0xa1, $opt{'vwtp-bs'}, 0x8a, 0xff, 0x0a, 0xff);
+  }
+
+sub vwtp_send
+  {
+  my ($e, $t, @resp) = @_;
+  my $len = @resp;
+  my @chunk = (($len >> 8) & 0x0f, $len & 0xff, splice(@resp, 0, 5));
+  my $block = 0;
+  while (1)
+    {
+    my $op = (!@resp) ? 0x10 : (++$block % $opt{'vwtp-bs'} == 0) ? 0x00 : 0x20;
+    frame($e, $t, $e->{'txid'}, $op | ($e->{'txseq'}++ & 0x0f), @chunk);
+    last if (!@resp);
+    @chunk = splice(@resp, 0, 7);
+    $t += 0.001;
+    }
+  }
+
+sub vwtp_receive
+  {
+  my ($e, @d) = @_;
+  my $op = $d[0];
+  if ($op == 0xa0 || $op == 0xa3)
+    {
+    vwtp_params($e);
+    }
+  elsif ($op == 0xa8)
+    {
+    frame($e, time, $e->{'txid'}, 0xa8);
+    delete $rxmap{"$e->{bus}:$e->{rxid}"};
+    }
+  elsif ($op < 0x40)
+    {
+    if (!$e->{'rxbuf'})
+      {
+      $e->{'rxlen'} = (($d[1] & 0x0f) << 8) | $d[2];
+      $e->{'rxbuf'} = [ @d[3..$#d] ];
+      }
+    else
+      {
+      push @{$e->{'rxbuf'}}, @d[1..$#d];
+      }
+    # ACK if requested:
+    frame($e, time, $e->{'txid'}, 0xb0 | (($op + 1) & 0x0f)) if (($op & 0xf0) <= 0x10);
+    if (@{$e->{'rxbuf'}} >= $e->{'rxlen'})
+      {
+      my @req = splice(@{$e->{'rxbuf'}}, 0, $e->{'rxlen'});
+      delete $e->{'rxbuf'};
+      request($e, @req);
+      }
+    }
+  }
+
+#
+# Main loop
+#
+my $sel = IO::Select->new($chld_out);
+my $inbuf = '';
+while (1)
+  {
+  # Send due frames:
+  my $now = time;
+  while (@queue && $queue[0]->[0] <= $now)
+    {
+    my $line = shift(@queue)->[1];
+    print "TX: $line\n" if ($opt{'verbose'});
+    print $chld_in $line, "\n";
+    }
+  if ($opt{'stats'} && $now - $laststats >= $opt{'stats'})
+    {
+    stats();
+    $laststats = $now;
+    }
+
+  # Wait for input:
+  my $timeout = (@queue) ? $queue[0]->[0] - $now : 1;
+  $timeout = 0 if ($timeout < 0);
+  next if (!$sel->can_read($timeout));
+  my $n = sysread($chld_out, $inbuf, 4096, length($inbuf));
+  last if (!$n);
+
+  while ($inbuf =~ s/^([^\n]*)\n//)
+    {
+    my $line = $1;
+    $line =~ s/\r$//;
+    next if ($line !~ /^(\d+\.\d+) (\d)[RT](11|29) (\S+)\s*(.*)/);
+    my ($ts, $bus, $id, @d) = ($1, $2, hex($4), map { hex } split(' ', $5));
+    next if (!@d);
+    print "RX: $line\n" if ($opt{'verbose'});
+    if (my $e = $rxmap{"$bus:$id"})
+      {
+      if ($e->{'type'} eq 'vwtp') { vwtp_receive($e, @d); }
+      else { isotp_receive($e, $ts, @d); }
+      }
+    elsif (@d == 7 && $d[1] == 0xc0 && (my $v = $vwtpmap{"$bus:$id:$d[0]"}))
+      {
+      vwtp_setup($v, @d);
+      }
+    }
+  }
+
+stats();